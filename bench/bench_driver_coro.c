@@ -0,0 +1,229 @@
+/* bench_driver_coro.c – Sensor conversations: coroutines on one thread vs one thread per device */
+
+#define _POSIX_C_SOURCE 200112L
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+
+#include "alloc_track.h"
+#include "driver_coro.h"
+#include "i2c_mock.h"
+#include "mem_pool.h"
+#include "timebase.h"
+
+#define CONVERSION_NS     1000000ULL    // Wait between starting a conversion and reading it
+#define ROUNDS            20
+#define THREAD_STACK      (64U * 1024)
+
+// One device on its own bus, so neither variant contends for a bus
+typedef struct {
+    i2c_mock_bus_t bus;
+    i2c_mock_target_t target;
+    i2c_driver_t i2c;
+    driver_async_i2c_t async;
+    int32_t sum;
+} device_t;
+
+typedef struct {
+    uint32_t round;
+    uint8_t config[2];
+    uint8_t reg;
+    uint8_t data[6];
+    i2c_msg_t msgs[2];
+} conversation_frame_t;
+
+static mem_arena_t arena;
+static void *arena_buffer;
+
+static double clock_seconds(clockid_t clock) {
+    struct timespec ts;
+    clock_gettime(clock, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static void sleep_until(uint64_t deadline_ns) {
+    struct timespec ts = {(time_t)(deadline_ns / 1000000000ULL), (long)(deadline_ns % 1000000000ULL)};
+    clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL);
+}
+
+static int32_t calibrate(const uint8_t *data) {
+    int32_t x = (int16_t)((data[0] << 8) | data[1]);
+    int32_t y = (int16_t)((data[2] << 8) | data[3]);
+    int32_t z = (int16_t)((data[4] << 8) | data[5]);
+    return (x * 3 + y * 5 + z * 7) >> 2;
+}
+
+static device_t* devices_create(uint32_t count) {
+    driver_async_config_t config = {2, 0, NULL};
+    device_t *devices = calloc(count, sizeof(device_t));
+
+    // More register blocks than the static pool holds: place them in an
+    // arena sized for the run
+    size_t arena_size = count * ((MEM_POOL_I2C_REGS_BYTES + 7u) & ~7u);
+    arena_buffer = malloc(arena_size);
+    mem_arena_init(&arena, arena_buffer, arena_size);
+    mem_pool_use_arena(&arena);
+
+    for (uint32_t i = 0; i < count; i++) {
+        device_t *d = &devices[i];
+        i2c_mock_init(&d->bus);
+        d->target.address = 0x68;
+        for (uint8_t r = 0; r < 6; r++) {
+            d->target.regs[0x3B + r] = (uint8_t)(i + r);
+        }
+        i2c_mock_attach(&d->bus, &d->target);
+        i2c_driver_init(&d->i2c, 0x68, 400000);
+        d->i2c.backend = &d->bus.backend;
+        driver_async_bind_i2c(&d->async, &d->i2c, &config);
+    }
+
+    return devices;
+}
+
+static void devices_destroy(device_t *devices, uint32_t count) {
+    for (uint32_t i = 0; i < count; i++) {
+        i2c_driver_deinit(&devices[i].i2c);
+    }
+    mem_pool_use_arena(NULL);
+    free(arena_buffer);
+    free(devices);
+}
+
+static driver_coro_status_t conversation(driver_coro_t *co) {
+    conversation_frame_t *f = (conversation_frame_t*)co->frame;
+    device_t *d = (device_t*)co->arg;
+
+    DRIVER_CORO_BEGIN(co);
+    for (f->round = 0; f->round < ROUNDS; f->round++) {
+        f->config[0] = 0x6B;
+        f->config[1] = 0x01;
+        f->msgs[0] = (i2c_msg_t){0x68, 0, f->config, 2};
+        co->req.op.i2c.msgs = f->msgs;
+        co->req.op.i2c.msg_count = 1;
+        DRIVER_CORO_AWAIT(co, &d->async.channel);
+
+        DRIVER_CORO_SLEEP(co, CONVERSION_NS);
+
+        f->reg = 0x3B;
+        f->msgs[0] = (i2c_msg_t){0x68, 0, &f->reg, 1};
+        f->msgs[1] = (i2c_msg_t){0x68, I2C_MSG_READ, f->data, 6};
+        co->req.op.i2c.msgs = f->msgs;
+        co->req.op.i2c.msg_count = 2;
+        DRIVER_CORO_AWAIT(co, &d->async.channel);
+
+        d->sum += calibrate(f->data);
+    }
+    DRIVER_CORO_END(co);
+}
+
+static void* device_thread(void *arg) {
+    device_t *d = (device_t*)arg;
+    uint8_t config = 0x01;
+    uint8_t data[6];
+
+    for (uint32_t round = 0; round < ROUNDS; round++) {
+        i2c_driver_write(&d->i2c, 0x6B, &config, 1);
+        sleep_until(timebase_now_ns() + CONVERSION_NS);
+        i2c_driver_read(&d->i2c, 0x3B, data, 6);
+        d->sum += calibrate(data);
+    }
+
+    return NULL;
+}
+
+static int64_t checksum(const device_t *devices, uint32_t count) {
+    int64_t sum = 0;
+    for (uint32_t i = 0; i < count; i++) {
+        sum += devices[i].sum;
+    }
+    return sum;
+}
+
+static void bench_coroutines(uint32_t count) {
+    device_t *devices = devices_create(count);
+    size_t pool_bytes = DRIVER_CORO_POOL_BYTES(sizeof(conversation_frame_t), count);
+    void *storage = malloc(pool_bytes);
+    driver_coro_t **timers = malloc(count * sizeof(driver_coro_t*));
+    driver_coro_pool_t pool;
+    driver_coro_exec_t exec;
+
+    driver_coro_pool_init(&pool, storage, pool_bytes, sizeof(conversation_frame_t));
+    driver_coro_exec_init(&exec, timebase_now_ns, timers, (uint16_t)count);
+
+    double wall = clock_seconds(CLOCK_MONOTONIC);
+    double cpu = clock_seconds(CLOCK_PROCESS_CPUTIME_ID);
+    // Steady state: spawning and running must not touch the heap
+    alloc_track_arm();
+    for (uint32_t i = 0; i < count; i++) {
+        driver_coro_spawn(&exec, &pool, conversation, &devices[i]);
+    }
+    while (driver_coro_exec_live(&exec) > 0) {
+        driver_coro_exec_run(&exec);
+        uint64_t wake = driver_coro_exec_next_wake(&exec);
+        if (wake != UINT64_MAX) {
+            sleep_until(wake);
+        }
+    }
+    alloc_track_disarm();
+    cpu = clock_seconds(CLOCK_PROCESS_CPUTIME_ID) - cpu;
+    wall = clock_seconds(CLOCK_MONOTONIC) - wall;
+
+    printf("  coroutines  %5u devices  wall %7.1f ms  cpu %7.1f ms  %6.2f us cpu/conversation  "
+           "memory %7.1f KiB  (sum %lld)\n",
+           count, wall * 1e3, cpu * 1e3, cpu * 1e6 / ((double)count * ROUNDS),
+           (pool_bytes + count * sizeof(driver_coro_t*)) / 1024.0, (long long)checksum(devices, count));
+
+    free(timers);
+    free(storage);
+    devices_destroy(devices, count);
+}
+
+static void bench_threads(uint32_t count) {
+    device_t *devices = devices_create(count);
+    pthread_t *threads = malloc(count * sizeof(pthread_t));
+    pthread_attr_t attr;
+    uint32_t started = 0;
+
+    pthread_attr_init(&attr);
+    pthread_attr_setstacksize(&attr, THREAD_STACK);
+
+    double wall = clock_seconds(CLOCK_MONOTONIC);
+    double cpu = clock_seconds(CLOCK_PROCESS_CPUTIME_ID);
+    for (uint32_t i = 0; i < count; i++) {
+        if (pthread_create(&threads[i], &attr, device_thread, &devices[i]) != 0) break;
+        started++;
+    }
+    for (uint32_t i = 0; i < started; i++) {
+        pthread_join(threads[i], NULL);
+    }
+    cpu = clock_seconds(CLOCK_PROCESS_CPUTIME_ID) - cpu;
+    wall = clock_seconds(CLOCK_MONOTONIC) - wall;
+
+    if (started < count) {
+        printf("  threads     %5u devices  only %u threads could be created\n", count, started);
+    } else {
+        printf("  threads     %5u devices  wall %7.1f ms  cpu %7.1f ms  %6.2f us cpu/conversation  "
+               "stacks %7.1f KiB  (sum %lld)\n",
+               count, wall * 1e3, cpu * 1e3, cpu * 1e6 / ((double)count * ROUNDS),
+               (double)count * THREAD_STACK / 1024.0, (long long)checksum(devices, count));
+    }
+
+    pthread_attr_destroy(&attr);
+    free(threads);
+    devices_destroy(devices, count);
+}
+
+int main(void) {
+    const uint32_t counts[] = {10, 100, 1000, 4000};
+
+    printf("Sensor conversation: config write, %llu us conversion, 6-byte burst read; %u rounds\n",
+           CONVERSION_NS / 1000, ROUNDS);
+    for (uint32_t i = 0; i < sizeof(counts) / sizeof(counts[0]); i++) {
+        bench_coroutines(counts[i]);
+        bench_threads(counts[i]);
+    }
+
+    return 0;
+}
@@ -0,0 +1,333 @@
+/* bench_peripheral_sim.c – Driver stack over the simulated peripherals */
+
+#define _POSIX_C_SOURCE 199309L
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include "device_drivers.h"
+#include "peripheral_sim.h"
+#include "protocol_wire.h"
+#include "spi_queue.h"
+#include "gpio_capture.h"
+
+#define UART_BYTES    (256U * 1024U)
+#define SPI_READS     20000
+#define RX_FRAMES     20000
+#define ADC_COUNT     4
+#define ADC_ROUNDS    5000
+#define TACH_PERIODS  200000
+
+static void uart_isr(void *context) {
+    uart_driver_process_interrupt((uart_driver_t*)context);
+}
+
+static void spi_queue_isr(void *context) {
+    spi_queue_process_interrupt((spi_queue_t*)context);
+}
+
+static void gpio_capture_isr(void *context) {
+    gpio_capture_sample((gpio_capture_t*)context);
+}
+
+static void count_message(const protocol_frame_t *frame, void *context) {
+    (void)frame;
+    (*(uint32_t*)context)++;
+}
+
+static double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static void report(const char *name, double wall, uint64_t virtual_ns, double units, const char *unit) {
+    double simulated = virtual_ns * 1e-9;
+    printf("%-28s %9.3f s simulated  %7.3f s wall  x%8.1f real time  %10.0f %s/s wall\n",
+           name, simulated, wall, simulated / wall, units / wall, unit);
+}
+
+static void bench_uart(uint32_t baud) {
+    peripheral_sim_config_t config = {72000000, 0};
+    uart_config_t uart_config = {baud, 8, 0, 0, false};
+    peripheral_sim_t sim;
+    uart_driver_t driver;
+    uint8_t block[256];
+    char name[32];
+
+    memset(&driver, 0, sizeof(driver));
+    memset(block, 0x5A, sizeof(block));
+    peripheral_sim_init(&sim, &config);
+    peripheral_sim_install(&sim);
+    uart_driver_init(&driver, &uart_config);
+    peripheral_sim_attach_uart(&sim, driver.uart, NULL);
+
+    double start = now_seconds();
+    for (uint32_t sent = 0; sent < UART_BYTES; sent += sizeof(block)) {
+        uart_driver_transmit(&driver, block, sizeof(block));
+    }
+    double wall = now_seconds() - start;
+
+    snprintf(name, sizeof(name), "uart_driver_transmit %u", baud);
+    report(name, wall, peripheral_sim_now(&sim), UART_BYTES, "bytes");
+    uart_driver_deinit(&driver);
+    peripheral_sim_uninstall();
+}
+
+static void bench_spi(uint8_t prescaler) {
+    peripheral_sim_config_t config = {72000000, 0};
+    spi_config_t spi_config = {prescaler, 8, 0, 0, false, false};
+    peripheral_sim_t sim;
+    peripheral_sim_regmap_t regmap;
+    spi_driver_t driver;
+    GPIO_TypeDef cs;
+    uint8_t tx[7] = {0x80 | 0x20, 0, 0, 0, 0, 0, 0};
+    uint8_t rx[7];
+    char name[32];
+
+    memset(&driver, 0, sizeof(driver));
+    memset(&regmap, 0, sizeof(regmap));
+    memset(&cs, 0, sizeof(cs));
+    cs.MODER = 0x1U;
+    cs.ODR = 0x1U;
+    peripheral_sim_device_t device = peripheral_sim_regmap_device(&regmap);
+
+    peripheral_sim_init(&sim, &config);
+    peripheral_sim_install(&sim);
+    spi_driver_init(&driver, &spi_config);
+    driver.cs_gpio = &cs;
+    driver.cs_pin = 0;
+    peripheral_sim_attach_spi(&sim, driver.spi, &cs, 0, &device);
+
+    double start = now_seconds();
+    for (uint32_t i = 0; i < SPI_READS; i++) {
+        spi_driver_transfer(&driver, tx, rx, sizeof(tx));
+    }
+    double wall = now_seconds() - start;
+
+    snprintf(name, sizeof(name), "spi_driver_transfer /%u", 2U << prescaler);
+    report(name, wall, peripheral_sim_now(&sim), SPI_READS, "reads");
+    spi_driver_deinit(&driver);
+    peripheral_sim_uninstall();
+}
+
+// 16-bit ADC samples at SCK = pclk / 2 with 150 ns per register access,
+// moved as 8-bit byte pairs (core-bound: two accesses per 222 ns frame) or
+// as 16-bit frames (wire-bound)
+static void bench_spi_samples(bool wide) {
+    peripheral_sim_config_t config = {72000000, 150};
+    spi_config_t spi_config = {0, wide ? 16 : 8, 0, 0, false, false};
+    peripheral_sim_t sim;
+    SPI_TypeDef spi;
+    uint16_t tx[64] = {0};
+    uint16_t rx[64];
+
+    memset(&spi, 0, sizeof(spi));
+    peripheral_sim_init(&sim, &config);
+    peripheral_sim_install(&sim);
+    spi_init(&spi, &spi_config);
+    peripheral_sim_attach_spi(&sim, &spi, NULL, 0, NULL);
+
+    double start = now_seconds();
+    for (uint32_t block = 0; block < SPI_READS / 4; block++) {
+        spi_transmit_receive(&spi, (uint8_t*)tx, (uint8_t*)rx, wide ? 64 : 128);
+    }
+    double wall = now_seconds() - start;
+
+    uint64_t elapsed = peripheral_sim_now(&sim);
+    double samples = (double)SPI_READS / 4 * 64;
+    printf("%-28s %9.3f s simulated  %7.3f s wall  %8.0f ksamples/s  wire=%5.1f%%\n",
+           wide ? "spi 16-bit frames" : "spi 8-bit byte pairs", elapsed * 1e-9, wall,
+           samples / (elapsed * 1e-9) / 1000.0,
+           100.0 * peripheral_sim_get_stats(&sim, &spi)->busy_ns / elapsed);
+    peripheral_sim_uninstall();
+}
+
+// Four ADCs on one bus, each sampled with a 3-byte register read per round.
+// Blocking: one spi_driver_transfer at a time. Queued: every round submitted
+// at once and moved by DMA while the core is free.
+static void bench_spi_adcs(bool queued) {
+    peripheral_sim_config_t config = {72000000, 0};
+    spi_config_t spi_config = {2, 8, 0, 0, false, false};
+    peripheral_sim_t sim;
+    peripheral_sim_regmap_t regmaps[ADC_COUNT];
+    spi_device_t devices[ADC_COUNT];
+    spi_segment_t segments[ADC_COUNT];
+    spi_transaction_t txns[ADC_COUNT];
+    spi_driver_t driver;
+    spi_queue_t queue;
+    DMA_Channel_TypeDef dma_tx;
+    DMA_Channel_TypeDef dma_rx;
+    GPIO_TypeDef cs;
+    uint8_t tx[3] = {0x80 | 0x20, 0, 0};
+    uint8_t rx[ADC_COUNT][3];
+
+    memset(&driver, 0, sizeof(driver));
+    memset(regmaps, 0, sizeof(regmaps));
+    memset(txns, 0, sizeof(txns));
+    memset(&dma_tx, 0, sizeof(dma_tx));
+    memset(&dma_rx, 0, sizeof(dma_rx));
+    memset(&cs, 0, sizeof(cs));
+    cs.MODER = 0x55U;
+    cs.ODR = 0xFU;
+
+    peripheral_sim_init(&sim, &config);
+    peripheral_sim_install(&sim);
+    spi_driver_init(&driver, &spi_config);
+    driver.cs_gpio = &cs;
+    for (uint8_t i = 0; i < ADC_COUNT; i++) {
+        peripheral_sim_device_t device = peripheral_sim_regmap_device(&regmaps[i]);
+        peripheral_sim_attach_spi(&sim, driver.spi, &cs, i, &device);
+        devices[i] = (spi_device_t){&cs, i, 0, 2};
+        segments[i] = (spi_segment_t){tx, rx[i], sizeof(tx)};
+        txns[i].device = &devices[i];
+        txns[i].segments = &segments[i];
+        txns[i].segment_count = 1;
+    }
+    if (queued) {
+        driver.dma_tx = &dma_tx;
+        driver.dma_rx = &dma_rx;
+        peripheral_sim_attach_dma(&sim, &dma_tx, driver.spi, true);
+        peripheral_sim_attach_dma(&sim, &dma_rx, driver.spi, false);
+        peripheral_sim_set_irq(&sim, &dma_rx, spi_queue_isr, &queue);
+    }
+    spi_queue_init(&queue, &driver, peripheral_sim_clock);
+
+    double start = now_seconds();
+    for (uint32_t round = 0; round < ADC_ROUNDS; round++) {
+        for (uint8_t i = 0; i < ADC_COUNT; i++) {
+            if (queued) {
+                spi_queue_submit(&queue, &txns[i]);
+            } else {
+                driver.cs_pin = i;
+                spi_driver_transfer(&driver, tx, rx[i], sizeof(tx));
+            }
+        }
+        while (!spi_queue_idle(&queue) && peripheral_sim_step(&sim)) {
+        }
+    }
+    double wall = now_seconds() - start;
+
+    const peripheral_sim_stats_t *bus = peripheral_sim_get_stats(&sim, driver.spi);
+    uint64_t elapsed = peripheral_sim_now(&sim);
+    printf("%-28s %9.3f s simulated  %7.3f s wall  bus=%5.1f%%", queued ? "spi_queue 4 ADCs (DMA)" : "spi_driver_transfer 4 ADCs",
+           elapsed * 1e-9, wall, 100.0 * bus->busy_ns / elapsed);
+    if (queued) {
+        const spi_queue_stats_t *stats = spi_queue_get_stats(&queue);
+        printf("  mean=%6.0f ns  p99=%llu ns  dma_runs=%u", (double)stats->total_ns / stats->transactions,
+               (unsigned long long)latency_hist_percentile(&stats->latency, 99.0), stats->dma_runs);
+    }
+    printf("\n");
+    spi_driver_deinit(&driver);
+    peripheral_sim_uninstall();
+}
+
+// Variable-length protocol frames at 3 Mbaud into the framer, either one
+// RXNE interrupt per byte or circular DMA flushed on half/full/idle
+static void bench_uart_rx(bool circular) {
+    peripheral_sim_config_t config = {72000000, 0};
+    uart_config_t uart_config = {3000000, 8, 0, 0, false};
+    peripheral_sim_t sim;
+    uart_driver_t driver;
+    DMA_Channel_TypeDef dma_rx;
+    protocol_framer_t framer;
+    uint8_t payload[PROTOCOL_MAX_PAYLOAD];
+    uint8_t frame[PROTOCOL_MAX_FRAME];
+    uint8_t scratch[PROTOCOL_MAX_FRAME];
+    uint32_t messages = 0;
+    uint64_t bytes = 0;
+
+    memset(&driver, 0, sizeof(driver));
+    memset(&dma_rx, 0, sizeof(dma_rx));
+    memset(payload, 0x33, sizeof(payload));
+    peripheral_sim_init(&sim, &config);
+    peripheral_sim_install(&sim);
+    uart_driver_init(&driver, &uart_config);
+    peripheral_sim_attach_uart(&sim, driver.uart, NULL);
+    peripheral_sim_set_irq(&sim, driver.uart, uart_isr, &driver);
+    protocol_framer_init(&framer, count_message, &messages);
+
+    if (circular) {
+        driver.dma_rx = &dma_rx;
+        peripheral_sim_attach_dma(&sim, &dma_rx, driver.uart, false);
+        peripheral_sim_set_irq(&sim, &dma_rx, uart_isr, &driver);
+        uart_driver_start_circular_rx(&driver, NULL, 0, &framer);
+    }
+
+    uint64_t frame_ns = peripheral_sim_uart_frame_ns(driver.uart);
+    double start = now_seconds();
+    for (uint32_t i = 0; i < RX_FRAMES; i++) {
+        uint16_t length = 0;
+        protocol_wire_encode(frame, sizeof(frame), (uint8_t)i, payload, (uint16_t)((i * 37) % 200), &length);
+
+        if (!circular) {
+            uart_driver_receive_async(&driver, scratch, length);
+        }
+        peripheral_sim_uart_inject(&sim, driver.uart, frame, length, 0);
+        peripheral_sim_advance(&sim, length * frame_ns);
+        if (!circular) {
+            protocol_framer_feed(&framer, scratch, length);
+        }
+        bytes += length;
+    }
+    peripheral_sim_advance(&sim, 2 * frame_ns);
+    double wall = now_seconds() - start;
+
+    const peripheral_sim_stats_t *stats = peripheral_sim_get_stats(&sim, driver.uart);
+    uint32_t irqs = circular ? driver.rx_stats.interrupts : stats->irqs;
+    printf("%-28s frames=%u/%u  irqs/KB=%7.1f  bytes/irq=%6.1f  overruns=%u  %7.3f s wall\n",
+           circular ? "3 Mbaud circular DMA RX" : "3 Mbaud RXNE interrupt RX", messages, RX_FRAMES,
+           irqs * 1024.0 / bytes, (double)bytes / irqs, stats->overruns, wall);
+    uart_driver_deinit(&driver);
+    peripheral_sim_uninstall();
+}
+
+// Two 500 kHz tachometer inputs sampled from the edge interrupt; the
+// consumer drains the ring every drain_ns of simulated time
+static void bench_gpio_capture(uint64_t drain_ns) {
+    peripheral_sim_config_t config = {72000000, 0};
+    peripheral_sim_t sim;
+    GPIO_TypeDef port;
+    static gpio_capture_t capture;
+    uint64_t edges = 0;
+
+    memset(&port, 0, sizeof(port));
+    peripheral_sim_init(&sim, &config);
+    peripheral_sim_install(&sim);
+    peripheral_sim_attach_gpio(&sim, &port);
+    gpio_capture_init(&capture, &port, 0x3, peripheral_sim_clock);
+    peripheral_sim_set_irq(&sim, &port, gpio_capture_isr, &capture);
+    peripheral_sim_gpio_wave(&sim, &port, 0, 2000, 1000, TACH_PERIODS);
+    peripheral_sim_gpio_wave(&sim, &port, 1, 2000, 500, TACH_PERIODS);
+
+    uint64_t end = (uint64_t)TACH_PERIODS * 2000;
+    double start = now_seconds();
+    while (peripheral_sim_now(&sim) < end) {
+        peripheral_sim_advance(&sim, drain_ns);
+        edges += gpio_capture_process(&capture, NULL, 0);
+    }
+    double wall = now_seconds() - start;
+
+    char name[48];
+    snprintf(name, sizeof(name), "gpio_capture 2x500 kHz /%u us", (unsigned)(drain_ns / 1000));
+    printf("%-28s edges=%llu  dropped=%u  f=%6.1f kHz  duty=%4.2f  %7.3f s wall  %10.0f edges/s wall\n",
+           name, (unsigned long long)edges, capture.dropped, gpio_capture_frequency_hz(&capture, 1) / 1000.0,
+           gpio_capture_duty_cycle(&capture, 1), wall, edges / wall);
+    peripheral_sim_uninstall();
+}
+
+int main(void) {
+    bench_uart(115200);
+    bench_uart(921600);
+    bench_spi(0);
+    bench_spi(3);
+    bench_spi_samples(false);
+    bench_spi_samples(true);
+    bench_spi_adcs(false);
+    bench_spi_adcs(true);
+    bench_uart_rx(false);
+    bench_uart_rx(true);
+    bench_gpio_capture(100000);
+    bench_gpio_capture(1000000);
+    return 0;
+}
@@ -0,0 +1,169 @@
+/* bench_protocol_window.c – Stop-and-wait vs sliding-window throughput on a simulated UART link */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "protocol_window.h"
+
+#define MESSAGES        2000
+#define PAYLOAD_SIZE    32
+#define QUEUE_DEPTH     1024
+
+// Simulated one-way link: frames serialise at the baud rate, then arrive
+// after a fixed latency; a fraction of frames is corrupted in flight
+typedef struct {
+    uint64_t arrival[QUEUE_DEPTH];
+    uint16_t length[QUEUE_DEPTH];
+    uint8_t data[QUEUE_DEPTH][PROTOCOL_MAX_FRAME];
+    uint32_t head;
+    uint32_t tail;
+    uint64_t busy_until;
+    uint32_t baud;
+    uint64_t latency_ns;
+    double error_rate;
+} sim_link_t;
+
+typedef struct {
+    uint32_t baud;
+    uint64_t latency_ns;
+    double error_rate;
+} scenario_t;
+
+static uint64_t sim_now;
+static uint32_t delivered;
+
+static uint64_t sim_clock(void) {
+    return sim_now;
+}
+
+static protocol_error_t sim_link_tx(const uint8_t *data, uint16_t length, void *context) {
+    sim_link_t *link = (sim_link_t*)context;
+
+    if (link->head - link->tail == QUEUE_DEPTH) {
+        return PROTOCOL_ERROR_BUFFER_OVERFLOW;
+    }
+
+    uint64_t start = link->busy_until > sim_now ? link->busy_until : sim_now;
+    link->busy_until = start + (uint64_t)length * 10ULL * 1000000000ULL / link->baud;
+
+    uint32_t slot = link->head++ % QUEUE_DEPTH;
+    memcpy(link->data[slot], data, length);
+    link->length[slot] = length;
+    link->arrival[slot] = link->busy_until + link->latency_ns;
+
+    if ((double)rand() / RAND_MAX < link->error_rate) {
+        link->data[slot][length / 2] ^= 0x10;
+    }
+
+    return PROTOCOL_ERROR_NONE;
+}
+
+static void sim_link_deliver(sim_link_t *link, protocol_window_t *receiver) {
+    while (link->tail != link->head && link->arrival[link->tail % QUEUE_DEPTH] <= sim_now) {
+        uint32_t slot = link->tail++ % QUEUE_DEPTH;
+        protocol_window_receive_bytes(receiver, link->data[slot], link->length[slot]);
+    }
+}
+
+static uint64_t sim_link_next(const sim_link_t *link) {
+    return (link->tail != link->head) ? link->arrival[link->tail % QUEUE_DEPTH] : UINT64_MAX;
+}
+
+static void count_delivery(const protocol_frame_t *frame, void *context) {
+    (void)frame;
+    (void)context;
+    delivered++;
+}
+
+static sim_link_t a_to_b;
+static sim_link_t b_to_a;
+static protocol_window_t endpoint_a;
+static protocol_window_t endpoint_b;
+
+static double run(const scenario_t *sc, uint8_t window_size, uint32_t *retransmits) {
+    uint64_t frame_ns = (uint64_t)(PROTOCOL_HEADER_SIZE + PROTOCOL_WINDOW_LINK_HEADER + PAYLOAD_SIZE +
+                                   PROTOCOL_CRC_SIZE) * 10ULL * 1000000000ULL / sc->baud;
+    protocol_window_config_t config;
+    uint8_t payload[PAYLOAD_SIZE];
+
+    memset(&a_to_b, 0, sizeof(a_to_b));
+    memset(&b_to_a, 0, sizeof(b_to_a));
+    a_to_b.baud = b_to_a.baud = sc->baud;
+    a_to_b.latency_ns = b_to_a.latency_ns = sc->latency_ns;
+    a_to_b.error_rate = b_to_a.error_rate = sc->error_rate;
+    memset(payload, 0x3C, sizeof(payload));
+    sim_now = 0;
+    delivered = 0;
+    srand(7);
+
+    memset(&config, 0, sizeof(config));
+    config.window_size = window_size;
+    config.rto_ns = 3 * (2 * sc->latency_ns + frame_ns * (window_size + 2));
+    config.max_retries = 50;
+    config.clock = sim_clock;
+
+    config.tx = sim_link_tx;
+    config.tx_context = &a_to_b;
+    protocol_window_init(&endpoint_a, &config);
+
+    config.tx_context = &b_to_a;
+    config.deliver_cb = count_delivery;
+    protocol_window_init(&endpoint_b, &config);
+
+    uint32_t sent = 0;
+    while (delivered < MESSAGES) {
+        while (sent < MESSAGES &&
+               protocol_window_send(&endpoint_a, 0x10, payload, sizeof(payload)) == PROTOCOL_ERROR_NONE) {
+            sent++;
+        }
+
+        uint64_t next = sim_link_next(&a_to_b);
+        uint64_t candidate = sim_link_next(&b_to_a);
+        if (candidate < next) next = candidate;
+        candidate = protocol_window_next_deadline(&endpoint_a);
+        if (candidate < next) next = candidate;
+        if (next == UINT64_MAX) {
+            break;
+        }
+
+        sim_now = next > sim_now ? next : sim_now;
+        sim_link_deliver(&a_to_b, &endpoint_b);
+        sim_link_deliver(&b_to_a, &endpoint_a);
+        if (protocol_window_service(&endpoint_a) != PROTOCOL_ERROR_NONE) {
+            break;
+        }
+    }
+
+    *retransmits = endpoint_a.stats.retransmits;
+    return (double)delivered * PAYLOAD_SIZE / (sim_now * 1e-9);
+}
+
+int main(void) {
+    static const scenario_t scenarios[] = {
+        { 115200,  5000000ULL, 0.00 },
+        { 115200, 20000000ULL, 0.01 },
+        { 1000000,  2000000ULL, 0.02 },
+        { 3000000,   500000ULL, 0.05 },
+    };
+    static const uint8_t windows[] = { 1, 4, 8, 16, 32 };
+
+    printf("%u messages x %u bytes, throughput in payload bytes/s (simulated time)\n", MESSAGES, PAYLOAD_SIZE);
+    for (size_t s = 0; s < sizeof(scenarios) / sizeof(scenarios[0]); s++) {
+        const scenario_t *sc = &scenarios[s];
+        double baseline = 0.0;
+
+        printf("\nbaud=%u latency=%.1fms error=%.0f%%\n", sc->baud, sc->latency_ns / 1e6, sc->error_rate * 100);
+        for (size_t w = 0; w < sizeof(windows); w++) {
+            uint32_t retransmits = 0;
+            double rate = run(sc, windows[w], &retransmits);
+            if (w == 0) {
+                baseline = rate;
+            }
+            printf("  window=%2u  %10.0f B/s  x%5.2f  delivered=%u retransmits=%u\n",
+                   windows[w], rate, rate / baseline, delivered, retransmits);
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,100 @@
+/* bench_protocol_wire.c – Schema codec vs protocol_message_t union */
+
+#define _POSIX_C_SOURCE 199309L
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "protocol_wire.h"
+
+#define ITERATIONS    2000000
+
+static volatile uint32_t sink;
+
+static double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+// Union path: fill the struct, checksum it, copy the whole union out
+static void legacy_encode(uint8_t *wire, uint8_t command, const uint8_t *payload, uint16_t length) {
+    protocol_message_t message;
+
+    message.packet.header = PROTOCOL_HEADER_BYTE;
+    message.packet.command = command;
+    message.packet.data_length = length;
+    memcpy(message.packet.payload, payload, length);
+    message.packet.crc = protocol_calculate_crc(message.raw_bytes, PROTOCOL_HEADER_SIZE + length);
+    memcpy(wire, message.raw_bytes, sizeof(message.raw_bytes));
+}
+
+// Union path: copy into the union, then validate
+static uint32_t legacy_decode(const uint8_t *wire) {
+    protocol_message_t message;
+
+    if (protocol_parse_message(wire, sizeof(message.raw_bytes), &message) != PROTOCOL_ERROR_NONE ||
+        protocol_validate_message(&message) != PROTOCOL_ERROR_NONE) {
+        return 0;
+    }
+    return message.packet.payload[0] + message.packet.data_length;
+}
+
+static void run(uint16_t length) {
+    uint8_t payload[PROTOCOL_MAX_PAYLOAD];
+    uint8_t legacy_wire[sizeof(protocol_message_t)];
+    uint8_t wire[PROTOCOL_MAX_FRAME];
+    uint16_t wire_length = 0;
+    protocol_frame_t frame;
+
+    for (uint16_t i = 0; i < length; i++) {
+        payload[i] = (uint8_t)rand();
+    }
+
+    double start = now_seconds();
+    for (uint32_t it = 0; it < ITERATIONS; it++) {
+        payload[0] = (uint8_t)it;
+        legacy_encode(legacy_wire, 0x10, payload, length);
+        sink += legacy_wire[PROTOCOL_HEADER_SIZE];
+    }
+    double legacy_enc = now_seconds() - start;
+
+    start = now_seconds();
+    for (uint32_t it = 0; it < ITERATIONS; it++) {
+        sink += legacy_decode(legacy_wire);
+    }
+    double legacy_dec = now_seconds() - start;
+
+    start = now_seconds();
+    for (uint32_t it = 0; it < ITERATIONS; it++) {
+        payload[0] = (uint8_t)it;
+        protocol_wire_encode(wire, sizeof(wire), 0x10, payload, length, &wire_length);
+        sink += wire[PROTOCOL_HEADER_SIZE];
+    }
+    double wire_enc = now_seconds() - start;
+
+    start = now_seconds();
+    for (uint32_t it = 0; it < ITERATIONS; it++) {
+        if (protocol_wire_decode(wire, wire_length, &frame) == PROTOCOL_ERROR_NONE) {
+            sink += frame.payload[0] + frame.data_length;
+        }
+    }
+    double wire_dec = now_seconds() - start;
+
+    double mmsgs = ITERATIONS / 1e6;
+    printf("payload=%3u  encode: union %6.2f  schema %6.2f Mmsg/s (x%.2f)   "
+           "decode: union %6.2f  schema %6.2f Mmsg/s (x%.2f)\n",
+           length, mmsgs / legacy_enc, mmsgs / wire_enc, legacy_enc / wire_enc,
+           mmsgs / legacy_dec, mmsgs / wire_dec, legacy_dec / wire_dec);
+}
+
+int main(void) {
+    srand(1);
+
+    run(16);
+    run(64);
+    run(PROTOCOL_MAX_PAYLOAD);
+
+    return 0;
+}
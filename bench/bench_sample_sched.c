@@ -0,0 +1,111 @@
+/* bench_sample_sched.c – 10,000 sensors at mixed rates on one core: scheduler load and sampling jitter */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "sample_sched.h"
+#include "timebase.h"
+
+#define SENSORS         10000
+#define BUSES           16
+#define RUN_NS          2000000000ULL
+#define COALESCE_NS     1000000     // Below the shortest period, 2 ms
+
+static const uint32_t rates[] = {1, 10, 50, 100, 200, 500};
+#define RATE_COUNT      (sizeof(rates) / sizeof(rates[0]))
+
+static sample_sched_t sched;
+static i2c_driver_t buses[BUSES];
+static sensor_driver_t sensors[SENSORS];
+static sample_sched_entry_t entries[SENSORS];
+
+// Bus with no wire time, so only the scheduler and driver path are measured
+static error_t sample_transfer(i2c_driver_t *driver, const i2c_msg_t *msgs, uint8_t count, void *context) {
+    (void)driver;
+    (void)context;
+    for (uint8_t i = 0; i < count; i++) {
+        if (msgs[i].flags & I2C_MSG_READ) {
+            memset(msgs[i].data, 0x10, msgs[i].length);
+        }
+    }
+    return ERROR_NONE;
+}
+
+static const i2c_backend_t sample_backend = {sample_transfer, NULL};
+
+// One run; coalesce_ns 0 batches only reads that expire in the same tick
+static void run(uint64_t coalesce_ns) {
+    uint64_t expected = 0;
+    uint64_t busy_ns = 0;
+
+    sample_sched_init(&sched, timebase_now_ns, 0);
+    for (uint8_t i = 0; i < BUSES; i++) {
+        sample_sched_set_coalesce(&sched, i, coalesce_ns);
+    }
+    for (uint16_t i = 0; i < SENSORS; i++) {
+        sensor_driver_t *sensor = &sensors[i];
+        uint32_t rate = rates[i % RATE_COUNT];
+        uint64_t period = 1000000000ULL / rate;
+
+        sensor->i2c = &buses[i % BUSES];
+        sensor->bus = SENSOR_BUS_I2C;
+        sensor->state = DEVICE_STATE_READY;
+        sensor->calibration_scale = 1.0f;
+        sensor->sampling_rate = rate;
+        error_log_init(&sensor->errors, ERROR_SOURCE_SENSOR);
+
+        // Phases spread over the period, on a 50 us grid so neighbours share ticks
+        sample_sched_add(&sched, &entries[i], sensor, (uint8_t)(i % BUSES), (i * 50000ULL) % period);
+        expected += rate;
+    }
+
+    uint64_t start = timebase_now_ns();
+    uint64_t now = start;
+    while (now - start < RUN_NS) {
+        if (sample_sched_run(&sched) != 0) {
+            uint64_t end = timebase_now_ns();
+            busy_ns += end - now;
+            now = end;
+        } else {
+            now = timebase_now_ns();
+        }
+    }
+
+    const sample_sched_stats_t *stats = &sched.stats;
+    double seconds = (double)(now - start) * 1e-9;
+    printf("sampling scheduler, %u sensors on %u buses, rates 1..500 Hz, coalescing %llu us, %.2f s\n", SENSORS,
+           BUSES, (unsigned long long)(coalesce_ns / 1000), seconds);
+    printf("  reads         %10llu  (%.0f/s, target %llu/s)\n", (unsigned long long)stats->reads,
+           (double)stats->reads / seconds, (unsigned long long)expected);
+    printf("  busy          %9.2f%%  %6.1f ns/read\n", 100.0 * (double)busy_ns / (double)(now - start),
+           stats->reads ? (double)busy_ns / (double)stats->reads : 0.0);
+    printf("  windows       %10u  avg batch %.1f, max %u\n", stats->windows,
+           stats->windows ? (double)stats->reads / stats->windows : 0.0, stats->max_batch);
+    printf("  missed        %10u  errors %u, cascades %llu\n", stats->missed, stats->errors,
+           (unsigned long long)stats->cascades);
+    printf("  jitter (ns)   p50 %llu  p90 %llu  p99 %llu  p99.9 %llu  max %llu\n",
+           (unsigned long long)latency_hist_percentile(&sched.jitter, 50.0),
+           (unsigned long long)latency_hist_percentile(&sched.jitter, 90.0),
+           (unsigned long long)latency_hist_percentile(&sched.jitter, 99.0),
+           (unsigned long long)latency_hist_percentile(&sched.jitter, 99.9),
+           (unsigned long long)sched.jitter.max_ns);
+}
+
+int main(void) {
+    if (!timebase_init(TIMEBASE_SOURCE_CYCLE_COUNTER)) {
+        printf("cycle counter unavailable, timing with CLOCK_MONOTONIC\n");
+    }
+
+    for (uint8_t i = 0; i < BUSES; i++) {
+        i2c_driver_init(&buses[i], (uint8_t)(0x40 + i), 400000);
+        buses[i].backend = &sample_backend;
+    }
+
+    run(0);
+    run(COALESCE_NS);
+
+    for (uint8_t i = 0; i < BUSES; i++) {
+        i2c_driver_deinit(&buses[i]);
+    }
+    return 0;
+}
@@ -0,0 +1,165 @@
+/* bench_sensor_read.c – Cost per sample of the sensor read path: run-time bus selection vs compile-time binding */
+
+#define _POSIX_C_SOURCE 199309L
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include "device_drivers.h"
+#include "peripheral_sim.h"
+
+#define ITERATIONS      2000000
+#define SIM_ITERATIONS  200000
+#define ROUNDS          5       // Interleaved; the fastest round counts
+
+SENSOR_BUS_DEFINE(thermo, i2c)
+SENSOR_BUS_DEFINE(pressure, spi)
+SENSOR_BUS_DEFINE(humidity, uart)
+
+static volatile float sink;
+
+static const uint8_t read_command[] = {SENSOR_UART_CMD_READ, SENSOR_REG_VALUE};
+static const uint8_t read_reply[] = {0x0B, 0xB8};
+static const peripheral_sim_script_step_t read_steps[] = {
+    {read_command, sizeof(read_command), read_reply, sizeof(read_reply), 0},
+};
+
+static double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+// Bus with no wire time, so only the driver path is measured
+static error_t sample_transfer(i2c_driver_t *driver, const i2c_msg_t *msgs, uint8_t count, void *context) {
+    (void)driver;
+    (void)context;
+    for (uint8_t i = 0; i < count; i++) {
+        if (msgs[i].flags & I2C_MSG_READ) {
+            msgs[i].data[0] = 0x09;
+            msgs[i].data[1] = 0xC4;
+        }
+    }
+    return ERROR_NONE;
+}
+
+static const i2c_backend_t sample_backend = {sample_transfer, NULL};
+
+static double generic_ns(sensor_driver_t *sensor, uint32_t iterations) {
+    float value;
+    double start = now_seconds();
+    for (uint32_t it = 0; it < iterations; it++) {
+        sensor_driver_read(sensor, &value);
+        sink = value;
+    }
+    return (now_seconds() - start) * 1e9 / iterations;
+}
+
+static double thermo_ns(sensor_driver_t *sensor) {
+    float value;
+    double start = now_seconds();
+    for (uint32_t it = 0; it < ITERATIONS; it++) {
+        thermo_read(sensor, &value);
+        sink = value;
+    }
+    return (now_seconds() - start) * 1e9 / ITERATIONS;
+}
+
+static double pressure_ns(sensor_driver_t *sensor) {
+    float value;
+    double start = now_seconds();
+    for (uint32_t it = 0; it < SIM_ITERATIONS; it++) {
+        pressure_read(sensor, &value);
+        sink = value;
+    }
+    return (now_seconds() - start) * 1e9 / SIM_ITERATIONS;
+}
+
+static double humidity_ns(sensor_driver_t *sensor) {
+    float value;
+    double start = now_seconds();
+    for (uint32_t it = 0; it < SIM_ITERATIONS; it++) {
+        humidity_read(sensor, &value);
+        sink = value;
+    }
+    return (now_seconds() - start) * 1e9 / SIM_ITERATIONS;
+}
+
+int main(void) {
+    peripheral_sim_config_t sim_config = {8000000, 0};
+    static peripheral_sim_t sim;
+    static peripheral_sim_regmap_t regmap;
+    peripheral_sim_script_t script;
+    GPIO_TypeDef cs_port;
+    sensor_driver_t i2c_sensor;
+    sensor_driver_t spi_sensor;
+    sensor_driver_t uart_sensor;
+
+    memset(&script, 0, sizeof(script));
+    memset(&cs_port, 0, sizeof(cs_port));
+    memset(&i2c_sensor, 0, sizeof(i2c_sensor));
+    memset(&spi_sensor, 0, sizeof(spi_sensor));
+    memset(&uart_sensor, 0, sizeof(uart_sensor));
+
+    thermo_init(&i2c_sensor, 0);
+    i2c_sensor.i2c->backend = &sample_backend;
+
+    double i2c_generic = 1e9;
+    double i2c_bound = 1e9;
+    for (uint8_t round = 0; round < ROUNDS; round++) {
+        double ns = generic_ns(&i2c_sensor, ITERATIONS);
+        i2c_generic = (ns < i2c_generic) ? ns : i2c_generic;
+        ns = thermo_ns(&i2c_sensor);
+        i2c_bound = (ns < i2c_bound) ? ns : i2c_bound;
+    }
+
+    printf("sensor read, i2c with a zero-time bus, best of %u x %u samples\n", ROUNDS, ITERATIONS);
+    printf("  sensor_driver_read   %6.2f ns/sample\n", i2c_generic);
+    printf("  SENSOR_BUS_DEFINE    %6.2f ns/sample  (%+5.2f ns)\n", i2c_bound, i2c_bound - i2c_generic);
+
+    // SPI and UART through the peripheral simulator: host time includes
+    // the simulator, virtual time is the wire
+    cs_port.MODER = 0x1U;
+    cs_port.ODR = 0x1U;
+    regmap.regs[SENSOR_REG_VALUE] = 0x0A;
+    regmap.regs[SENSOR_REG_VALUE + 1] = 0x28;
+    script.steps = read_steps;
+    script.step_count = 1;
+    script.loop = true;
+
+    peripheral_sim_init(&sim, &sim_config);
+    peripheral_sim_install(&sim);
+
+    pressure_init(&spi_sensor, 0);
+    spi_sensor.spi->cs_gpio = &cs_port;
+    spi_sensor.spi->cs_pin = 0;
+    peripheral_sim_device_t spi_device = peripheral_sim_regmap_device(&regmap);
+    peripheral_sim_attach_spi(&sim, spi_sensor.spi->spi, &cs_port, 0, &spi_device);
+
+    humidity_init(&uart_sensor, 0);
+    peripheral_sim_device_t uart_device = peripheral_sim_script_device(&script);
+    peripheral_sim_attach_uart(&sim, uart_sensor.uart->uart, &uart_device);
+
+    uint64_t wire_start = peripheral_sim_now(&sim);
+    double spi_generic = generic_ns(&spi_sensor, SIM_ITERATIONS);
+    double spi_bound = pressure_ns(&spi_sensor);
+    uint64_t spi_wire = (peripheral_sim_now(&sim) - wire_start) / (2 * SIM_ITERATIONS);
+
+    wire_start = peripheral_sim_now(&sim);
+    double uart_generic = generic_ns(&uart_sensor, SIM_ITERATIONS);
+    double uart_bound = humidity_ns(&uart_sensor);
+    uint64_t uart_wire = (peripheral_sim_now(&sim) - wire_start) / (2 * SIM_ITERATIONS);
+
+    printf("sensor read under peripheral_sim, %u samples\n", SIM_ITERATIONS);
+    printf("  spi  run-time %8.2f  bound %8.2f ns/sample  wire %6llu ns\n",
+           spi_generic, spi_bound, (unsigned long long)spi_wire);
+    printf("  uart run-time %8.2f  bound %8.2f ns/sample  wire %6llu ns\n",
+           uart_generic, uart_bound, (unsigned long long)uart_wire);
+    printf("  regmap transactions %u, script mismatches %u\n", regmap.transactions, script.mismatches);
+
+    peripheral_sim_uninstall();
+    sensor_driver_deinit(&i2c_sensor);
+    sensor_driver_deinit(&spi_sensor);
+    sensor_driver_deinit(&uart_sensor);
+    return 0;
+}
@@ -0,0 +1,45 @@
+/* bench_timebase.c – Cost of a timebase read per source */
+
+#define _POSIX_C_SOURCE 199309L
+#include <stdio.h>
+#include <time.h>
+
+#include "timebase.h"
+
+#define ITERATIONS    20000000
+
+static volatile uint64_t sink;
+
+static double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static void run(const char *name, timebase_source_t source) {
+    if (!timebase_init(source)) {
+        printf("%-14s unavailable, using CLOCK_MONOTONIC\n", name);
+    }
+
+    uint64_t acc = 0;
+    double start = now_seconds();
+    for (uint32_t it = 0; it < ITERATIONS; it++) {
+        acc += timebase_now_ns();
+    }
+    double elapsed = now_seconds() - start;
+    sink += acc;
+
+    printf("%-14s %6.2f ns/read", name, elapsed * 1e9 / ITERATIONS);
+    if (timebase_get_source() == TIMEBASE_SOURCE_CYCLE_COUNTER) {
+        printf("  (counter %.3f GHz)", timebase_counter_hz() / 1e9);
+    }
+    printf("\n");
+}
+
+int main(void) {
+    run("monotonic", TIMEBASE_SOURCE_MONOTONIC);
+    run("cycle counter", TIMEBASE_SOURCE_CYCLE_COUNTER);
+    run("simulated", TIMEBASE_SOURCE_SIMULATED);
+
+    return 0;
+}
@@ -0,0 +1,228 @@
+#define _GNU_SOURCE
+#include "alloc_track.h"
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <dlfcn.h>
+
+// State is written from the allocation wrappers, which may run on any
+// thread; a spin lock keeps the site table consistent
+static alloc_track_site_t sites[ALLOC_TRACK_MAX_SITES];
+static alloc_track_stats_t stats;
+static bool armed;
+static volatile char lock;
+
+// Internal helpers
+static void track_lock(void) {
+    while (__atomic_test_and_set(&lock, __ATOMIC_ACQUIRE)) {
+    }
+}
+
+static void track_unlock(void) {
+    __atomic_clear(&lock, __ATOMIC_RELEASE);
+}
+
+static void track_describe(FILE *out, const void *site) {
+    Dl_info info;
+
+    if (dladdr(site, &info) && info.dli_fname != NULL) {
+        uintptr_t offset = (uintptr_t)site - (uintptr_t)info.dli_fbase;
+        if (info.dli_sname != NULL) {
+            fprintf(out, "%s+0x%lx ", info.dli_sname,
+                    (unsigned long)((uintptr_t)site - (uintptr_t)info.dli_saddr));
+        }
+        fprintf(out, "(%s+0x%lx)", info.dli_fname, (unsigned long)offset);
+    } else {
+        fprintf(out, "%p", site);
+    }
+}
+
+#ifdef ALLOC_TRACK
+void *__real_malloc(size_t size);
+void *__real_calloc(size_t count, size_t size);
+void *__real_realloc(void *ptr, size_t size);
+void __real_free(void *ptr);
+
+static bool abort_on_violation;
+
+// Open addressing on the return address
+static alloc_track_site_t* track_site(const void *site) {
+    uint32_t slot = (uint32_t)(((uintptr_t)site >> 2) * 2654435761u) % ALLOC_TRACK_MAX_SITES;
+
+    for (uint32_t probe = 0; probe < ALLOC_TRACK_MAX_SITES; probe++) {
+        alloc_track_site_t *s = &sites[(slot + probe) % ALLOC_TRACK_MAX_SITES];
+        if (s->site == site) return s;
+        if (s->site == NULL) {
+            s->site = site;
+            stats.sites++;
+            return s;
+        }
+    }
+    return NULL;
+}
+
+static void track_alloc(const void *site, size_t size) {
+    bool violation;
+
+    track_lock();
+    alloc_track_site_t *s = track_site(site);
+    violation = armed;
+    stats.allocations++;
+    stats.bytes += size;
+    if (violation) {
+        stats.armed_allocations++;
+    }
+    if (s != NULL) {
+        s->calls++;
+        s->bytes += size;
+        if (violation) {
+            s->armed_calls++;
+        }
+    } else {
+        stats.untracked_sites++;
+    }
+    track_unlock();
+
+    if (violation && abort_on_violation) {
+        abort();
+    }
+}
+
+static void track_free(void) {
+    track_lock();
+    stats.frees++;
+    if (armed) {
+        stats.armed_frees++;
+    }
+    track_unlock();
+}
+
+static void track_exit(void) {
+    alloc_track_report(stderr);
+    if (stats.armed_allocations > 0) {
+        fprintf(stderr, "alloc_track: %u allocations in the steady state\n", stats.armed_allocations);
+        _exit(EXIT_FAILURE);
+    }
+}
+
+__attribute__((constructor))
+static void track_start(void) {
+    const char *env = getenv("ALLOC_TRACK_ABORT");
+    abort_on_violation = env != NULL && env[0] == '1';
+    atexit(track_exit);
+}
+
+// Allocation wrappers, bound with -Wl,--wrap
+void *__wrap_malloc(size_t size) {
+    track_alloc(__builtin_return_address(0), size);
+    return __real_malloc(size);
+}
+
+void *__wrap_calloc(size_t count, size_t size) {
+    track_alloc(__builtin_return_address(0), count * size);
+    return __real_calloc(count, size);
+}
+
+void *__wrap_realloc(void *ptr, size_t size) {
+    track_alloc(__builtin_return_address(0), size);
+    return __real_realloc(ptr, size);
+}
+
+void __wrap_free(void *ptr) {
+    if (ptr != NULL) {
+        track_free();
+    }
+    __real_free(ptr);
+}
+#endif
+
+// Tracker Functions
+bool alloc_track_enabled(void) {
+#ifdef ALLOC_TRACK
+    return true;
+#else
+    return false;
+#endif
+}
+
+// Start of the steady state
+void alloc_track_arm(void) {
+    __atomic_store_n(&armed, true, __ATOMIC_RELEASE);
+}
+
+void alloc_track_disarm(void) {
+    __atomic_store_n(&armed, false, __ATOMIC_RELEASE);
+}
+
+bool alloc_track_armed(void) {
+    return __atomic_load_n(&armed, __ATOMIC_ACQUIRE);
+}
+
+void alloc_track_get_stats(alloc_track_stats_t *out) {
+    if (out == NULL) return;
+
+    track_lock();
+    *out = stats;
+    track_unlock();
+}
+
+// Copies the call sites, most calls first
+uint16_t alloc_track_get_sites(alloc_track_site_t *out, uint16_t max) {
+    uint16_t count = 0;
+
+    if (out == NULL) return 0;
+
+    track_lock();
+    for (uint32_t i = 0; i < ALLOC_TRACK_MAX_SITES && count < max; i++) {
+        if (sites[i].site == NULL) continue;
+
+        // Insertion sort; the table is small
+        uint16_t j = count++;
+        while (j > 0 && out[j - 1].calls < sites[i].calls) {
+            out[j] = out[j - 1];
+            j--;
+        }
+        out[j] = sites[i];
+    }
+    track_unlock();
+
+    return count;
+}
+
+void alloc_track_reset(void) {
+    track_lock();
+    memset(sites, 0, sizeof(sites));
+    memset(&stats, 0, sizeof(stats));
+    track_unlock();
+}
+
+void alloc_track_report(FILE *out) {
+    alloc_track_site_t list[ALLOC_TRACK_MAX_SITES];
+    alloc_track_stats_t s;
+
+    if (out == NULL) return;
+
+    alloc_track_get_stats(&s);
+    uint16_t count = alloc_track_get_sites(list, ALLOC_TRACK_MAX_SITES);
+
+    fprintf(out, "alloc_track: %llu allocations (%llu bytes), %llu frees, %u call sites",
+            (unsigned long long)s.allocations, (unsigned long long)s.bytes,
+            (unsigned long long)s.frees, s.sites);
+    if (s.armed_allocations > 0 || s.armed_frees > 0) {
+        fprintf(out, "; steady state: %u allocations, %u frees", s.armed_allocations, s.armed_frees);
+    }
+    fprintf(out, "\n");
+
+    for (uint16_t i = 0; i < count; i++) {
+        fprintf(out, "  %8u calls %10llu bytes", list[i].calls, (unsigned long long)list[i].bytes);
+        if (list[i].armed_calls > 0) {
+            fprintf(out, "  %u ARMED", list[i].armed_calls);
+        }
+        fprintf(out, "  ");
+        track_describe(out, list[i].site);
+        fprintf(out, "\n");
+    }
+    if (s.untracked_sites > 0) {
+        fprintf(out, "  %8u calls from sites beyond the table\n", s.untracked_sites);
+    }
+}
@@ -0,0 +1,53 @@
+#ifndef ALLOC_TRACK_H
+#define ALLOC_TRACK_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+
+// Heap allocation tracker for host builds.
+// Built with -DALLOC_TRACK and linked with ALLOC_TRACK_LDFLAGS (make
+// ALLOC_TRACK=1), every malloc, calloc, realloc and free called from the
+// program's own objects goes through the tracker, which counts calls and
+// bytes per call site (the caller's return address). Allocations inside
+// the C library itself are not seen.
+//
+// alloc_track_arm marks the start of the steady state: any allocation
+// after it is a violation, counted against its call site. At exit the
+// tracker prints the call-site report to stderr and, if anything was
+// allocated while armed, exits with a failure status so the test or
+// benchmark fails. Set ALLOC_TRACK_ABORT=1 in the environment to abort at
+// the violating call instead, for a backtrace in the debugger.
+//
+// Without ALLOC_TRACK the API is still there and does nothing, so code can
+// arm and check unconditionally.
+#define ALLOC_TRACK_MAX_SITES   256
+
+typedef struct {
+    const void *site;           // Return address in the allocating function
+    uint32_t calls;
+    uint32_t armed_calls;       // Calls while armed
+    uint64_t bytes;
+} alloc_track_site_t;
+
+typedef struct {
+    uint64_t allocations;
+    uint64_t frees;
+    uint64_t bytes;
+    uint32_t armed_allocations; // Violations
+    uint32_t armed_frees;
+    uint16_t sites;
+    uint32_t untracked_sites;   // Calls from sites beyond ALLOC_TRACK_MAX_SITES
+} alloc_track_stats_t;
+
+// Function declarations
+bool alloc_track_enabled(void);
+void alloc_track_arm(void);
+void alloc_track_disarm(void);
+bool alloc_track_armed(void);
+void alloc_track_get_stats(alloc_track_stats_t *stats);
+uint16_t alloc_track_get_sites(alloc_track_site_t *sites, uint16_t max);
+void alloc_track_reset(void);
+void alloc_track_report(FILE *out);
+
+#endif // ALLOC_TRACK_H
@@ -12,7 +12,7 @@ typedef struct {
     uint32_t rsvd : 1;       // Reserved bit
     uint8_t data[8];         // Data field (up to 8 bytes)
     uint8_t dlc : 4;         // Data length code (0-8)
-    uint32_t timestamp;      // Reception timestamp
+    uint32_t timestamp;      // Reception timestamp (timebase_now_us)
 } can_frame_t;
 
 // CAN Identifier Union for flexible access
@@ -35,6 +35,29 @@ typedef struct {
     uint32_t crc;            // CRC checksum
 } ethernet_frame_t;
 
+// Ethernet payload fragment for scatter-gather transmit
+typedef struct {
+    const uint8_t *data;     // Caller-owned fragment data
+    uint16_t length;         // Fragment length in bytes
+} ethernet_fragment_t;
+
+// Serialized Ethernet frame that references its payload fragments in place.
+// Wire order: header, fragments, padding, FCS.
+#define ETHERNET_HEADER_SIZE     14
+#define ETHERNET_FCS_SIZE        4
+#define ETHERNET_MIN_PAYLOAD     46
+#define ETHERNET_MAX_PAYLOAD     1500
+#define ETHERNET_MAX_FRAGMENTS   16
+typedef struct {
+    uint8_t header[ETHERNET_HEADER_SIZE];   // Destination, source, EtherType
+    const ethernet_fragment_t *fragments;   // Payload fragments (not copied)
+    uint8_t fragment_count;
+    uint16_t payload_length;                // Sum of fragment lengths
+    uint16_t pad_length;                    // Zero padding up to the minimum frame
+    uint8_t fcs[ETHERNET_FCS_SIZE];         // FCS in transmission byte order
+    uint16_t frame_length;                  // Total bytes on the wire including FCS
+} ethernet_tx_frame_t;
+
 // UART Protocol Message Union
 typedef union {
     struct {
@@ -65,6 +88,9 @@ typedef enum {
     PROTOCOL_ERROR_TIMEOUT
 } protocol_error_t;
 
+// Monotonic clock used for protocol timing (nanoseconds)
+typedef uint64_t (*protocol_clock_t)(void);
+
 // CAN Handle Structure
 typedef struct {
     can_frame_t *rx_buffer;
@@ -75,19 +101,30 @@ typedef struct {
     uint16_t tx_tail;
     uint16_t buffer_size;
     protocol_state_t state;
+    const void *pool_owner;     // The handle itself once init took its queues from the pool
 } can_handle_t;
 
 // Function declarations
 protocol_error_t can_init(can_handle_t *can, uint16_t buffer_size);
+void can_deinit(can_handle_t *can);
 protocol_error_t can_transmit_message(can_handle_t *can, const can_frame_t *frame, uint32_t timeout);
 protocol_error_t can_receive_message(can_handle_t *can, can_frame_t *frame, uint32_t timeout);
+protocol_error_t can_process_rx(can_handle_t *can, const can_frame_t *frame);
 uint16_t can_calculate_crc(const can_frame_t *frame);
 
 protocol_error_t ethernet_parse_frame(const uint8_t *data, uint16_t length, ethernet_frame_t *frame);
 uint32_t ethernet_calculate_crc(const ethernet_frame_t *frame);
+uint32_t ethernet_crc32_update(uint32_t crc, const uint8_t *data, uint16_t length);
+protocol_error_t ethernet_build_frame(const uint8_t destination[6], const uint8_t source[6], uint16_t ethertype,
+                                      const ethernet_fragment_t *fragments, uint8_t fragment_count,
+                                      ethernet_tx_frame_t *frame);
+protocol_error_t ethernet_frame_flatten(const ethernet_tx_frame_t *frame, uint8_t *buffer,
+                                        uint16_t buffer_size, uint16_t *length);
 
 protocol_error_t protocol_parse_message(const uint8_t *data, uint16_t length, protocol_message_t *message);
 protocol_error_t protocol_validate_message(const protocol_message_t *message);
 uint16_t protocol_calculate_crc(const uint8_t *data, uint16_t length);
+uint16_t protocol_crc_update(uint16_t crc, const uint8_t *data, uint16_t length);
+uint16_t protocol_crc_copy(uint16_t crc, uint8_t *dst, const uint8_t *src, uint16_t length);
 
 #endif // COMMUNICATION_PROTOCOLS_H
\ No newline at end of file
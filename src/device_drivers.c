@@ -1,5 +1,7 @@
 #include "device_drivers.h"
-#include <stdlib.h>
+#include "timebase.h"
+#include "mem_pool.h"
+#include "latency_hist.h"
 #include <string.h>
 
 // UART Driver Functions
@@ -10,23 +12,35 @@ error_t uart_driver_init(uart_driver_t *driver, const uart_config_t *config) {
 
     driver->state = DEVICE_STATE_INIT;
 
-    // Allocate hardware registers (mock)
-    driver->uart = (USART_TypeDef*)malloc(sizeof(USART_TypeDef));
+    // Hardware registers from the static pool (mock, reset value zero).
+    // Re-running init returns the previous block; a copy of another driver
+    // or an uninitialised struct does not own the pointer it holds
+    if (driver->pool_owner == driver) {
+        mem_pool_release(MEM_POOL_UART_REGS, driver->uart);
+    }
+    driver->pool_owner = NULL;
+    driver->uart = (USART_TypeDef*)mem_pool_alloc(MEM_POOL_UART_REGS);
     if (driver->uart == NULL) {
         return ERROR_BUSY;
     }
+    driver->pool_owner = driver;
 
     // Initialize UART hardware
     error_t err = uart_init(driver->uart, (uart_config_t*)config);
     if (err != ERROR_NONE) {
-        free(driver->uart);
+        mem_pool_release(MEM_POOL_UART_REGS, driver->uart);
+        driver->uart = NULL;
+        driver->pool_owner = NULL;
         driver->state = DEVICE_STATE_ERROR;
         return err;
     }
 
     driver->timeout_ms = 1000;  // Default timeout
-    driver->error_index = 0;
-    memset(driver->errors, 0, sizeof(driver->errors));
+    driver->tx_async_active = false;
+    driver->rx_async_active = false;
+    driver->rx_circular = false;
+    driver->rx_framer = NULL;
+    error_log_init(&driver->errors, ERROR_SOURCE_UART);
 
     driver->state = DEVICE_STATE_READY;
 
@@ -37,22 +51,38 @@ error_t uart_driver_init(uart_driver_t *driver, const uart_config_t *config) {
     return ERROR_NONE;
 }
 
+// Returns the register block to its pool; init again before further use
+void uart_driver_deinit(uart_driver_t *driver) {
+    if (driver == NULL) return;
+
+    if (driver->pool_owner == driver) {
+        mem_pool_release(MEM_POOL_UART_REGS, driver->uart);
+    }
+    driver->pool_owner = NULL;
+    driver->uart = NULL;
+    driver->state = DEVICE_STATE_UNINITIALIZED;
+}
+
 error_t uart_driver_transmit(uart_driver_t *driver, const uint8_t *data, uint16_t size) {
     if (driver == NULL || data == NULL || size == 0 || driver->state != DEVICE_STATE_READY) {
         return ERROR_INVALID_PARAM;
     }
 
+    if (driver->tx_async_active) {
+        return ERROR_BUSY;
+    }
+
     driver->state = DEVICE_STATE_BUSY;
 
+    uint64_t started = LATENCY_START(LATENCY_OP_UART_TX);
     error_t err = uart_transmit(driver->uart, (uint8_t*)data, size, driver->timeout_ms);
+    LATENCY_STOP(LATENCY_OP_UART_TX, started);
 
     driver->state = DEVICE_STATE_READY;
 
     if (err != ERROR_NONE) {
         // Log error
-        driver->errors[driver->error_index].timestamp = 0;  // Mock timestamp
-        driver->errors[driver->error_index].error_code = err;
-        driver->error_index = (driver->error_index + 1) % ERROR_HISTORY_SIZE;
+        error_log_record(&driver->errors, err, size);
         driver->state = DEVICE_STATE_ERROR;
     }
 
@@ -64,35 +94,337 @@ error_t uart_driver_receive(uart_driver_t *driver, uint8_t *data, uint16_t size)
         return ERROR_INVALID_PARAM;
     }
 
+    if (driver->rx_async_active) {
+        return ERROR_BUSY;
+    }
+
     driver->state = DEVICE_STATE_BUSY;
 
+    uint64_t started = LATENCY_START(LATENCY_OP_UART_RX);
     error_t err = uart_receive(driver->uart, data, size, driver->timeout_ms);
+    LATENCY_STOP(LATENCY_OP_UART_RX, started);
 
     driver->state = DEVICE_STATE_READY;
 
     if (err != ERROR_NONE) {
-        driver->errors[driver->error_index].timestamp = 0;
-        driver->errors[driver->error_index].error_code = err;
-        driver->error_index = (driver->error_index + 1) % ERROR_HISTORY_SIZE;
+        error_log_record(&driver->errors, err, size);
         driver->state = DEVICE_STATE_ERROR;
     }
 
     return err;
 }
 
+error_t uart_driver_transmit_async(uart_driver_t *driver, const uint8_t *data, uint16_t size) {
+    if (driver == NULL || data == NULL || size == 0 || driver->uart == NULL ||
+        driver->state != DEVICE_STATE_READY) {
+        return ERROR_INVALID_PARAM;
+    }
+
+    if (driver->tx_async_active) {
+        return ERROR_BUSY;
+    }
+
+    USART_TypeDef *uart = driver->uart;
+
+    driver->tx_async_data = data;
+    driver->tx_async_size = size;
+    driver->tx_async_sent = 0;
+    driver->tx_async_active = true;
+
+    uart->SR &= ~USART_SR_TC;
+
+    if (driver->dma_tx != NULL) {
+        // Whole buffer in one channel run; TC marks the last stop bit
+        uart->CR3 |= USART_CR3_DMAT;
+        uart_enable_interrupts(uart, USART_CR1_TCIE);
+        error_t err = dma_channel_start(driver->dma_tx, &uart->DR, (void*)data, size,
+                                        DMA_CCR_DIR | DMA_CCR_MINC | DMA_CCR_TEIE);
+        if (err != ERROR_NONE) {
+            uart->CR3 &= ~USART_CR3_DMAT;
+            uart_disable_interrupts(uart, USART_CR1_TCIE);
+            driver->tx_async_active = false;
+            error_log_record(&driver->errors, err, size);
+            return err;
+        }
+        driver->tx_async_sent = size;
+    } else {
+        uart_enable_interrupts(uart, USART_CR1_TXEIE);
+    }
+
+    return ERROR_NONE;
+}
+
+// Completes after 'size' bytes, or earlier when the line goes idle after
+// at least one byte (variable-length frames)
+error_t uart_driver_receive_async(uart_driver_t *driver, uint8_t *data, uint16_t size) {
+    if (driver == NULL || data == NULL || size == 0 || driver->uart == NULL ||
+        driver->state != DEVICE_STATE_READY) {
+        return ERROR_INVALID_PARAM;
+    }
+
+    if (driver->rx_async_active) {
+        return ERROR_BUSY;
+    }
+
+    USART_TypeDef *uart = driver->uart;
+
+    driver->rx_async_data = data;
+    driver->rx_async_size = size;
+    driver->rx_async_received = 0;
+    driver->rx_async_delivered = 0;
+    driver->rx_async_active = true;
+
+    if (driver->dma_rx != NULL) {
+        uart->CR3 |= USART_CR3_DMAR;
+        error_t err = dma_channel_start(driver->dma_rx, &uart->DR, data, size,
+                                        DMA_CCR_MINC | DMA_CCR_HTIE | DMA_CCR_TCIE | DMA_CCR_TEIE);
+        if (err != ERROR_NONE) {
+            uart->CR3 &= ~USART_CR3_DMAR;
+            driver->rx_async_active = false;
+            error_log_record(&driver->errors, err, size);
+            return err;
+        }
+        uart_enable_interrupts(uart, USART_CR1_IDLEIE);
+    } else {
+        uart_enable_interrupts(uart, USART_CR1_RXNEIE | USART_CR1_IDLEIE);
+    }
+
+    return ERROR_NONE;
+}
+
+static void uart_driver_finish_tx(uart_driver_t *driver, error_t result) {
+    uart_disable_interrupts(driver->uart, USART_CR1_TXEIE | USART_CR1_TCIE);
+    if (driver->dma_tx != NULL) {
+        driver->uart->CR3 &= ~USART_CR3_DMAT;
+        dma_channel_stop(driver->dma_tx);
+    }
+    driver->tx_async_active = false;
+
+    if (driver->tx_complete_cb) {
+        driver->tx_complete_cb(result, driver->async_context);
+    }
+}
+
+static void uart_driver_emit_span(uart_driver_t *driver, const uint8_t *data, uint16_t length) {
+    if (driver->rx_framer) {
+        protocol_framer_feed(driver->rx_framer, data, length);
+    } else if (driver->rx_data_cb) {
+        driver->rx_data_cb(data, length, driver->callback_context);
+    }
+}
+
+static void uart_driver_deliver_rx(uart_driver_t *driver) {
+    uint16_t fresh = driver->rx_async_received - driver->rx_async_delivered;
+
+    if (fresh > 0) {
+        uart_driver_emit_span(driver, driver->rx_async_data + driver->rx_async_delivered, fresh);
+    }
+    driver->rx_async_delivered = driver->rx_async_received;
+}
+
+// Hands everything between the last read position and the DMA write
+// position to the consumer, in place; a wrap yields two spans
+static void uart_driver_service_circular(uart_driver_t *driver, bool idle) {
+    uint16_t size = driver->rx_async_size;
+    uint16_t last = driver->rx_async_delivered;
+    uint16_t position = size - (uint16_t)driver->dma_rx->CNDTR;
+    uint16_t fresh;
+
+    if (position == size) {
+        position = 0;
+    }
+
+    if (idle) {
+        driver->rx_stats.idle_events++;
+    }
+    if (position == last) {
+        return;
+    }
+
+    if (position > last) {
+        fresh = position - last;
+        if (last < size / 2 && position >= size / 2) {
+            driver->rx_stats.half_events++;
+        }
+        uart_driver_emit_span(driver, driver->rx_async_data + last, fresh);
+    } else {
+        fresh = (size - last) + position;
+        driver->rx_stats.wrap_events++;
+        if (last < size / 2) {
+            driver->rx_stats.half_events++;
+        }
+        uart_driver_emit_span(driver, driver->rx_async_data + last, size - last);
+        if (position > 0) {
+            uart_driver_emit_span(driver, driver->rx_async_data, position);
+        }
+    }
+
+    driver->rx_async_delivered = position;
+    driver->rx_stats.interrupts++;
+    driver->rx_stats.bytes += fresh;
+    if (fresh > driver->rx_stats.max_bytes_per_irq) {
+        driver->rx_stats.max_bytes_per_irq = fresh;
+    }
+}
+
+static void uart_driver_finish_rx(uart_driver_t *driver, error_t result) {
+    uart_driver_deliver_rx(driver);
+
+    uart_disable_interrupts(driver->uart, USART_CR1_RXNEIE | USART_CR1_IDLEIE);
+    if (driver->dma_rx != NULL) {
+        driver->uart->CR3 &= ~USART_CR3_DMAR;
+        dma_channel_stop(driver->dma_rx);
+    }
+    driver->rx_async_active = false;
+
+    if (driver->rx_complete_cb) {
+        driver->rx_complete_cb(result, driver->rx_async_received, driver->async_context);
+    }
+}
+
+// Continuous reception into a ring the DMA channel refills forever.
+// Half, full and idle events each flush the new bytes, so a frame is
+// handed over as soon as the line goes quiet, whatever its length.
+error_t uart_driver_start_circular_rx(uart_driver_t *driver, uint8_t *buffer, uint16_t size,
+                                      protocol_framer_t *framer) {
+    if (driver == NULL || driver->uart == NULL || driver->dma_rx == NULL ||
+        driver->state != DEVICE_STATE_READY) {
+        return ERROR_INVALID_PARAM;
+    }
+
+    if (driver->rx_async_active) {
+        return ERROR_BUSY;
+    }
+
+    if (buffer == NULL) {
+        buffer = driver->rx_buffer;
+        size = sizeof(driver->rx_buffer);
+    }
+    if (size < 2) {
+        return ERROR_INVALID_PARAM;
+    }
+
+    USART_TypeDef *uart = driver->uart;
+
+    driver->rx_async_data = buffer;
+    driver->rx_async_size = size;
+    driver->rx_async_received = 0;
+    driver->rx_async_delivered = 0;
+    driver->rx_framer = framer;
+    driver->rx_circular = true;
+    driver->rx_async_active = true;
+    memset(&driver->rx_stats, 0, sizeof(driver->rx_stats));
+
+    uart->CR3 |= USART_CR3_DMAR;
+    error_t err = dma_channel_start(driver->dma_rx, &uart->DR, buffer, size,
+                                    DMA_CCR_MINC | DMA_CCR_CIRC | DMA_CCR_HTIE | DMA_CCR_TCIE | DMA_CCR_TEIE);
+    if (err != ERROR_NONE) {
+        uart->CR3 &= ~USART_CR3_DMAR;
+        driver->rx_circular = false;
+        driver->rx_async_active = false;
+        error_log_record(&driver->errors, err, size);
+        return err;
+    }
+    uart_enable_interrupts(uart, USART_CR1_IDLEIE);
+
+    return ERROR_NONE;
+}
+
+void uart_driver_stop_circular_rx(uart_driver_t *driver) {
+    if (driver == NULL || driver->uart == NULL || !driver->rx_circular) return;
+
+    uart_driver_service_circular(driver, false);  // Flush what already landed
+    uart_driver_abort_async(driver);
+}
+
+void uart_driver_abort_async(uart_driver_t *driver) {
+    if (driver == NULL || driver->uart == NULL) return;
+
+    if (driver->tx_async_active) {
+        uart_disable_interrupts(driver->uart, USART_CR1_TXEIE | USART_CR1_TCIE);
+        if (driver->dma_tx != NULL) {
+            driver->uart->CR3 &= ~USART_CR3_DMAT;
+            dma_channel_stop(driver->dma_tx);
+        }
+        driver->tx_async_active = false;
+    }
+
+    if (driver->rx_async_active) {
+        uart_disable_interrupts(driver->uart, USART_CR1_RXNEIE | USART_CR1_IDLEIE);
+        if (driver->dma_rx != NULL) {
+            driver->uart->CR3 &= ~USART_CR3_DMAR;
+            dma_channel_stop(driver->dma_rx);
+        }
+        driver->rx_async_active = false;
+        driver->rx_circular = false;
+        driver->rx_framer = NULL;
+    }
+}
+
+// Shared handler for the USART vector and the driver's DMA channel vectors.
+// DMA progress is read from CNDTR, so half/full transfer need no flags.
 void uart_driver_process_interrupt(uart_driver_t *driver) {
-    if (driver == NULL) return;
+    if (driver == NULL || driver->uart == NULL) return;
+
+    USART_TypeDef *uart = driver->uart;
+    uint32_t sr = uart->SR;
+    uint32_t cr1 = uart->CR1;
+
+    // RX interrupt (no DMA): one byte per RXNE
+    if ((sr & (USART_SR_RXNE | USART_SR_ORE)) && (cr1 & USART_CR1_RXNEIE)) {
+        if (sr & USART_SR_ORE) {
+            driver->rx_stats.overruns++;
+            error_log_record(&driver->errors, ERROR_OVERFLOW, driver->rx_stats.overruns);
+        }
+        uint8_t data = (uint8_t)uart_read_data(uart);
+        if (driver->rx_async_active && driver->rx_async_received < driver->rx_async_size) {
+            driver->rx_async_data[driver->rx_async_received++] = data;
+        }
+        sr &= ~(USART_SR_RXNE | USART_SR_ORE);
+    } else if (sr & USART_SR_ORE) {
+        // DMA mode: a byte was lost before the channel could move it
+        driver->rx_stats.overruns++;
+        error_log_record(&driver->errors, ERROR_OVERFLOW, driver->rx_stats.overruns);
+        uart_read_data(uart);
+    }
+
+    bool idle = (sr & USART_SR_IDLE) && (cr1 & USART_CR1_IDLEIE);
+    if (idle) {
+        uart_read_data(uart);  // SR then DR read clears IDLE
+    }
 
-    // Simulate interrupt processing
-    if (driver->uart->SR & USART_SR_RXNE) {
-        // RX interrupt
-        uint8_t data = (uint8_t)driver->uart->DR;
-        // Process received data
+    if (driver->rx_async_active && driver->rx_circular) {
+        uart_driver_service_circular(driver, idle);
+    } else if (driver->rx_async_active) {
+        if (driver->dma_rx != NULL) {
+            driver->rx_async_received = driver->rx_async_size - (uint16_t)driver->dma_rx->CNDTR;
+        }
+
+        if (driver->rx_async_received == driver->rx_async_size) {
+            uart_driver_finish_rx(driver, ERROR_NONE);
+        } else if (idle && driver->rx_async_received > 0) {
+            uart_driver_finish_rx(driver, ERROR_NONE);
+        } else if (driver->rx_async_received >= driver->rx_async_size / 2) {
+            uart_driver_deliver_rx(driver);  // Half transfer
+        }
     }
 
-    if (driver->uart->SR & USART_SR_TXE) {
-        // TX interrupt
-        // Send next byte
+    // TX interrupt (no DMA): refill on TXE, then wait for TC
+    if ((sr & USART_SR_TXE) && (cr1 & USART_CR1_TXEIE) && driver->tx_async_active) {
+        uart_write_data(uart, driver->tx_async_data[driver->tx_async_sent++]);
+        if (driver->tx_async_sent == driver->tx_async_size) {
+            uart_disable_interrupts(uart, USART_CR1_TXEIE);
+            uart_enable_interrupts(uart, USART_CR1_TCIE);
+        }
+        sr = uart->SR;
+    }
+
+    if ((sr & USART_SR_TC) && (uart->CR1 & USART_CR1_TCIE) && driver->tx_async_active) {
+        bool drained = driver->dma_tx ? driver->dma_tx->CNDTR == 0
+                                      : driver->tx_async_sent == driver->tx_async_size;
+        if (drained) {
+            uart_driver_finish_tx(driver, ERROR_NONE);
+        }
     }
 }
 
@@ -104,47 +436,70 @@ error_t spi_driver_init(spi_driver_t *driver, const spi_config_t *config) {
 
     driver->state = DEVICE_STATE_INIT;
 
-    driver->spi = (SPI_TypeDef*)malloc(sizeof(SPI_TypeDef));
+    // Only a block this driver took itself goes back to the pool
+    if (driver->pool_owner == driver) {
+        mem_pool_release(MEM_POOL_SPI_REGS, driver->spi);
+    }
+    driver->pool_owner = NULL;
+    driver->spi = (SPI_TypeDef*)mem_pool_alloc(MEM_POOL_SPI_REGS);
     if (driver->spi == NULL) {
         return ERROR_BUSY;
     }
+    driver->pool_owner = driver;
 
     error_t err = spi_init(driver->spi, (spi_config_t*)config);
     if (err != ERROR_NONE) {
-        free(driver->spi);
+        mem_pool_release(MEM_POOL_SPI_REGS, driver->spi);
+        driver->spi = NULL;
+        driver->pool_owner = NULL;
         driver->state = DEVICE_STATE_ERROR;
         return err;
     }
 
-    driver->error_index = 0;
-    memset(driver->errors, 0, sizeof(driver->errors));
+    error_log_init(&driver->errors, ERROR_SOURCE_SPI);
+    driver->timeout_ms = 100;  // Default timeout
 
     driver->state = DEVICE_STATE_READY;
 
     return ERROR_NONE;
 }
 
+void spi_driver_deinit(spi_driver_t *driver) {
+    if (driver == NULL) return;
+
+    if (driver->pool_owner == driver) {
+        mem_pool_release(MEM_POOL_SPI_REGS, driver->spi);
+    }
+    driver->pool_owner = NULL;
+    driver->spi = NULL;
+    driver->state = DEVICE_STATE_UNINITIALIZED;
+}
+
 error_t spi_driver_transfer(spi_driver_t *driver, const uint8_t *tx_data, uint8_t *rx_data, uint16_t size) {
     if (driver == NULL || tx_data == NULL || rx_data == NULL || driver->state != DEVICE_STATE_READY) {
         return ERROR_INVALID_PARAM;
     }
 
     driver->state = DEVICE_STATE_BUSY;
+    uint64_t started = LATENCY_START(LATENCY_OP_SPI_TRANSFER);
 
-    // Set CS low (mock)
-    gpio_write_pin(driver->cs_gpio, driver->cs_pin, false);
+    // Set CS low; without a CS port the device is always selected
+    if (driver->cs_gpio != NULL) {
+        gpio_write_pin(driver->cs_gpio, driver->cs_pin, false);
+    }
 
-    error_t err = spi_transmit_receive(driver->spi, (uint8_t*)tx_data, rx_data, size);
+    error_t err = spi_transmit_receive_timeout(driver->spi, tx_data, rx_data, size, driver->timeout_ms);
 
     // Set CS high
-    gpio_write_pin(driver->cs_gpio, driver->cs_pin, true);
+    if (driver->cs_gpio != NULL) {
+        gpio_write_pin(driver->cs_gpio, driver->cs_pin, true);
+    }
+    LATENCY_STOP(LATENCY_OP_SPI_TRANSFER, started);
 
     driver->state = DEVICE_STATE_READY;
 
     if (err != ERROR_NONE) {
-        driver->errors[driver->error_index].timestamp = 0;
-        driver->errors[driver->error_index].error_code = err;
-        driver->error_index = (driver->error_index + 1) % ERROR_HISTORY_SIZE;
+        error_log_record(&driver->errors, err, size);
         driver->state = DEVICE_STATE_ERROR;
     }
 
@@ -152,6 +507,28 @@ error_t spi_driver_transfer(spi_driver_t *driver, const uint8_t *tx_data, uint8_
 }
 
 // I2C Driver Functions
+// No backend attached: reads return mock data
+static error_t i2c_driver_mock_transfer(const i2c_msg_t *msgs, uint8_t count) {
+    for (uint8_t i = 0; i < count; i++) {
+        if (msgs[i].flags & I2C_MSG_READ) {
+            memset(msgs[i].data, 0xAA, msgs[i].length);
+        }
+    }
+    return ERROR_NONE;
+}
+
+// Blocking transaction for the register helpers
+static error_t i2c_driver_run(i2c_driver_t *driver, const i2c_msg_t *msgs, uint8_t count) {
+    i2c_transaction_t txn;
+
+    memset(&txn, 0, sizeof(txn));
+    txn.msgs = msgs;
+    txn.msg_count = count;
+
+    error_t err = i2c_driver_submit(driver, &txn);
+    return (err != ERROR_NONE) ? err : txn.result;
+}
+
 error_t i2c_driver_init(i2c_driver_t *driver, uint8_t address, uint32_t frequency) {
     if (driver == NULL) {
         return ERROR_INVALID_PARAM;
@@ -159,70 +536,175 @@ error_t i2c_driver_init(i2c_driver_t *driver, uint8_t address, uint32_t frequenc
 
     driver->state = DEVICE_STATE_INIT;
     driver->device_addr = address;
+    driver->frequency = frequency;
     driver->timeout_ms = 100;
-    driver->error_index = 0;
-    memset(driver->errors, 0, sizeof(driver->errors));
+    error_log_init(&driver->errors, ERROR_SOURCE_I2C);
+
+    driver->backend = NULL;
+    driver->clock = NULL;
+    driver->head = NULL;
+    driver->tail = NULL;
+    memset(&driver->stats, 0, sizeof(driver->stats));
 
     // Mock I2C initialization
-    driver->i2c_regs = malloc(100);  // Mock registers
+    if (driver->pool_owner == driver) {
+        mem_pool_release(MEM_POOL_I2C_REGS, driver->i2c_regs);
+    }
+    driver->pool_owner = NULL;
+    driver->i2c_regs = mem_pool_alloc(MEM_POOL_I2C_REGS);  // Mock registers
     if (driver->i2c_regs == NULL) {
         return ERROR_BUSY;
     }
+    driver->pool_owner = driver;
 
     driver->state = DEVICE_STATE_READY;
 
     return ERROR_NONE;
 }
 
+void i2c_driver_deinit(i2c_driver_t *driver) {
+    if (driver == NULL) return;
+
+    if (driver->pool_owner == driver) {
+        mem_pool_release(MEM_POOL_I2C_REGS, driver->i2c_regs);
+    }
+    driver->pool_owner = NULL;
+    driver->i2c_regs = NULL;
+    driver->state = DEVICE_STATE_UNINITIALIZED;
+}
+
+// Register write: register address and data in one write, no repeated START
 error_t i2c_driver_write(i2c_driver_t *driver, uint8_t reg, const uint8_t *data, uint16_t size) {
     if (driver == NULL || data == NULL || driver->state != DEVICE_STATE_READY) {
         return ERROR_INVALID_PARAM;
     }
 
-    driver->state = DEVICE_STATE_BUSY;
+    i2c_msg_t msgs[2] = {
+        {driver->device_addr, 0, &reg, 1},
+        {driver->device_addr, I2C_MSG_NOSTART, (uint8_t*)data, size},
+    };
 
-    // Mock I2C write operation
-    // In real implementation, this would handle START, address, register, data, STOP
+    return i2c_driver_run(driver, msgs, size > 0 ? 2 : 1);
+}
 
-    driver->state = DEVICE_STATE_READY;
+// Register read: write the start register, repeated START, then read size
+// bytes as one auto-increment burst
+error_t i2c_driver_read(i2c_driver_t *driver, uint8_t reg, uint8_t *data, uint16_t size) {
+    if (driver == NULL || data == NULL || size == 0 || driver->state != DEVICE_STATE_READY) {
+        return ERROR_INVALID_PARAM;
+    }
 
-    return ERROR_NONE;
+    i2c_msg_t msgs[2] = {
+        {driver->device_addr, 0, &reg, 1},
+        {driver->device_addr, I2C_MSG_READ, data, size},
+    };
+
+    return i2c_driver_run(driver, msgs, 2);
 }
 
-error_t i2c_driver_read(i2c_driver_t *driver, uint8_t reg, uint8_t *data, uint16_t size) {
-    if (driver == NULL || data == NULL || driver->state != DEVICE_STATE_READY) {
+error_t i2c_driver_submit(i2c_driver_t *driver, i2c_transaction_t *txn) {
+    if (driver == NULL || txn == NULL || txn->msgs == NULL || txn->msg_count == 0) {
         return ERROR_INVALID_PARAM;
     }
+    for (uint8_t i = 0; i < txn->msg_count; i++) {
+        const i2c_msg_t *msg = &txn->msgs[i];
+        if ((msg->data == NULL && msg->length > 0) ||
+            ((msg->flags & I2C_MSG_NOSTART) && (i == 0 || (msg->flags & I2C_MSG_READ)))) {
+            return ERROR_INVALID_PARAM;
+        }
+    }
 
-    driver->state = DEVICE_STATE_BUSY;
+    txn->result = ERROR_BUSY;
+    txn->submitted_at = driver->clock ? driver->clock() : 0;
+    txn->completed_at = 0;
+    txn->next = NULL;
 
-    // Mock I2C read operation
-    memset(data, 0xAA, size);  // Mock data
+    if (driver->tail) {
+        driver->tail->next = txn;
+    } else {
+        driver->head = txn;
+    }
+    driver->tail = txn;
 
-    driver->state = DEVICE_STATE_READY;
+    i2c_driver_process(driver);
 
     return ERROR_NONE;
 }
 
+// Runs queued transactions in order. Transactions submitted from a
+// completion callback are picked up by the loop already running.
+void i2c_driver_process(i2c_driver_t *driver) {
+    if (driver == NULL || driver->state != DEVICE_STATE_READY) return;
+
+    while (driver->head != NULL) {
+        i2c_transaction_t *txn = driver->head;
+        driver->head = txn->next;
+        if (driver->head == NULL) {
+            driver->tail = NULL;
+        }
+        txn->next = NULL;
+
+        driver->state = DEVICE_STATE_BUSY;
+        uint64_t started = LATENCY_START(LATENCY_OP_I2C_TRANSFER);
+        if (driver->backend) {
+            txn->result = driver->backend->transfer(driver, txn->msgs, txn->msg_count, driver->backend->context);
+        } else {
+            txn->result = i2c_driver_mock_transfer(txn->msgs, txn->msg_count);
+        }
+        LATENCY_STOP(LATENCY_OP_I2C_TRANSFER, started);
+        txn->completed_at = driver->clock ? driver->clock() : 0;
+
+        i2c_stats_t *stats = &driver->stats;
+        uint64_t latency = txn->completed_at - txn->submitted_at;
+        stats->transactions++;
+        stats->messages += txn->msg_count;
+        for (uint8_t i = 0; i < txn->msg_count; i++) {
+            stats->bytes += txn->msgs[i].length;
+        }
+        stats->total_ns += latency;
+        if (latency > stats->max_ns) {
+            stats->max_ns = latency;
+        }
+        if (txn->result != ERROR_NONE) {
+            stats->errors++;
+            error_log_record(&driver->errors, txn->result, txn->msgs[0].address);
+        }
+
+        if (txn->completion_cb) {
+            txn->completion_cb(txn, txn->result, txn->context);
+        }
+        driver->state = DEVICE_STATE_READY;
+    }
+}
+
 // CAN Driver Functions
 error_t can_driver_init(can_driver_t *driver, uint32_t bitrate) {
     if (driver == NULL) {
         return ERROR_INVALID_PARAM;
     }
 
+    // Re-running init returns the previous handle to its pool; a copy of
+    // another driver or an uninitialised struct does not own it
+    if (driver->pool_owner == driver) {
+        can_driver_deinit(driver);
+    }
+    driver->pool_owner = NULL;
+
     driver->state = DEVICE_STATE_INIT;
     driver->bitrate = bitrate;
-    driver->error_index = 0;
-    memset(driver->errors, 0, sizeof(driver->errors));
+    error_log_init(&driver->errors, ERROR_SOURCE_CAN);
 
-    driver->can = (can_handle_t*)malloc(sizeof(can_handle_t));
+    driver->can = (can_handle_t*)mem_pool_alloc(MEM_POOL_CAN_HANDLES);
     if (driver->can == NULL) {
         return ERROR_BUSY;
     }
+    driver->pool_owner = driver;
 
     protocol_error_t err = can_init(driver->can, 32);  // 32 message buffer
     if (err != PROTOCOL_ERROR_NONE) {
-        free(driver->can);
+        mem_pool_release(MEM_POOL_CAN_HANDLES, driver->can);
+        driver->can = NULL;
+        driver->pool_owner = NULL;
         driver->state = DEVICE_STATE_ERROR;
         return ERROR_BUSY;
     }
@@ -232,6 +714,18 @@ error_t can_driver_init(can_driver_t *driver, uint32_t bitrate) {
     return ERROR_NONE;
 }
 
+void can_driver_deinit(can_driver_t *driver) {
+    if (driver == NULL) return;
+
+    if (driver->pool_owner == driver && mem_pool_owns(MEM_POOL_CAN_HANDLES, driver->can)) {
+        can_deinit(driver->can);
+        mem_pool_release(MEM_POOL_CAN_HANDLES, driver->can);
+    }
+    driver->pool_owner = NULL;
+    driver->can = NULL;
+    driver->state = DEVICE_STATE_UNINITIALIZED;
+}
+
 error_t can_driver_send_message(can_driver_t *driver, const can_frame_t *frame) {
     if (driver == NULL || frame == NULL || driver->state != DEVICE_STATE_READY) {
         return ERROR_INVALID_PARAM;
@@ -239,14 +733,19 @@ error_t can_driver_send_message(can_driver_t *driver, const can_frame_t *frame)
 
     driver->state = DEVICE_STATE_BUSY;
 
+    uint64_t started = LATENCY_START(LATENCY_OP_CAN_SEND);
     protocol_error_t err = can_transmit_message(driver->can, frame, 1000);
+    LATENCY_STOP(LATENCY_OP_CAN_SEND, started);
 
     driver->state = DEVICE_STATE_READY;
 
+    // A full TX queue is backpressure, not a fault
+    if (err == PROTOCOL_ERROR_BUFFER_OVERFLOW) {
+        return ERROR_BUSY;
+    }
+
     if (err != PROTOCOL_ERROR_NONE) {
-        driver->errors[driver->error_index].timestamp = 0;
-        driver->errors[driver->error_index].error_code = (error_t)err;
-        driver->error_index = (driver->error_index + 1) % ERROR_HISTORY_SIZE;
+        error_log_record(&driver->errors, (error_t)err, frame->id);
         driver->state = DEVICE_STATE_ERROR;
         return ERROR_BUSY;
     }
@@ -254,74 +753,266 @@ error_t can_driver_send_message(can_driver_t *driver, const can_frame_t *frame)
     return ERROR_NONE;
 }
 
+// Transmit-complete interrupt: the controller sent the oldest queued frame
+void can_driver_process_tx_complete(can_driver_t *driver) {
+    if (driver == NULL || driver->can == NULL) return;
+
+    can_handle_t *can = driver->can;
+    if (can->tx_tail == can->tx_head) return;
+
+    const can_frame_t *frame = &can->tx_buffer[can->tx_tail];
+    can->tx_tail = (can->tx_tail + 1) % can->buffer_size;
+
+    if (driver->tx_complete_cb) {
+        driver->tx_complete_cb(frame, driver->async_context);
+    }
+}
+
 // Sensor Driver Functions
+// Bus defaults: SPI mode 0 at PCLK/4, UART 115200 8N1
+static const spi_config_t sensor_spi_config = {1, 8, 0, 0, false, false};
+static const uart_config_t sensor_uart_config = {115200, 8, 0, 0, false};
+
+// Scales the raw sample, applies calibration and reports it; every bus
+// path ends here
+static error_t sensor_driver_complete(sensor_driver_t *driver, error_t err, const uint8_t *data,
+                                      uint64_t started, float *value) {
+    if (err != ERROR_NONE) {
+        // The interface stays in ERROR; reads refuse until sensor_driver_recover
+        LATENCY_STOP(LATENCY_OP_SENSOR_READ, started);
+        error_log_record(&driver->errors, err, SENSOR_REG_VALUE);
+        driver->state = DEVICE_STATE_ERROR;
+        return err;
+    }
+
+    *value = ((data[0] << 8) | data[1]) * 0.01f;
+
+    // Apply calibration
+    *value = (*value * driver->calibration_scale) + driver->calibration_offset;
+
+    driver->last_value = *value;
+    driver->last_reading_time = timebase_now_us();
+    LATENCY_STOP(LATENCY_OP_SENSOR_READ, started);
+
+    driver->state = DEVICE_STATE_READY;
+
+    if (driver->data_ready_cb) {
+        driver->data_ready_cb(*value, driver->callback_context);
+    }
+
+    return ERROR_NONE;
+}
+
 error_t sensor_driver_init(sensor_driver_t *driver, uint8_t interface_type, uint8_t sensor_type) {
     if (driver == NULL) {
         return ERROR_INVALID_PARAM;
     }
 
+    // Re-running init returns the previous interface to its pool; a copy of
+    // another sensor or an uninitialised struct does not own it
+    if (driver->pool_owner == driver) {
+        sensor_driver_deinit(driver);
+    }
+    driver->pool_owner = NULL;
+    driver->i2c = NULL;
+    driver->spi = NULL;
+    driver->uart = NULL;
+
     driver->state = DEVICE_STATE_INIT;
     driver->sensor_type = sensor_type;
     driver->sampling_rate = 100;  // 100 Hz default
     driver->calibration_offset = 0.0f;
     driver->calibration_scale = 1.0f;
-    driver->error_index = 0;
-    memset(driver->errors, 0, sizeof(driver->errors));
+    error_log_init(&driver->errors, ERROR_SOURCE_SENSOR);
 
     // Initialize appropriate interface
     switch (interface_type) {
-        case 0:  // I2C
-            driver->i2c = (i2c_driver_t*)malloc(sizeof(i2c_driver_t));
-            i2c_driver_init(driver->i2c, 0x40, 400000);  // Mock address and frequency
+        case SENSOR_BUS_I2C:
+            driver->i2c = (i2c_driver_t*)mem_pool_alloc(MEM_POOL_SENSOR_I2C);
+            if (driver->i2c == NULL) {
+                return ERROR_BUSY;
+            }
+            driver->pool_owner = driver;
+            if (i2c_driver_init(driver->i2c, 0x40, 400000) != ERROR_NONE) {  // Mock address and frequency
+                sensor_driver_deinit(driver);
+                return ERROR_BUSY;
+            }
             break;
-        case 1:  // SPI
-            driver->spi = (spi_driver_t*)malloc(sizeof(spi_driver_t));
-            // SPI config would be set here
+        case SENSOR_BUS_SPI:
+            driver->spi = (spi_driver_t*)mem_pool_alloc(MEM_POOL_SENSOR_SPI);
+            if (driver->spi == NULL) {
+                return ERROR_BUSY;
+            }
+            driver->pool_owner = driver;
+            // Chip select is board wiring: set spi->cs_gpio/cs_pin after init
+            memset(driver->spi, 0, sizeof(*driver->spi));
+            if (spi_driver_init(driver->spi, &sensor_spi_config) != ERROR_NONE) {
+                sensor_driver_deinit(driver);
+                return ERROR_BUSY;
+            }
             break;
-        case 2:  // UART
-            driver->uart = (uart_driver_t*)malloc(sizeof(uart_driver_t));
-            // UART config would be set here
+        case SENSOR_BUS_UART:
+            driver->uart = (uart_driver_t*)mem_pool_alloc(MEM_POOL_SENSOR_UART);
+            if (driver->uart == NULL) {
+                return ERROR_BUSY;
+            }
+            driver->pool_owner = driver;
+            memset(driver->uart, 0, sizeof(*driver->uart));
+            if (uart_driver_init(driver->uart, &sensor_uart_config) != ERROR_NONE) {
+                sensor_driver_deinit(driver);
+                return ERROR_BUSY;
+            }
             break;
         default:
             return ERROR_INVALID_PARAM;
     }
 
+    driver->bus = (sensor_bus_t)interface_type;
     driver->state = DEVICE_STATE_READY;
 
     return ERROR_NONE;
 }
 
+// Returns the interface driver and its registers to their pools
+void sensor_driver_deinit(sensor_driver_t *driver) {
+    if (driver == NULL) return;
+
+    if (driver->pool_owner != driver) {
+        // Never took an interface from the pools, or is a copy of a sensor that did
+        driver->i2c = NULL;
+        driver->spi = NULL;
+        driver->uart = NULL;
+        driver->state = DEVICE_STATE_UNINITIALIZED;
+        return;
+    }
+    if (mem_pool_owns(MEM_POOL_SENSOR_I2C, driver->i2c)) {
+        i2c_driver_deinit(driver->i2c);
+        mem_pool_release(MEM_POOL_SENSOR_I2C, driver->i2c);
+    }
+    if (mem_pool_owns(MEM_POOL_SENSOR_SPI, driver->spi)) {
+        spi_driver_deinit(driver->spi);
+        mem_pool_release(MEM_POOL_SENSOR_SPI, driver->spi);
+    }
+    if (mem_pool_owns(MEM_POOL_SENSOR_UART, driver->uart)) {
+        uart_driver_deinit(driver->uart);
+        mem_pool_release(MEM_POOL_SENSOR_UART, driver->uart);
+    }
+    driver->pool_owner = NULL;
+    driver->i2c = NULL;
+    driver->spi = NULL;
+    driver->uart = NULL;
+    driver->state = DEVICE_STATE_UNINITIALIZED;
+}
+
+// Run-time bus selection for code holding sensors of mixed buses. The
+// compiler may lower the compares to a jump table; sensors with a fixed bus
+// skip the selection entirely through SENSOR_BUS_DEFINE.
 error_t sensor_driver_read(sensor_driver_t *driver, float *value) {
-    if (driver == NULL || value == NULL || driver->state != DEVICE_STATE_READY) {
+    if (driver == NULL) {
+        return ERROR_INVALID_PARAM;
+    }
+
+    if (driver->bus == SENSOR_BUS_I2C) {
+        return sensor_driver_read_i2c(driver, value);
+    }
+    if (driver->bus == SENSOR_BUS_SPI) {
+        return sensor_driver_read_spi(driver, value);
+    }
+    return sensor_driver_read_uart(driver, value);
+}
+
+// Register read with a repeated START
+error_t sensor_driver_read_i2c(sensor_driver_t *driver, float *value) {
+    if (driver == NULL || value == NULL || driver->bus != SENSOR_BUS_I2C || driver->state != DEVICE_STATE_READY) {
         return ERROR_INVALID_PARAM;
     }
 
+    uint8_t data[2];
+
     driver->state = DEVICE_STATE_BUSY;
+    uint64_t started = LATENCY_START(LATENCY_OP_SENSOR_READ);
 
-    // Mock sensor reading based on interface
-    if (driver->i2c) {
-        uint8_t data[2];
-        i2c_driver_read(driver->i2c, 0x00, data, 2);  // Mock register read
-        *value = ((data[0] << 8) | data[1]) * 0.01f;  // Convert to float
-    } else {
-        *value = 25.5f;  // Mock value
+    error_t err = i2c_driver_read(driver->i2c, SENSOR_REG_VALUE, data, 2);
+    return sensor_driver_complete(driver, err, data, started, value);
+}
+
+// Address byte with the read bit, two dummy bytes clock the sample out
+error_t sensor_driver_read_spi(sensor_driver_t *driver, float *value) {
+    if (driver == NULL || value == NULL || driver->bus != SENSOR_BUS_SPI || driver->state != DEVICE_STATE_READY) {
+        return ERROR_INVALID_PARAM;
+    }
+    if (driver->spi->cs_gpio == NULL) {
+        return ERROR_INVALID_PARAM;  // Chip select not wired yet
     }
 
-    // Apply calibration
-    *value = (*value * driver->calibration_scale) + driver->calibration_offset;
+    const uint8_t tx[3] = {SENSOR_SPI_READ | SENSOR_REG_VALUE, 0x00, 0x00};
+    uint8_t rx[3];
 
-    driver->last_value = *value;
-    driver->last_reading_time = 0;  // Mock timestamp
+    driver->state = DEVICE_STATE_BUSY;
+    uint64_t started = LATENCY_START(LATENCY_OP_SENSOR_READ);
 
-    driver->state = DEVICE_STATE_READY;
+    error_t err = spi_driver_transfer(driver->spi, tx, rx, sizeof(tx));
+    return sensor_driver_complete(driver, err, &rx[1], started, value);
+}
 
-    if (driver->data_ready_cb) {
-        driver->data_ready_cb(*value, driver->callback_context);
+// Read command and register out, two sample bytes back
+error_t sensor_driver_read_uart(sensor_driver_t *driver, float *value) {
+    if (driver == NULL || value == NULL || driver->bus != SENSOR_BUS_UART || driver->state != DEVICE_STATE_READY) {
+        return ERROR_INVALID_PARAM;
     }
 
+    const uint8_t command[2] = {SENSOR_UART_CMD_READ, SENSOR_REG_VALUE};
+    uint8_t data[2];
+
+    driver->state = DEVICE_STATE_BUSY;
+    uint64_t started = LATENCY_START(LATENCY_OP_SENSOR_READ);
+
+    error_t err = uart_driver_transmit(driver->uart, command, sizeof(command));
+    if (err == ERROR_NONE) {
+        err = uart_driver_receive(driver->uart, data, sizeof(data));
+    }
+    return sensor_driver_complete(driver, err, data, started, value);
+}
+
+// Returns a sensor whose last read failed, and its interface, to READY. The
+// failure stays in the sensor's error log.
+error_t sensor_driver_recover(sensor_driver_t *driver) {
+    if (driver == NULL || driver->state != DEVICE_STATE_ERROR) {
+        return ERROR_INVALID_PARAM;
+    }
+
+    if (driver->i2c != NULL && driver->i2c->state == DEVICE_STATE_ERROR) {
+        driver->i2c->state = DEVICE_STATE_READY;
+    }
+    if (driver->spi != NULL && driver->spi->state == DEVICE_STATE_ERROR) {
+        driver->spi->state = DEVICE_STATE_READY;
+    }
+    if (driver->uart != NULL && driver->uart->state == DEVICE_STATE_ERROR) {
+        driver->uart->state = DEVICE_STATE_READY;
+    }
+    driver->state = DEVICE_STATE_READY;
+
     return ERROR_NONE;
 }
 
+// Consecutive registers (e.g. a whole accelerometer/gyro sample) in one
+// bus transaction
+error_t sensor_driver_read_block(sensor_driver_t *driver, uint8_t reg, uint8_t *data, uint16_t size) {
+    if (driver == NULL || data == NULL || driver->i2c == NULL || driver->state != DEVICE_STATE_READY) {
+        return ERROR_INVALID_PARAM;
+    }
+
+    driver->state = DEVICE_STATE_BUSY;
+    error_t err = i2c_driver_read(driver->i2c, reg, data, size);
+    driver->state = DEVICE_STATE_READY;
+
+    if (err != ERROR_NONE) {
+        error_log_record(&driver->errors, err, reg);
+    }
+
+    return err;
+}
+
 error_t sensor_driver_calibrate(sensor_driver_t *driver, float reference_value) {
     if (driver == NULL) {
         return ERROR_INVALID_PARAM;
@@ -5,6 +5,8 @@
 #include <stdbool.h>
 #include "embedded_hardware.h"
 #include "communication_protocols.h"
+#include "protocol_framer.h"
+#include "error_telemetry.h"
 
 // Device States
 typedef enum {
@@ -17,13 +19,16 @@ typedef enum {
     DEVICE_STATE_OFF
 } device_state_t;
 
-// Error History
-#define ERROR_HISTORY_SIZE 10
+// Circular DMA receive counters
 typedef struct {
-    uint32_t timestamp;
-    error_t error_code;
-    uint32_t context;
-} error_history_t;
+    uint32_t interrupts;           // Handler runs that found new bytes
+    uint32_t idle_events;
+    uint32_t half_events;          // Write position crossed the buffer midpoint
+    uint32_t wrap_events;          // Write position wrapped to the start
+    uint32_t overruns;             // USART ORE: bytes lost before DMA moved them
+    uint64_t bytes;
+    uint16_t max_bytes_per_irq;
+} uart_rx_stats_t;
 
 // UART Driver Structure
 typedef struct {
@@ -35,12 +40,32 @@ typedef struct {
     uint32_t timeout_ms;           // Timeout in milliseconds
     void (*state_change_cb)(device_state_t old, device_state_t new, void* context);
     void *callback_context;        // Callback context
-    error_history_t errors[ERROR_HISTORY_SIZE];
-    uint8_t error_index;
+    error_log_t errors;            // Recent errors and per-code counters
     uint8_t tx_buffer[256];        // TX buffer
     uint8_t rx_buffer[256];        // RX buffer
     uint16_t tx_size;              // Current TX size
     uint16_t rx_size;              // Current RX size
+
+    // Asynchronous transfers: DMA when the channel is set, interrupts otherwise
+    void (*tx_complete_cb)(error_t result, void* context);
+    void (*rx_complete_cb)(error_t result, uint16_t length, void* context);
+    void (*rx_data_cb)(const uint8_t *data, uint16_t length, void* context);  // Spans as they land
+    void *async_context;           // Context of tx_complete_cb and rx_complete_cb
+    const uint8_t *tx_async_data;
+    uint16_t tx_async_size;
+    uint16_t tx_async_sent;        // Bytes handed to the USART (interrupt mode)
+    uint8_t *rx_async_data;
+    uint16_t rx_async_size;
+    uint16_t rx_async_received;
+    uint16_t rx_async_delivered;   // Bytes already passed to rx_data_cb
+    bool tx_async_active;
+    bool rx_async_active;
+
+    // Circular receive: DMA runs continuously, spans go to rx_data_cb or rx_framer
+    bool rx_circular;
+    protocol_framer_t *rx_framer;
+    uart_rx_stats_t rx_stats;
+    const void *pool_owner;        // The driver itself once init took its block from the pool
 } uart_driver_t;
 
 // SPI Driver Structure
@@ -52,25 +77,80 @@ typedef struct {
     uint8_t cs_pin;                // Chip select pin
     GPIO_TypeDef *cs_gpio;         // CS GPIO port
     uint32_t frequency;            // SPI frequency
+    uint32_t timeout_ms;           // Timeout in milliseconds
     void (*completion_cb)(error_t result, void* context);
     void *callback_context;
-    error_history_t errors[ERROR_HISTORY_SIZE];
-    uint8_t error_index;
+    error_log_t errors;            // Recent errors and per-code counters
+    const void *pool_owner;        // The driver itself once init took its block from the pool
 } spi_driver_t;
 
-// I2C Driver Structure
+// I2C message: one address phase and its data. Consecutive messages of a
+// transaction are joined by a repeated START; STOP follows the last one.
+#define I2C_MSG_READ       0x01    // Read from the target
+#define I2C_MSG_NOSTART    0x02    // Continue the previous write without a new address phase
+
 typedef struct {
+    uint8_t address;               // 7-bit target address
+    uint8_t flags;
+    uint8_t *data;
+    uint16_t length;
+} i2c_msg_t;
+
+typedef struct i2c_transaction i2c_transaction_t;
+
+// Transaction descriptor; owned by the caller until completion_cb runs
+struct i2c_transaction {
+    const i2c_msg_t *msgs;
+    uint8_t msg_count;
+    void (*completion_cb)(i2c_transaction_t *txn, error_t result, void* context);
+    void *context;
+
+    // Filled in by the driver
+    error_t result;
+    uint64_t submitted_at;
+    uint64_t completed_at;
+    i2c_transaction_t *next;
+};
+
+// Bus statistics
+typedef struct {
+    uint32_t transactions;
+    uint32_t messages;
+    uint32_t errors;
+    uint64_t bytes;
+    uint64_t total_ns;             // Submit to completion
+    uint64_t max_ns;
+} i2c_stats_t;
+
+struct i2c_driver;
+
+// Bus backend: runs one transaction from START to STOP before returning
+typedef struct {
+    error_t (*transfer)(struct i2c_driver *driver, const i2c_msg_t *msgs, uint8_t count, void *context);
+    void *context;
+} i2c_backend_t;
+
+// I2C Driver Structure
+typedef struct i2c_driver {
     void *i2c_regs;                // I2C hardware registers (placeholder)
     device_state_t state;
     uint8_t device_addr;
+    uint32_t frequency;            // SCL frequency
     uint32_t timeout_ms;
     bool use_dma;
     DMA_Channel_TypeDef *dma_tx;
     DMA_Channel_TypeDef *dma_rx;
     void (*event_cb)(uint32_t event, void* context);
     void *callback_context;
-    error_history_t errors[ERROR_HISTORY_SIZE];
-    uint8_t error_index;
+    error_log_t errors;            // Recent errors and per-code counters
+
+    // Transaction queue; without a backend reads return mock data
+    const i2c_backend_t *backend;
+    protocol_clock_t clock;
+    i2c_transaction_t *head;
+    i2c_transaction_t *tail;
+    i2c_stats_t stats;
+    const void *pool_owner;        // The driver itself once init took its block from the pool
 } i2c_driver_t;
 
 // CAN Driver Structure
@@ -80,16 +160,34 @@ typedef struct {
     uint32_t bitrate;              // CAN bitrate
     uint8_t filter_count;          // Number of filters
     void (*message_cb)(const can_frame_t* frame, void* context);
+    void (*tx_complete_cb)(const can_frame_t* frame, void* context);  // Frame left the TX queue
     void *callback_context;
-    error_history_t errors[ERROR_HISTORY_SIZE];
-    uint8_t error_index;
+    void *async_context;           // Context of tx_complete_cb
+    error_log_t errors;            // Recent errors and per-code counters
+    const void *pool_owner;        // The driver itself once init took its handle from the pool
 } can_driver_t;
 
+// Sensor bus; the values are sensor_driver_init's interface_type
+typedef enum {
+    SENSOR_BUS_I2C,
+    SENSOR_BUS_SPI,
+    SENSOR_BUS_UART
+} sensor_bus_t;
+
+// Sensor register map as seen on every bus: a 16-bit big-endian sample in
+// 0.01 units at SENSOR_REG_VALUE. SPI reads set bit 7 of the address byte;
+// UART reads send SENSOR_UART_CMD_READ and the register, then get the two
+// bytes back.
+#define SENSOR_REG_VALUE        0x00
+#define SENSOR_SPI_READ         0x80
+#define SENSOR_UART_CMD_READ    0x52
+
 // Sensor Driver Structure (complex with multiple interfaces)
 typedef struct {
     i2c_driver_t *i2c;             // I2C interface
     spi_driver_t *spi;             // SPI interface (alternative)
     uart_driver_t *uart;           // UART interface (alternative)
+    sensor_bus_t bus;              // Which of the three is in use
     device_state_t state;
     uint8_t sensor_type;           // Type of sensor
     uint32_t sampling_rate;        // Sampling rate in Hz
@@ -97,32 +195,68 @@ typedef struct {
     float calibration_scale;       // Calibration scale
     void (*data_ready_cb)(float data, void* context);
     void *callback_context;
-    error_history_t errors[ERROR_HISTORY_SIZE];
-    uint8_t error_index;
-    uint32_t last_reading_time;    // Timestamp of last reading
+    error_log_t errors;            // Recent errors and per-code counters
+    uint32_t last_reading_time;    // Timestamp of last reading (timebase_now_us)
     float last_value;              // Last sensor value
+    const void *pool_owner;        // The driver itself once init took its interface from the pool
 } sensor_driver_t;
 
+// Compile-time bus binding. SENSOR_BUS_DEFINE(humidity, spi) generates
+// humidity_init(driver, sensor_type) and humidity_read(driver, value), which
+// call the SPI read path directly: a sensor whose bus is fixed by the board
+// reads without looking at driver->bus. sensor_driver_read is the run-time
+// equivalent for code that handles sensors on mixed buses.
+#define SENSOR_BUS_ID_i2c       SENSOR_BUS_I2C
+#define SENSOR_BUS_ID_spi       SENSOR_BUS_SPI
+#define SENSOR_BUS_ID_uart      SENSOR_BUS_UART
+
+#define SENSOR_BUS_DEFINE(name, bus)                                                    \
+    static inline error_t name##_init(sensor_driver_t *driver, uint8_t sensor_type) {  \
+        return sensor_driver_init(driver, SENSOR_BUS_ID_##bus, sensor_type);            \
+    }                                                                                   \
+    static inline error_t name##_read(sensor_driver_t *driver, float *value) {         \
+        return sensor_driver_read_##bus(driver, value);                                 \
+    }
+
 // Function declarations
 error_t uart_driver_init(uart_driver_t *driver, const uart_config_t *config);
+void uart_driver_deinit(uart_driver_t *driver);
 error_t uart_driver_transmit(uart_driver_t *driver, const uint8_t *data, uint16_t size);
 error_t uart_driver_receive(uart_driver_t *driver, uint8_t *data, uint16_t size);
+error_t uart_driver_transmit_async(uart_driver_t *driver, const uint8_t *data, uint16_t size);
+error_t uart_driver_receive_async(uart_driver_t *driver, uint8_t *data, uint16_t size);
+void uart_driver_abort_async(uart_driver_t *driver);
+error_t uart_driver_start_circular_rx(uart_driver_t *driver, uint8_t *buffer, uint16_t size,
+                                      protocol_framer_t *framer);
+void uart_driver_stop_circular_rx(uart_driver_t *driver);
 void uart_driver_process_interrupt(uart_driver_t *driver);
 
 error_t spi_driver_init(spi_driver_t *driver, const spi_config_t *config);
+void spi_driver_deinit(spi_driver_t *driver);
 error_t spi_driver_transfer(spi_driver_t *driver, const uint8_t *tx_data, uint8_t *rx_data, uint16_t size);
 void spi_driver_process_interrupt(spi_driver_t *driver);
 
 error_t i2c_driver_init(i2c_driver_t *driver, uint8_t address, uint32_t frequency);
+void i2c_driver_deinit(i2c_driver_t *driver);
 error_t i2c_driver_write(i2c_driver_t *driver, uint8_t reg, const uint8_t *data, uint16_t size);
 error_t i2c_driver_read(i2c_driver_t *driver, uint8_t reg, uint8_t *data, uint16_t size);
+error_t i2c_driver_submit(i2c_driver_t *driver, i2c_transaction_t *txn);
+void i2c_driver_process(i2c_driver_t *driver);
 
 error_t can_driver_init(can_driver_t *driver, uint32_t bitrate);
+void can_driver_deinit(can_driver_t *driver);
 error_t can_driver_send_message(can_driver_t *driver, const can_frame_t *frame);
+void can_driver_process_tx_complete(can_driver_t *driver);
 void can_driver_process_message(can_driver_t *driver, const can_frame_t *frame);
 
 error_t sensor_driver_init(sensor_driver_t *driver, uint8_t interface_type, uint8_t sensor_type);
+void sensor_driver_deinit(sensor_driver_t *driver);
 error_t sensor_driver_read(sensor_driver_t *driver, float *value);
+error_t sensor_driver_read_i2c(sensor_driver_t *driver, float *value);
+error_t sensor_driver_read_spi(sensor_driver_t *driver, float *value);
+error_t sensor_driver_read_uart(sensor_driver_t *driver, float *value);
+error_t sensor_driver_recover(sensor_driver_t *driver);
+error_t sensor_driver_read_block(sensor_driver_t *driver, uint8_t reg, uint8_t *data, uint16_t size);
 error_t sensor_driver_calibrate(sensor_driver_t *driver, float reference_value);
 
 #endif // DEVICE_DRIVERS_H
\ No newline at end of file
@@ -0,0 +1,268 @@
+#include "dma_engine.h"
+#include <stddef.h>
+#include <string.h>
+
+// Internal helpers
+static void engine_lock(dma_engine_t *engine) {
+    if (engine->backend && engine->backend->lock) {
+        engine->backend->lock(engine->backend->context);
+    }
+}
+
+static void engine_unlock(dma_engine_t *engine) {
+    if (engine->backend && engine->backend->unlock) {
+        engine->backend->unlock(engine->backend->context);
+    }
+}
+
+// Programs the next chunk of the channel's descriptor
+static error_t engine_start_chunk(dma_engine_t *engine, uint8_t channel) {
+    dma_engine_channel_t *ch = &engine->channels[channel];
+    const dma_descriptor_t *desc = ch->descriptor;
+    uint32_t remaining = desc->length - ch->offset;
+    const uint8_t *source = (const uint8_t*)desc->source + ch->offset;
+    uint8_t *destination = (uint8_t*)desc->destination + ch->offset;
+
+    ch->chunk = remaining > DMA_ENGINE_MAX_CHUNK ? DMA_ENGINE_MAX_CHUNK : remaining;
+    uint32_t ccr = ((uint32_t)ch->transfer->priority << DMA_CCR_PL_Pos) | DMA_CCR_TCIE | DMA_CCR_TEIE;
+
+    error_t err = dma_channel_start_copy(engine->regs[channel], source, destination, (uint16_t)ch->chunk, ccr);
+    if (err != ERROR_NONE) {
+        return err;
+    }
+    engine->stats.chunks++;
+
+    if (engine->backend && engine->backend->start) {
+        engine->backend->start(engine, channel, source, destination, ch->chunk, engine->backend->context);
+    }
+
+    return ERROR_NONE;
+}
+
+static dma_transfer_t* engine_dequeue(dma_engine_t *engine) {
+    for (int p = DMA_ENGINE_PRIORITIES - 1; p >= 0; p--) {
+        dma_transfer_t *transfer = engine->head[p];
+        if (transfer != NULL) {
+            engine->head[p] = transfer->next;
+            if (engine->head[p] == NULL) {
+                engine->tail[p] = NULL;
+            }
+            transfer->next = NULL;
+            engine->pending--;
+            return transfer;
+        }
+    }
+    return NULL;
+}
+
+static error_t engine_start_transfer(dma_engine_t *engine, uint8_t channel, dma_transfer_t *transfer) {
+    dma_engine_channel_t *ch = &engine->channels[channel];
+
+    transfer->channel = channel;
+    ch->transfer = transfer;
+    ch->descriptor = transfer->chain;
+    ch->offset = 0;
+
+    return engine_start_chunk(engine, channel);
+}
+
+// Called with the lock held; finished transfers are collected on a list
+// and completed after the lock is dropped
+static void engine_release_channel(dma_engine_t *engine, uint8_t channel, error_t result,
+                                   dma_transfer_t **finished) {
+    dma_engine_channel_t *ch = &engine->channels[channel];
+    dma_transfer_t *done = ch->transfer;
+
+    done->result = result;
+    done->next = *finished;
+    *finished = done;
+    ch->transfer = NULL;
+    ch->descriptor = NULL;
+
+    if (result == ERROR_NONE) {
+        engine->stats.transfers++;
+    } else {
+        engine->stats.errors++;
+    }
+
+    // Arbitration: the freed channel takes the next waiting transfer
+    dma_transfer_t *next;
+    while ((next = engine_dequeue(engine)) != NULL) {
+        error_t err = engine_start_transfer(engine, channel, next);
+        if (err == ERROR_NONE) {
+            break;
+        }
+        ch->transfer = NULL;
+        next->result = err;
+        next->next = *finished;
+        *finished = next;
+        engine->stats.errors++;
+    }
+}
+
+static void engine_finish(dma_engine_t *engine, dma_transfer_t *transfer) {
+    while (transfer != NULL) {
+        dma_transfer_t *next = transfer->next;
+        transfer->next = NULL;
+        if (transfer->completion_cb) {
+            transfer->completion_cb(transfer, transfer->result, transfer->context);
+        }
+        __atomic_store_n(&transfer->done, true, __ATOMIC_RELEASE);
+        if (engine->backend && engine->backend->complete) {
+            engine->backend->complete(engine, transfer, engine->backend->context);
+        }
+        transfer = next;
+    }
+}
+
+// Engine Functions
+error_t dma_engine_init(dma_engine_t *engine, DMA_Channel_TypeDef *const *channels, uint8_t count,
+                        const dma_engine_backend_t *backend) {
+    if (engine == NULL || channels == NULL || count == 0 || count > DMA_ENGINE_MAX_CHANNELS) {
+        return ERROR_INVALID_PARAM;
+    }
+
+    memset(engine, 0, sizeof(dma_engine_t));
+    for (uint8_t i = 0; i < count; i++) {
+        if (channels[i] == NULL) {
+            return ERROR_INVALID_PARAM;
+        }
+        engine->regs[i] = channels[i];
+    }
+    engine->channel_count = count;
+    engine->backend = backend;
+
+    return ERROR_NONE;
+}
+
+error_t dma_engine_submit(dma_engine_t *engine, dma_transfer_t *transfer) {
+    if (engine == NULL || transfer == NULL || transfer->chain == NULL ||
+        transfer->priority >= DMA_ENGINE_PRIORITIES) {
+        return ERROR_INVALID_PARAM;
+    }
+
+    uint32_t bytes = 0;
+    for (const dma_descriptor_t *desc = transfer->chain; desc != NULL; desc = desc->next) {
+        if (desc->source == NULL || desc->destination == NULL || desc->length == 0) {
+            return ERROR_INVALID_PARAM;
+        }
+        bytes += desc->length;
+    }
+
+    transfer->result = ERROR_BUSY;
+    transfer->bytes = bytes;
+    transfer->next = NULL;
+    __atomic_store_n(&transfer->done, false, __ATOMIC_RELAXED);
+
+    engine_lock(engine);
+
+    error_t err = ERROR_NONE;
+    int idle = -1;
+    for (uint8_t i = 0; i < engine->channel_count; i++) {
+        if (engine->channels[i].transfer == NULL) {
+            idle = i;
+            break;
+        }
+    }
+
+    if (idle >= 0) {
+        err = engine_start_transfer(engine, (uint8_t)idle, transfer);
+        if (err != ERROR_NONE) {
+            engine->channels[idle].transfer = NULL;
+        }
+    } else {
+        uint8_t p = transfer->priority;
+        if (engine->tail[p] != NULL) {
+            engine->tail[p]->next = transfer;
+        } else {
+            engine->head[p] = transfer;
+        }
+        engine->tail[p] = transfer;
+        engine->pending++;
+        engine->stats.queued++;
+        if (engine->pending > engine->stats.max_pending) {
+            engine->stats.max_pending = engine->pending;
+        }
+    }
+
+    engine_unlock(engine);
+
+    return err;
+}
+
+// Transfer-complete interrupt of one channel: next chunk, next descriptor,
+// or completion and hand-over of the channel to the next waiting transfer
+void dma_engine_process_interrupt(dma_engine_t *engine, uint8_t channel) {
+    if (engine == NULL || channel >= engine->channel_count) return;
+
+    dma_transfer_t *finished = NULL;
+
+    engine_lock(engine);
+
+    dma_engine_channel_t *ch = &engine->channels[channel];
+    if (ch->transfer == NULL) {
+        engine_unlock(engine);
+        return;
+    }
+
+    engine->regs[channel]->CCR &= ~DMA_CCR_EN;
+    engine->stats.bytes += ch->chunk;
+    ch->offset += ch->chunk;
+
+    if (ch->offset >= ch->descriptor->length) {
+        engine->stats.descriptors++;
+        ch->descriptor = ch->descriptor->next;
+        ch->offset = 0;
+    }
+
+    if (ch->descriptor != NULL) {
+        error_t err = engine_start_chunk(engine, channel);
+        if (err != ERROR_NONE) {
+            engine_release_channel(engine, channel, err, &finished);
+        }
+    } else {
+        engine_release_channel(engine, channel, ERROR_NONE, &finished);
+    }
+
+    engine_unlock(engine);
+
+    engine_finish(engine, finished);
+}
+
+// Blocks (host backend) or spins (target) until the transfer is done
+void dma_engine_wait(dma_engine_t *engine, const dma_transfer_t *transfer) {
+    if (engine == NULL || transfer == NULL) return;
+
+    if (engine->backend && engine->backend->wait) {
+        engine->backend->wait(engine, transfer, engine->backend->context);
+        return;
+    }
+
+    while (!dma_engine_transfer_done(transfer)) {
+    }
+}
+
+bool dma_engine_transfer_done(const dma_transfer_t *transfer) {
+    return transfer ? __atomic_load_n(&transfer->done, __ATOMIC_ACQUIRE) : false;
+}
+
+bool dma_engine_idle(dma_engine_t *engine) {
+    if (engine == NULL) return true;
+
+    engine_lock(engine);
+    bool idle = engine->pending == 0;
+    for (uint8_t i = 0; i < engine->channel_count && idle; i++) {
+        idle = engine->channels[i].transfer == NULL;
+    }
+    engine_unlock(engine);
+
+    return idle;
+}
+
+void dma_engine_get_stats(dma_engine_t *engine, dma_engine_stats_t *stats) {
+    if (engine == NULL || stats == NULL) return;
+
+    engine_lock(engine);
+    *stats = engine->stats;
+    engine_unlock(engine);
+}
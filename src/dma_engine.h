@@ -0,0 +1,102 @@
+#ifndef DMA_ENGINE_H
+#define DMA_ENGINE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "embedded_hardware.h"
+
+// Memory-to-memory DMA engine.
+// Callers submit transfers made of linked scatter-gather descriptors; the
+// engine runs each transfer on one of its channels, descriptor by
+// descriptor (split into CNDTR-sized chunks), and calls the completion
+// callback from the transfer-complete interrupt. Transfers wait in one FIFO
+// per priority level; a channel that frees up takes the oldest transfer of
+// the highest waiting priority, which is also written to CCR PL so the
+// hardware arbiter favours it on the bus.
+//
+// On target the channel moves the bytes itself and its TC interrupt calls
+// dma_engine_process_interrupt. A host backend (dma_host) runs one worker
+// thread per channel instead.
+#define DMA_ENGINE_MAX_CHANNELS     8
+#define DMA_ENGINE_PRIORITIES       4       // CCR PL levels
+#define DMA_ENGINE_MAX_CHUNK        0xFFFFU // CNDTR is 16 bits wide
+
+// One contiguous copy; chained through next
+typedef struct dma_descriptor {
+    const void *source;
+    void *destination;
+    uint32_t length;
+    struct dma_descriptor *next;    // NULL: last descriptor of the transfer
+} dma_descriptor_t;
+
+typedef struct dma_transfer dma_transfer_t;
+typedef struct dma_engine dma_engine_t;
+
+// Transfer; owned by the engine from submit until done is set
+struct dma_transfer {
+    const dma_descriptor_t *chain;
+    uint8_t priority;           // 0 (low) - 3 (very high)
+    void (*completion_cb)(dma_transfer_t *transfer, error_t result, void *context);  // Interrupt context
+    void *context;
+
+    // Filled in by the engine
+    error_t result;
+    uint32_t bytes;
+    uint8_t channel;
+    bool done;                  // Set after completion_cb returns; read with dma_engine_transfer_done
+    dma_transfer_t *next;
+};
+
+// Channel backend. start is called after the channel registers have been
+// programmed with one chunk and complete after a transfer's done flag is
+// set; lock/unlock guard the engine against its interrupt (target: mask
+// the DMA IRQs) or worker threads (host).
+typedef struct {
+    void (*start)(dma_engine_t *engine, uint8_t channel, const void *source, void *destination,
+                  uint32_t length, void *context);
+    void (*complete)(dma_engine_t *engine, const dma_transfer_t *transfer, void *context);
+    void (*wait)(dma_engine_t *engine, const dma_transfer_t *transfer, void *context);
+    void (*lock)(void *context);
+    void (*unlock)(void *context);
+    void *context;
+} dma_engine_backend_t;
+
+typedef struct {
+    dma_transfer_t *transfer;           // NULL: channel idle
+    const dma_descriptor_t *descriptor; // Descriptor in progress
+    uint32_t offset;                    // Bytes of it already moved
+    uint32_t chunk;                     // Bytes in flight
+} dma_engine_channel_t;
+
+typedef struct {
+    uint32_t transfers;         // Completed
+    uint32_t descriptors;
+    uint32_t chunks;            // Channel programs (descriptors split at DMA_ENGINE_MAX_CHUNK)
+    uint32_t queued;            // Transfers that had to wait for a channel
+    uint32_t max_pending;
+    uint32_t errors;
+    uint64_t bytes;
+} dma_engine_stats_t;
+
+struct dma_engine {
+    DMA_Channel_TypeDef *regs[DMA_ENGINE_MAX_CHANNELS];
+    dma_engine_channel_t channels[DMA_ENGINE_MAX_CHANNELS];
+    uint8_t channel_count;
+    dma_transfer_t *head[DMA_ENGINE_PRIORITIES];    // Waiting transfers per priority
+    dma_transfer_t *tail[DMA_ENGINE_PRIORITIES];
+    uint32_t pending;
+    const dma_engine_backend_t *backend;
+    dma_engine_stats_t stats;
+};
+
+// Function declarations
+error_t dma_engine_init(dma_engine_t *engine, DMA_Channel_TypeDef *const *channels, uint8_t count,
+                        const dma_engine_backend_t *backend);
+error_t dma_engine_submit(dma_engine_t *engine, dma_transfer_t *transfer);
+void dma_engine_process_interrupt(dma_engine_t *engine, uint8_t channel);
+void dma_engine_wait(dma_engine_t *engine, const dma_transfer_t *transfer);
+bool dma_engine_transfer_done(const dma_transfer_t *transfer);
+bool dma_engine_idle(dma_engine_t *engine);
+void dma_engine_get_stats(dma_engine_t *engine, dma_engine_stats_t *stats);
+
+#endif // DMA_ENGINE_H
@@ -0,0 +1,145 @@
+#include "dma_host.h"
+#include <string.h>
+
+// Internal helpers
+static void *host_worker_main(void *arg) {
+    dma_host_worker_t *worker = (dma_host_worker_t*)arg;
+
+    pthread_mutex_lock(&worker->mutex);
+    for (;;) {
+        while (!worker->pending && !worker->stop) {
+            pthread_cond_wait(&worker->cond, &worker->mutex);
+        }
+        if (worker->stop) {
+            break;
+        }
+
+        dma_engine_t *engine = worker->engine;
+        const void *source = worker->source;
+        void *destination = worker->destination;
+        uint32_t length = worker->length;
+        worker->pending = false;
+        pthread_mutex_unlock(&worker->mutex);
+
+        memcpy(destination, source, length);
+        worker->chunks++;
+        worker->bytes += length;
+
+        // Transfer-complete interrupt; may hand this worker its next chunk,
+        // which the loop then picks up without sleeping
+        dma_engine_process_interrupt(engine, worker->channel);
+
+        pthread_mutex_lock(&worker->mutex);
+    }
+    pthread_mutex_unlock(&worker->mutex);
+
+    return NULL;
+}
+
+static void host_start(dma_engine_t *engine, uint8_t channel, const void *source, void *destination,
+                       uint32_t length, void *context) {
+    dma_host_t *host = (dma_host_t*)context;
+    if (channel >= host->worker_count) return;
+
+    dma_host_worker_t *worker = &host->workers[channel];
+    pthread_mutex_lock(&worker->mutex);
+    worker->engine = engine;
+    worker->source = source;
+    worker->destination = destination;
+    worker->length = length;
+    worker->pending = true;
+    pthread_cond_signal(&worker->cond);
+    pthread_mutex_unlock(&worker->mutex);
+}
+
+// Waiters only wake when a whole transfer is done, not per chunk
+static void host_complete(dma_engine_t *engine, const dma_transfer_t *transfer, void *context) {
+    dma_host_t *host = (dma_host_t*)context;
+    (void)engine;
+    (void)transfer;
+
+    pthread_mutex_lock(&host->done_mutex);
+    pthread_cond_broadcast(&host->done_cond);
+    pthread_mutex_unlock(&host->done_mutex);
+}
+
+static void host_wait(dma_engine_t *engine, const dma_transfer_t *transfer, void *context) {
+    dma_host_t *host = (dma_host_t*)context;
+    (void)engine;
+
+    pthread_mutex_lock(&host->done_mutex);
+    while (!dma_engine_transfer_done(transfer)) {
+        pthread_cond_wait(&host->done_cond, &host->done_mutex);
+    }
+    pthread_mutex_unlock(&host->done_mutex);
+}
+
+static void host_lock(void *context) {
+    pthread_mutex_lock(&((dma_host_t*)context)->lock);
+}
+
+static void host_unlock(void *context) {
+    pthread_mutex_unlock(&((dma_host_t*)context)->lock);
+}
+
+// Host Backend Functions
+error_t dma_host_init(dma_host_t *host, uint8_t channels) {
+    if (host == NULL || channels == 0 || channels > DMA_ENGINE_MAX_CHANNELS) {
+        return ERROR_INVALID_PARAM;
+    }
+
+    memset(host, 0, sizeof(dma_host_t));
+    host->backend.start = host_start;
+    host->backend.complete = host_complete;
+    host->backend.wait = host_wait;
+    host->backend.lock = host_lock;
+    host->backend.unlock = host_unlock;
+    host->backend.context = host;
+    pthread_mutex_init(&host->lock, NULL);
+    pthread_mutex_init(&host->done_mutex, NULL);
+    pthread_cond_init(&host->done_cond, NULL);
+
+    for (uint8_t i = 0; i < channels; i++) {
+        dma_host_worker_t *worker = &host->workers[i];
+        worker->host = host;
+        worker->channel = i;
+        pthread_mutex_init(&worker->mutex, NULL);
+        pthread_cond_init(&worker->cond, NULL);
+        if (pthread_create(&worker->thread, NULL, host_worker_main, worker) != 0) {
+            pthread_mutex_destroy(&worker->mutex);
+            pthread_cond_destroy(&worker->cond);
+            dma_host_shutdown(host);
+            return ERROR_BUSY;
+        }
+        worker->started = true;
+        host->worker_count++;
+    }
+
+    return ERROR_NONE;
+}
+
+// Stops the workers once their current chunk is done; chunks still queued
+// are dropped, so drain the engine first
+void dma_host_shutdown(dma_host_t *host) {
+    if (host == NULL) return;
+
+    for (uint8_t i = 0; i < host->worker_count; i++) {
+        dma_host_worker_t *worker = &host->workers[i];
+        if (!worker->started) continue;
+
+        pthread_mutex_lock(&worker->mutex);
+        worker->stop = true;
+        pthread_cond_signal(&worker->cond);
+        pthread_mutex_unlock(&worker->mutex);
+        pthread_join(worker->thread, NULL);
+
+        pthread_mutex_destroy(&worker->mutex);
+        pthread_cond_destroy(&worker->cond);
+        worker->started = false;
+    }
+    host->worker_count = 0;
+
+    pthread_cond_destroy(&host->done_cond);
+    pthread_mutex_destroy(&host->done_mutex);
+    pthread_mutex_destroy(&host->lock);
+}
@@ -0,0 +1,58 @@
+#ifndef DMA_HOST_H
+#define DMA_HOST_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <pthread.h>
+#include "dma_engine.h"
+
+// Threaded host backend for the DMA engine.
+// Each channel gets a worker thread that copies the programmed chunk and
+// then runs dma_engine_process_interrupt in its own context, the way the
+// transfer-complete interrupt would on target. The calling thread is free
+// while the copy runs; dma_engine_wait blocks on a condition variable
+// instead of spinning.
+//
+// Usage:
+//   dma_host_init(&host, 2);
+//   dma_engine_init(&engine, channels, 2, &host.backend);
+//   ...
+//   dma_host_shutdown(&host);
+
+typedef struct dma_host dma_host_t;
+
+typedef struct {
+    dma_host_t *host;
+    uint8_t channel;
+    pthread_t thread;
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+    bool started;
+
+    // Chunk handed over by start
+    dma_engine_t *engine;
+    const void *source;
+    void *destination;
+    uint32_t length;
+    bool pending;
+    bool stop;
+
+    // Worker counters
+    uint32_t chunks;
+    uint64_t bytes;
+} dma_host_worker_t;
+
+struct dma_host {
+    dma_engine_backend_t backend;   // Pass to dma_engine_init
+    pthread_mutex_t lock;           // Engine state
+    pthread_mutex_t done_mutex;
+    pthread_cond_t done_cond;       // Broadcast after every completed transfer
+    dma_host_worker_t workers[DMA_ENGINE_MAX_CHANNELS];
+    uint8_t worker_count;
+};
+
+// Function declarations
+error_t dma_host_init(dma_host_t *host, uint8_t channels);
+void dma_host_shutdown(dma_host_t *host);
+
+#endif // DMA_HOST_H
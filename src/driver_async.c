@@ -0,0 +1,321 @@
+#include "driver_async.h"
+#include <stddef.h>
+#include <string.h>
+
+// Internal helpers
+static uint64_t async_now(const driver_async_t *channel) {
+    return channel->clock ? channel->clock() : 0;
+}
+
+static void async_set_congested(driver_async_t *channel, bool congested) {
+    if (channel->congested == congested) return;
+
+    channel->congested = congested;
+    if (congested) {
+        channel->stats.congestions++;
+    }
+    if (channel->backpressure_cb) {
+        channel->backpressure_cb(channel, congested, channel->backpressure_context);
+    }
+}
+
+// Starts waiting requests while the bus has room. Completions reported
+// from inside start (synchronous buses) re-enter here and return at once;
+// the loop already running picks up what they freed.
+static void async_pump(driver_async_t *channel) {
+    if (channel->pumping) return;
+    channel->pumping = true;
+
+    while (channel->waiting != NULL && channel->active < channel->max_active) {
+        driver_request_t *req = channel->waiting;
+        channel->waiting = req->next;
+        channel->active++;
+        req->started_at = async_now(channel);
+        __atomic_store_n(&req->state, DRIVER_REQUEST_ACTIVE, __ATOMIC_RELAXED);
+
+        error_t err = channel->start(channel, req, channel->start_context);
+        if (err != ERROR_NONE) {
+            driver_async_complete(channel, req, err);
+        }
+    }
+
+    channel->pumping = false;
+}
+
+static void async_unlink(driver_async_t *channel, driver_request_t *req) {
+    driver_request_t *prev = NULL;
+    driver_request_t *cur = channel->head;
+
+    while (cur != NULL && cur != req) {
+        prev = cur;
+        cur = cur->next;
+    }
+    if (cur == NULL) return;
+
+    if (prev) {
+        prev->next = req->next;
+    } else {
+        channel->head = req->next;
+    }
+    if (channel->tail == req) {
+        channel->tail = prev;
+    }
+    req->next = NULL;
+}
+
+// Oldest active request: buses complete in submit order
+static driver_request_t* async_oldest(driver_async_t *channel) {
+    return channel->active > 0 ? channel->head : NULL;
+}
+
+static error_t uart_tx_start(driver_async_t *channel, driver_request_t *req, void *context) {
+    driver_async_uart_t *binding = (driver_async_uart_t*)context;
+    (void)channel;
+    return uart_driver_transmit_async(binding->driver, req->op.uart_tx.data, req->op.uart_tx.size);
+}
+
+static error_t uart_rx_start(driver_async_t *channel, driver_request_t *req, void *context) {
+    driver_async_uart_t *binding = (driver_async_uart_t*)context;
+    (void)channel;
+    return uart_driver_receive_async(binding->driver, req->op.uart_rx.data, req->op.uart_rx.size);
+}
+
+static void uart_tx_done(error_t result, void *context) {
+    driver_async_uart_t *binding = (driver_async_uart_t*)context;
+    driver_async_complete(&binding->tx, async_oldest(&binding->tx), result);
+}
+
+static void uart_rx_done(error_t result, uint16_t length, void *context) {
+    driver_async_uart_t *binding = (driver_async_uart_t*)context;
+    driver_request_t *req = async_oldest(&binding->rx);
+    if (req != NULL) {
+        req->length = length;
+    }
+    driver_async_complete(&binding->rx, req, result);
+}
+
+// The transaction is the first member of the request
+static void spi_done(spi_transaction_t *txn, error_t result, void *context) {
+    driver_async_spi_t *binding = (driver_async_spi_t*)context;
+    driver_async_complete(&binding->channel, (driver_request_t*)txn, result);
+}
+
+static error_t spi_start(driver_async_t *channel, driver_request_t *req, void *context) {
+    driver_async_spi_t *binding = (driver_async_spi_t*)context;
+    (void)channel;
+    req->op.spi.completion_cb = spi_done;
+    req->op.spi.context = binding;
+    return spi_queue_submit(binding->queue, &req->op.spi);
+}
+
+static void i2c_done(i2c_transaction_t *txn, error_t result, void *context) {
+    driver_async_i2c_t *binding = (driver_async_i2c_t*)context;
+    driver_async_complete(&binding->channel, (driver_request_t*)txn, result);
+}
+
+static error_t i2c_start(driver_async_t *channel, driver_request_t *req, void *context) {
+    driver_async_i2c_t *binding = (driver_async_i2c_t*)context;
+    (void)channel;
+    req->op.i2c.completion_cb = i2c_done;
+    req->op.i2c.context = binding;
+    return i2c_driver_submit(binding->driver, &req->op.i2c);
+}
+
+static error_t can_start(driver_async_t *channel, driver_request_t *req, void *context) {
+    driver_async_can_t *binding = (driver_async_can_t*)context;
+    (void)channel;
+    return can_driver_send_message(binding->driver, &req->op.can);
+}
+
+static void can_tx_done(const can_frame_t *frame, void *context) {
+    driver_async_can_t *binding = (driver_async_can_t*)context;
+    (void)frame;
+    driver_async_complete(&binding->channel, async_oldest(&binding->channel), ERROR_NONE);
+}
+
+// Channel Functions
+error_t driver_async_init(driver_async_t *channel, const driver_async_config_t *config,
+                          driver_async_start_t start, uint16_t max_active, void *context) {
+    if (channel == NULL || config == NULL || start == NULL || config->capacity == 0 ||
+        config->low_water >= config->capacity || max_active == 0) {
+        return ERROR_INVALID_PARAM;
+    }
+
+    memset(channel, 0, sizeof(driver_async_t));
+    channel->start = start;
+    channel->start_context = context;
+    channel->max_active = max_active;
+    channel->capacity = config->capacity;
+    channel->low_water = config->low_water;
+    channel->clock = config->clock;
+
+    return ERROR_NONE;
+}
+
+void driver_async_set_backpressure(driver_async_t *channel,
+                                   void (*backpressure_cb)(driver_async_t *channel, bool congested, void *context),
+                                   void *context) {
+    if (channel == NULL) return;
+
+    channel->backpressure_cb = backpressure_cb;
+    channel->backpressure_context = context;
+}
+
+// Queues the request and starts it if the bus has room. ERROR_BUSY: the
+// channel is full; retry once backpressure_cb reports it released.
+error_t driver_async_submit(driver_async_t *channel, driver_request_t *req) {
+    if (channel == NULL || req == NULL) {
+        return ERROR_INVALID_PARAM;
+    }
+
+    if (channel->depth >= channel->capacity) {
+        channel->stats.rejected++;
+        async_set_congested(channel, true);
+        return ERROR_BUSY;
+    }
+
+    req->result = ERROR_BUSY;
+    req->length = 0;
+    req->submitted_at = async_now(channel);
+    req->started_at = 0;
+    req->completed_at = 0;
+    req->next = NULL;
+    __atomic_store_n(&req->state, DRIVER_REQUEST_QUEUED, __ATOMIC_RELAXED);
+
+    if (channel->tail) {
+        channel->tail->next = req;
+    } else {
+        channel->head = req;
+    }
+    channel->tail = req;
+    if (channel->waiting == NULL) {
+        channel->waiting = req;
+    }
+
+    channel->depth++;
+    channel->stats.submitted++;
+    if (channel->depth > channel->stats.max_depth) {
+        channel->stats.max_depth = channel->depth;
+    }
+    if (channel->depth >= channel->capacity) {
+        async_set_congested(channel, true);
+    }
+
+    async_pump(channel);
+
+    return ERROR_NONE;
+}
+
+// Called by the bus (usually its interrupt) when an active request is done
+void driver_async_complete(driver_async_t *channel, driver_request_t *req, error_t result) {
+    if (channel == NULL || req == NULL || req->state != DRIVER_REQUEST_ACTIVE) return;
+
+    async_unlink(channel, req);
+    channel->active--;
+    channel->depth--;
+
+    req->result = result;
+    req->completed_at = async_now(channel);
+
+    driver_async_stats_t *stats = &channel->stats;
+    uint64_t latency = req->completed_at - req->submitted_at;
+    stats->completed++;
+    stats->wait_ns += req->started_at - req->submitted_at;
+    stats->total_ns += latency;
+    if (latency > stats->max_ns) {
+        stats->max_ns = latency;
+    }
+    if (result != ERROR_NONE) {
+        stats->errors++;
+    }
+
+    if (channel->congested && channel->depth <= channel->low_water) {
+        async_set_congested(channel, false);
+    }
+
+    // Done before the callback, so the callback may resubmit the request
+    __atomic_store_n(&req->state, DRIVER_REQUEST_DONE, __ATOMIC_RELEASE);
+    if (req->completion_cb) {
+        req->completion_cb(req, result, req->context);
+    }
+
+    async_pump(channel);
+}
+
+uint16_t driver_async_space(const driver_async_t *channel) {
+    return channel ? (uint16_t)(channel->capacity - channel->depth) : 0;
+}
+
+bool driver_async_idle(const driver_async_t *channel) {
+    return channel ? channel->depth == 0 : true;
+}
+
+// Future side of a request
+bool driver_request_done(const driver_request_t *req) {
+    return req ? __atomic_load_n(&req->state, __ATOMIC_ACQUIRE) == DRIVER_REQUEST_DONE : false;
+}
+
+// Binding Functions
+// One transfer per direction at a time; the next starts from the
+// completion interrupt of the previous one
+error_t driver_async_bind_uart(driver_async_uart_t *binding, uart_driver_t *driver, const driver_async_config_t *config) {
+    if (binding == NULL || driver == NULL) {
+        return ERROR_INVALID_PARAM;
+    }
+
+    binding->driver = driver;
+    error_t err = driver_async_init(&binding->tx, config, uart_tx_start, 1, binding);
+    if (err == ERROR_NONE) {
+        err = driver_async_init(&binding->rx, config, uart_rx_start, 1, binding);
+    }
+    if (err != ERROR_NONE) {
+        return err;
+    }
+
+    driver->tx_complete_cb = uart_tx_done;
+    driver->rx_complete_cb = uart_rx_done;
+    driver->async_context = binding;
+
+    return ERROR_NONE;
+}
+
+// Requests pass straight into the SPI queue, which keeps chip-select
+// merging across consecutive transactions
+error_t driver_async_bind_spi(driver_async_spi_t *binding, spi_queue_t *queue, const driver_async_config_t *config) {
+    if (binding == NULL || queue == NULL || config == NULL) {
+        return ERROR_INVALID_PARAM;
+    }
+
+    binding->queue = queue;
+    return driver_async_init(&binding->channel, config, spi_start, config->capacity, binding);
+}
+
+// The I2C backend runs a transaction to STOP inside submit, so I2C
+// requests complete before driver_async_submit returns
+error_t driver_async_bind_i2c(driver_async_i2c_t *binding, i2c_driver_t *driver, const driver_async_config_t *config) {
+    if (binding == NULL || driver == NULL || config == NULL) {
+        return ERROR_INVALID_PARAM;
+    }
+
+    binding->driver = driver;
+    return driver_async_init(&binding->channel, config, i2c_start, config->capacity, binding);
+}
+
+// Frames go to the controller's TX queue while it has room and complete
+// on its transmit-complete interrupt
+error_t driver_async_bind_can(driver_async_can_t *binding, can_driver_t *driver, const driver_async_config_t *config) {
+    if (binding == NULL || driver == NULL || driver->can == NULL) {
+        return ERROR_INVALID_PARAM;
+    }
+
+    binding->driver = driver;
+    error_t err = driver_async_init(&binding->channel, config, can_start, driver->can->buffer_size - 1, binding);
+    if (err != ERROR_NONE) {
+        return err;
+    }
+
+    driver->tx_complete_cb = can_tx_done;
+    driver->async_context = binding;
+
+    return ERROR_NONE;
+}
@@ -0,0 +1,148 @@
+#ifndef DRIVER_ASYNC_H
+#define DRIVER_ASYNC_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "embedded_hardware.h"
+#include "communication_protocols.h"
+#include "device_drivers.h"
+#include "spi_queue.h"
+
+// Uniform asynchronous request model over the drivers.
+// Every bus direction gets a channel with a bounded FIFO of request
+// descriptors. driver_async_submit never blocks: it queues the request and
+// returns, or returns ERROR_BUSY when the channel is full. The request
+// completes from the bus interrupt through its completion_cb, and doubles
+// as a future that driver_request_done polls. A channel that fills up
+// reports congested through backpressure_cb and is released once it drains
+// to low_water, so one control thread can keep every bus busy without
+// blocking on any of them.
+//
+// Bindings own the driver callbacks they complete from (UART
+// tx/rx_complete_cb and callback_context, SPI/I2C transaction callbacks,
+// CAN tx_complete_cb); drive a bound driver only through its channels.
+
+typedef struct driver_request driver_request_t;
+typedef struct driver_async driver_async_t;
+
+typedef enum {
+    DRIVER_REQUEST_IDLE,
+    DRIVER_REQUEST_QUEUED,
+    DRIVER_REQUEST_ACTIVE,      // Handed to the bus
+    DRIVER_REQUEST_DONE
+} driver_request_state_t;
+
+// Request descriptor; owned by the channel from submit until it is done.
+// Fill in the op member matching the channel's bus.
+struct driver_request {
+    union {
+        struct {
+            const uint8_t *data;
+            uint16_t size;
+        } uart_tx;
+        struct {
+            uint8_t *data;
+            uint16_t size;      // Completes early when the line goes idle
+        } uart_rx;
+        spi_transaction_t spi;  // device, segments, segment_count, cs_hold
+        i2c_transaction_t i2c;  // msgs, msg_count
+        can_frame_t can;
+    } op;
+    void (*completion_cb)(driver_request_t *req, error_t result, void *context);
+    void *context;
+
+    // Filled in by the channel
+    driver_request_state_t state;   // Read with driver_request_done
+    error_t result;
+    uint16_t length;                // UART RX: bytes received
+    uint64_t submitted_at;
+    uint64_t started_at;
+    uint64_t completed_at;
+    driver_request_t *next;
+};
+
+// Starts one request on the bus. Returns an error only if the request was
+// not started; otherwise the bus reports it with driver_async_complete,
+// possibly before start returns.
+typedef error_t (*driver_async_start_t)(driver_async_t *channel, driver_request_t *req, void *context);
+
+typedef struct {
+    uint16_t capacity;          // Requests queued or active before submit pushes back
+    uint16_t low_water;         // Depth that releases a congested channel
+    protocol_clock_t clock;     // NULL: no timestamps
+} driver_async_config_t;
+
+// Channel statistics
+typedef struct {
+    uint32_t submitted;
+    uint32_t completed;
+    uint32_t errors;
+    uint32_t rejected;          // Submits refused while full
+    uint32_t congestions;       // Transitions into the congested state
+    uint16_t max_depth;
+    uint64_t wait_ns;           // Submit to start
+    uint64_t total_ns;          // Submit to completion
+    uint64_t max_ns;
+} driver_async_stats_t;
+
+struct driver_async {
+    driver_async_start_t start;
+    void *start_context;
+    uint16_t max_active;        // Requests the bus accepts at once
+    uint16_t capacity;
+    uint16_t low_water;
+    protocol_clock_t clock;
+
+    driver_request_t *head;     // Active requests, then waiting ones, in submit order
+    driver_request_t *tail;
+    driver_request_t *waiting;  // First request not yet started
+    uint16_t depth;
+    uint16_t active;
+    bool congested;
+    bool pumping;
+
+    void (*backpressure_cb)(driver_async_t *channel, bool congested, void *context);
+    void *backpressure_context;
+    driver_async_stats_t stats;
+};
+
+// Driver bindings
+typedef struct {
+    uart_driver_t *driver;
+    driver_async_t tx;
+    driver_async_t rx;
+} driver_async_uart_t;
+
+typedef struct {
+    spi_queue_t *queue;
+    driver_async_t channel;
+} driver_async_spi_t;
+
+typedef struct {
+    i2c_driver_t *driver;
+    driver_async_t channel;
+} driver_async_i2c_t;
+
+typedef struct {
+    can_driver_t *driver;
+    driver_async_t channel;
+} driver_async_can_t;
+
+// Function declarations
+error_t driver_async_init(driver_async_t *channel, const driver_async_config_t *config,
+                          driver_async_start_t start, uint16_t max_active, void *context);
+void driver_async_set_backpressure(driver_async_t *channel,
+                                   void (*backpressure_cb)(driver_async_t *channel, bool congested, void *context),
+                                   void *context);
+error_t driver_async_submit(driver_async_t *channel, driver_request_t *req);
+void driver_async_complete(driver_async_t *channel, driver_request_t *req, error_t result);
+uint16_t driver_async_space(const driver_async_t *channel);
+bool driver_async_idle(const driver_async_t *channel);
+bool driver_request_done(const driver_request_t *req);
+
+error_t driver_async_bind_uart(driver_async_uart_t *binding, uart_driver_t *driver, const driver_async_config_t *config);
+error_t driver_async_bind_spi(driver_async_spi_t *binding, spi_queue_t *queue, const driver_async_config_t *config);
+error_t driver_async_bind_i2c(driver_async_i2c_t *binding, i2c_driver_t *driver, const driver_async_config_t *config);
+error_t driver_async_bind_can(driver_async_can_t *binding, can_driver_t *driver, const driver_async_config_t *config);
+
+#endif // DRIVER_ASYNC_H
@@ -0,0 +1,271 @@
+#include "driver_coro.h"
+#include <string.h>
+
+// Internal helpers
+static uint64_t coro_now(const driver_coro_exec_t *exec) {
+    return exec->clock ? exec->clock() : 0;
+}
+
+static void coro_make_ready(driver_coro_exec_t *exec, driver_coro_t *co) {
+    co->state = DRIVER_CORO_READY;
+    co->next = NULL;
+    if (exec->ready_tail) {
+        exec->ready_tail->next = co;
+    } else {
+        exec->ready_head = co;
+    }
+    exec->ready_tail = co;
+}
+
+static void coro_block(driver_coro_exec_t *exec, driver_coro_t *co, driver_async_t *channel) {
+    co->state = DRIVER_CORO_BLOCKED;
+    co->blocked_on = channel;
+    co->next = NULL;
+    if (exec->blocked_tail) {
+        exec->blocked_tail->next = co;
+    } else {
+        exec->blocked_head = co;
+    }
+    exec->blocked_tail = co;
+}
+
+static void coro_timer_push(driver_coro_exec_t *exec, driver_coro_t *co) {
+    uint16_t i = exec->timer_count++;
+
+    while (i > 0) {
+        uint16_t parent = (uint16_t)((i - 1) / 2);
+        if (exec->timers[parent]->wake_at <= co->wake_at) break;
+        exec->timers[i] = exec->timers[parent];
+        i = parent;
+    }
+    exec->timers[i] = co;
+}
+
+static driver_coro_t* coro_timer_pop(driver_coro_exec_t *exec) {
+    driver_coro_t *top = exec->timers[0];
+    driver_coro_t *last = exec->timers[--exec->timer_count];
+    uint16_t count = exec->timer_count;
+    uint16_t i = 0;
+
+    while (count > 0) {
+        uint32_t child = 2u * i + 1;
+        if (child >= count) break;
+        if (child + 1 < count && exec->timers[child + 1]->wake_at < exec->timers[child]->wake_at) {
+            child++;
+        }
+        if (last->wake_at <= exec->timers[child]->wake_at) break;
+        exec->timers[i] = exec->timers[child];
+        i = (uint16_t)child;
+    }
+    if (count > 0) {
+        exec->timers[i] = last;
+    }
+
+    return top;
+}
+
+static void coro_request_done(driver_request_t *req, error_t result, void *context) {
+    driver_coro_t *co = (driver_coro_t*)context;
+    (void)req;
+
+    co->result = result;
+    co->exec->completions++;
+    coro_make_ready(co->exec, co);
+}
+
+// Blocked awaits are retried, in the order they blocked, after a request
+// of this executor completes and may have made room on its channel
+static void coro_retry_blocked(driver_coro_exec_t *exec) {
+    if (exec->blocked_head == NULL || exec->retried_at == exec->completions) return;
+
+    exec->retried_at = exec->completions;
+    driver_coro_t *co = exec->blocked_head;
+    exec->blocked_head = NULL;
+    exec->blocked_tail = NULL;
+
+    while (co != NULL) {
+        driver_coro_t *next = co->next;
+        driver_async_t *channel = co->blocked_on;
+
+        co->state = DRIVER_CORO_AWAITING;
+        co->blocked_on = NULL;
+        error_t err = driver_async_submit(channel, &co->req);
+        if (err == ERROR_BUSY) {
+            coro_block(exec, co, channel);
+        } else if (err != ERROR_NONE) {
+            co->result = err;
+            coro_make_ready(exec, co);
+        }
+        co = next;
+    }
+}
+
+static void coro_release(driver_coro_exec_t *exec, driver_coro_t *co) {
+    driver_coro_pool_t *pool = co->pool;
+
+    co->state = DRIVER_CORO_FREE;
+    co->next = pool->free;
+    pool->free = co;
+    pool->in_use--;
+
+    exec->live--;
+    exec->stats.finished++;
+}
+
+// Pool Functions
+error_t driver_coro_pool_init(driver_coro_pool_t *pool, void *storage, size_t storage_size, uint32_t frame_size) {
+    if (pool == NULL || storage == NULL || ((uintptr_t)storage & 7u) != 0) {
+        return ERROR_INVALID_PARAM;
+    }
+
+    size_t slot_size = DRIVER_CORO_SLOT_SIZE(frame_size);
+    size_t count = storage_size / slot_size;
+    if (count == 0) {
+        return ERROR_INVALID_PARAM;
+    }
+    if (count > UINT16_MAX) {
+        count = UINT16_MAX;
+    }
+
+    memset(pool, 0, sizeof(driver_coro_pool_t));
+    pool->storage = (uint8_t*)storage;
+    pool->slot_size = (uint32_t)slot_size;
+    pool->frame_size = frame_size;
+    pool->count = (uint16_t)count;
+
+    // Free list in address order
+    for (size_t i = count; i > 0; i--) {
+        driver_coro_t *co = (driver_coro_t*)(pool->storage + (i - 1) * slot_size);
+        co->state = DRIVER_CORO_FREE;
+        co->next = pool->free;
+        pool->free = co;
+    }
+
+    return ERROR_NONE;
+}
+
+// Executor Functions
+error_t driver_coro_exec_init(driver_coro_exec_t *exec, protocol_clock_t clock,
+                              driver_coro_t **timers, uint16_t timer_capacity) {
+    if (exec == NULL || timers == NULL || timer_capacity == 0) {
+        return ERROR_INVALID_PARAM;
+    }
+
+    memset(exec, 0, sizeof(driver_coro_exec_t));
+    exec->clock = clock;
+    exec->timers = timers;
+    exec->timer_capacity = timer_capacity;
+
+    return ERROR_NONE;
+}
+
+// Takes a frame from the pool and queues the coroutine to run on the next
+// driver_coro_exec_run. ERROR_BUSY: the pool or the executor is full.
+error_t driver_coro_spawn(driver_coro_exec_t *exec, driver_coro_pool_t *pool, driver_coro_fn_t fn, void *arg) {
+    if (exec == NULL || pool == NULL || fn == NULL) {
+        return ERROR_INVALID_PARAM;
+    }
+
+    if (pool->free == NULL || exec->live >= exec->timer_capacity) {
+        exec->stats.rejected++;
+        return ERROR_BUSY;
+    }
+
+    driver_coro_t *co = pool->free;
+    pool->free = co->next;
+    pool->in_use++;
+    if (pool->in_use > pool->max_in_use) {
+        pool->max_in_use = pool->in_use;
+    }
+
+    memset(co, 0, sizeof(driver_coro_t));
+    co->fn = fn;
+    co->arg = arg;
+    co->frame = (uint8_t*)co + DRIVER_CORO_FRAME_OFFSET;
+    co->exec = exec;
+    co->pool = pool;
+    memset(co->frame, 0, pool->frame_size);
+
+    exec->live++;
+    exec->stats.spawned++;
+    if (exec->live > exec->stats.max_live) {
+        exec->stats.max_live = exec->live;
+    }
+    coro_make_ready(exec, co);
+
+    return ERROR_NONE;
+}
+
+// Wakes the coroutines whose sleep is over and resumes every ready
+// coroutine until none is left. Returns the number of resumes.
+uint32_t driver_coro_exec_run(driver_coro_exec_t *exec) {
+    if (exec == NULL) return 0;
+
+    uint64_t now = coro_now(exec);
+    while (exec->timer_count > 0 && exec->timers[0]->wake_at <= now) {
+        coro_make_ready(exec, coro_timer_pop(exec));
+    }
+
+    uint32_t resumes = 0;
+    for (;;) {
+        coro_retry_blocked(exec);
+
+        driver_coro_t *co = exec->ready_head;
+        if (co == NULL) break;
+        exec->ready_head = co->next;
+        if (exec->ready_head == NULL) {
+            exec->ready_tail = NULL;
+        }
+        co->next = NULL;
+
+        resumes++;
+        if (co->fn(co) == DRIVER_CORO_FINISHED) {
+            coro_release(exec, co);
+        }
+    }
+
+    exec->stats.resumes += resumes;
+    return resumes;
+}
+
+// Earliest wake time of a sleeping coroutine, UINT64_MAX if none sleeps
+uint64_t driver_coro_exec_next_wake(const driver_coro_exec_t *exec) {
+    if (exec == NULL || exec->timer_count == 0) return UINT64_MAX;
+
+    return exec->timers[0]->wake_at;
+}
+
+uint16_t driver_coro_exec_live(const driver_coro_exec_t *exec) {
+    return exec ? exec->live : 0;
+}
+
+// Coroutine Functions
+// Used through DRIVER_CORO_AWAIT; a full channel parks the coroutine
+// instead of failing the await
+void driver_coro_await(driver_coro_t *co, driver_async_t *channel) {
+    if (co == NULL) return;
+
+    driver_coro_exec_t *exec = co->exec;
+    co->req.completion_cb = coro_request_done;
+    co->req.context = co;
+    co->state = DRIVER_CORO_AWAITING;
+
+    error_t err = driver_async_submit(channel, &co->req);
+    if (err == ERROR_BUSY) {
+        exec->stats.blocked++;
+        coro_block(exec, co, channel);
+    } else if (err != ERROR_NONE) {
+        co->result = err;
+        coro_make_ready(exec, co);
+    }
+}
+
+// Used through DRIVER_CORO_SLEEP
+void driver_coro_sleep(driver_coro_t *co, uint64_t ns) {
+    if (co == NULL) return;
+
+    driver_coro_exec_t *exec = co->exec;
+    co->state = DRIVER_CORO_SLEEPING;
+    co->wake_at = coro_now(exec) + ns;
+    coro_timer_push(exec, co);
+}
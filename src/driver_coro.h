@@ -0,0 +1,145 @@
+#ifndef DRIVER_CORO_H
+#define DRIVER_CORO_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "embedded_hardware.h"
+#include "communication_protocols.h"
+#include "driver_async.h"
+
+// Stackless coroutines over the asynchronous driver channels.
+// A coroutine is a function that resumes at the line it last suspended
+// on: DRIVER_CORO_AWAIT submits the coroutine's request to a channel and
+// suspends until the request completes, DRIVER_CORO_SLEEP suspends for a
+// number of nanoseconds. Locals do not survive a suspension; keep them in
+// the frame, which is taken from a fixed pool at spawn and returned when
+// the coroutine finishes, so nothing is allocated while coroutines run.
+// One executor runs any number of coroutines from a single thread.
+//
+//     static driver_coro_status_t conversation(driver_coro_t *co) {
+//         my_frame_t *f = (my_frame_t*)co->frame;
+//         DRIVER_CORO_BEGIN(co);
+//         co->req.op.i2c = ...;                 // Write the config register
+//         DRIVER_CORO_AWAIT(co, &bus->channel);
+//         DRIVER_CORO_SLEEP(co, 2000000);       // Conversion time
+//         ...
+//         DRIVER_CORO_END(co);
+//     }
+//
+// Completions only link the coroutine onto the ready list; run the
+// executor from the same context that takes the bus completions.
+
+typedef struct driver_coro driver_coro_t;
+typedef struct driver_coro_exec driver_coro_exec_t;
+
+typedef enum {
+    DRIVER_CORO_SUSPENDED,
+    DRIVER_CORO_FINISHED
+} driver_coro_status_t;
+
+typedef enum {
+    DRIVER_CORO_FREE,
+    DRIVER_CORO_READY,
+    DRIVER_CORO_AWAITING,       // Request in flight
+    DRIVER_CORO_BLOCKED,        // Channel was full; submit is retried
+    DRIVER_CORO_SLEEPING
+} driver_coro_state_t;
+
+typedef driver_coro_status_t (*driver_coro_fn_t)(driver_coro_t *co);
+
+struct driver_coro {
+    driver_coro_fn_t fn;
+    void *arg;
+    void *frame;                // Zeroed at spawn
+    driver_coro_exec_t *exec;
+    struct driver_coro_pool *pool;
+    driver_coro_state_t state;
+    uint32_t line;              // Resume point
+    driver_request_t req;       // Request for the next DRIVER_CORO_AWAIT
+    error_t result;             // Result of the last await
+    driver_async_t *blocked_on;
+    uint64_t wake_at;
+    driver_coro_t *next;
+};
+
+// Fixed pool of coroutines with their frames
+typedef struct driver_coro_pool {
+    uint8_t *storage;
+    uint32_t slot_size;
+    uint32_t frame_size;
+    uint16_t count;
+    uint16_t in_use;
+    uint16_t max_in_use;
+    driver_coro_t *free;
+} driver_coro_pool_t;
+
+// Storage bytes for count coroutines with frame_size byte frames; the
+// storage must be 8-byte aligned
+#define DRIVER_CORO_FRAME_OFFSET \
+    ((sizeof(driver_coro_t) + 15u) & ~(size_t)15u)
+#define DRIVER_CORO_SLOT_SIZE(frame_size) \
+    ((DRIVER_CORO_FRAME_OFFSET + (frame_size) + 15u) & ~(size_t)15u)
+#define DRIVER_CORO_POOL_BYTES(frame_size, count) \
+    (DRIVER_CORO_SLOT_SIZE(frame_size) * (size_t)(count))
+
+// Executor statistics
+typedef struct {
+    uint32_t spawned;
+    uint32_t finished;
+    uint32_t rejected;          // Spawns refused: pool or timer heap full
+    uint64_t resumes;
+    uint32_t blocked;           // Awaits that found the channel full
+    uint16_t max_live;
+} driver_coro_stats_t;
+
+struct driver_coro_exec {
+    protocol_clock_t clock;
+    driver_coro_t *ready_head;
+    driver_coro_t *ready_tail;
+    driver_coro_t *blocked_head;
+    driver_coro_t *blocked_tail;
+    uint32_t completions;       // Bumped per request completion
+    uint32_t retried_at;        // completions when blocked awaits were last retried
+
+    driver_coro_t **timers;     // Min-heap on wake_at
+    uint16_t timer_count;
+    uint16_t timer_capacity;    // Also bounds the live coroutines
+    uint16_t live;
+    driver_coro_stats_t stats;
+};
+
+// Coroutine body macros. The body runs inside a switch on the resume
+// point; do not put an await or sleep inside another switch statement.
+#define DRIVER_CORO_BEGIN(co) \
+    switch ((co)->line) { case 0:
+
+#define DRIVER_CORO_END(co) \
+    } return DRIVER_CORO_FINISHED
+
+#define DRIVER_CORO_SUSPEND_(co) \
+    do { (co)->line = __LINE__; return DRIVER_CORO_SUSPENDED; case __LINE__:; } while (0)
+
+// Submits co->req to the channel and resumes with co->result set
+#define DRIVER_CORO_AWAIT(co, channel) \
+    do { driver_coro_await((co), (channel)); DRIVER_CORO_SUSPEND_(co); } while (0)
+
+#define DRIVER_CORO_SLEEP(co, ns) \
+    do { driver_coro_sleep((co), (ns)); DRIVER_CORO_SUSPEND_(co); } while (0)
+
+// Lets the other ready coroutines run first
+#define DRIVER_CORO_YIELD(co) DRIVER_CORO_SLEEP(co, 0)
+
+// Function declarations
+error_t driver_coro_pool_init(driver_coro_pool_t *pool, void *storage, size_t storage_size, uint32_t frame_size);
+error_t driver_coro_exec_init(driver_coro_exec_t *exec, protocol_clock_t clock,
+                              driver_coro_t **timers, uint16_t timer_capacity);
+error_t driver_coro_spawn(driver_coro_exec_t *exec, driver_coro_pool_t *pool, driver_coro_fn_t fn, void *arg);
+uint32_t driver_coro_exec_run(driver_coro_exec_t *exec);
+uint64_t driver_coro_exec_next_wake(const driver_coro_exec_t *exec);
+uint16_t driver_coro_exec_live(const driver_coro_exec_t *exec);
+
+void driver_coro_await(driver_coro_t *co, driver_async_t *channel);
+void driver_coro_sleep(driver_coro_t *co, uint64_t ns);
+
+#endif // DRIVER_CORO_H
@@ -1,36 +1,102 @@
 #include "embedded_hardware.h"
+#include "hw_regs.h"
 #include <stddef.h>
+#include <string.h>
+
+#ifndef HW_NO_BACKEND
+static const hw_backend_t *hw_backend = NULL;
+
+#define HW_ACCESS(regs, reg, write) \
+    do { if (hw_backend) hw_backend->access((regs), &(reg), (write), hw_backend->context); } while (0)
+#define HW_POLL(regs) \
+    do { if (hw_backend) hw_backend->poll((regs), hw_backend->context); } while (0)
+#else
+#define HW_ACCESS(regs, reg, write) do { } while (0)
+#define HW_POLL(regs) do { } while (0)
+#endif
+
+// Backend Functions
+void hw_set_backend(const hw_backend_t *backend) {
+#ifndef HW_NO_BACKEND
+    hw_backend = backend;
+#else
+    (void)backend;
+#endif
+}
 
 // GPIO Functions
 error_t gpio_init(GPIO_TypeDef *gpio, gpio_config_t *config) {
-    if (gpio == NULL || config == NULL) {
+    gpio_port_config_t port_config;
+
+    error_t err = gpio_config_compile(&port_config, config, 1);
+    if (err != ERROR_NONE) {
+        return err;
+    }
+
+    return gpio_config_apply(gpio, &port_config);
+}
+
+// Merges per-pin settings into register masks; later entries win
+error_t gpio_config_compile(gpio_port_config_t *port_config, const gpio_config_t *pins, uint8_t count) {
+    if (port_config == NULL || pins == NULL) {
         return ERROR_INVALID_PARAM;
     }
 
-    // Configure mode
-    uint32_t moder = gpio->MODER;
-    moder &= ~(0x3U << (config->mode * 2));  // Clear bits
-    moder |= (config->mode << (config->mode * 2));  // Set mode
-    gpio->MODER = moder;
+    gpio_moder_t moder = gpio_moder_value();
+    gpio_pupdr_t pupdr = gpio_pupdr_value();
+    gpio_ospeedr_t ospeedr = gpio_ospeedr_value();
+    gpio_afrl_t afrl = gpio_afrl_value();
+    gpio_afrh_t afrh = gpio_afrh_value();
+
+    for (uint8_t i = 0; i < count; i++) {
+        const gpio_config_t *config = &pins[i];
+        uint8_t pin = config->pin;
+        if (pin > 15 || !gpio_moder_mode_fits(config->mode) || !gpio_pupdr_pull_fits(config->pull) ||
+            !gpio_ospeedr_speed_fits(config->speed) || !gpio_afrl_af_fits(config->alternate)) {
+            return ERROR_INVALID_PARAM;  // Would be truncated into a different setting
+        }
+
+        moder = gpio_moder_mode(moder, pin, config->mode);
+        pupdr = gpio_pupdr_pull(pupdr, pin, config->pull);
+        ospeedr = gpio_ospeedr_speed(ospeedr, pin, config->speed);
 
-    // Configure pull-up/pull-down
-    uint32_t pupdr = gpio->PUPDR;
-    pupdr &= ~(0x3U << (config->pull * 2));
-    pupdr |= (config->pull << (config->pull * 2));
-    gpio->PUPDR = pupdr;
+        // Alternate function if needed
+        if (config->mode == 2 || config->mode == 3) {  // AF mode
+            if (pin < 8) {
+                afrl = gpio_afrl_af(afrl, pin, config->alternate);
+            } else {
+                afrh = gpio_afrh_af(afrh, pin, config->alternate);
+            }
+        }
+    }
 
-    // Configure speed
-    uint32_t ospeedr = gpio->OSPEEDR;
-    ospeedr &= ~(0x3U << (config->speed * 2));
-    ospeedr |= (config->speed << (config->speed * 2));
-    gpio->OSPEEDR = ospeedr;
+    port_config->moder_clear = moder.mask;
+    port_config->moder_set = moder.bits;
+    port_config->pupdr_clear = pupdr.mask;
+    port_config->pupdr_set = pupdr.bits;
+    port_config->ospeedr_clear = ospeedr.mask;
+    port_config->ospeedr_set = ospeedr.bits;
+    port_config->afr_clear[0] = afrl.mask;
+    port_config->afr_set[0] = afrl.bits;
+    port_config->afr_clear[1] = afrh.mask;
+    port_config->afr_set[1] = afrh.bits;
 
-    // Configure alternate function if needed
-    if (config->mode == 2 || config->mode == 3) {  // AF mode
-        uint32_t afr_index = config->alternate / 8;
-        uint32_t afr_shift = (config->alternate % 8) * 4;
-        gpio->AFR[afr_index] &= ~(0xFU << afr_shift);
-        gpio->AFR[afr_index] |= (config->alternate << afr_shift);
+    return ERROR_NONE;
+}
+
+error_t gpio_config_apply(GPIO_TypeDef *gpio, const gpio_port_config_t *port_config) {
+    if (gpio == NULL || port_config == NULL) {
+        return ERROR_INVALID_PARAM;
+    }
+
+    gpio_moder_modify(gpio, (gpio_moder_t){port_config->moder_clear, port_config->moder_set});
+    gpio_pupdr_modify(gpio, (gpio_pupdr_t){port_config->pupdr_clear, port_config->pupdr_set});
+    gpio_ospeedr_modify(gpio, (gpio_ospeedr_t){port_config->ospeedr_clear, port_config->ospeedr_set});
+    if (port_config->afr_clear[0] != 0) {
+        gpio_afrl_modify(gpio, (gpio_afrl_t){port_config->afr_clear[0], port_config->afr_set[0]});
+    }
+    if (port_config->afr_clear[1] != 0) {
+        gpio_afrh_modify(gpio, (gpio_afrh_t){port_config->afr_clear[1], port_config->afr_set[1]});
     }
 
     return ERROR_NONE;
@@ -46,6 +112,7 @@ error_t gpio_write_pin(GPIO_TypeDef *gpio, uint16_t pin, bool state) {
     } else {
         gpio->BSRR = (1U << (pin + 16));  // Reset pin
     }
+    HW_ACCESS(gpio, gpio->BSRR, true);
 
     return ERROR_NONE;
 }
@@ -57,37 +124,46 @@ bool gpio_read_pin(GPIO_TypeDef *gpio, uint16_t pin) {
     return (gpio->IDR & (1U << pin)) != 0;
 }
 
+// Sets and resets any pins of the port in a single BSRR write; a pin in
+// both masks ends up set
+error_t gpio_write_port(GPIO_TypeDef *gpio, uint16_t set_mask, uint16_t reset_mask) {
+    if (gpio == NULL) {
+        return ERROR_INVALID_PARAM;
+    }
+
+    gpio->BSRR = ((uint32_t)reset_mask << 16) | set_mask;
+    HW_ACCESS(gpio, gpio->BSRR, true);
+
+    return ERROR_NONE;
+}
+
+uint16_t gpio_read_port(GPIO_TypeDef *gpio) {
+    if (gpio == NULL) {
+        return 0;
+    }
+    return (uint16_t)gpio->IDR;
+}
+
 // UART Functions
 error_t uart_init(USART_TypeDef *uart, uart_config_t *config) {
-    if (uart == NULL || config == NULL) {
+    if (uart == NULL || config == NULL || !usart_cr2_stop_fits(config->stop_bits)) {
         return ERROR_INVALID_PARAM;
     }
 
     // Configure baud rate
     uart->BRR = config->baud_rate;
 
-    // Configure data bits, parity, stop bits
-    uint32_t cr1 = uart->CR1;
-    cr1 &= ~(USART_CR1_M | USART_CR1_PCE | USART_CR1_PS);
-    if (config->data_bits == 9) {
-        cr1 |= USART_CR1_M;
-    }
-    if (config->parity != 0) {
-        cr1 |= USART_CR1_PCE;
-        if (config->parity == 2) {  // Odd parity
-            cr1 |= USART_CR1_PS;
-        }
-    }
-    uart->CR1 = cr1;
-
     // Configure stop bits
-    uint32_t cr2 = uart->CR2;
-    cr2 &= ~USART_CR2_STOP;
-    cr2 |= (config->stop_bits << 12);
-    uart->CR2 = cr2;
+    usart_cr2_t cr2 = usart_cr2_stop(usart_cr2_value(), config->stop_bits);
+    usart_cr2_modify(uart, cr2);
 
-    // Enable UART
-    uart->CR1 |= USART_CR1_UE;
+    // Data bits, parity and enable in one CR1 update
+    usart_cr1_t cr1 = usart_cr1_value();
+    cr1 = usart_cr1_m(cr1, config->data_bits == 9);
+    cr1 = usart_cr1_pce(cr1, config->parity != 0);
+    cr1 = usart_cr1_ps(cr1, config->parity == 2);  // Odd parity
+    cr1 = usart_cr1_ue(cr1, 1);
+    usart_cr1_modify(uart, cr1);
 
     return ERROR_NONE;
 }
@@ -104,8 +180,9 @@ error_t uart_transmit(USART_TypeDef *uart, uint8_t *data, uint16_t size, uint32_
             if (ticks++ > timeout) {
                 return ERROR_TIMEOUT;
             }
+            HW_POLL(uart);
         }
-        uart->DR = data[i];
+        uart_write_data(uart, data[i]);
     }
 
     // Wait for transmission complete
@@ -114,6 +191,7 @@ error_t uart_transmit(USART_TypeDef *uart, uint8_t *data, uint16_t size, uint32_
         if (ticks++ > timeout) {
             return ERROR_TIMEOUT;
         }
+        HW_POLL(uart);
     }
 
     return ERROR_NONE;
@@ -131,61 +209,185 @@ error_t uart_receive(USART_TypeDef *uart, uint8_t *data, uint16_t size, uint32_t
             if (ticks++ > timeout) {
                 return ERROR_TIMEOUT;
             }
+            HW_POLL(uart);
         }
-        data[i] = (uint8_t)uart->DR;
+        data[i] = (uint8_t)uart_read_data(uart);
     }
 
     return ERROR_NONE;
 }
 
+// Data register accessors (the backend sees every access)
+void uart_write_data(USART_TypeDef *uart, uint16_t data) {
+    uart->DR = data;
+    HW_ACCESS(uart, uart->DR, true);
+}
+
+uint16_t uart_read_data(USART_TypeDef *uart) {
+    uint16_t data = (uint16_t)uart->DR;
+    HW_ACCESS(uart, uart->DR, false);
+    return data;
+}
+
+// A pending flag interrupts as soon as its enable bit is set
+void uart_enable_interrupts(USART_TypeDef *uart, uint32_t cr1_mask) {
+    uart->CR1 |= cr1_mask;
+    HW_ACCESS(uart, uart->CR1, true);
+}
+
+void uart_disable_interrupts(USART_TypeDef *uart, uint32_t cr1_mask) {
+    uart->CR1 &= ~cr1_mask;
+    HW_ACCESS(uart, uart->CR1, true);
+}
+
 // SPI Functions
 error_t spi_init(SPI_TypeDef *spi, spi_config_t *config) {
-    if (spi == NULL || config == NULL) {
+    if (spi == NULL || config == NULL || config->data_size == 0 || !spi_cr1_ds_fits(config->data_size - 1U) ||
+        !spi_cr1_br_fits(config->baud_rate) || !spi_cr1_mode_fits(config->mode) ||
+        !spi_cr1_bidioe_fits(config->direction)) {
         return ERROR_INVALID_PARAM;
     }
 
-    // Configure CR1
-    uint32_t cr1 = 0;
-    cr1 |= (config->baud_rate << 3);  // Baud rate
-    cr1 |= (config->data_size - 1) << 8;  // Data size
-    cr1 |= config->mode << 0;  // CPOL/CPHA
-    cr1 |= config->direction << 14;  // Direction
-    spi->CR1 = cr1;
-
     // Configure CR2
-    uint32_t cr2 = 0;
-    if (config->nss_mode) {
-        cr2 |= SPI_CR2_SSOE;
-    }
-    if (config->dma_enable) {
-        cr2 |= SPI_CR2_TXDMAEN | SPI_CR2_RXDMAEN;
+    spi_cr2_t cr2 = spi_cr2_value();
+    cr2 = spi_cr2_ssoe(cr2, config->nss_mode);
+    cr2 = spi_cr2_txdmaen(cr2, config->dma_enable);
+    cr2 = spi_cr2_rxdmaen(cr2, config->dma_enable);
+    spi_cr2_write(spi, cr2);
+
+    // Configure and enable in one CR1 store
+    spi_cr1_t cr1 = spi_cr1_value();
+    cr1 = spi_cr1_br(cr1, config->baud_rate);  // Prescaler index
+    cr1 = spi_cr1_ds(cr1, config->data_size - 1U);
+    cr1 = spi_cr1_mode(cr1, config->mode);  // CPOL/CPHA
+    cr1 = spi_cr1_bidioe(cr1, config->direction);
+    cr1 = spi_cr1_spe(cr1, 1);
+    spi_cr1_write(spi, cr1);
+
+    return ERROR_NONE;
+}
+
+// Full duplex with one frame queued in TXE behind the one shifting, so the
+// next frame starts as soon as the previous one ends. With DFF set the
+// buffers hold uint16_t frames and size counts frames.
+error_t spi_transmit_receive_timeout(SPI_TypeDef *spi, const uint8_t *tx_data, uint8_t *rx_data, uint16_t size,
+                                     uint32_t timeout) {
+    if (spi == NULL || tx_data == NULL || rx_data == NULL || size == 0) {
+        return ERROR_INVALID_PARAM;
     }
-    spi->CR2 = cr2;
 
-    // Enable SPI
-    spi->CR1 |= SPI_CR1_SPE;
+    bool wide = (spi->CR1 & SPI_CR1_DFF) != 0;
+    const uint16_t *tx16 = (const uint16_t*)(const void*)tx_data;
+    uint16_t *rx16 = (uint16_t*)(void*)rx_data;
+    uint16_t sent = 0;
+    uint16_t received = 0;
+    bool overrun = false;
+    uint32_t ticks = 0;
 
-    return ERROR_NONE;
+    while (received < size) {
+        bool progress = false;
+
+        // At most two frames in flight: shift register plus TX buffer
+        if (sent < size && sent - received < 2 && (spi->SR & SPI_SR_TXE)) {
+            spi_write_data(spi, wide ? tx16[sent] : tx_data[sent]);
+            sent++;
+            progress = true;
+        }
+
+        if (spi->SR & SPI_SR_RXNE) {
+            overrun |= (spi->SR & SPI_SR_OVR) != 0;
+            uint16_t data = spi_read_data(spi);
+            if (wide) {
+                rx16[received] = data;
+            } else {
+                rx_data[received] = (uint8_t)data;
+            }
+            received++;
+            progress = true;
+        }
+
+        if (progress) {
+            ticks = 0;
+        } else {
+            if (ticks++ > timeout) {
+                return ERROR_TIMEOUT;
+            }
+            HW_POLL(spi);
+        }
+    }
+
+    return overrun ? ERROR_OVERFLOW : ERROR_NONE;
 }
 
 error_t spi_transmit_receive(SPI_TypeDef *spi, uint8_t *tx_data, uint8_t *rx_data, uint16_t size) {
-    if (spi == NULL || tx_data == NULL || rx_data == NULL || size == 0) {
+    return spi_transmit_receive_timeout(spi, tx_data, rx_data, size, SPI_TIMEOUT_NONE);
+}
+
+// Data register accessors (the backend sees every access)
+void spi_write_data(SPI_TypeDef *spi, uint16_t data) {
+    spi->DR = data;
+    HW_ACCESS(spi, spi->DR, true);
+}
+
+uint16_t spi_read_data(SPI_TypeDef *spi) {
+    uint16_t data = (uint16_t)spi->DR;
+    HW_ACCESS(spi, spi->DR, false);
+    return data;
+}
+
+// DMA Functions
+error_t dma_channel_start(DMA_Channel_TypeDef *dma, volatile uint32_t *peripheral, void *memory,
+                          uint16_t count, uint32_t ccr) {
+    if (dma == NULL || peripheral == NULL || memory == NULL || count == 0) {
         return ERROR_INVALID_PARAM;
     }
 
-    for (uint16_t i = 0; i < size; i++) {
-        // Wait for TXE
-        while (!(spi->SR & SPI_SR_TXE));
+    if (dma->CCR & DMA_CCR_EN) {
+        return ERROR_BUSY;
+    }
+
+    // Address registers are 32 bits wide; on a 64-bit host only the
+    // backend sees the full memory pointer
+    dma->CPAR = (uint32_t)(uintptr_t)peripheral;
+    dma->CMAR = (uint32_t)(uintptr_t)memory;
+    dma->CNDTR = count;
+#ifndef HW_NO_BACKEND
+    if (hw_backend && hw_backend->dma_bind) {
+        hw_backend->dma_bind(dma, memory, hw_backend->context);
+    }
+#endif
 
-        // Send data
-        spi->DR = tx_data[i];
+    dma->CCR = ccr | DMA_CCR_EN;
+    HW_ACCESS(dma, dma->CCR, true);
 
-        // Wait for RXNE
-        while (!(spi->SR & SPI_SR_RXNE));
+    return ERROR_NONE;
+}
+
+// Memory-to-memory: CPAR holds the source, CMAR the destination, both
+// incremented. No peripheral is involved, so the access hook is not raised
+// and the call is safe from a host DMA worker thread; a host backend that
+// moves the bytes gets the full pointers from the caller.
+error_t dma_channel_start_copy(DMA_Channel_TypeDef *dma, const void *source, void *destination,
+                               uint16_t count, uint32_t ccr) {
+    if (dma == NULL || source == NULL || destination == NULL || count == 0) {
+        return ERROR_INVALID_PARAM;
+    }
 
-        // Receive data
-        rx_data[i] = (uint8_t)spi->DR;
+    if (dma->CCR & DMA_CCR_EN) {
+        return ERROR_BUSY;
     }
 
+    dma->CPAR = (uint32_t)(uintptr_t)source;
+    dma->CMAR = (uint32_t)(uintptr_t)destination;
+    dma->CNDTR = count;
+    dma->CCR = (ccr & ~DMA_CCR_DIR) | DMA_CCR_MEM2MEM | DMA_CCR_PINC | DMA_CCR_MINC | DMA_CCR_EN;
+
     return ERROR_NONE;
+}
+
+void dma_channel_stop(DMA_Channel_TypeDef *dma) {
+    if (dma == NULL) return;
+
+    dma->CCR &= ~DMA_CCR_EN;
+    HW_ACCESS(dma, dma->CCR, true);
 }
\ No newline at end of file
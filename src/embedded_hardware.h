@@ -14,18 +14,51 @@
 #define USART_CR2_STOP_1 (1U << 13)
 #define USART_CR2_STOP   (USART_CR2_STOP_0 | USART_CR2_STOP_1)
 
+#define USART_CR1_TXEIE  (1U << 7)
+#define USART_CR1_TCIE   (1U << 6)
+#define USART_CR1_RXNEIE (1U << 5)
+#define USART_CR1_IDLEIE (1U << 4)
+
+#define USART_CR3_DMAT   (1U << 7)
+#define USART_CR3_DMAR   (1U << 6)
+
 #define USART_SR_TXE     (1U << 7)
 #define USART_SR_TC      (1U << 6)
 #define USART_SR_RXNE    (1U << 5)
+#define USART_SR_IDLE    (1U << 4)
+#define USART_SR_ORE     (1U << 3)
 
+#define SPI_CR1_DFF      (1U << 11)
 #define SPI_CR1_SPE      (1U << 6)
+#define SPI_CR1_BR_Pos   3
+#define SPI_CR1_BR       (0x7U << SPI_CR1_BR_Pos)
+#define SPI_CR1_CPOL     (1U << 1)
+#define SPI_CR1_CPHA     (1U << 0)
+#define SPI_CR2_TXEIE    (1U << 7)
+#define SPI_CR2_RXNEIE   (1U << 6)
 #define SPI_CR2_SSOE     (1U << 2)
 #define SPI_CR2_TXDMAEN  (1U << 1)
 #define SPI_CR2_RXDMAEN  (1U << 0)
 
+#define SPI_SR_BSY       (1U << 7)
+#define SPI_SR_OVR       (1U << 6)
 #define SPI_SR_TXE       (1U << 1)
 #define SPI_SR_RXNE      (1U << 0)
 
+#define SPI_TIMEOUT_NONE UINT32_MAX     // Wait-loop ticks: never time out
+
+#define DMA_CCR_EN       (1U << 0)
+#define DMA_CCR_TCIE     (1U << 1)
+#define DMA_CCR_HTIE     (1U << 2)
+#define DMA_CCR_TEIE     (1U << 3)
+#define DMA_CCR_DIR      (1U << 4)      // 1: memory to peripheral
+#define DMA_CCR_CIRC     (1U << 5)
+#define DMA_CCR_PINC     (1U << 6)
+#define DMA_CCR_MINC     (1U << 7)
+#define DMA_CCR_PL_Pos   12             // Channel priority: 0 low - 3 very high
+#define DMA_CCR_PL       (0x3U << DMA_CCR_PL_Pos)
+#define DMA_CCR_MEM2MEM  (1U << 14)     // CPAR is a memory source
+
 // Hardware register structures based on STM32-like peripherals
 
 // GPIO Register Structure (from STM32 datasheet)
@@ -75,12 +108,32 @@ typedef struct {
 
 // Configuration structures
 typedef struct {
+    uint8_t pin;                // Pin number (0-15)
     uint8_t mode;               // GPIO mode (input, output, etc.)
     uint8_t pull;               // Pull-up/pull-down
     uint8_t speed;              // Output speed
     uint8_t alternate;          // Alternate function
 } gpio_config_t;
 
+// Register masks for a set of pins of one port, applied with one
+// read-modify-write per register. Build with gpio_config_compile or
+// statically with the field macros below.
+typedef struct {
+    uint32_t moder_clear;
+    uint32_t moder_set;
+    uint32_t pupdr_clear;
+    uint32_t pupdr_set;
+    uint32_t ospeedr_clear;
+    uint32_t ospeedr_set;
+    uint32_t afr_clear[2];
+    uint32_t afr_set[2];
+} gpio_port_config_t;
+
+#define GPIO_FIELD2_MASK(pin)          (0x3U << ((pin) * 2))
+#define GPIO_FIELD2(pin, value)        (((uint32_t)(value) & 0x3U) << ((pin) * 2))
+#define GPIO_AFR_MASK(pin)             (0xFU << (((pin) % 8) * 4))
+#define GPIO_AFR(pin, af)              (((uint32_t)(af) & 0xFU) << (((pin) % 8) * 4))
+
 typedef struct {
     uint32_t baud_rate;         // Baud rate
     uint8_t data_bits;          // Data bits (7, 8, 9)
@@ -104,19 +157,51 @@ typedef enum {
     ERROR_INVALID_PARAM,
     ERROR_TIMEOUT,
     ERROR_BUSY,
-    ERROR_OVERFLOW
+    ERROR_OVERFLOW,
+    ERROR_NACK                  // Bus target did not acknowledge
 } error_t;
 
+// Register access backend. On target nothing is installed and the hooks
+// compile away with HW_NO_BACKEND; on a host a simulator (peripheral_sim)
+// observes data-register accesses and drives the status flags polled in
+// wait loops.
+typedef struct {
+    void (*access)(volatile void *regs, volatile uint32_t *reg, bool write, void *context);
+    void (*poll)(volatile void *regs, void *context);
+    void (*dma_bind)(DMA_Channel_TypeDef *dma, void *memory, void *context);  // Full host pointer
+    void *context;
+} hw_backend_t;
+
 // Function declarations
+void hw_set_backend(const hw_backend_t *backend);
+
 error_t gpio_init(GPIO_TypeDef *gpio, gpio_config_t *config);
 error_t gpio_write_pin(GPIO_TypeDef *gpio, uint16_t pin, bool state);
 bool gpio_read_pin(GPIO_TypeDef *gpio, uint16_t pin);
+error_t gpio_write_port(GPIO_TypeDef *gpio, uint16_t set_mask, uint16_t reset_mask);
+uint16_t gpio_read_port(GPIO_TypeDef *gpio);
+error_t gpio_config_compile(gpio_port_config_t *port_config, const gpio_config_t *pins, uint8_t count);
+error_t gpio_config_apply(GPIO_TypeDef *gpio, const gpio_port_config_t *port_config);
 
 error_t uart_init(USART_TypeDef *uart, uart_config_t *config);
 error_t uart_transmit(USART_TypeDef *uart, uint8_t *data, uint16_t size, uint32_t timeout);
 error_t uart_receive(USART_TypeDef *uart, uint8_t *data, uint16_t size, uint32_t timeout);
+void uart_write_data(USART_TypeDef *uart, uint16_t data);
+uint16_t uart_read_data(USART_TypeDef *uart);
+void uart_enable_interrupts(USART_TypeDef *uart, uint32_t cr1_mask);
+void uart_disable_interrupts(USART_TypeDef *uart, uint32_t cr1_mask);
 
 error_t spi_init(SPI_TypeDef *spi, spi_config_t *config);
 error_t spi_transmit_receive(SPI_TypeDef *spi, uint8_t *tx_data, uint8_t *rx_data, uint16_t size);
+error_t spi_transmit_receive_timeout(SPI_TypeDef *spi, const uint8_t *tx_data, uint8_t *rx_data, uint16_t size,
+                                     uint32_t timeout);
+void spi_write_data(SPI_TypeDef *spi, uint16_t data);
+uint16_t spi_read_data(SPI_TypeDef *spi);
+
+error_t dma_channel_start(DMA_Channel_TypeDef *dma, volatile uint32_t *peripheral, void *memory,
+                          uint16_t count, uint32_t ccr);
+error_t dma_channel_start_copy(DMA_Channel_TypeDef *dma, const void *source, void *destination,
+                               uint16_t count, uint32_t ccr);
+void dma_channel_stop(DMA_Channel_TypeDef *dma);
 
 #endif // EMBEDDED_HARDWARE_H
\ No newline at end of file
@@ -0,0 +1,148 @@
+#include "error_telemetry.h"
+#include "timebase.h"
+#include <string.h>
+
+// Fleet counters: one relaxed add per recorded error
+static uint64_t fleet_counts[ERROR_SOURCE_COUNT][ERROR_TELEMETRY_CODES];
+
+// Internal helpers
+static uint8_t error_slot(error_t code) {
+    return ((uint32_t)code < ERROR_TELEMETRY_CODES) ? (uint8_t)code : ERROR_TELEMETRY_CODES - 1;
+}
+
+// Seqlock write side: odd while the body runs
+static uint32_t log_write_begin(error_log_t *log) {
+    uint32_t seq = __atomic_load_n(&log->seq, __ATOMIC_RELAXED) | 1u;
+    __atomic_store_n(&log->seq, seq, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    return seq;
+}
+
+static void log_write_end(error_log_t *log, uint32_t seq) {
+    __atomic_store_n(&log->seq, seq + 1, __ATOMIC_RELEASE);
+}
+
+// Error Log Functions
+void error_log_init(error_log_t *log, error_source_t source) {
+    if (log == NULL) return;
+
+    uint32_t seq = log_write_begin(log);
+    log->total = 0;
+    log->source = (source < ERROR_SOURCE_COUNT) ? source : ERROR_SOURCE_UART;
+    memset(log->entries, 0, sizeof(log->entries));
+    memset(log->counts, 0, sizeof(log->counts));
+    log_write_end(log, seq);
+}
+
+// Single writer per log: the owning driver
+void error_log_record(error_log_t *log, error_t code, uint32_t context) {
+    if (log == NULL) return;
+
+    uint8_t slot = error_slot(code);
+    uint32_t timestamp = timebase_now_us();
+
+    uint32_t seq = log_write_begin(log);
+    error_history_t *entry = &log->entries[log->total % ERROR_HISTORY_SIZE];
+    entry->timestamp = timestamp;
+    entry->error_code = code;
+    entry->context = context;
+    log->counts[slot]++;
+    log->total++;
+    log_write_end(log, seq);
+
+    __atomic_fetch_add(&fleet_counts[log->source][slot], 1, __ATOMIC_RELAXED);
+}
+
+// ERROR_BUSY when the writer kept the log busy for every retry
+error_t error_log_snapshot(const error_log_t *log, error_log_snapshot_t *snapshot) {
+    if (log == NULL || snapshot == NULL) {
+        return ERROR_INVALID_PARAM;
+    }
+
+    error_history_t raw[ERROR_HISTORY_SIZE];
+
+    for (uint32_t attempt = 0; attempt < ERROR_SNAPSHOT_RETRIES; attempt++) {
+        uint32_t begin = __atomic_load_n(&log->seq, __ATOMIC_ACQUIRE);
+        if (begin & 1u) continue;
+
+        snapshot->source = log->source;
+        snapshot->total = log->total;
+        memcpy(raw, log->entries, sizeof(raw));
+        memcpy(snapshot->counts, log->counts, sizeof(snapshot->counts));
+
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        if (__atomic_load_n(&log->seq, __ATOMIC_RELAXED) != begin) continue;
+
+        uint32_t count = snapshot->total < ERROR_HISTORY_SIZE ? snapshot->total : ERROR_HISTORY_SIZE;
+        uint32_t first = snapshot->total - count;
+        for (uint32_t i = 0; i < count; i++) {
+            snapshot->entries[i] = raw[(first + i) % ERROR_HISTORY_SIZE];
+        }
+        snapshot->count = (uint8_t)count;
+        return ERROR_NONE;
+    }
+
+    return ERROR_BUSY;
+}
+
+// Counters only grow, so a single read needs no retry
+uint32_t error_log_count(const error_log_t *log, error_t code) {
+    if (log == NULL) return 0;
+
+    return __atomic_load_n(&log->counts[error_slot(code)], __ATOMIC_RELAXED);
+}
+
+// Fleet Functions
+void error_telemetry_get_fleet(error_fleet_t *fleet) {
+    if (fleet == NULL) return;
+
+    memset(fleet, 0, sizeof(*fleet));
+    for (uint8_t source = 0; source < ERROR_SOURCE_COUNT; source++) {
+        for (uint8_t slot = 0; slot < ERROR_TELEMETRY_CODES; slot++) {
+            uint64_t count = __atomic_load_n(&fleet_counts[source][slot], __ATOMIC_RELAXED);
+            fleet->counts[source][slot] = count;
+            fleet->by_source[source] += count;
+            fleet->total += count;
+        }
+    }
+}
+
+void error_rate_init(error_rate_t *meter) {
+    if (meter == NULL) return;
+
+    memset(meter, 0, sizeof(*meter));
+}
+
+// Fleet errors per second since the previous update; the first call only
+// sets the baseline
+uint32_t error_rate_update(error_rate_t *meter, uint64_t now_ns) {
+    error_fleet_t fleet;
+
+    if (meter == NULL) return 0;
+
+    error_telemetry_get_fleet(&fleet);
+
+    if (!meter->primed) {
+        meter->last_total = fleet.total;
+        meter->last_ns = now_ns;
+        meter->primed = true;
+        return 0;
+    }
+
+    if (now_ns <= meter->last_ns) {
+        return meter->rate;
+    }
+
+    uint64_t delta = fleet.total - meter->last_total;
+    uint64_t elapsed = now_ns - meter->last_ns;
+    uint64_t rate = delta * 1000000000ULL / elapsed;
+    meter->rate = rate > UINT32_MAX ? UINT32_MAX : (uint32_t)rate;
+
+    int64_t diff = (int64_t)meter->rate - (int64_t)meter->smoothed;
+    meter->smoothed = (uint32_t)((int64_t)meter->smoothed + diff / (1 << ERROR_RATE_EWMA_SHIFT));
+
+    meter->last_total = fleet.total;
+    meter->last_ns = now_ns;
+
+    return meter->rate;
+}
@@ -0,0 +1,82 @@
+#ifndef ERROR_TELEMETRY_H
+#define ERROR_TELEMETRY_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "embedded_hardware.h"
+
+// Driver error telemetry.
+// Every driver owns an error_log_t: a ring of the most recent errors plus
+// per-code counters that only ever increase. The driver is the log's only
+// writer (its thread or interrupt context); any number of readers on other
+// threads take consistent copies with error_log_snapshot, which retries
+// while a write is in progress (seqlock), so the writer never waits.
+// Nothing is touched on the success path; recording an error costs a few
+// stores and one relaxed atomic add to the fleet counters.
+//
+// The fleet counters sum every log's errors by driver kind and code, and
+// error_rate_update turns them into an errors-per-second rate.
+#define ERROR_HISTORY_SIZE          10
+#define ERROR_TELEMETRY_CODES       8       // Codes at or above this are counted in the last slot
+#define ERROR_SNAPSHOT_RETRIES      64
+#define ERROR_RATE_EWMA_SHIFT       2       // Rate smoothing: 1/4 weight per new sample
+
+typedef enum {
+    ERROR_SOURCE_UART,
+    ERROR_SOURCE_SPI,
+    ERROR_SOURCE_I2C,
+    ERROR_SOURCE_CAN,
+    ERROR_SOURCE_SENSOR,
+    ERROR_SOURCE_COUNT
+} error_source_t;
+
+// Error History
+typedef struct {
+    uint32_t timestamp;            // timebase_now_us
+    error_t error_code;
+    uint32_t context;              // Driver-specific: length, address, frame id
+} error_history_t;
+
+typedef struct {
+    uint32_t seq;                  // Odd while the writer is updating
+    uint32_t total;                // Errors recorded since init; newest is total - 1
+    error_source_t source;
+    error_history_t entries[ERROR_HISTORY_SIZE];
+    uint32_t counts[ERROR_TELEMETRY_CODES];
+} error_log_t;
+
+// Consistent copy of one log, entries oldest first
+typedef struct {
+    error_source_t source;
+    uint32_t total;
+    uint8_t count;                 // Valid entries
+    error_history_t entries[ERROR_HISTORY_SIZE];
+    uint32_t counts[ERROR_TELEMETRY_CODES];
+} error_log_snapshot_t;
+
+typedef struct {
+    uint64_t total;
+    uint64_t by_source[ERROR_SOURCE_COUNT];
+    uint64_t counts[ERROR_SOURCE_COUNT][ERROR_TELEMETRY_CODES];
+} error_fleet_t;
+
+// Caller-owned rate meter over the fleet total
+typedef struct {
+    uint64_t last_total;
+    uint64_t last_ns;
+    uint32_t rate;                 // Errors per second over the last interval
+    uint32_t smoothed;             // EWMA of rate
+    bool primed;
+} error_rate_t;
+
+// Function declarations
+void error_log_init(error_log_t *log, error_source_t source);
+void error_log_record(error_log_t *log, error_t code, uint32_t context);
+error_t error_log_snapshot(const error_log_t *log, error_log_snapshot_t *snapshot);
+uint32_t error_log_count(const error_log_t *log, error_t code);
+
+void error_telemetry_get_fleet(error_fleet_t *fleet);
+void error_rate_init(error_rate_t *meter);
+uint32_t error_rate_update(error_rate_t *meter, uint64_t now_ns);
+
+#endif // ERROR_TELEMETRY_H
@@ -0,0 +1,104 @@
+#include "ethernet_dma.h"
+#include <string.h>
+
+// Internal helpers
+static void ethernet_dma_link(ethernet_dma_t *eth_dma, uint16_t *links, const void *source, void *destination,
+                              uint32_t length) {
+    dma_descriptor_t *desc = &eth_dma->chain[*links];
+
+    desc->source = source;
+    desc->destination = destination;
+    desc->length = length;
+    desc->next = NULL;
+    if (*links > 0) {
+        eth_dma->chain[*links - 1].next = desc;
+    }
+    (*links)++;
+}
+
+// Same layout as ethernet_frame_flatten. Fragments of at least
+// ETHERNET_DMA_MIN_FRAGMENT bytes go on the chain; header, short fragments,
+// padding and FCS are copied here, while the chain is already running.
+static void ethernet_dma_chain_frame(ethernet_dma_t *eth_dma, uint16_t *links, const ethernet_tx_frame_t *frame,
+                                     uint8_t *out) {
+    out += ETHERNET_HEADER_SIZE;
+    for (uint8_t i = 0; i < frame->fragment_count; i++) {
+        if (frame->fragments[i].length >= ETHERNET_DMA_MIN_FRAGMENT) {
+            ethernet_dma_link(eth_dma, links, frame->fragments[i].data, out, frame->fragments[i].length);
+        }
+        out += frame->fragments[i].length;
+    }
+}
+
+static void ethernet_dma_copy_inline(const ethernet_tx_frame_t *frame, uint8_t *out) {
+    memcpy(out, frame->header, ETHERNET_HEADER_SIZE);
+    out += ETHERNET_HEADER_SIZE;
+
+    for (uint8_t i = 0; i < frame->fragment_count; i++) {
+        if (frame->fragments[i].length < ETHERNET_DMA_MIN_FRAGMENT && frame->fragments[i].length > 0) {
+            memcpy(out, frame->fragments[i].data, frame->fragments[i].length);
+        }
+        out += frame->fragments[i].length;
+    }
+
+    memset(out, 0, frame->pad_length);
+    out += frame->pad_length;
+    memcpy(out, frame->fcs, ETHERNET_FCS_SIZE);
+}
+
+// Ethernet DMA Functions
+error_t ethernet_dma_init(ethernet_dma_t *eth_dma, dma_engine_t *engine, uint8_t priority) {
+    if (eth_dma == NULL || engine == NULL || priority >= DMA_ENGINE_PRIORITIES) {
+        return ERROR_INVALID_PARAM;
+    }
+
+    memset(eth_dma, 0, sizeof(ethernet_dma_t));
+    eth_dma->engine = engine;
+    eth_dma->priority = priority;
+
+    return ERROR_NONE;
+}
+
+protocol_error_t ethernet_dma_flatten(const ethernet_tx_frame_t *frames, uint16_t count,
+                                      uint8_t (*scratch)[ETHERNET_SINK_SCRATCH], void *context) {
+    ethernet_dma_t *eth_dma = (ethernet_dma_t*)context;
+    if (eth_dma == NULL || frames == NULL || scratch == NULL || count > ETHERNET_SINK_MAX_BATCH) {
+        return PROTOCOL_ERROR_INVALID_HEADER;
+    }
+
+    uint16_t links = 0;
+    for (uint16_t i = 0; i < count; i++) {
+        if (frames[i].frame_length > ETHERNET_SINK_SCRATCH || frames[i].fragment_count > ETHERNET_MAX_FRAGMENTS) {
+            return PROTOCOL_ERROR_BUFFER_OVERFLOW;
+        }
+        ethernet_dma_chain_frame(eth_dma, &links, &frames[i], scratch[i]);
+    }
+
+    dma_transfer_t *transfer = &eth_dma->transfer;
+    memset(transfer, 0, sizeof(dma_transfer_t));
+    transfer->chain = eth_dma->chain;
+    transfer->priority = eth_dma->priority;
+
+    if (links == 0 || dma_engine_submit(eth_dma->engine, transfer) == ERROR_NONE) {
+        for (uint16_t i = 0; i < count; i++) {
+            ethernet_dma_copy_inline(&frames[i], scratch[i]);
+        }
+        if (links > 0) {
+            dma_engine_wait(eth_dma->engine, transfer);
+        }
+        if (links == 0 || transfer->result == ERROR_NONE) {
+            eth_dma->batches++;
+            eth_dma->frames += count;
+            return PROTOCOL_ERROR_NONE;
+        }
+    }
+
+    // Engine refused the chain: copy on this thread
+    eth_dma->fallbacks++;
+    for (uint16_t i = 0; i < count; i++) {
+        uint16_t length = 0;
+        ethernet_frame_flatten(&frames[i], scratch[i], ETHERNET_SINK_SCRATCH, &length);
+    }
+
+    return PROTOCOL_ERROR_NONE;
+}
@@ -0,0 +1,34 @@
+#ifndef ETHERNET_DMA_H
+#define ETHERNET_DMA_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "dma_engine.h"
+#include "ethernet_sink.h"
+
+// Ethernet frame flattening over the memory-to-memory DMA engine.
+// The payload fragments of a batch become one scatter-gather transfer, each
+// into its frame's scratch slot; the calling thread copies the header,
+// padding and FCS meanwhile and then sleeps in dma_engine_wait. Fragments
+// below ETHERNET_DMA_MIN_FRAGMENT are cheaper to copy than to program a
+// channel for and stay on the CPU as well.
+// Install on a contiguous sink with
+//   ethernet_sink_set_flattener(&sink, ethernet_dma_flatten, &eth_dma);
+#define ETHERNET_DMA_MIN_FRAGMENT   256
+
+typedef struct {
+    dma_engine_t *engine;
+    uint8_t priority;
+    dma_transfer_t transfer;
+    dma_descriptor_t chain[ETHERNET_SINK_MAX_BATCH * ETHERNET_MAX_FRAGMENTS];
+    uint32_t batches;
+    uint32_t frames;
+    uint32_t fallbacks;         // Batches copied with memcpy after the engine refused them
+} ethernet_dma_t;
+
+// Function declarations
+error_t ethernet_dma_init(ethernet_dma_t *eth_dma, dma_engine_t *engine, uint8_t priority);
+protocol_error_t ethernet_dma_flatten(const ethernet_tx_frame_t *frames, uint16_t count,
+                                      uint8_t (*scratch)[ETHERNET_SINK_SCRATCH], void *context);
+
+#endif // ETHERNET_DMA_H
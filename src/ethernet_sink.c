@@ -0,0 +1,267 @@
+#define _GNU_SOURCE  // sendmmsg
+#include "ethernet_sink.h"
+#include <errno.h>
+#include <string.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+// Header, fragments, padding and FCS for every frame in a batch
+#define ETHERNET_SINK_IOV_PER_FRAME  (ETHERNET_MAX_FRAGMENTS + 3)
+
+static const uint8_t ethernet_sink_zero_pad[ETHERNET_MIN_PAYLOAD] = {0};
+
+static protocol_error_t ethernet_sink_map_errno(int err) {
+    if (err == EAGAIN || err == EWOULDBLOCK) {
+        return PROTOCOL_ERROR_TIMEOUT;
+    }
+    if (err == ENOBUFS || err == EMSGSIZE) {
+        return PROTOCOL_ERROR_BUFFER_OVERFLOW;
+    }
+    return PROTOCOL_ERROR_INVALID_HEADER;
+}
+
+// Describes one frame as an iovec list; returns the number of entries used
+static int ethernet_sink_frame_iov(ethernet_sink_t *sink, const ethernet_tx_frame_t *frame,
+                                   uint16_t slot, struct iovec *iov) {
+    if (sink->requires_contiguous) {
+        uint16_t length = frame->frame_length;
+        if (sink->flatten == NULL) {
+            ethernet_frame_flatten(frame, sink->scratch[slot], sizeof(sink->scratch[slot]), &length);
+        }
+        sink->flattened++;
+        iov[0].iov_base = sink->scratch[slot];
+        iov[0].iov_len = length;
+        return 1;
+    }
+
+    int n = 0;
+    iov[n].iov_base = (void*)frame->header;
+    iov[n++].iov_len = ETHERNET_HEADER_SIZE;
+
+    for (uint8_t i = 0; i < frame->fragment_count; i++) {
+        if (frame->fragments[i].length > 0) {
+            iov[n].iov_base = (void*)frame->fragments[i].data;
+            iov[n++].iov_len = frame->fragments[i].length;
+        }
+    }
+
+    if (frame->pad_length > 0) {
+        iov[n].iov_base = (void*)ethernet_sink_zero_pad;
+        iov[n++].iov_len = frame->pad_length;
+    }
+
+    iov[n].iov_base = (void*)frame->fcs;
+    iov[n++].iov_len = ETHERNET_FCS_SIZE;
+    return n;
+}
+
+// Stream sinks: one writev per batch, resuming after partial writes and
+// after the prefix of frames[0] an earlier call already wrote
+static protocol_error_t ethernet_sink_write_stream(ethernet_sink_t *sink, const ethernet_tx_frame_t *frames,
+                                                   uint16_t count, struct iovec *iov, int iov_count,
+                                                   uint16_t *sent) {
+    size_t resumed = sink->partial;
+    int first = 0;
+
+    size_t skip = resumed;
+    while (first < iov_count && skip >= iov[first].iov_len) {
+        skip -= iov[first].iov_len;
+        first++;
+    }
+    if (skip > 0) {
+        iov[first].iov_base = (uint8_t*)iov[first].iov_base + skip;
+        iov[first].iov_len -= skip;
+    }
+
+    size_t total = 0;
+    for (int i = first; i < iov_count; i++) {
+        total += iov[i].iov_len;
+    }
+
+    size_t written = 0;
+    int error = 0;
+    while (written < total) {
+        ssize_t result = writev(sink->fd, &iov[first], iov_count - first);
+        sink->syscalls++;
+        if (result < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            error = errno;
+            break;
+        }
+        if (result == 0) {
+            error = EIO;    // No progress and no errno to report
+            break;
+        }
+
+        written += (size_t)result;
+        size_t remaining = (size_t)result;
+        while (first < iov_count && remaining >= iov[first].iov_len) {
+            remaining -= iov[first].iov_len;
+            first++;
+        }
+        if (remaining > 0) {
+            iov[first].iov_base = (uint8_t*)iov[first].iov_base + remaining;
+            iov[first].iov_len -= remaining;
+        }
+    }
+
+    // Only frames that reached the sink completely count as sent; the
+    // prefix of the next one is remembered for the retry
+    size_t on_stream = resumed + written;
+    size_t accounted = 0;
+    uint16_t complete = 0;
+    while (complete < count && accounted + frames[complete].frame_length <= on_stream) {
+        accounted += frames[complete].frame_length;
+        complete++;
+    }
+
+    *sent = complete;
+    sink->partial = (uint32_t)(on_stream - accounted);
+    sink->frames_sent += complete;
+    sink->bytes_sent += (uint32_t)written;
+
+    return (error == 0) ? PROTOCOL_ERROR_NONE : ethernet_sink_map_errno(error);
+}
+
+// Datagram sinks: one sendmmsg per batch, one datagram per frame
+static protocol_error_t ethernet_sink_write_datagram(ethernet_sink_t *sink, const ethernet_tx_frame_t *frames,
+                                                     uint16_t count, struct iovec *iov,
+                                                     const int *iov_first, const int *iov_len,
+                                                     uint16_t *sent) {
+    uint16_t done = 0;
+
+#ifdef __linux__
+    struct mmsghdr msgs[ETHERNET_SINK_MAX_BATCH];
+    memset(msgs, 0, sizeof(msgs));
+    for (uint16_t i = 0; i < count; i++) {
+        msgs[i].msg_hdr.msg_iov = &iov[iov_first[i]];
+        msgs[i].msg_hdr.msg_iovlen = (size_t)iov_len[i];
+    }
+
+    while (done < count) {
+        int result = sendmmsg(sink->fd, &msgs[done], count - done, 0);
+        sink->syscalls++;
+        if (result < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            break;
+        }
+        done += (uint16_t)result;
+    }
+#else
+    while (done < count) {
+        struct msghdr msg;
+        memset(&msg, 0, sizeof(msg));
+        msg.msg_iov = &iov[iov_first[done]];
+        msg.msg_iovlen = (size_t)iov_len[done];
+        ssize_t result = sendmsg(sink->fd, &msg, 0);
+        sink->syscalls++;
+        if (result < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            break;
+        }
+        done++;
+    }
+#endif
+
+    for (uint16_t i = 0; i < done; i++) {
+        sink->bytes_sent += frames[i].frame_length;
+    }
+    sink->frames_sent += done;
+    *sent = done;
+
+    return (done == count) ? PROTOCOL_ERROR_NONE : ethernet_sink_map_errno(errno);
+}
+
+// Sink Functions
+protocol_error_t ethernet_sink_init(ethernet_sink_t *sink, int fd, ethernet_sink_type_t type,
+                                    bool requires_contiguous) {
+    if (sink == NULL || fd < 0) {
+        return PROTOCOL_ERROR_INVALID_HEADER;
+    }
+
+    sink->fd = fd;
+    sink->type = type;
+    sink->requires_contiguous = requires_contiguous;
+    sink->frames_sent = 0;
+    sink->bytes_sent = 0;
+    sink->syscalls = 0;
+    sink->flattened = 0;
+    sink->partial = 0;
+    sink->flatten = NULL;
+    sink->flatten_context = NULL;
+
+    return PROTOCOL_ERROR_NONE;
+}
+
+// Replaces the per-frame memcpy of contiguous sinks with a batch flattener
+protocol_error_t ethernet_sink_set_flattener(ethernet_sink_t *sink, ethernet_sink_flatten_t flatten, void *context) {
+    if (sink == NULL) {
+        return PROTOCOL_ERROR_INVALID_HEADER;
+    }
+
+    sink->flatten = flatten;
+    sink->flatten_context = context;
+
+    return PROTOCOL_ERROR_NONE;
+}
+
+protocol_error_t ethernet_sink_send_batch(ethernet_sink_t *sink, const ethernet_tx_frame_t *frames,
+                                          uint16_t count, uint16_t *sent) {
+    if (sink == NULL || frames == NULL || sent == NULL) {
+        return PROTOCOL_ERROR_INVALID_HEADER;
+    }
+
+    *sent = 0;
+
+    while (*sent < count) {
+        struct iovec iov[ETHERNET_SINK_MAX_BATCH * ETHERNET_SINK_IOV_PER_FRAME];
+        int iov_first[ETHERNET_SINK_MAX_BATCH];
+        int iov_len[ETHERNET_SINK_MAX_BATCH];
+        int iov_count = 0;
+
+        uint16_t chunk = count - *sent;
+        if (chunk > ETHERNET_SINK_MAX_BATCH) {
+            chunk = ETHERNET_SINK_MAX_BATCH;
+        }
+
+        const ethernet_tx_frame_t *batch = &frames[*sent];
+        for (uint16_t i = 0; i < chunk; i++) {
+            if (batch[i].fragment_count > ETHERNET_MAX_FRAGMENTS) {
+                return PROTOCOL_ERROR_BUFFER_OVERFLOW;
+            }
+            iov_first[i] = iov_count;
+            iov_len[i] = ethernet_sink_frame_iov(sink, &batch[i], i, &iov[iov_count]);
+            iov_count += iov_len[i];
+        }
+
+        if (sink->requires_contiguous && sink->flatten != NULL) {
+            protocol_error_t err = sink->flatten(batch, chunk, sink->scratch, sink->flatten_context);
+            if (err != PROTOCOL_ERROR_NONE) {
+                return err;
+            }
+        }
+
+        uint16_t chunk_sent = 0;
+        protocol_error_t err;
+        if (sink->type == ETHERNET_SINK_DATAGRAM) {
+            err = ethernet_sink_write_datagram(sink, batch, chunk, iov, iov_first, iov_len, &chunk_sent);
+        } else {
+            err = ethernet_sink_write_stream(sink, batch, chunk, iov, iov_count, &chunk_sent);
+        }
+
+        *sent += chunk_sent;
+        if (err != PROTOCOL_ERROR_NONE) {
+            return err;
+        }
+    }
+
+    return PROTOCOL_ERROR_NONE;
+}
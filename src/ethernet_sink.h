@@ -0,0 +1,49 @@
+#ifndef ETHERNET_SINK_H
+#define ETHERNET_SINK_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "communication_protocols.h"
+
+// Frames handed to the kernel per system call
+#define ETHERNET_SINK_MAX_BATCH  32
+#define ETHERNET_SINK_SCRATCH    (ETHERNET_HEADER_SIZE + ETHERNET_MAX_PAYLOAD + ETHERNET_FCS_SIZE)
+
+// Batch flattener: copies frames[i] into scratch[i] for a whole batch
+// (e.g. ethernet_dma_flatten over the DMA engine). NULL: memcpy per frame.
+typedef protocol_error_t (*ethernet_sink_flatten_t)(const ethernet_tx_frame_t *frames, uint16_t count,
+                                                    uint8_t (*scratch)[ETHERNET_SINK_SCRATCH], void *context);
+
+// Sink types
+typedef enum {
+    ETHERNET_SINK_STREAM,       // File, pipe or stream socket: frames back to back via writev
+    ETHERNET_SINK_DATAGRAM      // Datagram socket: one frame per datagram via sendmmsg
+} ethernet_sink_type_t;
+
+// Transmit sink backed by a file descriptor.
+// A stream write can stop inside a frame (EAGAIN after a short writev).
+// That frame is not counted in *sent; its written prefix is kept in
+// partial, and the next send_batch, which must start at that frame,
+// writes only the rest, so a retry from *sent keeps the stream intact.
+typedef struct {
+    int fd;
+    ethernet_sink_type_t type;
+    bool requires_contiguous;   // Flatten each frame before handing it over
+    uint8_t scratch[ETHERNET_SINK_MAX_BATCH][ETHERNET_SINK_SCRATCH];
+    ethernet_sink_flatten_t flatten;
+    void *flatten_context;
+    uint32_t frames_sent;
+    uint32_t bytes_sent;
+    uint32_t syscalls;          // write/writev/sendmmsg calls issued
+    uint32_t flattened;         // Frames copied into scratch buffers
+    uint32_t partial;           // Stream sinks: bytes of frames[*sent] already written
+} ethernet_sink_t;
+
+// Function declarations
+protocol_error_t ethernet_sink_init(ethernet_sink_t *sink, int fd, ethernet_sink_type_t type,
+                                    bool requires_contiguous);
+protocol_error_t ethernet_sink_set_flattener(ethernet_sink_t *sink, ethernet_sink_flatten_t flatten, void *context);
+protocol_error_t ethernet_sink_send_batch(ethernet_sink_t *sink, const ethernet_tx_frame_t *frames,
+                                          uint16_t count, uint16_t *sent);
+
+#endif // ETHERNET_SINK_H
@@ -0,0 +1,151 @@
+#include "gpio_capture.h"
+#include <string.h>
+
+// Internal helpers
+static uint64_t capture_smooth(uint64_t estimate, uint64_t sample) {
+    if (estimate == 0) {
+        return sample;
+    }
+    int64_t delta = (int64_t)sample - (int64_t)estimate;
+    return (uint64_t)((int64_t)estimate + delta / (1 << GPIO_CAPTURE_EWMA_SHIFT));
+}
+
+static void capture_update(gpio_capture_pin_t *pin, const gpio_edge_t *edge) {
+    if (edge->level) {
+        if (pin->rising_edges > 0) {
+            uint64_t period = edge->timestamp_ns - pin->last_rise_ns;
+            pin->last_period_ns = period;
+            pin->period_ns = capture_smooth(pin->period_ns, period);
+            if (pin->min_period_ns == 0 || period < pin->min_period_ns) {
+                pin->min_period_ns = period;
+            }
+            if (period > pin->max_period_ns) {
+                pin->max_period_ns = period;
+            }
+        }
+        pin->last_rise_ns = edge->timestamp_ns;
+        pin->rising_edges++;
+    } else {
+        if (pin->rising_edges > 0) {
+            pin->high_ns = capture_smooth(pin->high_ns, edge->timestamp_ns - pin->last_rise_ns);
+        }
+        pin->last_fall_ns = edge->timestamp_ns;
+        pin->falling_edges++;
+    }
+}
+
+// Capture Functions
+error_t gpio_capture_init(gpio_capture_t *capture, GPIO_TypeDef *gpio, uint16_t pin_mask, protocol_clock_t clock) {
+    if (capture == NULL || gpio == NULL || pin_mask == 0) {
+        return ERROR_INVALID_PARAM;
+    }
+
+    memset(capture, 0, sizeof(gpio_capture_t));
+    capture->gpio = gpio;
+    capture->pin_mask = pin_mask;
+    capture->clock = clock;
+    capture->last_idr = gpio_read_port(gpio) & pin_mask;
+
+    return ERROR_NONE;
+}
+
+// Producer: IDR change detector for the edge interrupt or a polling loop.
+// Every watched pin that differs from the previous snapshot gets an event
+// stamped with the current time. Returns the number of edges queued.
+uint16_t gpio_capture_sample(gpio_capture_t *capture) {
+    if (capture == NULL) return 0;
+
+    uint16_t idr = gpio_read_port(capture->gpio) & capture->pin_mask;
+    uint16_t changed = idr ^ capture->last_idr;
+    if (changed == 0) {
+        return 0;
+    }
+
+    uint64_t now = capture->clock ? capture->clock() : 0;
+    uint16_t queued = 0;
+    capture->last_idr = idr;
+
+    while (changed != 0) {
+        uint8_t pin = (uint8_t)__builtin_ctz(changed);
+        changed &= (uint16_t)(changed - 1);
+        queued += gpio_capture_push(capture, pin, (idr >> pin) & 1U, now);
+    }
+
+    return queued;
+}
+
+// Producer: queues one edge (e.g. from a hardware input-capture timestamp)
+bool gpio_capture_push(gpio_capture_t *capture, uint8_t pin, bool level, uint64_t timestamp_ns) {
+    if (capture == NULL || pin >= GPIO_CAPTURE_PINS) return false;
+
+    uint32_t head = capture->head;
+    uint32_t tail = __atomic_load_n(&capture->tail, __ATOMIC_ACQUIRE);
+    if (head - tail >= GPIO_CAPTURE_RING) {
+        capture->dropped++;
+        return false;
+    }
+
+    gpio_edge_t *edge = &capture->ring[head & (GPIO_CAPTURE_RING - 1)];
+    edge->timestamp_ns = timestamp_ns;
+    edge->pin = pin;
+    edge->level = level;
+    __atomic_store_n(&capture->head, head + 1, __ATOMIC_RELEASE);
+
+    return true;
+}
+
+uint32_t gpio_capture_pending(const gpio_capture_t *capture) {
+    if (capture == NULL) return 0;
+
+    return __atomic_load_n(&capture->head, __ATOMIC_ACQUIRE) - capture->tail;
+}
+
+// Consumer: drains up to max_events (0: all queued) into the estimates,
+// copying them to events when given
+uint32_t gpio_capture_process(gpio_capture_t *capture, gpio_edge_t *events, uint32_t max_events) {
+    if (capture == NULL) return 0;
+
+    uint32_t tail = capture->tail;
+    uint32_t head = __atomic_load_n(&capture->head, __ATOMIC_ACQUIRE);
+    uint32_t count = head - tail;
+    if (max_events != 0 && count > max_events) {
+        count = max_events;
+    }
+
+    for (uint32_t i = 0; i < count; i++) {
+        const gpio_edge_t *edge = &capture->ring[(tail + i) & (GPIO_CAPTURE_RING - 1)];
+        capture_update(&capture->pins[edge->pin], edge);
+        if (events != NULL) {
+            events[i] = *edge;
+        }
+    }
+    __atomic_store_n(&capture->tail, tail + count, __ATOMIC_RELEASE);
+
+    return count;
+}
+
+// Estimate Functions
+const gpio_capture_pin_t* gpio_capture_get_pin(const gpio_capture_t *capture, uint8_t pin) {
+    if (capture == NULL || pin >= GPIO_CAPTURE_PINS) return NULL;
+
+    return &capture->pins[pin];
+}
+
+float gpio_capture_frequency_hz(const gpio_capture_t *capture, uint8_t pin) {
+    uint64_t period = gpio_capture_period_ns(capture, pin);
+
+    return period ? 1e9f / (float)period : 0.0f;
+}
+
+uint64_t gpio_capture_period_ns(const gpio_capture_t *capture, uint8_t pin) {
+    const gpio_capture_pin_t *p = gpio_capture_get_pin(capture, pin);
+
+    return p ? p->period_ns : 0;
+}
+
+float gpio_capture_duty_cycle(const gpio_capture_t *capture, uint8_t pin) {
+    const gpio_capture_pin_t *p = gpio_capture_get_pin(capture, pin);
+    if (p == NULL || p->period_ns == 0) return 0.0f;
+
+    return (float)p->high_ns / (float)p->period_ns;
+}
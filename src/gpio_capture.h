@@ -0,0 +1,69 @@
+#ifndef GPIO_CAPTURE_H
+#define GPIO_CAPTURE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "embedded_hardware.h"
+#include "communication_protocols.h"
+
+// GPIO edge capture.
+// A producer (edge interrupt, polling loop or simulator) compares IDR
+// against the previous snapshot and pushes timestamped transitions of the
+// watched pins into a single-producer/single-consumer ring. The consumer
+// drains the ring and keeps per-pin period, high-time and frequency
+// estimates up to date. Head and tail are only ever written by their own
+// side, so neither side takes a lock.
+#define GPIO_CAPTURE_RING           1024    // Events; power of two
+#define GPIO_CAPTURE_PINS           16
+#define GPIO_CAPTURE_EWMA_SHIFT     3       // Estimate smoothing: 1/8 weight per new sample
+
+// One pin transition
+typedef struct {
+    uint64_t timestamp_ns;
+    uint8_t pin;
+    bool level;                 // Level after the edge
+} gpio_edge_t;
+
+// Per-pin estimates, updated by the consumer
+typedef struct {
+    uint32_t rising_edges;
+    uint32_t falling_edges;
+    uint64_t last_rise_ns;
+    uint64_t last_fall_ns;
+    uint64_t last_period_ns;    // Rising edge to rising edge
+    uint64_t period_ns;         // Smoothed
+    uint64_t high_ns;           // Smoothed rising-to-falling time
+    uint64_t min_period_ns;
+    uint64_t max_period_ns;
+} gpio_capture_pin_t;
+
+typedef struct {
+    GPIO_TypeDef *gpio;
+    uint16_t pin_mask;          // Watched pins
+    protocol_clock_t clock;
+
+    // Producer side
+    uint16_t last_idr;
+    uint32_t head;
+    uint32_t dropped;           // Edges lost to a full ring
+
+    // Consumer side
+    uint32_t tail;
+    gpio_capture_pin_t pins[GPIO_CAPTURE_PINS];
+
+    gpio_edge_t ring[GPIO_CAPTURE_RING];
+} gpio_capture_t;
+
+// Function declarations
+error_t gpio_capture_init(gpio_capture_t *capture, GPIO_TypeDef *gpio, uint16_t pin_mask, protocol_clock_t clock);
+uint16_t gpio_capture_sample(gpio_capture_t *capture);
+bool gpio_capture_push(gpio_capture_t *capture, uint8_t pin, bool level, uint64_t timestamp_ns);
+uint32_t gpio_capture_pending(const gpio_capture_t *capture);
+uint32_t gpio_capture_process(gpio_capture_t *capture, gpio_edge_t *events, uint32_t max_events);
+
+const gpio_capture_pin_t* gpio_capture_get_pin(const gpio_capture_t *capture, uint8_t pin);
+float gpio_capture_frequency_hz(const gpio_capture_t *capture, uint8_t pin);
+uint64_t gpio_capture_period_ns(const gpio_capture_t *capture, uint8_t pin);
+float gpio_capture_duty_cycle(const gpio_capture_t *capture, uint8_t pin);
+
+#endif // GPIO_CAPTURE_H
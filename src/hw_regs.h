@@ -0,0 +1,135 @@
+#ifndef HW_REGS_H
+#define HW_REGS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "embedded_hardware.h"
+
+// Typed register field access generated from schemas.
+// Each register gets a value type <periph>_<reg>_t that collects the fields
+// named so far (mask) and their contents (bits); field setters only accept
+// the value type of their own register, and modify/write only accept the
+// peripheral block the register belongs to, so mixing up fields, registers
+// or peripherals fails to compile. Setters are static inline and fold to
+// constant masks: a chain of setters followed by one modify compiles to a
+// single load-and-store, the same code as a hand-merged shift/mask
+// expression.
+//
+// Usage:
+//   usart_cr1_t cr1 = usart_cr1_value();
+//   cr1 = usart_cr1_m(cr1, 1);
+//   cr1 = usart_cr1_ue(cr1, 1);
+//   usart_cr1_modify(uart, cr1);     // One read-modify-write of CR1
+
+// Register expansion: value type, empty value and whole-register access
+#define HW_REG_ACCESSORS(periph, reg, type, member)                                                 \
+    typedef struct {                                                                                \
+        uint32_t mask;          /* Fields set so far */                                             \
+        uint32_t bits;                                                                              \
+    } periph##_##reg##_t;                                                                           \
+    static inline periph##_##reg##_t periph##_##reg##_value(void) {                                 \
+        periph##_##reg##_t value = {0, 0};                                                          \
+        return value;                                                                               \
+    }                                                                                               \
+    static inline void periph##_##reg##_modify(type *p, periph##_##reg##_t value) {                 \
+        p->member = (p->member & ~value.mask) | value.bits;                                         \
+    }                                                                                               \
+    static inline void periph##_##reg##_write(type *p, periph##_##reg##_t value) {                  \
+        p->member = value.bits;                                                                     \
+    }                                                                                               \
+    static inline uint32_t periph##_##reg##_read(const type *p) {                                   \
+        return p->member;                                                                           \
+    }
+
+// Field expansion: each X(periph, reg, field, pos, width) entry yields
+//   <periph>_<reg>_<field>(value, v)       value with the field set to v
+//   <periph>_<reg>_<field>_get(raw)        field of a raw register read
+//   <periph>_<reg>_<field>_fits(v)         v fits the field width
+// and a compile-time check that the field lies inside the register.
+#define HW_FIELD_ACCESSORS(periph, reg, field, pos, width)                                          \
+    typedef char periph##_##reg##_##field##_fits_reg[((pos) + (width) <= 32 && (width) > 0) ? 1 : -1]; \
+    static inline periph##_##reg##_t periph##_##reg##_##field(periph##_##reg##_t value, uint32_t v) { \
+        const uint32_t mask = (uint32_t)(((1ULL << (width)) - 1) << (pos));                         \
+        value.mask |= mask;                                                                         \
+        value.bits = (value.bits & ~mask) | ((v << (pos)) & mask);                                  \
+        return value;                                                                               \
+    }                                                                                               \
+    static inline uint32_t periph##_##reg##_##field##_get(uint32_t raw) {                           \
+        return (raw >> (pos)) & (uint32_t)((1ULL << (width)) - 1);                                  \
+    }                                                                                               \
+    static inline bool periph##_##reg##_##field##_fits(uint32_t v) {                                \
+        return ((uint64_t)v >> (width)) == 0;                                                       \
+    }
+
+// Indexed field expansion for registers holding one field per pin: each
+// XI(periph, reg, field, width) entry yields
+//   <periph>_<reg>_<field>(value, index, v)
+//   <periph>_<reg>_<field>_get(raw, index)
+//   <periph>_<reg>_<field>_fits(v)
+// with the field of index n at bit n * width.
+#define HW_INDEXED_FIELD_ACCESSORS(periph, reg, field, width)                                       \
+    typedef char periph##_##reg##_##field##_fits_reg[(32 % (width) == 0) ? 1 : -1];                 \
+    static inline periph##_##reg##_t periph##_##reg##_##field(periph##_##reg##_t value, uint8_t index, \
+                                                              uint32_t v) {                         \
+        const uint32_t mask = ((1U << (width)) - 1) << ((index % (32 / (width))) * (width));       \
+        value.mask |= mask;                                                                         \
+        value.bits = (value.bits & ~mask) | ((v << ((index % (32 / (width))) * (width))) & mask);  \
+        return value;                                                                               \
+    }                                                                                               \
+    static inline uint32_t periph##_##reg##_##field##_get(uint32_t raw, uint8_t index) {            \
+        return (raw >> ((index % (32 / (width))) * (width))) & ((1U << (width)) - 1);              \
+    }                                                                                               \
+    static inline bool periph##_##reg##_##field##_fits(uint32_t v) {                                \
+        return (v >> (width)) == 0;                                                                 \
+    }
+
+// USART
+#define HW_USART_REGISTERS(R)                   \
+    R(usart, cr1, USART_TypeDef, CR1)           \
+    R(usart, cr2, USART_TypeDef, CR2)
+
+#define HW_USART_FIELDS(X)                      \
+    X(usart, cr1, ue,       13, 1)              \
+    X(usart, cr1, m,        12, 1)              \
+    X(usart, cr1, pce,      10, 1)              \
+    X(usart, cr1, ps,        9, 1)              \
+    X(usart, cr2, stop,     12, 2)
+
+// SPI: the data size field holds (bits - 1); 16-bit frames set DFF (bit 11)
+#define HW_SPI_REGISTERS(R)                     \
+    R(spi, cr1, SPI_TypeDef, CR1)               \
+    R(spi, cr2, SPI_TypeDef, CR2)
+
+#define HW_SPI_FIELDS(X)                        \
+    X(spi, cr1, mode,        0, 2)              \
+    X(spi, cr1, br,          3, 3)              \
+    X(spi, cr1, spe,         6, 1)              \
+    X(spi, cr1, ds,          8, 4)              \
+    X(spi, cr1, bidioe,     14, 1)              \
+    X(spi, cr2, rxdmaen,     0, 1)              \
+    X(spi, cr2, txdmaen,     1, 1)              \
+    X(spi, cr2, ssoe,        2, 1)
+
+// GPIO: one field per pin; AFR[0] covers pins 0-7, AFR[1] pins 8-15
+#define HW_GPIO_REGISTERS(R)                    \
+    R(gpio, moder,   GPIO_TypeDef, MODER)       \
+    R(gpio, pupdr,   GPIO_TypeDef, PUPDR)       \
+    R(gpio, ospeedr, GPIO_TypeDef, OSPEEDR)     \
+    R(gpio, afrl,    GPIO_TypeDef, AFR[0])      \
+    R(gpio, afrh,    GPIO_TypeDef, AFR[1])
+
+#define HW_GPIO_FIELDS(XI)                      \
+    XI(gpio, moder,   mode,  2)                 \
+    XI(gpio, pupdr,   pull,  2)                 \
+    XI(gpio, ospeedr, speed, 2)                 \
+    XI(gpio, afrl,    af,    4)                 \
+    XI(gpio, afrh,    af,    4)
+
+HW_USART_REGISTERS(HW_REG_ACCESSORS)
+HW_USART_FIELDS(HW_FIELD_ACCESSORS)
+HW_SPI_REGISTERS(HW_REG_ACCESSORS)
+HW_SPI_FIELDS(HW_FIELD_ACCESSORS)
+HW_GPIO_REGISTERS(HW_REG_ACCESSORS)
+HW_GPIO_FIELDS(HW_INDEXED_FIELD_ACCESSORS)
+
+#endif // HW_REGS_H
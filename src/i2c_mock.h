@@ -0,0 +1,55 @@
+#ifndef I2C_MOCK_H
+#define I2C_MOCK_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "device_drivers.h"
+
+// Mock I2C bus backend for host builds.
+// Transactions run against register-file targets (first written byte sets
+// the register pointer, further bytes auto-increment) and advance a
+// virtual clock by their wire time: one bit per START, repeated START and
+// STOP, nine bits per address or data byte at the driver's SCL frequency,
+// plus the SCL low time each target stretches the clock.
+#define I2C_MOCK_MAX_TARGETS    8
+#define I2C_MOCK_REGS           256
+#define I2C_MOCK_DEFAULT_HZ     100000
+
+// Register-file target
+typedef struct {
+    uint8_t address;            // 7-bit address
+    uint8_t regs[I2C_MOCK_REGS];
+    uint8_t pointer;            // Auto-increment register pointer
+    uint32_t read_stretch_ns;   // SCL held low before the first byte of a read
+    uint32_t byte_stretch_ns;   // SCL held low after every byte
+    uint32_t transactions;      // Transactions that addressed this target
+} i2c_mock_target_t;
+
+// Bus counters
+typedef struct {
+    uint32_t transactions;
+    uint32_t starts;            // START and repeated START conditions
+    uint32_t bytes;             // Address and data bytes on the wire
+    uint32_t nacks;
+    uint32_t timeouts;          // Clock stretched beyond stretch_timeout_ns
+    uint32_t irqs;              // Controller interrupts the transfer would take
+    uint64_t stretch_ns;
+    uint64_t busy_ns;
+} i2c_mock_stats_t;
+
+typedef struct {
+    i2c_mock_target_t *targets[I2C_MOCK_MAX_TARGETS];
+    uint8_t target_count;
+    uint32_t stretch_timeout_ns;  // 0: wait for the target indefinitely
+    uint64_t now_ns;            // Virtual time
+    i2c_mock_stats_t stats;
+    i2c_backend_t backend;      // Install with driver->backend = &bus->backend
+} i2c_mock_bus_t;
+
+// Function declarations
+error_t i2c_mock_init(i2c_mock_bus_t *bus);
+error_t i2c_mock_attach(i2c_mock_bus_t *bus, i2c_mock_target_t *target);
+uint64_t i2c_mock_now(const i2c_mock_bus_t *bus);
+void i2c_mock_reset_stats(i2c_mock_bus_t *bus);
+
+#endif // I2C_MOCK_H
@@ -0,0 +1,240 @@
+#include "latency_hist.h"
+#include "timebase.h"
+#include <stdio.h>
+
+#define LATENCY_HIST_HALF           (1u << (LATENCY_HIST_SUB_BITS - 1))
+#define LATENCY_HIST_MAX_VALUE      ((1ULL << LATENCY_HIST_MAX_BITS) - 1)
+
+static latency_hist_t histograms[LATENCY_OP_COUNT];
+static uint32_t sample_ticks[LATENCY_OP_COUNT];
+static bool recording;
+static uint32_t sample_mask = (1u << LATENCY_HIST_DEFAULT_SAMPLING) - 1;
+
+static const char *const op_names[LATENCY_OP_COUNT] = {
+    "uart tx",
+    "uart rx",
+    "spi transfer",
+    "i2c transfer",
+    "can send",
+    "sensor read",
+};
+
+// Internal helpers
+static uint32_t latency_bucket(uint64_t ns) {
+    if (ns > LATENCY_HIST_MAX_VALUE) {
+        ns = LATENCY_HIST_MAX_VALUE;
+    }
+    if (ns < (1u << LATENCY_HIST_SUB_BITS)) {
+        return (uint32_t)ns;
+    }
+
+    uint32_t shift = (uint32_t)(63 - __builtin_clzll(ns)) - (LATENCY_HIST_SUB_BITS - 1);
+    return shift * LATENCY_HIST_HALF + (uint32_t)(ns >> shift);
+}
+
+// Range of values that land in a bucket
+static uint64_t latency_bucket_low(uint32_t index) {
+    if (index < (1u << LATENCY_HIST_SUB_BITS)) {
+        return index;
+    }
+
+    uint32_t shift = index / LATENCY_HIST_HALF - 1;
+    return (uint64_t)(index - shift * LATENCY_HIST_HALF) << shift;
+}
+
+static uint64_t latency_bucket_high(uint32_t index) {
+    if (index < (1u << LATENCY_HIST_SUB_BITS)) {
+        return index;
+    }
+
+    uint32_t shift = index / LATENCY_HIST_HALF - 1;
+    return (((uint64_t)(index - shift * LATENCY_HIST_HALF) + 1) << shift) - 1;
+}
+
+// Counts operations per op so only every 2^shift-th one is timed. Plain
+// load and store: a lost increment between threads only shifts the sample.
+static bool latency_sampled(latency_op_t op) {
+    uint32_t mask = __atomic_load_n(&sample_mask, __ATOMIC_RELAXED);
+    if (mask == 0) return true;
+
+    uint32_t tick = __atomic_load_n(&sample_ticks[op], __ATOMIC_RELAXED) + 1;
+    __atomic_store_n(&sample_ticks[op], tick, __ATOMIC_RELAXED);
+    return (tick & mask) == 0;
+}
+
+// Control Functions
+void latency_hist_enable(bool enabled) {
+    __atomic_store_n(&recording, enabled, __ATOMIC_RELAXED);
+}
+
+bool latency_hist_enabled(void) {
+    return __atomic_load_n(&recording, __ATOMIC_RELAXED);
+}
+
+// Times one operation in 2^shift per op; 0 times every operation
+void latency_hist_set_sampling(uint8_t shift) {
+    if (shift > 16) {
+        shift = 16;
+    }
+    __atomic_store_n(&sample_mask, (1u << shift) - 1, __ATOMIC_RELAXED);
+}
+
+// LATENCY_HIST_IDLE when the operation is not timed
+uint64_t latency_hist_start(latency_op_t op) {
+    if (!__atomic_load_n(&recording, __ATOMIC_RELAXED) || op >= LATENCY_OP_COUNT || !latency_sampled(op)) {
+        return LATENCY_HIST_IDLE;
+    }
+    return timebase_ticks();
+}
+
+void latency_hist_stop(latency_op_t op, uint64_t start) {
+    if (start == LATENCY_HIST_IDLE || op >= LATENCY_OP_COUNT) return;
+
+    latency_hist_record(&histograms[op], timebase_ticks_to_ns(timebase_ticks() - start));
+}
+
+// Histogram Functions
+void latency_hist_record(latency_hist_t *hist, uint64_t ns) {
+    if (hist == NULL) return;
+
+    __atomic_fetch_add(&hist->counts[latency_bucket(ns)], 1, __ATOMIC_RELAXED);
+
+    uint64_t max = __atomic_load_n(&hist->max_ns, __ATOMIC_RELAXED);
+    while (ns > max &&
+           !__atomic_compare_exchange_n(&hist->max_ns, &max, ns, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+    }
+}
+
+latency_hist_t* latency_hist_get(latency_op_t op) {
+    return (op < LATENCY_OP_COUNT) ? &histograms[op] : NULL;
+}
+
+const char* latency_hist_op_name(latency_op_t op) {
+    return (op < LATENCY_OP_COUNT) ? op_names[op] : "unknown";
+}
+
+void latency_hist_snapshot(const latency_hist_t *hist, latency_hist_t *snapshot) {
+    if (hist == NULL || snapshot == NULL) return;
+
+    for (uint32_t i = 0; i < LATENCY_HIST_BUCKETS; i++) {
+        snapshot->counts[i] = __atomic_load_n(&hist->counts[i], __ATOMIC_RELAXED);
+    }
+    snapshot->max_ns = __atomic_load_n(&hist->max_ns, __ATOMIC_RELAXED);
+}
+
+// Adds src into dst; dst may be recorded into at the same time
+void latency_hist_merge(latency_hist_t *dst, const latency_hist_t *src) {
+    if (dst == NULL || src == NULL) return;
+
+    for (uint32_t i = 0; i < LATENCY_HIST_BUCKETS; i++) {
+        uint32_t count = __atomic_load_n(&src->counts[i], __ATOMIC_RELAXED);
+        if (count != 0) {
+            __atomic_fetch_add(&dst->counts[i], count, __ATOMIC_RELAXED);
+        }
+    }
+
+    uint64_t ns = __atomic_load_n(&src->max_ns, __ATOMIC_RELAXED);
+    uint64_t max = __atomic_load_n(&dst->max_ns, __ATOMIC_RELAXED);
+    while (ns > max &&
+           !__atomic_compare_exchange_n(&dst->max_ns, &max, ns, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+    }
+}
+
+// Records racing the reset land either side of it
+void latency_hist_reset(latency_hist_t *hist) {
+    if (hist == NULL) return;
+
+    for (uint32_t i = 0; i < LATENCY_HIST_BUCKETS; i++) {
+        __atomic_store_n(&hist->counts[i], 0, __ATOMIC_RELAXED);
+    }
+    __atomic_store_n(&hist->max_ns, 0, __ATOMIC_RELAXED);
+}
+
+void latency_hist_reset_all(void) {
+    for (uint8_t op = 0; op < LATENCY_OP_COUNT; op++) {
+        latency_hist_reset(&histograms[op]);
+        __atomic_store_n(&sample_ticks[op], 0, __ATOMIC_RELAXED);
+    }
+}
+
+// Query Functions
+uint64_t latency_hist_count(const latency_hist_t *hist) {
+    uint64_t total = 0;
+
+    if (hist == NULL) return 0;
+
+    for (uint32_t i = 0; i < LATENCY_HIST_BUCKETS; i++) {
+        total += __atomic_load_n(&hist->counts[i], __ATOMIC_RELAXED);
+    }
+    return total;
+}
+
+// Highest value equivalent to the percentile's bucket, capped at max_ns;
+// 0 when empty
+uint64_t latency_hist_percentile(const latency_hist_t *hist, double percentile) {
+    uint64_t total = latency_hist_count(hist);
+    if (total == 0) return 0;
+
+    if (percentile < 0.0) {
+        percentile = 0.0;
+    } else if (percentile > 100.0) {
+        percentile = 100.0;
+    }
+
+    // Smallest count covering the percentile, at least one
+    double exact = percentile / 100.0 * (double)total;
+    uint64_t target = (uint64_t)exact;
+    if ((double)target < exact || target == 0) {
+        target++;
+    }
+
+    uint64_t max = __atomic_load_n(&hist->max_ns, __ATOMIC_RELAXED);
+    uint64_t seen = 0;
+    for (uint32_t i = 0; i < LATENCY_HIST_BUCKETS; i++) {
+        seen += __atomic_load_n(&hist->counts[i], __ATOMIC_RELAXED);
+        if (seen >= target) {
+            // The last bucket also holds everything beyond the range
+            uint64_t high = latency_bucket_high(i);
+            return (high < max && i < LATENCY_HIST_BUCKETS - 1) ? high : max;
+        }
+    }
+    return max;
+}
+
+// Bucket midpoints weighted by count
+uint64_t latency_hist_mean(const latency_hist_t *hist) {
+    uint64_t total = 0;
+    double sum = 0.0;
+
+    if (hist == NULL) return 0;
+
+    for (uint32_t i = 0; i < LATENCY_HIST_BUCKETS; i++) {
+        uint32_t count = __atomic_load_n(&hist->counts[i], __ATOMIC_RELAXED);
+        if (count != 0) {
+            total += count;
+            sum += (double)count * (double)(latency_bucket_low(i) + latency_bucket_high(i)) / 2.0;
+        }
+    }
+    return total ? (uint64_t)(sum / (double)total + 0.5) : 0;
+}
+
+void latency_hist_print(void) {
+    latency_hist_t snapshot;
+
+    printf("%-13s %10s %9s %9s %9s %9s %9s %9s\n",
+           "op (ns)", "count", "mean", "p50", "p90", "p99", "p99.9", "max");
+    for (uint8_t op = 0; op < LATENCY_OP_COUNT; op++) {
+        latency_hist_snapshot(&histograms[op], &snapshot);
+        uint64_t count = latency_hist_count(&snapshot);
+        if (count == 0) continue;
+
+        printf("%-13s %10llu %9llu %9llu %9llu %9llu %9llu %9llu\n", op_names[op],
+               (unsigned long long)count,
+               (unsigned long long)latency_hist_mean(&snapshot),
+               (unsigned long long)latency_hist_percentile(&snapshot, 50.0),
+               (unsigned long long)latency_hist_percentile(&snapshot, 90.0),
+               (unsigned long long)latency_hist_percentile(&snapshot, 99.0),
+               (unsigned long long)latency_hist_percentile(&snapshot, 99.9),
+               (unsigned long long)snapshot.max_ns);
+    }
+}
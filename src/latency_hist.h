@@ -0,0 +1,83 @@
+#ifndef LATENCY_HIST_H
+#define LATENCY_HIST_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Per-operation latency histograms.
+// Each driver operation (latency_op_t) has a fixed-size log-linear
+// histogram in the style of HdrHistogram: values below 2^SUB_BITS ns get
+// one bucket each, above that every power of two is split into
+// 2^(SUB_BITS-1) buckets, so any recorded value is off by at most
+// 1/2^(SUB_BITS-1) (about 3%) up to 2^MAX_BITS ns. Larger values count in
+// the last bucket; max_ns stays exact.
+//
+// Recording is one relaxed atomic add on the bucket (plus a compare-and-
+// swap when a new maximum is seen), so drivers on any number of threads
+// record into the same histogram without a lock. Readers snapshot, merge
+// and query while recording goes on; a snapshot is exact per bucket but
+// not a single instant across buckets.
+//
+// Drivers bracket operations with LATENCY_START/LATENCY_STOP, timed with
+// timebase_ticks. Recording is off until latency_hist_enable(true). Two
+// clock reads cost more than the recording itself, so by default only one
+// operation in 2^LATENCY_HIST_DEFAULT_SAMPLING is timed (the others pay a
+// counter increment), which keeps the average cost per operation well
+// under 20 ns; latency_hist_set_sampling(0) times every operation. Build
+// with -DLATENCY_HIST_DISABLE (make LATENCY_HIST=0) to compile the
+// instrumentation out of the drivers entirely.
+//
+// Components that keep their own latency statistics (SPI queue, command
+// dispatcher) embed a latency_hist_t and record into it directly.
+#define LATENCY_HIST_SUB_BITS       6
+#define LATENCY_HIST_MAX_BITS       36      // 2^36 ns, about 68 s
+#define LATENCY_HIST_BUCKETS        ((LATENCY_HIST_MAX_BITS - LATENCY_HIST_SUB_BITS + 2) << (LATENCY_HIST_SUB_BITS - 1))
+#ifndef LATENCY_HIST_DEFAULT_SAMPLING
+#define LATENCY_HIST_DEFAULT_SAMPLING   3   // Time 1 operation in 8
+#endif
+#define LATENCY_HIST_IDLE           UINT64_MAX  // Start value of an operation that is not timed
+
+typedef enum {
+    LATENCY_OP_UART_TX,
+    LATENCY_OP_UART_RX,
+    LATENCY_OP_SPI_TRANSFER,
+    LATENCY_OP_I2C_TRANSFER,
+    LATENCY_OP_CAN_SEND,
+    LATENCY_OP_SENSOR_READ,
+    LATENCY_OP_COUNT
+} latency_op_t;
+
+typedef struct {
+    uint32_t counts[LATENCY_HIST_BUCKETS];
+    uint64_t max_ns;
+} latency_hist_t;
+
+#ifndef LATENCY_HIST_DISABLE
+#define LATENCY_START(op)           latency_hist_start(op)
+#define LATENCY_STOP(op, start)     latency_hist_stop((op), (start))
+#else
+#define LATENCY_START(op)           ((void)(op), LATENCY_HIST_IDLE)
+#define LATENCY_STOP(op, start)     ((void)(start))
+#endif
+
+// Function declarations
+void latency_hist_enable(bool enabled);
+bool latency_hist_enabled(void);
+void latency_hist_set_sampling(uint8_t shift);
+uint64_t latency_hist_start(latency_op_t op);
+void latency_hist_stop(latency_op_t op, uint64_t start);
+
+void latency_hist_record(latency_hist_t *hist, uint64_t ns);
+latency_hist_t* latency_hist_get(latency_op_t op);
+const char* latency_hist_op_name(latency_op_t op);
+void latency_hist_snapshot(const latency_hist_t *hist, latency_hist_t *snapshot);
+void latency_hist_merge(latency_hist_t *dst, const latency_hist_t *src);
+void latency_hist_reset(latency_hist_t *hist);
+void latency_hist_reset_all(void);
+
+uint64_t latency_hist_count(const latency_hist_t *hist);
+uint64_t latency_hist_percentile(const latency_hist_t *hist, double percentile);
+uint64_t latency_hist_mean(const latency_hist_t *hist);
+void latency_hist_print(void);
+
+#endif // LATENCY_HIST_H
@@ -0,0 +1,228 @@
+#include "mem_pool.h"
+#include "communication_protocols.h"
+#include "device_drivers.h"
+#include <stdio.h>
+#include <string.h>
+
+#if MEM_POOL_UART_COUNT < 1 || MEM_POOL_SPI_COUNT < 1 || MEM_POOL_I2C_COUNT < 1 || MEM_POOL_CAN_COUNT < 1 || \
+    MEM_POOL_SENSOR_I2C_COUNT < 1 || MEM_POOL_SENSOR_SPI_COUNT < 1 || MEM_POOL_SENSOR_UART_COUNT < 1
+#error "mem_pool: every pool needs at least one object"
+#endif
+
+#ifdef MEM_POOL_STRICT
+// A sensor takes an interface driver from its sensor pool and that driver's
+// register block from the bus pool, so sensors count against both
+MEM_POOL_STATIC_ASSERT(MEM_POOL_DEMAND_UARTS + MEM_POOL_DEMAND_UART_SENSORS <= MEM_POOL_UART_COUNT, uart_pool_overflow);
+MEM_POOL_STATIC_ASSERT(MEM_POOL_DEMAND_SPIS + MEM_POOL_DEMAND_SPI_SENSORS <= MEM_POOL_SPI_COUNT, spi_pool_overflow);
+MEM_POOL_STATIC_ASSERT(MEM_POOL_DEMAND_I2CS + MEM_POOL_DEMAND_SENSORS <= MEM_POOL_I2C_COUNT, i2c_pool_overflow);
+MEM_POOL_STATIC_ASSERT(MEM_POOL_DEMAND_CANS <= MEM_POOL_CAN_COUNT, can_pool_overflow);
+MEM_POOL_STATIC_ASSERT(MEM_POOL_DEMAND_SENSORS <= MEM_POOL_SENSOR_I2C_COUNT, sensor_i2c_pool_overflow);
+MEM_POOL_STATIC_ASSERT(MEM_POOL_DEMAND_SPI_SENSORS <= MEM_POOL_SENSOR_SPI_COUNT, sensor_spi_pool_overflow);
+MEM_POOL_STATIC_ASSERT(MEM_POOL_DEMAND_UART_SENSORS <= MEM_POOL_SENSOR_UART_COUNT, sensor_uart_pool_overflow);
+#endif
+
+typedef struct {
+    can_frame_t frames[MEM_POOL_CAN_QUEUE_FRAMES];
+} can_queue_block_t;
+
+typedef struct {
+    uint64_t words[(MEM_POOL_I2C_REGS_BYTES + 7) / 8];
+} i2c_regs_block_t;
+
+static USART_TypeDef uart_regs[MEM_POOL_UART_COUNT];
+static SPI_TypeDef spi_regs[MEM_POOL_SPI_COUNT];
+static i2c_regs_block_t i2c_regs[MEM_POOL_I2C_COUNT];
+static can_handle_t can_handles[MEM_POOL_CAN_COUNT];
+static can_queue_block_t can_queues[MEM_POOL_CAN_COUNT * 2];
+static i2c_driver_t sensor_i2c[MEM_POOL_SENSOR_I2C_COUNT];
+static spi_driver_t sensor_spi[MEM_POOL_SENSOR_SPI_COUNT];
+static uart_driver_t sensor_uart[MEM_POOL_SENSOR_UART_COUNT];
+
+static uint8_t uart_regs_used[MEM_POOL_UART_COUNT];
+static uint8_t spi_regs_used[MEM_POOL_SPI_COUNT];
+static uint8_t i2c_regs_used[MEM_POOL_I2C_COUNT];
+static uint8_t can_handles_used[MEM_POOL_CAN_COUNT];
+static uint8_t can_queues_used[MEM_POOL_CAN_COUNT * 2];
+static uint8_t sensor_i2c_used[MEM_POOL_SENSOR_I2C_COUNT];
+static uint8_t sensor_spi_used[MEM_POOL_SENSOR_SPI_COUNT];
+static uint8_t sensor_uart_used[MEM_POOL_SENSOR_UART_COUNT];
+
+typedef struct {
+    const char *name;
+    uint8_t *storage;
+    uint32_t object_size;
+    uint16_t capacity;
+    uint8_t *in_use;
+} mem_pool_def_t;
+
+#define POOL_DEF(name, storage, used) \
+    {name, (uint8_t*)(storage), sizeof((storage)[0]), sizeof(storage) / sizeof((storage)[0]), used}
+
+static const mem_pool_def_t pools[MEM_POOL_COUNT] = {
+    POOL_DEF("uart regs", uart_regs, uart_regs_used),
+    POOL_DEF("spi regs", spi_regs, spi_regs_used),
+    POOL_DEF("i2c regs", i2c_regs, i2c_regs_used),
+    POOL_DEF("can handles", can_handles, can_handles_used),
+    POOL_DEF("can queues", can_queues, can_queues_used),
+    POOL_DEF("sensor i2c", sensor_i2c, sensor_i2c_used),
+    POOL_DEF("sensor spi", sensor_spi, sensor_spi_used),
+    POOL_DEF("sensor uart", sensor_uart, sensor_uart_used),
+};
+
+static mem_pool_budget_t budgets[MEM_POOL_COUNT];
+static mem_arena_t *pool_arena;
+static bool pool_sealed;
+
+// Pool Functions
+// Zeroed object, or NULL when the pool (or installed arena) is exhausted
+// or the pools are sealed
+void* mem_pool_alloc(mem_pool_id_t id) {
+    if (id >= MEM_POOL_COUNT) return NULL;
+
+    const mem_pool_def_t *pool = &pools[id];
+    mem_pool_budget_t *budget = &budgets[id];
+    void *object = NULL;
+
+    if (pool_sealed) {
+        budget->failures++;
+        return NULL;
+    }
+
+    if (pool_arena != NULL) {
+        object = mem_arena_alloc(pool_arena, pool->object_size);
+        if (object == NULL) {
+            budget->failures++;
+            return NULL;
+        }
+        budget->from_arena++;
+        return object;
+    }
+
+    for (uint16_t i = 0; i < pool->capacity; i++) {
+        if (!pool->in_use[i]) {
+            pool->in_use[i] = 1;
+            object = pool->storage + (size_t)i * pool->object_size;
+            memset(object, 0, pool->object_size);
+            break;
+        }
+    }
+
+    if (object == NULL) {
+        budget->failures++;
+        return NULL;
+    }
+
+    budget->used++;
+    if (budget->used > budget->high_water) {
+        budget->high_water = budget->used;
+    }
+
+    return object;
+}
+
+// Returns a pool object. Anything else (NULL, arena objects, stale or
+// uninitialised pointers) is ignored.
+void mem_pool_release(mem_pool_id_t id, void *object) {
+    if (!mem_pool_owns(id, object)) return;
+
+    const mem_pool_def_t *pool = &pools[id];
+    size_t index = (size_t)((uint8_t*)object - pool->storage) / pool->object_size;
+    pool->in_use[index] = 0;
+    budgets[id].used--;
+}
+
+bool mem_pool_owns(mem_pool_id_t id, const void *object) {
+    if (id >= MEM_POOL_COUNT || object == NULL) return false;
+
+    const mem_pool_def_t *pool = &pools[id];
+    const uint8_t *p = (const uint8_t*)object;
+    if (p < pool->storage || p >= pool->storage + (size_t)pool->capacity * pool->object_size) {
+        return false;
+    }
+
+    size_t offset = (size_t)(p - pool->storage);
+    return offset % pool->object_size == 0 && pool->in_use[offset / pool->object_size];
+}
+
+// End of startup: later allocations fail and count against their pool
+void mem_pool_seal(bool sealed) {
+    pool_sealed = sealed;
+}
+
+bool mem_pool_sealed(void) {
+    return pool_sealed;
+}
+
+// Arena Functions
+error_t mem_arena_init(mem_arena_t *arena, void *buffer, size_t size) {
+    if (arena == NULL || buffer == NULL || ((uintptr_t)buffer & 7u) != 0) {
+        return ERROR_INVALID_PARAM;
+    }
+
+    arena->base = (uint8_t*)buffer;
+    arena->size = size;
+    arena->used = 0;
+    arena->failures = 0;
+
+    return ERROR_NONE;
+}
+
+// Zeroed, 8-byte aligned
+void* mem_arena_alloc(mem_arena_t *arena, size_t size) {
+    if (arena == NULL) return NULL;
+
+    size_t rounded = (size + 7u) & ~(size_t)7u;
+    if (rounded > arena->size - arena->used) {
+        arena->failures++;
+        return NULL;
+    }
+
+    void *object = arena->base + arena->used;
+    arena->used += rounded;
+    memset(object, 0, size);
+
+    return object;
+}
+
+// Places later pool allocations in the arena; NULL returns to the static pools
+void mem_pool_use_arena(mem_arena_t *arena) {
+    pool_arena = arena;
+}
+
+// Budget Functions
+void mem_pool_get_budget(mem_pool_id_t id, mem_pool_budget_t *budget) {
+    if (id >= MEM_POOL_COUNT || budget == NULL) return;
+
+    *budget = budgets[id];
+    budget->name = pools[id].name;
+    budget->object_size = pools[id].object_size;
+    budget->capacity = pools[id].capacity;
+}
+
+// Bytes reserved at link time for all pools
+size_t mem_pool_static_bytes(void) {
+    size_t total = 0;
+    for (uint8_t i = 0; i < MEM_POOL_COUNT; i++) {
+        total += (size_t)pools[i].capacity * (pools[i].object_size + 1);
+    }
+    return total;
+}
+
+void mem_pool_print_budget(void) {
+    mem_pool_budget_t budget;
+    uint32_t failures = 0;
+
+    printf("%-12s %8s %9s %6s %8s %9s\n", "pool", "object", "used/cap", "peak", "arena", "reserved");
+    for (uint8_t i = 0; i < MEM_POOL_COUNT; i++) {
+        mem_pool_get_budget((mem_pool_id_t)i, &budget);
+        printf("%-12s %8u %4u/%-4u %6u %8u %9zu%s\n", budget.name, budget.object_size,
+               budget.used, budget.capacity, budget.high_water, budget.from_arena,
+               (size_t)budget.capacity * budget.object_size, budget.failures ? "  OVERFLOW" : "");
+        failures += budget.failures;
+    }
+    printf("static pools: %zu bytes", mem_pool_static_bytes());
+    if (pool_arena != NULL) {
+        printf(", arena: %zu/%zu bytes", pool_arena->used, pool_arena->size);
+    }
+    printf(", failed allocations: %u%s\n", failures, pool_sealed ? " (sealed)" : "");
+}
@@ -0,0 +1,135 @@
+#ifndef MEM_POOL_H
+#define MEM_POOL_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include "embedded_hardware.h"
+
+// Static object pools for the driver and protocol init paths.
+// Every object the inits used to malloc (mock register blocks, CAN
+// handles and frame queues, sensor interface drivers) comes from a pool
+// sized at compile time, so startup memory is fixed at link time and
+// nothing fragments. The sizes below can be overridden with -D. A caller
+// that would rather place everything in its own memory installs an arena
+// with mem_pool_use_arena before the first init.
+//
+// mem_pool_seal marks the end of startup: allocations after it fail and
+// are counted, so a driver init in the steady state shows up in the
+// budget report instead of silently taking memory.
+//
+// Build with -DMEM_POOL_STRICT to turn overflow into a build failure:
+// MEM_POOL_DEMAND_* (the objects the application initialises, default 0)
+// are checked against the pool sizes at compile time, and sources that
+// include this header cannot name the heap functions at all. make strict
+// also rejects any library object (everything but main, sensor, utils and
+// alloc_track) that references them, whatever it includes.
+// Pools are not thread-safe; initialise drivers from one thread.
+
+#ifndef MEM_POOL_UART_COUNT
+#define MEM_POOL_UART_COUNT         8       // UART register blocks
+#endif
+#ifndef MEM_POOL_SPI_COUNT
+#define MEM_POOL_SPI_COUNT          8       // SPI register blocks
+#endif
+#ifndef MEM_POOL_I2C_COUNT
+#define MEM_POOL_I2C_COUNT          16      // I2C register blocks
+#endif
+#ifndef MEM_POOL_CAN_COUNT
+#define MEM_POOL_CAN_COUNT          4       // CAN handles; two frame queues each
+#endif
+#ifndef MEM_POOL_CAN_QUEUE_FRAMES
+#define MEM_POOL_CAN_QUEUE_FRAMES   64      // Largest can_init buffer_size
+#endif
+#ifndef MEM_POOL_SENSOR_I2C_COUNT
+#define MEM_POOL_SENSOR_I2C_COUNT   8       // I2C drivers owned by sensor drivers
+#endif
+#ifndef MEM_POOL_SENSOR_SPI_COUNT
+#define MEM_POOL_SENSOR_SPI_COUNT   4
+#endif
+#ifndef MEM_POOL_SENSOR_UART_COUNT
+#define MEM_POOL_SENSOR_UART_COUNT  4
+#endif
+
+#define MEM_POOL_I2C_REGS_BYTES     100     // Mock I2C register block
+
+typedef enum {
+    MEM_POOL_UART_REGS,
+    MEM_POOL_SPI_REGS,
+    MEM_POOL_I2C_REGS,
+    MEM_POOL_CAN_HANDLES,
+    MEM_POOL_CAN_QUEUES,
+    MEM_POOL_SENSOR_I2C,
+    MEM_POOL_SENSOR_SPI,
+    MEM_POOL_SENSOR_UART,
+    MEM_POOL_COUNT
+} mem_pool_id_t;
+
+// Caller-provided bump arena; objects taken from it are never released
+// individually
+typedef struct {
+    uint8_t *base;
+    size_t size;
+    size_t used;
+    uint32_t failures;
+} mem_arena_t;
+
+// Budget line for one pool
+typedef struct {
+    const char *name;
+    uint32_t object_size;
+    uint16_t capacity;
+    uint16_t used;
+    uint16_t high_water;
+    uint16_t from_arena;        // Objects placed in the installed arena
+    uint32_t failures;          // Pool full, arena full or sealed
+} mem_pool_budget_t;
+
+// Compile-time check; a false condition fails the build
+#define MEM_POOL_STATIC_ASSERT(cond, tag) typedef char mem_pool_assert_##tag[(cond) ? 1 : -1]
+
+#ifdef MEM_POOL_STRICT
+#ifndef MEM_POOL_DEMAND_UARTS
+#define MEM_POOL_DEMAND_UARTS       0
+#endif
+#ifndef MEM_POOL_DEMAND_SPIS
+#define MEM_POOL_DEMAND_SPIS        0
+#endif
+#ifndef MEM_POOL_DEMAND_I2CS
+#define MEM_POOL_DEMAND_I2CS        0
+#endif
+#ifndef MEM_POOL_DEMAND_CANS
+#define MEM_POOL_DEMAND_CANS        0
+#endif
+#ifndef MEM_POOL_DEMAND_SENSORS
+#define MEM_POOL_DEMAND_SENSORS     0       // I2C sensor drivers
+#endif
+#ifndef MEM_POOL_DEMAND_SPI_SENSORS
+#define MEM_POOL_DEMAND_SPI_SENSORS 0
+#endif
+#ifndef MEM_POOL_DEMAND_UART_SENSORS
+#define MEM_POOL_DEMAND_UART_SENSORS 0
+#endif
+#endif
+
+// Function declarations
+void* mem_pool_alloc(mem_pool_id_t id);
+void mem_pool_release(mem_pool_id_t id, void *object);
+bool mem_pool_owns(mem_pool_id_t id, const void *object);
+void mem_pool_seal(bool sealed);
+bool mem_pool_sealed(void);
+
+error_t mem_arena_init(mem_arena_t *arena, void *buffer, size_t size);
+void* mem_arena_alloc(mem_arena_t *arena, size_t size);
+void mem_pool_use_arena(mem_arena_t *arena);
+
+void mem_pool_get_budget(mem_pool_id_t id, mem_pool_budget_t *budget);
+size_t mem_pool_static_bytes(void);
+void mem_pool_print_budget(void);
+
+#ifdef MEM_POOL_STRICT
+#pragma GCC poison malloc calloc realloc free
+#endif
+
+#endif // MEM_POOL_H
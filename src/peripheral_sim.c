@@ -0,0 +1,912 @@
+#include "peripheral_sim.h"
+#include <string.h>
+
+#define SIM_NO_EVENT    UINT64_MAX
+
+static peripheral_sim_t *sim_active = NULL;
+
+// Internal helpers
+static peripheral_sim_uart_t* sim_find_uart(peripheral_sim_t *sim, volatile const void *regs) {
+    for (uint8_t i = 0; i < sim->uart_count; i++) {
+        if ((volatile const void*)sim->uarts[i].regs == regs) return &sim->uarts[i];
+    }
+    return NULL;
+}
+
+static peripheral_sim_spi_t* sim_find_spi(peripheral_sim_t *sim, volatile const void *regs) {
+    for (uint8_t i = 0; i < sim->spi_count; i++) {
+        if ((volatile const void*)sim->spis[i].regs == regs) return &sim->spis[i];
+    }
+    return NULL;
+}
+
+static peripheral_sim_dma_t* sim_find_dma(peripheral_sim_t *sim, volatile const void *regs) {
+    for (uint8_t i = 0; i < sim->dma_count; i++) {
+        if ((volatile const void*)sim->dmas[i].regs == regs) return &sim->dmas[i];
+    }
+    return NULL;
+}
+
+static int sim_gpio_index(const peripheral_sim_t *sim, volatile const void *regs) {
+    for (uint8_t i = 0; i < sim->gpio_count; i++) {
+        if ((volatile const void*)sim->gpios[i] == regs) return i;
+    }
+    return -1;
+}
+
+static bool sim_is_gpio(peripheral_sim_t *sim, volatile const void *regs) {
+    return sim_gpio_index(sim, regs) >= 0;
+}
+
+// DMA channel: element transfer and half/full transfer bookkeeping
+static bool dma_ready(const peripheral_sim_dma_t *dma) {
+    return dma != NULL && dma->active && dma->memory != NULL && dma->regs->CNDTR > 0;
+}
+
+static void dma_advance(peripheral_sim_dma_t *dma) {
+    uint32_t ccr = dma->regs->CCR;
+
+    dma->position++;
+    dma->regs->CNDTR--;
+
+    if (dma->position == dma->count / 2 && (ccr & DMA_CCR_HTIE)) {
+        dma->irq_pending = true;
+    }
+
+    if (dma->regs->CNDTR == 0) {
+        if (ccr & DMA_CCR_TCIE) {
+            dma->irq_pending = true;
+        }
+        if (ccr & DMA_CCR_CIRC) {
+            dma->regs->CNDTR = dma->count;
+            dma->position = 0;
+        } else {
+            dma->active = false;  // EN stays set until software clears it
+        }
+    }
+}
+
+// Without MINC every element uses the same memory location
+static uint8_t* dma_element(const peripheral_sim_dma_t *dma, bool wide) {
+    uint32_t index = (dma->regs->CCR & DMA_CCR_MINC) ? dma->position : 0;
+    return dma->memory + index * (wide ? 2 : 1);
+}
+
+static uint16_t dma_read(peripheral_sim_dma_t *dma, bool wide) {
+    const uint8_t *p = dma_element(dma, wide);
+    uint16_t value = wide ? (uint16_t)(p[0] | (p[1] << 8)) : p[0];
+    dma_advance(dma);
+    return value;
+}
+
+static void dma_write(peripheral_sim_dma_t *dma, uint16_t value, bool wide) {
+    uint8_t *p = dma_element(dma, wide);
+    p[0] = (uint8_t)value;
+    if (wide) {
+        p[1] = (uint8_t)(value >> 8);
+    }
+    dma_advance(dma);
+}
+
+// UART model
+uint64_t peripheral_sim_uart_frame_ns(const USART_TypeDef *uart) {
+    if (uart == NULL || uart->BRR == 0) return 0;
+
+    // uart_init programs BRR with the baud rate itself. Count half bits so
+    // 0.5 and 1.5 stop bits stay exact.
+    static const uint8_t stop_half_bits[4] = {2, 1, 4, 3};
+    uint32_t half_bits = 2 + ((uart->CR1 & USART_CR1_M) ? 18 : 16) + stop_half_bits[(uart->CR2 >> 12) & 0x3];
+
+    return ((uint64_t)half_bits * 1000000000ULL + uart->BRR) / (2ULL * uart->BRR);
+}
+
+static void uart_tx_pump(peripheral_sim_t *sim, peripheral_sim_uart_t *u) {
+    for (;;) {
+        if (!u->tx_busy && u->tx_buffer_full) {
+            u->tx_shift = u->tx_buffer;
+            u->tx_buffer_full = false;
+            u->tx_busy = true;
+            u->tx_done_at = sim->now_ns + peripheral_sim_uart_frame_ns(u->regs);
+            u->regs->SR |= USART_SR_TXE;
+        }
+
+        if (u->tx_buffer_full || !(u->regs->CR3 & USART_CR3_DMAT) || !dma_ready(u->dma_tx)) {
+            break;
+        }
+
+        // TXE raises a DMA request: the channel refills the buffer
+        u->tx_buffer = dma_read(u->dma_tx, false);
+        u->tx_buffer_full = true;
+        u->regs->SR &= ~(USART_SR_TXE | USART_SR_TC);
+    }
+}
+
+static void uart_data_write(peripheral_sim_t *sim, peripheral_sim_uart_t *u) {
+    uint16_t value = (uint16_t)(u->regs->DR & 0x1FF);
+
+    // DR is one memory word here, but TDR and RDR are separate on silicon
+    u->regs->DR = u->rx_latch;
+
+    if (!(u->regs->CR1 & USART_CR1_UE)) {
+        return;
+    }
+
+    u->tx_buffer = value;  // Overwrites an unsent byte, as the hardware does
+    u->tx_buffer_full = true;
+    u->regs->SR &= ~(USART_SR_TXE | USART_SR_TC);
+    uart_tx_pump(sim, u);
+}
+
+static void uart_tx_done(peripheral_sim_t *sim, peripheral_sim_uart_t *u) {
+    u->tx_busy = false;
+    u->stats.tx_frames++;
+    u->stats.busy_ns += peripheral_sim_uart_frame_ns(u->regs);
+
+    if (u->device.uart_rx) {
+        u->device.uart_rx(sim, u->regs, (uint8_t)u->tx_shift, u->device.context);
+    }
+
+    uart_tx_pump(sim, u);
+    if (!u->tx_busy && !u->tx_buffer_full) {
+        u->regs->SR |= USART_SR_TC;
+    }
+}
+
+static void uart_rx_event(peripheral_sim_t *sim, peripheral_sim_uart_t *u) {
+    uint64_t frame = peripheral_sim_uart_frame_ns(u->regs);
+    uint8_t byte = u->rx_queue[u->rx_head];
+
+    u->rx_head = (u->rx_head + 1) % PERIPHERAL_SIM_RX_QUEUE;
+    u->rx_count--;
+    u->stats.rx_frames++;
+
+    if ((u->regs->CR3 & USART_CR3_DMAR) && dma_ready(u->dma_rx)) {
+        dma_write(u->dma_rx, byte, false);
+    } else if (u->regs->SR & USART_SR_RXNE) {
+        u->regs->SR |= USART_SR_ORE;  // Previous byte unread: this one is lost
+        u->stats.overruns++;
+    } else {
+        u->rx_latch = byte;
+        u->regs->DR = byte;
+        u->regs->SR |= USART_SR_RXNE;
+    }
+
+    if (u->rx_count > 0) {
+        u->rx_next_at = sim->now_ns + frame;
+    }
+
+    // Line idle one frame after the last stop bit
+    u->idle_at = sim->now_ns + frame;
+    u->idle_armed = true;
+}
+
+static bool uart_irq_pending(const peripheral_sim_uart_t *u) {
+    uint32_t sr = u->regs->SR;
+    uint32_t cr1 = u->regs->CR1;
+
+    return ((sr & (USART_SR_RXNE | USART_SR_ORE)) && (cr1 & USART_CR1_RXNEIE)) ||
+           ((sr & USART_SR_TXE) && (cr1 & USART_CR1_TXEIE)) ||
+           ((sr & USART_SR_TC) && (cr1 & USART_CR1_TCIE)) ||
+           ((sr & USART_SR_IDLE) && (cr1 & USART_CR1_IDLEIE));
+}
+
+// SPI model
+uint64_t peripheral_sim_spi_frame_ns(const peripheral_sim_t *sim, const SPI_TypeDef *spi) {
+    if (sim == NULL || spi == NULL) return 0;
+
+    uint32_t prescaler_shift = ((spi->CR1 & SPI_CR1_BR) >> SPI_CR1_BR_Pos) + 1;
+    uint32_t sck_hz = sim->config.pclk_hz >> prescaler_shift;
+    uint32_t bits = (spi->CR1 & SPI_CR1_DFF) ? 16 : 8;
+
+    return ((uint64_t)bits * 1000000000ULL + sck_hz / 2) / sck_hz;
+}
+
+static void spi_pump(peripheral_sim_t *sim, peripheral_sim_spi_t *s) {
+    bool wide = (s->regs->CR1 & SPI_CR1_DFF) != 0;
+
+    for (;;) {
+        if (!s->busy && s->tx_buffer_full) {
+            s->tx_shift = s->tx_buffer;
+            s->tx_buffer_full = false;
+            s->busy = true;
+            s->done_at = sim->now_ns + peripheral_sim_spi_frame_ns(sim, s->regs);
+            s->regs->SR |= SPI_SR_TXE | SPI_SR_BSY;
+        }
+
+        if (s->tx_buffer_full || !(s->regs->CR2 & SPI_CR2_TXDMAEN) || !dma_ready(s->dma_tx)) {
+            break;
+        }
+
+        s->tx_buffer = dma_read(s->dma_tx, wide);
+        s->tx_buffer_full = true;
+        s->regs->SR &= ~SPI_SR_TXE;
+    }
+}
+
+static void spi_data_write(peripheral_sim_t *sim, peripheral_sim_spi_t *s) {
+    uint16_t mask = (s->regs->CR1 & SPI_CR1_DFF) ? 0xFFFF : 0xFF;
+    uint16_t value = (uint16_t)(s->regs->DR & mask);
+
+    s->regs->DR = s->rx_latch;
+
+    if (!(s->regs->CR1 & SPI_CR1_SPE)) {
+        return;
+    }
+
+    s->tx_buffer = value;
+    s->tx_buffer_full = true;
+    s->regs->SR &= ~SPI_SR_TXE;
+    spi_pump(sim, s);
+}
+
+static void spi_done(peripheral_sim_t *sim, peripheral_sim_spi_t *s) {
+    bool wide = (s->regs->CR1 & SPI_CR1_DFF) != 0;
+    uint16_t miso = wide ? 0xFFFF : 0xFF;  // Pulled-up MISO when nobody drives it
+
+    s->busy = false;
+    s->stats.tx_frames++;
+    s->stats.rx_frames++;
+    s->stats.busy_ns += peripheral_sim_spi_frame_ns(sim, s->regs);
+
+    for (uint8_t i = 0; i < s->target_count; i++) {
+        peripheral_sim_spi_target_t *t = &s->targets[i];
+        if (t->device.spi_exchange && (t->cs_gpio == NULL || t->selected)) {
+            miso = t->device.spi_exchange(sim, s->regs, s->tx_shift, t->device.context);
+            break;
+        }
+    }
+
+    if ((s->regs->CR2 & SPI_CR2_RXDMAEN) && dma_ready(s->dma_rx)) {
+        dma_write(s->dma_rx, miso, wide);
+    } else if (s->regs->SR & SPI_SR_RXNE) {
+        s->regs->SR |= SPI_SR_OVR;
+        s->stats.overruns++;
+    } else {
+        s->rx_latch = miso;
+        s->regs->DR = miso;
+        s->regs->SR |= SPI_SR_RXNE;
+    }
+
+    spi_pump(sim, s);
+    if (!s->busy) {
+        s->regs->SR &= ~SPI_SR_BSY;
+    }
+}
+
+static bool spi_irq_pending(const peripheral_sim_spi_t *s) {
+    uint32_t sr = s->regs->SR;
+    uint32_t cr2 = s->regs->CR2;
+
+    return ((sr & SPI_SR_RXNE) && (cr2 & SPI_CR2_RXNEIE)) ||
+           ((sr & SPI_SR_TXE) && (cr2 & SPI_CR2_TXEIE));
+}
+
+// GPIO model: BSRR is applied to ODR; output pins read back on IDR
+static void gpio_bsrr_write(peripheral_sim_t *sim, GPIO_TypeDef *gpio) {
+    uint32_t bsrr = gpio->BSRR;
+    uint32_t odr = gpio->ODR;
+
+    odr &= ~(bsrr >> 16);
+    odr |= bsrr & 0xFFFF;  // Set wins when both bits are written
+    gpio->ODR = odr;
+    gpio->BSRR = 0;
+
+    uint32_t outputs = 0;
+    for (uint8_t pin = 0; pin < 16; pin++) {
+        if (((gpio->MODER >> (pin * 2)) & 0x3U) == 0x1U) {
+            outputs |= 1U << pin;
+        }
+    }
+    gpio->IDR = (gpio->IDR & ~outputs) | (odr & outputs);
+
+    // Chip selects are active low
+    for (uint8_t i = 0; i < sim->spi_count; i++) {
+        peripheral_sim_spi_t *s = &sim->spis[i];
+        for (uint8_t j = 0; j < s->target_count; j++) {
+            peripheral_sim_spi_target_t *t = &s->targets[j];
+            if (t->cs_gpio != gpio) continue;
+
+            bool selected = (odr & (1U << t->cs_pin)) == 0;
+            if (selected != t->selected) {
+                t->selected = selected;
+                if (t->device.spi_select) {
+                    t->device.spi_select(sim, s->regs, selected, t->device.context);
+                }
+            }
+        }
+    }
+}
+
+// Input waveform: toggles IDR and latches an edge flag for the port
+static void wave_edge(peripheral_sim_t *sim, peripheral_sim_wave_t *w) {
+    uint32_t bit = 1U << w->pin;
+
+    w->level = !w->level;
+    w->edges++;
+    if (w->level) {
+        w->gpio->IDR |= bit;
+        w->next_at += w->high_ns;
+    } else {
+        w->gpio->IDR &= ~bit;
+        w->next_at += w->period_ns - w->high_ns;
+        w->cycles--;
+    }
+
+    int index = sim_gpio_index(sim, w->gpio);
+    if (index >= 0) {
+        sim->gpio_edges[index] |= (uint16_t)bit;
+    }
+}
+
+// Runs handlers while their interrupt condition holds
+static void sim_dispatch_irqs(peripheral_sim_t *sim) {
+    if (sim->in_irq) return;
+
+    for (uint8_t i = 0; i < sim->uart_count; i++) {
+        peripheral_sim_uart_t *u = &sim->uarts[i];
+        for (uint8_t n = 0; u->irq && n < PERIPHERAL_SIM_IRQ_LOOPS && uart_irq_pending(u); n++) {
+            sim->in_irq = true;
+            u->irq(u->irq_context);
+            sim->in_irq = false;
+            u->stats.irqs++;
+        }
+    }
+
+    for (uint8_t i = 0; i < sim->spi_count; i++) {
+        peripheral_sim_spi_t *s = &sim->spis[i];
+        for (uint8_t n = 0; s->irq && n < PERIPHERAL_SIM_IRQ_LOOPS && spi_irq_pending(s); n++) {
+            sim->in_irq = true;
+            s->irq(s->irq_context);
+            sim->in_irq = false;
+            s->stats.irqs++;
+        }
+    }
+
+    for (uint8_t i = 0; i < sim->gpio_count; i++) {
+        if (sim->gpio_edges[i] != 0) {
+            sim->gpio_edges[i] = 0;
+            if (sim->gpio_irq[i]) {
+                sim->in_irq = true;
+                sim->gpio_irq[i](sim->gpio_irq_context[i]);
+                sim->in_irq = false;
+            }
+        }
+    }
+
+    for (uint8_t i = 0; i < sim->dma_count; i++) {
+        peripheral_sim_dma_t *d = &sim->dmas[i];
+        if (d->irq_pending) {
+            d->irq_pending = false;
+            if (d->irq) {
+                sim->in_irq = true;
+                d->irq(d->irq_context);
+                sim->in_irq = false;
+            }
+        }
+    }
+}
+
+static void sim_pump_dma_peer(peripheral_sim_t *sim, const peripheral_sim_dma_t *dma) {
+    for (uint8_t i = 0; i < sim->uart_count; i++) {
+        if (sim->uarts[i].dma_tx == dma) uart_tx_pump(sim, &sim->uarts[i]);
+    }
+    for (uint8_t i = 0; i < sim->spi_count; i++) {
+        if (sim->spis[i].dma_tx == dma) spi_pump(sim, &sim->spis[i]);
+    }
+}
+
+// Backend hooks
+static void sim_handle_access(peripheral_sim_t *sim, volatile void *regs, volatile uint32_t *reg, bool write) {
+    // Control register writes may enable interrupts or DMA requests
+    peripheral_sim_uart_t *u = sim_find_uart(sim, regs);
+    if (u != NULL) {
+        if (reg == &u->regs->DR && write) {
+            uart_data_write(sim, u);
+        } else if (reg == &u->regs->DR) {
+            u->regs->SR &= ~(USART_SR_RXNE | USART_SR_IDLE | USART_SR_ORE);
+        } else {
+            uart_tx_pump(sim, u);
+        }
+        sim_dispatch_irqs(sim);
+        return;
+    }
+
+    peripheral_sim_spi_t *s = sim_find_spi(sim, regs);
+    if (s != NULL) {
+        if (reg == &s->regs->DR && write) {
+            spi_data_write(sim, s);
+        } else if (reg == &s->regs->DR) {
+            s->regs->SR &= ~(SPI_SR_RXNE | SPI_SR_OVR);
+        } else {
+            spi_pump(sim, s);
+        }
+        sim_dispatch_irqs(sim);
+        return;
+    }
+
+    peripheral_sim_dma_t *d = sim_find_dma(sim, regs);
+    if (d != NULL && reg == &d->regs->CCR && write) {
+        bool enabled = (d->regs->CCR & DMA_CCR_EN) != 0;
+        if (enabled && !d->active) {
+            d->active = true;
+            d->count = (uint16_t)d->regs->CNDTR;
+            d->position = 0;
+            sim_pump_dma_peer(sim, d);
+        } else if (!enabled) {
+            d->active = false;
+        }
+        sim_dispatch_irqs(sim);
+        return;
+    }
+
+    if (write && sim_is_gpio(sim, regs)) {
+        GPIO_TypeDef *gpio = (GPIO_TypeDef*)regs;
+        if (reg == &gpio->BSRR) {
+            gpio_bsrr_write(sim, gpio);
+        }
+    }
+}
+
+static void sim_access(volatile void *regs, volatile uint32_t *reg, bool write, void *context) {
+    peripheral_sim_t *sim = (peripheral_sim_t*)context;
+
+    sim_handle_access(sim, regs, reg, write);
+
+    // The access takes core time while the peripherals keep running
+    if (sim->config.access_ns != 0) {
+        peripheral_sim_advance(sim, sim->config.access_ns);
+    }
+}
+
+static void sim_poll(volatile void *regs, void *context) {
+    (void)regs;
+    peripheral_sim_step((peripheral_sim_t*)context);
+}
+
+static void sim_dma_bind(DMA_Channel_TypeDef *dma, void *memory, void *context) {
+    peripheral_sim_dma_t *d = sim_find_dma((peripheral_sim_t*)context, dma);
+    if (d != NULL) {
+        d->memory = (uint8_t*)memory;
+    }
+}
+
+// Simulator Functions
+error_t peripheral_sim_init(peripheral_sim_t *sim, const peripheral_sim_config_t *config) {
+    if (sim == NULL || config == NULL || config->pclk_hz == 0) {
+        return ERROR_INVALID_PARAM;
+    }
+
+    memset(sim, 0, sizeof(peripheral_sim_t));
+    sim->config = *config;
+    sim->backend.access = sim_access;
+    sim->backend.poll = sim_poll;
+    sim->backend.dma_bind = sim_dma_bind;
+    sim->backend.context = sim;
+
+    return ERROR_NONE;
+}
+
+// Routes the hardware layer's register hooks to this simulator
+void peripheral_sim_install(peripheral_sim_t *sim) {
+    if (sim == NULL) return;
+
+    sim_active = sim;
+    hw_set_backend(&sim->backend);
+}
+
+void peripheral_sim_uninstall(void) {
+    sim_active = NULL;
+    hw_set_backend(NULL);
+}
+
+error_t peripheral_sim_attach_uart(peripheral_sim_t *sim, USART_TypeDef *uart, const peripheral_sim_device_t *device) {
+    if (sim == NULL || uart == NULL) {
+        return ERROR_INVALID_PARAM;
+    }
+    if (sim->uart_count >= PERIPHERAL_SIM_MAX_UART) {
+        return ERROR_OVERFLOW;
+    }
+
+    peripheral_sim_uart_t *u = &sim->uarts[sim->uart_count++];
+    memset(u, 0, sizeof(peripheral_sim_uart_t));
+    u->regs = uart;
+    if (device) {
+        u->device = *device;
+    }
+
+    // Reset state of the status and data registers; configuration is kept
+    uart->SR = USART_SR_TXE | USART_SR_TC;
+    uart->DR = 0;
+
+    return ERROR_NONE;
+}
+
+error_t peripheral_sim_attach_spi(peripheral_sim_t *sim, SPI_TypeDef *spi, GPIO_TypeDef *cs_gpio, uint16_t cs_pin,
+                                  const peripheral_sim_device_t *device) {
+    if (sim == NULL || spi == NULL || cs_pin > 15) {
+        return ERROR_INVALID_PARAM;
+    }
+
+    // Attaching a bus again adds another chip select to it
+    peripheral_sim_spi_t *s = sim_find_spi(sim, spi);
+    if (s == NULL && sim->spi_count >= PERIPHERAL_SIM_MAX_SPI) {
+        return ERROR_OVERFLOW;
+    }
+    if (s != NULL && s->target_count >= PERIPHERAL_SIM_SPI_TARGETS) {
+        return ERROR_OVERFLOW;
+    }
+
+    if (cs_gpio != NULL && !sim_is_gpio(sim, cs_gpio)) {
+        error_t err = peripheral_sim_attach_gpio(sim, cs_gpio);
+        if (err != ERROR_NONE) {
+            return err;
+        }
+    }
+
+    if (s == NULL) {
+        s = &sim->spis[sim->spi_count++];
+        memset(s, 0, sizeof(peripheral_sim_spi_t));
+        s->regs = spi;
+        spi->SR = SPI_SR_TXE;
+        spi->DR = 0;
+    }
+
+    peripheral_sim_spi_target_t *t = &s->targets[s->target_count++];
+    memset(t, 0, sizeof(peripheral_sim_spi_target_t));
+    t->cs_gpio = cs_gpio;
+    t->cs_pin = cs_pin;
+    t->selected = cs_gpio != NULL && (cs_gpio->ODR & (1U << cs_pin)) == 0;
+    if (device) {
+        t->device = *device;
+    }
+
+    return ERROR_NONE;
+}
+
+error_t peripheral_sim_attach_gpio(peripheral_sim_t *sim, GPIO_TypeDef *gpio) {
+    if (sim == NULL || gpio == NULL) {
+        return ERROR_INVALID_PARAM;
+    }
+    if (sim_is_gpio(sim, gpio)) {
+        return ERROR_NONE;
+    }
+    if (sim->gpio_count >= PERIPHERAL_SIM_MAX_GPIO) {
+        return ERROR_OVERFLOW;
+    }
+
+    sim->gpios[sim->gpio_count++] = gpio;
+    gpio->BSRR = 0;
+
+    return ERROR_NONE;
+}
+
+// Connects a channel to the request line of an attached UART or SPI
+error_t peripheral_sim_attach_dma(peripheral_sim_t *sim, DMA_Channel_TypeDef *dma, volatile void *peripheral,
+                                  bool to_peripheral) {
+    if (sim == NULL || dma == NULL || peripheral == NULL) {
+        return ERROR_INVALID_PARAM;
+    }
+
+    peripheral_sim_uart_t *u = sim_find_uart(sim, peripheral);
+    peripheral_sim_spi_t *s = sim_find_spi(sim, peripheral);
+    if (u == NULL && s == NULL) {
+        return ERROR_INVALID_PARAM;
+    }
+    if (sim->dma_count >= PERIPHERAL_SIM_MAX_DMA) {
+        return ERROR_OVERFLOW;
+    }
+
+    peripheral_sim_dma_t *d = &sim->dmas[sim->dma_count++];
+    memset(d, 0, sizeof(peripheral_sim_dma_t));
+    d->regs = dma;
+    d->to_peripheral = to_peripheral;
+    dma->CCR = 0;
+    dma->CNDTR = 0;
+
+    if (u != NULL) {
+        if (to_peripheral) u->dma_tx = d; else u->dma_rx = d;
+    } else {
+        if (to_peripheral) s->dma_tx = d; else s->dma_rx = d;
+    }
+
+    return ERROR_NONE;
+}
+
+error_t peripheral_sim_set_irq(peripheral_sim_t *sim, volatile void *regs, peripheral_sim_irq_t irq, void *context) {
+    if (sim == NULL || regs == NULL) {
+        return ERROR_INVALID_PARAM;
+    }
+
+    peripheral_sim_uart_t *u = sim_find_uart(sim, regs);
+    if (u != NULL) {
+        u->irq = irq;
+        u->irq_context = context;
+        return ERROR_NONE;
+    }
+
+    peripheral_sim_spi_t *s = sim_find_spi(sim, regs);
+    if (s != NULL) {
+        s->irq = irq;
+        s->irq_context = context;
+        return ERROR_NONE;
+    }
+
+    peripheral_sim_dma_t *d = sim_find_dma(sim, regs);
+    if (d != NULL) {
+        d->irq = irq;
+        d->irq_context = context;
+        return ERROR_NONE;
+    }
+
+    // GPIO: called once per event time at which input edges occurred
+    int index = sim_gpio_index(sim, regs);
+    if (index >= 0) {
+        sim->gpio_irq[index] = irq;
+        sim->gpio_irq_context[index] = context;
+        return ERROR_NONE;
+    }
+
+    return ERROR_INVALID_PARAM;
+}
+
+// Drives a square wave onto an input pin: rising edge now, falling edge
+// high_ns later, for the given number of periods
+error_t peripheral_sim_gpio_wave(peripheral_sim_t *sim, GPIO_TypeDef *gpio, uint16_t pin, uint64_t period_ns,
+                                 uint64_t high_ns, uint32_t cycles) {
+    if (sim == NULL || gpio == NULL || pin > 15 || high_ns == 0 || high_ns >= period_ns) {
+        return ERROR_INVALID_PARAM;
+    }
+    if (!sim_is_gpio(sim, gpio)) {
+        error_t err = peripheral_sim_attach_gpio(sim, gpio);
+        if (err != ERROR_NONE) {
+            return err;
+        }
+    }
+
+    // Reuse a finished or same-pin slot before taking a new one
+    peripheral_sim_wave_t *w = NULL;
+    for (uint8_t i = 0; i < sim->wave_count && w == NULL; i++) {
+        if (sim->waves[i].cycles == 0 || (sim->waves[i].gpio == gpio && sim->waves[i].pin == pin)) {
+            w = &sim->waves[i];
+        }
+    }
+    if (w == NULL) {
+        if (sim->wave_count >= PERIPHERAL_SIM_MAX_WAVES) {
+            return ERROR_OVERFLOW;
+        }
+        w = &sim->waves[sim->wave_count++];
+    }
+
+    memset(w, 0, sizeof(peripheral_sim_wave_t));
+    w->gpio = gpio;
+    w->pin = pin;
+    w->period_ns = period_ns;
+    w->high_ns = high_ns;
+    w->cycles = cycles;
+    w->level = false;
+    w->next_at = sim->now_ns;
+    gpio->IDR &= ~(1U << pin);
+
+    return ERROR_NONE;
+}
+
+// Queues bytes on the line toward the MCU. The first byte completes
+// delay_ns plus one frame from now; the rest follow back to back.
+error_t peripheral_sim_uart_inject(peripheral_sim_t *sim, USART_TypeDef *uart, const uint8_t *data,
+                                   uint16_t length, uint64_t delay_ns) {
+    if (sim == NULL || uart == NULL || data == NULL) {
+        return ERROR_INVALID_PARAM;
+    }
+
+    peripheral_sim_uart_t *u = sim_find_uart(sim, uart);
+    if (u == NULL) {
+        return ERROR_INVALID_PARAM;
+    }
+    if (u->rx_count + length > PERIPHERAL_SIM_RX_QUEUE) {
+        return ERROR_OVERFLOW;
+    }
+
+    if (u->rx_count == 0) {
+        u->rx_next_at = sim->now_ns + delay_ns + peripheral_sim_uart_frame_ns(uart);
+    }
+
+    for (uint16_t i = 0; i < length; i++) {
+        u->rx_queue[(u->rx_head + u->rx_count) % PERIPHERAL_SIM_RX_QUEUE] = data[i];
+        u->rx_count++;
+    }
+
+    return ERROR_NONE;
+}
+
+uint64_t peripheral_sim_next_event(const peripheral_sim_t *sim) {
+    if (sim == NULL) return SIM_NO_EVENT;
+
+    uint64_t next = SIM_NO_EVENT;
+
+    for (uint8_t i = 0; i < sim->uart_count; i++) {
+        const peripheral_sim_uart_t *u = &sim->uarts[i];
+        if (u->tx_busy && u->tx_done_at < next) next = u->tx_done_at;
+        if (u->rx_count > 0 && u->rx_next_at < next) next = u->rx_next_at;
+        if (u->idle_armed && u->idle_at < next) next = u->idle_at;
+    }
+
+    for (uint8_t i = 0; i < sim->spi_count; i++) {
+        const peripheral_sim_spi_t *s = &sim->spis[i];
+        if (s->busy && s->done_at < next) next = s->done_at;
+    }
+
+    for (uint8_t i = 0; i < sim->wave_count; i++) {
+        const peripheral_sim_wave_t *w = &sim->waves[i];
+        if (w->cycles > 0 && w->next_at < next) next = w->next_at;
+    }
+
+    return next;
+}
+
+// Jumps virtual time to the next event and processes everything due then
+bool peripheral_sim_step(peripheral_sim_t *sim) {
+    if (sim == NULL) return false;
+
+    uint64_t next = peripheral_sim_next_event(sim);
+    if (next == SIM_NO_EVENT) {
+        return false;
+    }
+
+    if (next > sim->now_ns) {
+        sim->now_ns = next;
+    }
+
+    for (uint8_t i = 0; i < sim->uart_count; i++) {
+        peripheral_sim_uart_t *u = &sim->uarts[i];
+        if (u->tx_busy && u->tx_done_at <= sim->now_ns) {
+            uart_tx_done(sim, u);
+            sim->events++;
+        }
+        if (u->rx_count > 0 && u->rx_next_at <= sim->now_ns) {
+            uart_rx_event(sim, u);
+            sim->events++;
+        }
+        if (u->idle_armed && u->idle_at <= sim->now_ns) {
+            u->idle_armed = false;
+            u->regs->SR |= USART_SR_IDLE;
+            sim->events++;
+        }
+    }
+
+    for (uint8_t i = 0; i < sim->spi_count; i++) {
+        peripheral_sim_spi_t *s = &sim->spis[i];
+        if (s->busy && s->done_at <= sim->now_ns) {
+            spi_done(sim, s);
+            sim->events++;
+        }
+    }
+
+    for (uint8_t i = 0; i < sim->wave_count; i++) {
+        peripheral_sim_wave_t *w = &sim->waves[i];
+        if (w->cycles > 0 && w->next_at <= sim->now_ns) {
+            wave_edge(sim, w);
+            sim->events++;
+        }
+    }
+
+    sim_dispatch_irqs(sim);
+
+    return true;
+}
+
+void peripheral_sim_advance(peripheral_sim_t *sim, uint64_t ns) {
+    if (sim == NULL) return;
+
+    uint64_t target = sim->now_ns + ns;
+
+    while (peripheral_sim_next_event(sim) <= target) {
+        peripheral_sim_step(sim);
+    }
+
+    sim->now_ns = target;
+}
+
+uint64_t peripheral_sim_now(const peripheral_sim_t *sim) {
+    return sim ? sim->now_ns : 0;
+}
+
+// protocol_clock_t over the installed simulator's virtual time
+uint64_t peripheral_sim_clock(void) {
+    return sim_active ? sim_active->now_ns : 0;
+}
+
+const peripheral_sim_stats_t* peripheral_sim_get_stats(const peripheral_sim_t *sim, volatile void *regs) {
+    if (sim == NULL || regs == NULL) return NULL;
+
+    peripheral_sim_uart_t *u = sim_find_uart((peripheral_sim_t*)sim, regs);
+    if (u != NULL) return &u->stats;
+
+    peripheral_sim_spi_t *s = sim_find_spi((peripheral_sim_t*)sim, regs);
+    if (s != NULL) return &s->stats;
+
+    return NULL;
+}
+
+// Scripted UART device
+static void script_uart_rx(peripheral_sim_t *sim, USART_TypeDef *uart, uint8_t byte, void *context) {
+    peripheral_sim_script_t *script = (peripheral_sim_script_t*)context;
+
+    if (script->step >= script->step_count) return;
+
+    const peripheral_sim_script_step_t *step = &script->steps[script->step];
+    if (step->expect_length == 0) return;
+
+    if (byte != step->expect[script->matched]) {
+        script->mismatches++;
+        script->matched = (byte == step->expect[0]) ? 1 : 0;
+        return;
+    }
+
+    if (++script->matched < step->expect_length) return;
+
+    script->matched = 0;
+    if (step->reply_length > 0) {
+        peripheral_sim_uart_inject(sim, uart, step->reply, step->reply_length, step->latency_ns);
+    }
+
+    script->step++;
+    if (script->step == script->step_count && script->loop) {
+        script->step = 0;
+    }
+}
+
+peripheral_sim_device_t peripheral_sim_script_device(peripheral_sim_script_t *script) {
+    peripheral_sim_device_t device;
+
+    memset(&device, 0, sizeof(device));
+    device.uart_rx = script_uart_rx;
+    device.context = script;
+
+    return device;
+}
+
+// SPI register-file device
+static uint16_t regmap_exchange(peripheral_sim_t *sim, SPI_TypeDef *spi, uint16_t mosi, void *context) {
+    (void)sim;
+    (void)spi;
+    peripheral_sim_regmap_t *map = (peripheral_sim_regmap_t*)context;
+
+    if (!map->addressed) {
+        map->address = (uint8_t)(mosi & (PERIPHERAL_SIM_REGMAP_SIZE - 1));
+        map->reading = (mosi & PERIPHERAL_SIM_REGMAP_READ) != 0;
+        map->addressed = true;
+        return 0x00;
+    }
+
+    uint16_t miso = 0x00;
+    if (map->reading) {
+        miso = map->regs[map->address];
+    } else {
+        map->regs[map->address] = (uint8_t)mosi;
+    }
+    map->address = (map->address + 1) % PERIPHERAL_SIM_REGMAP_SIZE;
+
+    return miso;
+}
+
+static void regmap_select(peripheral_sim_t *sim, SPI_TypeDef *spi, bool selected, void *context) {
+    (void)sim;
+    (void)spi;
+    peripheral_sim_regmap_t *map = (peripheral_sim_regmap_t*)context;
+
+    if (!selected && map->addressed) {
+        map->transactions++;
+    }
+    map->addressed = false;
+}
+
+peripheral_sim_device_t peripheral_sim_regmap_device(peripheral_sim_regmap_t *regmap) {
+    peripheral_sim_device_t device;
+
+    memset(&device, 0, sizeof(device));
+    device.spi_exchange = regmap_exchange;
+    device.spi_select = regmap_select;
+    device.context = regmap;
+
+    return device;
+}
@@ -0,0 +1,206 @@
+#ifndef PERIPHERAL_SIM_H
+#define PERIPHERAL_SIM_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "embedded_hardware.h"
+
+// Simulated peripheral backend for host builds.
+// A discrete-event scheduler in virtual time updates SR/DR of attached
+// USART, SPI, GPIO and DMA register blocks at rates derived from BRR and
+// the SPI prescaler. Driver wait loops advance virtual time straight to the
+// next event, so the stack runs as fast as the host allows while reported
+// times match the modelled wire.
+#define PERIPHERAL_SIM_MAX_UART     4
+#define PERIPHERAL_SIM_MAX_SPI      4
+#define PERIPHERAL_SIM_MAX_GPIO     4
+#define PERIPHERAL_SIM_MAX_DMA      8
+#define PERIPHERAL_SIM_SPI_TARGETS  4       // Chip selects per SPI bus
+#define PERIPHERAL_SIM_MAX_WAVES    8       // Input waveforms driven onto GPIO pins
+#define PERIPHERAL_SIM_RX_QUEUE     1024    // Bytes queued toward one UART
+#define PERIPHERAL_SIM_IRQ_LOOPS    8       // Re-entries while a flag stays pending
+
+typedef struct peripheral_sim peripheral_sim_t;
+
+// Interrupt handler (e.g. an adapter around uart_driver_process_interrupt)
+typedef void (*peripheral_sim_irq_t)(void *context);
+
+// Device model connected to a UART or SPI bus
+typedef struct {
+    void (*uart_rx)(peripheral_sim_t *sim, USART_TypeDef *uart, uint8_t byte, void *context);
+    uint16_t (*spi_exchange)(peripheral_sim_t *sim, SPI_TypeDef *spi, uint16_t mosi, void *context);
+    void (*spi_select)(peripheral_sim_t *sim, SPI_TypeDef *spi, bool selected, void *context);
+    void *context;
+} peripheral_sim_device_t;
+
+// Configuration
+typedef struct {
+    uint32_t pclk_hz;           // Peripheral clock feeding the SPI prescaler
+    uint32_t access_ns;         // Core time per data/control register access (0: free)
+} peripheral_sim_config_t;
+
+// Per-peripheral counters
+typedef struct {
+    uint32_t tx_frames;
+    uint32_t rx_frames;
+    uint32_t overruns;
+    uint32_t irqs;
+    uint64_t busy_ns;           // Time the shift register was active
+} peripheral_sim_stats_t;
+
+typedef struct {
+    DMA_Channel_TypeDef *regs;
+    uint8_t *memory;
+    uint16_t count;             // CNDTR at enable (circular reload value)
+    uint16_t position;
+    bool active;
+    bool to_peripheral;
+    bool irq_pending;           // Half or full transfer reached with HTIE/TCIE set
+    peripheral_sim_irq_t irq;
+    void *irq_context;
+} peripheral_sim_dma_t;
+
+typedef struct {
+    USART_TypeDef *regs;
+    peripheral_sim_device_t device;
+    peripheral_sim_dma_t *dma_tx;
+    peripheral_sim_dma_t *dma_rx;
+    peripheral_sim_irq_t irq;
+    void *irq_context;
+    uint16_t rx_latch;          // Value the core reads from DR
+    uint16_t tx_buffer;
+    uint16_t tx_shift;
+    bool tx_buffer_full;
+    bool tx_busy;
+    uint64_t tx_done_at;
+    uint8_t rx_queue[PERIPHERAL_SIM_RX_QUEUE];
+    uint16_t rx_head;
+    uint16_t rx_count;
+    uint64_t rx_next_at;
+    uint64_t idle_at;
+    bool idle_armed;
+    peripheral_sim_stats_t stats;
+} peripheral_sim_uart_t;
+
+// Device behind one chip select of a SPI bus
+typedef struct {
+    peripheral_sim_device_t device;
+    GPIO_TypeDef *cs_gpio;      // NULL: always selected
+    uint16_t cs_pin;
+    bool selected;
+} peripheral_sim_spi_target_t;
+
+typedef struct {
+    SPI_TypeDef *regs;
+    peripheral_sim_spi_target_t targets[PERIPHERAL_SIM_SPI_TARGETS];
+    uint8_t target_count;
+    peripheral_sim_dma_t *dma_tx;
+    peripheral_sim_dma_t *dma_rx;
+    peripheral_sim_irq_t irq;
+    void *irq_context;
+    uint16_t rx_latch;
+    uint16_t tx_buffer;
+    uint16_t tx_shift;
+    bool tx_buffer_full;
+    bool busy;
+    uint64_t done_at;
+    peripheral_sim_stats_t stats;
+} peripheral_sim_spi_t;
+
+// Square wave driven onto a GPIO input pin
+typedef struct {
+    GPIO_TypeDef *gpio;
+    uint16_t pin;
+    uint64_t period_ns;
+    uint64_t high_ns;
+    uint64_t next_at;           // Next edge
+    uint32_t cycles;            // Periods left (0: stopped)
+    bool level;
+    uint64_t edges;
+} peripheral_sim_wave_t;
+
+struct peripheral_sim {
+    peripheral_sim_config_t config;
+    uint64_t now_ns;            // Virtual time
+    uint64_t events;            // Events processed
+    bool in_irq;
+    hw_backend_t backend;
+
+    peripheral_sim_uart_t uarts[PERIPHERAL_SIM_MAX_UART];
+    peripheral_sim_spi_t spis[PERIPHERAL_SIM_MAX_SPI];
+    GPIO_TypeDef *gpios[PERIPHERAL_SIM_MAX_GPIO];
+    peripheral_sim_irq_t gpio_irq[PERIPHERAL_SIM_MAX_GPIO];  // Edge interrupt per port (EXTI)
+    void *gpio_irq_context[PERIPHERAL_SIM_MAX_GPIO];
+    uint16_t gpio_edges[PERIPHERAL_SIM_MAX_GPIO];            // Pending edge flags
+    peripheral_sim_wave_t waves[PERIPHERAL_SIM_MAX_WAVES];
+    peripheral_sim_dma_t dmas[PERIPHERAL_SIM_MAX_DMA];
+    uint8_t uart_count;
+    uint8_t spi_count;
+    uint8_t gpio_count;
+    uint8_t dma_count;
+    uint8_t wave_count;
+};
+
+// Scripted UART device: waits for each step's request, then replies after
+// the step's latency
+typedef struct {
+    const uint8_t *expect;
+    uint16_t expect_length;
+    const uint8_t *reply;
+    uint16_t reply_length;
+    uint64_t latency_ns;
+} peripheral_sim_script_step_t;
+
+typedef struct {
+    const peripheral_sim_script_step_t *steps;
+    uint16_t step_count;
+    uint16_t step;
+    uint16_t matched;
+    bool loop;                  // Restart at step 0 after the last step
+    uint32_t mismatches;
+} peripheral_sim_script_t;
+
+// SPI register-file device: first byte is the address (bit 7 set = read),
+// following bytes read or write consecutive registers
+#define PERIPHERAL_SIM_REGMAP_SIZE  128
+#define PERIPHERAL_SIM_REGMAP_READ  0x80
+
+typedef struct {
+    uint8_t regs[PERIPHERAL_SIM_REGMAP_SIZE];
+    uint8_t address;
+    bool addressed;
+    bool reading;
+    uint32_t transactions;
+} peripheral_sim_regmap_t;
+
+// Function declarations
+error_t peripheral_sim_init(peripheral_sim_t *sim, const peripheral_sim_config_t *config);
+void peripheral_sim_install(peripheral_sim_t *sim);
+void peripheral_sim_uninstall(void);
+
+error_t peripheral_sim_attach_uart(peripheral_sim_t *sim, USART_TypeDef *uart, const peripheral_sim_device_t *device);
+error_t peripheral_sim_attach_spi(peripheral_sim_t *sim, SPI_TypeDef *spi, GPIO_TypeDef *cs_gpio, uint16_t cs_pin,
+                                  const peripheral_sim_device_t *device);
+error_t peripheral_sim_attach_gpio(peripheral_sim_t *sim, GPIO_TypeDef *gpio);
+error_t peripheral_sim_attach_dma(peripheral_sim_t *sim, DMA_Channel_TypeDef *dma, volatile void *peripheral,
+                                  bool to_peripheral);
+error_t peripheral_sim_set_irq(peripheral_sim_t *sim, volatile void *regs, peripheral_sim_irq_t irq, void *context);
+
+error_t peripheral_sim_gpio_wave(peripheral_sim_t *sim, GPIO_TypeDef *gpio, uint16_t pin, uint64_t period_ns,
+                                 uint64_t high_ns, uint32_t cycles);
+error_t peripheral_sim_uart_inject(peripheral_sim_t *sim, USART_TypeDef *uart, const uint8_t *data,
+                                   uint16_t length, uint64_t delay_ns);
+bool peripheral_sim_step(peripheral_sim_t *sim);
+void peripheral_sim_advance(peripheral_sim_t *sim, uint64_t ns);
+uint64_t peripheral_sim_next_event(const peripheral_sim_t *sim);
+uint64_t peripheral_sim_now(const peripheral_sim_t *sim);
+uint64_t peripheral_sim_clock(void);
+const peripheral_sim_stats_t* peripheral_sim_get_stats(const peripheral_sim_t *sim, volatile void *regs);
+
+uint64_t peripheral_sim_uart_frame_ns(const USART_TypeDef *uart);
+uint64_t peripheral_sim_spi_frame_ns(const peripheral_sim_t *sim, const SPI_TypeDef *spi);
+
+peripheral_sim_device_t peripheral_sim_script_device(peripheral_sim_script_t *script);
+peripheral_sim_device_t peripheral_sim_regmap_device(peripheral_sim_regmap_t *regmap);
+
+#endif // PERIPHERAL_SIM_H
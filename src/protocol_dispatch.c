@@ -0,0 +1,173 @@
+#include "protocol_dispatch.h"
+#include <string.h>
+
+// Internal helpers
+static void dispatch_record(protocol_dispatcher_t *dispatcher, uint8_t command, uint16_t messages,
+                            uint64_t start, protocol_error_t result) {
+    protocol_command_stats_t *stats = &dispatcher->stats[command];
+
+    stats->messages += messages;
+    if (result != PROTOCOL_ERROR_NONE) {
+        stats->errors++;
+    }
+
+    if (dispatcher->clock == NULL) {
+        return;
+    }
+
+    uint64_t elapsed = dispatcher->clock() - start;
+    stats->total_ns += elapsed;
+    latency_hist_record(&stats->latency, elapsed);
+}
+
+static uint64_t dispatch_now(const protocol_dispatcher_t *dispatcher) {
+    return dispatcher->clock ? dispatcher->clock() : 0;
+}
+
+// Dispatcher Functions
+protocol_error_t protocol_dispatch_init(protocol_dispatcher_t *dispatcher, protocol_clock_t clock) {
+    if (dispatcher == NULL) {
+        return PROTOCOL_ERROR_INVALID_HEADER;
+    }
+
+    memset(dispatcher->commands, 0, sizeof(dispatcher->commands));
+    memset(dispatcher->stats, 0, sizeof(dispatcher->stats));
+    dispatcher->clock = clock;
+    dispatcher->unhandled = 0;
+    dispatcher->burst_overflow = 0;
+    dispatcher->burst_count = 0;
+
+    return PROTOCOL_ERROR_NONE;
+}
+
+protocol_error_t protocol_dispatch_register(protocol_dispatcher_t *dispatcher, uint8_t command,
+                                            protocol_handler_t handler, void *context) {
+    if (dispatcher == NULL || handler == NULL || dispatcher->commands[command].batch_handler != NULL) {
+        return PROTOCOL_ERROR_INVALID_HEADER;
+    }
+
+    dispatcher->commands[command].handler = handler;
+    dispatcher->commands[command].context = context;
+
+    return PROTOCOL_ERROR_NONE;
+}
+
+protocol_error_t protocol_dispatch_register_batch(protocol_dispatcher_t *dispatcher, uint8_t command,
+                                                  protocol_batch_handler_t handler, void *context) {
+    if (dispatcher == NULL || handler == NULL || dispatcher->commands[command].handler != NULL) {
+        return PROTOCOL_ERROR_INVALID_HEADER;
+    }
+
+    dispatcher->commands[command].batch_handler = handler;
+    dispatcher->commands[command].batch_context = context;
+
+    return PROTOCOL_ERROR_NONE;
+}
+
+void protocol_dispatch_unregister(protocol_dispatcher_t *dispatcher, uint8_t command) {
+    if (dispatcher == NULL) return;
+
+    memset(&dispatcher->commands[command], 0, sizeof(protocol_command_entry_t));
+}
+
+protocol_error_t protocol_dispatch_message(protocol_dispatcher_t *dispatcher, const protocol_frame_t *frame) {
+    if (dispatcher == NULL || frame == NULL || frame->raw == NULL) {
+        return PROTOCOL_ERROR_INVALID_HEADER;
+    }
+
+    // Single table lookup, no comparison chain
+    const protocol_command_entry_t *entry = &dispatcher->commands[frame->command];
+
+    if (entry->batch_handler != NULL) {
+        if (dispatcher->burst_count == PROTOCOL_DISPATCH_BURST_MAX) {
+            dispatcher->burst_overflow++;
+            protocol_dispatch_flush(dispatcher);
+        }
+
+        // The frame view only lives as long as the framer callback, so
+        // batched messages are staged in the dispatcher
+        uint16_t slot = dispatcher->burst_count++;
+        uint16_t raw_length = frame->raw_length > PROTOCOL_MAX_FRAME ? PROTOCOL_MAX_FRAME : frame->raw_length;
+        memcpy(dispatcher->burst_data[slot], frame->raw, raw_length);
+        dispatcher->burst[slot] = *frame;
+        dispatcher->burst[slot].raw = dispatcher->burst_data[slot];
+        dispatcher->burst[slot].payload = dispatcher->burst_data[slot] + (frame->payload - frame->raw);
+        return PROTOCOL_ERROR_NONE;
+    }
+
+    if (entry->handler == NULL) {
+        dispatcher->unhandled++;
+        return PROTOCOL_ERROR_INVALID_HEADER;
+    }
+
+    uint64_t start = dispatch_now(dispatcher);
+    protocol_error_t result = entry->handler(frame, entry->context);
+    dispatch_record(dispatcher, frame->command, 1, start, result);
+
+    return result;
+}
+
+// Hands every staged message to its batch handler, one call per command
+protocol_error_t protocol_dispatch_flush(protocol_dispatcher_t *dispatcher) {
+    if (dispatcher == NULL) {
+        return PROTOCOL_ERROR_INVALID_HEADER;
+    }
+
+    protocol_frame_t group[PROTOCOL_DISPATCH_BURST_MAX];
+    bool taken[PROTOCOL_DISPATCH_BURST_MAX] = {false};
+    protocol_error_t first_error = PROTOCOL_ERROR_NONE;
+
+    for (uint16_t i = 0; i < dispatcher->burst_count; i++) {
+        if (taken[i]) continue;
+
+        uint8_t command = dispatcher->burst[i].command;
+        uint16_t count = 0;
+
+        // Arrival order is preserved within a command
+        for (uint16_t j = i; j < dispatcher->burst_count; j++) {
+            if (!taken[j] && dispatcher->burst[j].command == command) {
+                group[count++] = dispatcher->burst[j];
+                taken[j] = true;
+            }
+        }
+
+        const protocol_command_entry_t *entry = &dispatcher->commands[command];
+        if (entry->batch_handler == NULL) {
+            dispatcher->unhandled += count;  // Unregistered while staged
+            continue;
+        }
+
+        uint64_t start = dispatch_now(dispatcher);
+        protocol_error_t result = entry->batch_handler(group, count, entry->batch_context);
+        dispatch_record(dispatcher, command, count, start, result);
+        dispatcher->stats[command].batches++;
+
+        if (result != PROTOCOL_ERROR_NONE && first_error == PROTOCOL_ERROR_NONE) {
+            first_error = result;
+        }
+    }
+
+    dispatcher->burst_count = 0;
+
+    return first_error;
+}
+
+// Adapter so a protocol_framer_t can feed the dispatcher directly
+void protocol_dispatch_framer_cb(const protocol_frame_t *frame, void *context) {
+    protocol_dispatch_message((protocol_dispatcher_t*)context, frame);
+}
+
+const protocol_command_stats_t* protocol_dispatch_get_stats(const protocol_dispatcher_t *dispatcher,
+                                                            uint8_t command) {
+    if (dispatcher == NULL) return NULL;
+
+    return &dispatcher->stats[command];
+}
+
+void protocol_dispatch_reset_stats(protocol_dispatcher_t *dispatcher) {
+    if (dispatcher == NULL) return;
+
+    memset(dispatcher->stats, 0, sizeof(dispatcher->stats));
+    dispatcher->unhandled = 0;
+    dispatcher->burst_overflow = 0;
+}
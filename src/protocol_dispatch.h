@@ -0,0 +1,68 @@
+#ifndef PROTOCOL_DISPATCH_H
+#define PROTOCOL_DISPATCH_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "communication_protocols.h"
+#include "protocol_framer.h"
+#include "latency_hist.h"
+
+#define PROTOCOL_COMMAND_COUNT      256
+#define PROTOCOL_DISPATCH_BURST_MAX 64      // Messages held per burst
+
+// Handler for a single message
+typedef protocol_error_t (*protocol_handler_t)(const protocol_frame_t *frame, void *context);
+
+// Handler for every message of one command collected in a burst
+typedef protocol_error_t (*protocol_batch_handler_t)(const protocol_frame_t *frames, uint16_t count,
+                                                     void *context);
+
+// Per-command statistics
+typedef struct {
+    uint32_t messages;
+    uint32_t batches;           // Batch handler invocations
+    uint32_t errors;            // Handler returned an error
+    uint64_t total_ns;
+    latency_hist_t latency;     // Handler time per call; exact max in latency.max_ns
+} protocol_command_stats_t;
+
+// Flat command table entry. A command has either a single or a batch
+// handler: registering the other kind fails until it is unregistered.
+typedef struct {
+    protocol_handler_t handler;
+    protocol_batch_handler_t batch_handler;
+    void *context;
+    void *batch_context;
+} protocol_command_entry_t;
+
+// Dispatcher
+typedef struct {
+    protocol_command_entry_t commands[PROTOCOL_COMMAND_COUNT];
+    protocol_command_stats_t stats[PROTOCOL_COMMAND_COUNT];
+    protocol_clock_t clock;
+    uint32_t unhandled;         // Messages with no registered handler
+    uint32_t burst_overflow;    // Burst full: staged messages flushed early
+
+    // Burst staging: frames copied here until protocol_dispatch_flush
+    uint8_t burst_data[PROTOCOL_DISPATCH_BURST_MAX][PROTOCOL_MAX_FRAME];
+    protocol_frame_t burst[PROTOCOL_DISPATCH_BURST_MAX];
+    uint16_t burst_count;
+} protocol_dispatcher_t;
+
+// Function declarations
+protocol_error_t protocol_dispatch_init(protocol_dispatcher_t *dispatcher, protocol_clock_t clock);
+protocol_error_t protocol_dispatch_register(protocol_dispatcher_t *dispatcher, uint8_t command,
+                                            protocol_handler_t handler, void *context);
+protocol_error_t protocol_dispatch_register_batch(protocol_dispatcher_t *dispatcher, uint8_t command,
+                                                  protocol_batch_handler_t handler, void *context);
+void protocol_dispatch_unregister(protocol_dispatcher_t *dispatcher, uint8_t command);
+
+protocol_error_t protocol_dispatch_message(protocol_dispatcher_t *dispatcher, const protocol_frame_t *frame);
+protocol_error_t protocol_dispatch_flush(protocol_dispatcher_t *dispatcher);
+void protocol_dispatch_framer_cb(const protocol_frame_t *frame, void *context);
+
+const protocol_command_stats_t* protocol_dispatch_get_stats(const protocol_dispatcher_t *dispatcher,
+                                                            uint8_t command);
+void protocol_dispatch_reset_stats(protocol_dispatcher_t *dispatcher);
+
+#endif // PROTOCOL_DISPATCH_H
@@ -0,0 +1,194 @@
+#include "protocol_framer.h"
+#include "protocol_wire.h"
+#include <string.h>
+
+// Internal helpers
+static uint16_t framer_data_length(const uint8_t *raw) {
+    return PROTOCOL_MSG_get_data_length(raw);
+}
+
+static bool framer_crc_ok(const uint8_t *raw, uint16_t data_length) {
+    return protocol_calculate_crc(raw, PROTOCOL_HEADER_SIZE + data_length) == PROTOCOL_MSG_get_crc(raw);
+}
+
+static void framer_emit(protocol_framer_t *framer, const uint8_t *raw, uint16_t data_length, bool zero_copy) {
+    protocol_frame_t frame;
+
+    framer->state = PROTOCOL_STATE_PROCESSING;
+
+    frame.command = PROTOCOL_MSG_get_command(raw);
+    frame.data_length = data_length;
+    frame.payload = raw + PROTOCOL_HEADER_SIZE;
+    frame.raw = raw;
+    frame.raw_length = PROTOCOL_HEADER_SIZE + data_length + PROTOCOL_CRC_SIZE;
+
+    framer->stats.messages++;
+    if (zero_copy) {
+        framer->stats.zero_copy++;
+    }
+
+    if (framer->message_cb) {
+        framer->message_cb(&frame, framer->callback_context);
+    }
+
+    framer->state = PROTOCOL_STATE_COMPLETE;
+    framer->last_error = PROTOCOL_ERROR_NONE;
+}
+
+static void framer_reject(protocol_framer_t *framer, protocol_error_t err) {
+    framer->state = PROTOCOL_STATE_ERROR;
+    framer->last_error = err;
+    framer->stats.resync_events++;
+    if (err == PROTOCOL_ERROR_CRC_MISMATCH) {
+        framer->stats.crc_errors++;
+    } else {
+        framer->stats.length_errors++;
+    }
+}
+
+// Discard buffered bytes up to the next header byte at or after 'from'
+static void framer_hunt_buffer(protocol_framer_t *framer, uint16_t from) {
+    const uint8_t *next = NULL;
+    if (framer->buffered > from) {
+        next = (const uint8_t*)memchr(framer->buffer + from, PROTOCOL_HEADER_BYTE,
+                                      framer->buffered - from);
+    }
+
+    if (next == NULL) {
+        framer->stats.discarded_bytes += framer->buffered;
+        framer->buffered = 0;
+        return;
+    }
+
+    uint16_t skip = (uint16_t)(next - framer->buffer);
+    framer->stats.discarded_bytes += skip;
+    framer->buffered -= skip;
+    memmove(framer->buffer, next, framer->buffered);
+}
+
+// Process whatever is in the assembly buffer until more input is needed
+static void framer_process_buffer(protocol_framer_t *framer) {
+    while (framer->buffered >= PROTOCOL_HEADER_SIZE) {
+        uint16_t data_length = framer_data_length(framer->buffer);
+        if (data_length > PROTOCOL_MAX_PAYLOAD) {
+            framer_reject(framer, PROTOCOL_ERROR_BUFFER_OVERFLOW);
+            framer_hunt_buffer(framer, 1);
+            continue;
+        }
+
+        uint16_t total = PROTOCOL_HEADER_SIZE + data_length + PROTOCOL_CRC_SIZE;
+        if (framer->buffered < total) {
+            return;
+        }
+
+        if (framer_crc_ok(framer->buffer, data_length)) {
+            framer_emit(framer, framer->buffer, data_length, false);
+            framer->buffered -= total;
+            memmove(framer->buffer, framer->buffer + total, framer->buffered);
+            framer_hunt_buffer(framer, 0);
+        } else {
+            // Rescan from the byte after the rejected header
+            framer_reject(framer, PROTOCOL_ERROR_CRC_MISMATCH);
+            framer_hunt_buffer(framer, 1);
+        }
+    }
+}
+
+// Framer Functions
+protocol_error_t protocol_framer_init(protocol_framer_t *framer,
+                                      void (*message_cb)(const protocol_frame_t *frame, void *context),
+                                      void *context) {
+    if (framer == NULL) {
+        return PROTOCOL_ERROR_INVALID_HEADER;
+    }
+
+    memset(framer, 0, sizeof(protocol_framer_t));
+    framer->state = PROTOCOL_STATE_IDLE;
+    framer->message_cb = message_cb;
+    framer->callback_context = context;
+
+    return PROTOCOL_ERROR_NONE;
+}
+
+void protocol_framer_reset(protocol_framer_t *framer) {
+    if (framer == NULL) return;
+
+    framer->buffered = 0;
+    framer->state = PROTOCOL_STATE_IDLE;
+    framer->last_error = PROTOCOL_ERROR_NONE;
+}
+
+protocol_error_t protocol_framer_feed(protocol_framer_t *framer, const uint8_t *data, uint32_t length) {
+    if (framer == NULL || (data == NULL && length > 0)) {
+        return PROTOCOL_ERROR_INVALID_HEADER;
+    }
+
+    const uint8_t *p = data;
+    const uint8_t *end = data + length;
+
+    framer->stats.bytes_received += length;
+
+    while (p < end) {
+        // Slow path: finish a frame that started in an earlier chunk
+        if (framer->buffered > 0) {
+            uint16_t need;
+            if (framer->buffered < PROTOCOL_HEADER_SIZE) {
+                need = PROTOCOL_HEADER_SIZE - framer->buffered;
+            } else {
+                need = PROTOCOL_HEADER_SIZE + framer_data_length(framer->buffer) +
+                       PROTOCOL_CRC_SIZE - framer->buffered;
+            }
+
+            uint32_t take = (uint32_t)(end - p) < need ? (uint32_t)(end - p) : need;
+            memcpy(framer->buffer + framer->buffered, p, take);
+            framer->buffered += (uint16_t)take;
+            p += take;
+
+            framer_process_buffer(framer);
+            continue;
+        }
+
+        // Fast path: hunt for the header (memchr is vectorised in libc)
+        const uint8_t *header = (const uint8_t*)memchr(p, PROTOCOL_HEADER_BYTE, (size_t)(end - p));
+        if (header == NULL) {
+            framer->stats.discarded_bytes += (uint32_t)(end - p);
+            break;
+        }
+        framer->stats.discarded_bytes += (uint32_t)(header - p);
+        p = header;
+
+        uint32_t available = (uint32_t)(end - p);
+        if (available < PROTOCOL_HEADER_SIZE) {
+            memcpy(framer->buffer, p, available);
+            framer->buffered = (uint16_t)available;
+            break;
+        }
+
+        uint16_t data_length = framer_data_length(p);
+        if (data_length > PROTOCOL_MAX_PAYLOAD) {
+            framer_reject(framer, PROTOCOL_ERROR_BUFFER_OVERFLOW);
+            p++;
+            continue;
+        }
+
+        uint16_t total = PROTOCOL_HEADER_SIZE + data_length + PROTOCOL_CRC_SIZE;
+        if (available < total) {
+            memcpy(framer->buffer, p, available);
+            framer->buffered = (uint16_t)available;
+            break;
+        }
+
+        // Whole frame is in the caller's chunk: verify and emit in place
+        if (framer_crc_ok(p, data_length)) {
+            framer_emit(framer, p, data_length, true);
+            p += total;
+        } else {
+            framer_reject(framer, PROTOCOL_ERROR_CRC_MISMATCH);
+            p++;
+        }
+    }
+
+    framer->state = (framer->buffered > 0) ? PROTOCOL_STATE_RECEIVING : PROTOCOL_STATE_IDLE;
+
+    return PROTOCOL_ERROR_NONE;
+}
@@ -0,0 +1,55 @@
+#ifndef PROTOCOL_FRAMER_H
+#define PROTOCOL_FRAMER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "communication_protocols.h"
+
+// Stream layout: header(0xAA) command length(2, LE) payload[length] crc(2, LE)
+#define PROTOCOL_HEADER_BYTE     0xAA
+#define PROTOCOL_HEADER_SIZE     4
+#define PROTOCOL_CRC_SIZE        2
+#define PROTOCOL_MAX_PAYLOAD     256
+#define PROTOCOL_MAX_FRAME       (PROTOCOL_HEADER_SIZE + PROTOCOL_MAX_PAYLOAD + PROTOCOL_CRC_SIZE)
+
+// Verified message view. Points into the caller's chunk when the message
+// arrived in one piece, otherwise into the framer's assembly buffer; valid
+// only for the duration of the callback.
+typedef struct {
+    uint8_t command;
+    uint16_t data_length;
+    const uint8_t *payload;
+    const uint8_t *raw;         // Whole frame starting at the header byte
+    uint16_t raw_length;
+} protocol_frame_t;
+
+// Framer statistics
+typedef struct {
+    uint32_t bytes_received;
+    uint32_t messages;          // CRC-verified messages emitted
+    uint32_t zero_copy;         // Messages emitted straight from the input chunk
+    uint32_t resync_events;     // Times the framer dropped a candidate and rescanned
+    uint32_t crc_errors;
+    uint32_t length_errors;
+    uint32_t discarded_bytes;   // Bytes skipped while hunting for a header
+} protocol_framer_stats_t;
+
+// Incremental framer
+typedef struct {
+    protocol_state_t state;
+    protocol_error_t last_error;
+    uint8_t buffer[PROTOCOL_MAX_FRAME];  // Assembly buffer for split frames
+    uint16_t buffered;
+    void (*message_cb)(const protocol_frame_t *frame, void *context);
+    void *callback_context;
+    protocol_framer_stats_t stats;
+} protocol_framer_t;
+
+// Function declarations
+protocol_error_t protocol_framer_init(protocol_framer_t *framer,
+                                      void (*message_cb)(const protocol_frame_t *frame, void *context),
+                                      void *context);
+void protocol_framer_reset(protocol_framer_t *framer);
+protocol_error_t protocol_framer_feed(protocol_framer_t *framer, const uint8_t *data, uint32_t length);
+
+#endif // PROTOCOL_FRAMER_H
@@ -0,0 +1,321 @@
+#include "protocol_window.h"
+#include "protocol_wire.h"
+#include <string.h>
+
+// Internal helpers
+static uint16_t window_encode(uint8_t *buf, uint8_t command, const uint8_t *link, uint16_t link_length,
+                              const uint8_t *data, uint16_t length) {
+    uint16_t payload_length = link_length + length;
+
+    PROTOCOL_MSG_set_header(buf, PROTOCOL_HEADER_BYTE);
+    PROTOCOL_MSG_set_command(buf, command);
+    PROTOCOL_MSG_set_data_length(buf, payload_length);
+
+    // Header, link header and data checksummed as they are written
+    uint16_t crc = protocol_crc_update(0xFFFF, buf, PROTOCOL_HEADER_SIZE);
+    crc = protocol_crc_copy(crc, buf + PROTOCOL_HEADER_SIZE, link, link_length);
+    if (length > 0) {
+        crc = protocol_crc_copy(crc, buf + PROTOCOL_HEADER_SIZE + link_length, data, length);
+    }
+    protocol_wire_store_le16(buf + PROTOCOL_HEADER_SIZE + payload_length, crc);
+
+    return PROTOCOL_HEADER_SIZE + payload_length + PROTOCOL_CRC_SIZE;
+}
+
+static void window_send_control(protocol_window_t *win, uint8_t command) {
+    uint8_t link[PROTOCOL_ACK_SIZE];
+    uint8_t buf[PROTOCOL_HEADER_SIZE + PROTOCOL_ACK_SIZE + PROTOCOL_CRC_SIZE];
+
+    PROTOCOL_ACK_set_cumulative(link, win->recv_base);
+    PROTOCOL_ACK_set_bitmap(link, win->recv_bitmap);
+
+    uint16_t length = window_encode(buf, command, link, sizeof(link), NULL, 0);
+    win->config.tx(buf, length, win->config.tx_context);
+
+    if (command == PROTOCOL_WINDOW_CMD_NACK) {
+        win->stats.nacks_sent++;
+    } else {
+        win->stats.acks_sent++;
+    }
+}
+
+static void window_transmit_slot(protocol_window_t *win, protocol_window_slot_t *slot) {
+    slot->sent_at = win->config.clock();
+    win->config.tx(slot->frame, slot->length, win->config.tx_context);
+}
+
+// Release acknowledged frames at the bottom of the send window
+static void window_slide(protocol_window_t *win) {
+    while (win->send_base != win->next_seq) {
+        protocol_window_slot_t *slot = &win->tx_slots[win->send_base % PROTOCOL_WINDOW_MAX];
+        if (!slot->acked) {
+            break;
+        }
+        slot->in_use = false;
+        win->send_base++;
+    }
+}
+
+static void window_handle_ack(protocol_window_t *win, const protocol_frame_t *frame, bool nack) {
+    uint8_t cumulative = PROTOCOL_ACK_get_cumulative(frame->payload);
+    uint32_t bitmap = PROTOCOL_ACK_get_bitmap(frame->payload);
+
+    if (nack) {
+        win->stats.nacks_received++;
+    } else {
+        win->stats.acks_received++;
+    }
+
+    for (uint8_t seq = win->send_base; seq != win->next_seq; seq++) {
+        protocol_window_slot_t *slot = &win->tx_slots[seq % PROTOCOL_WINDOW_MAX];
+        int8_t ahead = (int8_t)(seq - cumulative);
+
+        if (ahead < 0) {
+            slot->acked = true;  // Covered by the cumulative ACK
+        } else if (ahead >= 1 && ahead <= 32 && (bitmap & (1U << (ahead - 1)))) {
+            slot->acked = true;  // Selectively acknowledged
+        }
+    }
+
+    // NACK names the frame the receiver is stuck on: resend it now
+    if (nack) {
+        protocol_window_slot_t *slot = &win->tx_slots[cumulative % PROTOCOL_WINDOW_MAX];
+        if (slot->in_use && !slot->acked && slot->seq == cumulative) {
+            slot->retries++;
+            win->stats.retransmits++;
+            window_transmit_slot(win, slot);
+        }
+    }
+
+    window_slide(win);
+}
+
+static void window_deliver(protocol_window_t *win, const uint8_t *raw) {
+    protocol_frame_t frame;
+    uint16_t payload_length = PROTOCOL_MSG_get_data_length(raw);
+
+    frame.command = PROTOCOL_MSG_get_command(raw);
+    frame.data_length = payload_length - PROTOCOL_WINDOW_LINK_HEADER;
+    frame.payload = raw + PROTOCOL_HEADER_SIZE + PROTOCOL_WINDOW_LINK_HEADER;
+    frame.raw = raw;
+    frame.raw_length = PROTOCOL_HEADER_SIZE + payload_length + PROTOCOL_CRC_SIZE;
+
+    win->stats.delivered++;
+    if (win->config.deliver_cb) {
+        win->config.deliver_cb(&frame, win->config.deliver_context);
+    }
+}
+
+static void window_handle_data(protocol_window_t *win, const protocol_frame_t *frame) {
+    uint8_t seq = frame->payload[0];
+    uint8_t offset = (uint8_t)(seq - win->recv_base);
+
+    // Behind the window (already delivered) or beyond it: re-ACK so the
+    // sender learns where we are
+    if (offset >= win->config.window_size) {
+        win->stats.duplicates++;
+        window_send_control(win, PROTOCOL_WINDOW_CMD_ACK);
+        return;
+    }
+
+    if (offset == 0) {
+        window_deliver(win, frame->raw);
+        win->recv_base++;
+
+        // Drain frames that were waiting on this one
+        while (win->recv_bitmap & 1U) {
+            win->recv_bitmap >>= 1;
+            protocol_window_slot_t *slot = &win->rx_slots[win->recv_base % PROTOCOL_WINDOW_MAX];
+            window_deliver(win, slot->frame);
+            slot->in_use = false;
+            win->recv_base++;
+        }
+        win->recv_bitmap >>= 1;
+        win->nack_pending = false;
+
+        window_send_control(win, PROTOCOL_WINDOW_CMD_ACK);
+        return;
+    }
+
+    uint32_t bit = 1U << (offset - 1);
+    if (win->recv_bitmap & bit) {
+        win->stats.duplicates++;
+    } else {
+        protocol_window_slot_t *slot = &win->rx_slots[seq % PROTOCOL_WINDOW_MAX];
+        memcpy(slot->frame, frame->raw, frame->raw_length);
+        slot->length = frame->raw_length;
+        slot->seq = seq;
+        slot->in_use = true;
+        win->recv_bitmap |= bit;
+        win->stats.out_of_order++;
+    }
+
+    // One NACK per gap; later arrivals only refresh the selective ACK
+    if (!win->nack_pending || win->last_nack != win->recv_base) {
+        win->nack_pending = true;
+        win->last_nack = win->recv_base;
+        window_send_control(win, PROTOCOL_WINDOW_CMD_NACK);
+    } else {
+        window_send_control(win, PROTOCOL_WINDOW_CMD_ACK);
+    }
+}
+
+static void window_framer_cb(const protocol_frame_t *frame, void *context) {
+    protocol_window_t *win = (protocol_window_t*)context;
+
+    if ((frame->command == PROTOCOL_WINDOW_CMD_ACK || frame->command == PROTOCOL_WINDOW_CMD_NACK) &&
+        frame->data_length == PROTOCOL_ACK_SIZE) {
+        window_handle_ack(win, frame, frame->command == PROTOCOL_WINDOW_CMD_NACK);
+    } else if (frame->data_length >= PROTOCOL_WINDOW_LINK_HEADER) {
+        window_handle_data(win, frame);
+    }
+}
+
+// Window Functions
+protocol_error_t protocol_window_init(protocol_window_t *win, const protocol_window_config_t *config) {
+    if (win == NULL || config == NULL || config->tx == NULL || config->clock == NULL ||
+        config->window_size == 0 || config->window_size > PROTOCOL_WINDOW_MAX) {
+        return PROTOCOL_ERROR_INVALID_HEADER;
+    }
+
+    memset(win, 0, sizeof(protocol_window_t));
+    win->config = *config;
+    win->state = PROTOCOL_STATE_IDLE;
+
+    return protocol_framer_init(&win->framer, window_framer_cb, win);
+}
+
+protocol_error_t protocol_window_send(protocol_window_t *win, uint8_t command, const uint8_t *data, uint16_t length) {
+    if (win == NULL || (data == NULL && length > 0) ||
+        command == PROTOCOL_WINDOW_CMD_ACK || command == PROTOCOL_WINDOW_CMD_NACK) {
+        return PROTOCOL_ERROR_INVALID_HEADER;
+    }
+
+    if (win->state == PROTOCOL_STATE_ERROR) {
+        return PROTOCOL_ERROR_TIMEOUT;  // Link failed; re-initialise both ends
+    }
+
+    if (length > PROTOCOL_WINDOW_MAX_DATA ||
+        (uint8_t)(win->next_seq - win->send_base) >= win->config.window_size) {
+        return PROTOCOL_ERROR_BUFFER_OVERFLOW;  // Window full: caller retries later
+    }
+
+    uint8_t seq = win->next_seq++;
+    protocol_window_slot_t *slot = &win->tx_slots[seq % PROTOCOL_WINDOW_MAX];
+
+    slot->in_use = true;
+    slot->acked = false;
+    slot->seq = seq;
+    slot->retries = 0;
+    slot->length = window_encode(slot->frame, command, &seq, PROTOCOL_WINDOW_LINK_HEADER, data, length);
+
+    win->state = PROTOCOL_STATE_PROCESSING;
+    win->stats.data_sent++;
+    window_transmit_slot(win, slot);
+
+    return PROTOCOL_ERROR_NONE;
+}
+
+protocol_error_t protocol_window_receive_bytes(protocol_window_t *win, const uint8_t *data, uint32_t length) {
+    if (win == NULL) {
+        return PROTOCOL_ERROR_INVALID_HEADER;
+    }
+
+    return protocol_framer_feed(&win->framer, data, length);
+}
+
+// Retransmits frames whose timer expired; call periodically or at
+// protocol_window_next_deadline
+protocol_error_t protocol_window_service(protocol_window_t *win) {
+    if (win == NULL) {
+        return PROTOCOL_ERROR_INVALID_HEADER;
+    }
+
+    if (win->state == PROTOCOL_STATE_ERROR) {
+        return PROTOCOL_ERROR_TIMEOUT;
+    }
+
+    uint64_t now = win->config.clock();
+
+    for (uint8_t seq = win->send_base; seq != win->next_seq; seq++) {
+        protocol_window_slot_t *slot = &win->tx_slots[seq % PROTOCOL_WINDOW_MAX];
+        if (slot->acked || now - slot->sent_at < win->config.rto_ns) {
+            continue;
+        }
+
+        if (slot->retries >= win->config.max_retries) {
+            win->stats.dropped++;
+            win->state = PROTOCOL_STATE_ERROR;
+            return PROTOCOL_ERROR_TIMEOUT;
+        }
+
+        slot->retries++;
+        win->stats.timeouts++;
+        win->stats.retransmits++;
+        window_transmit_slot(win, slot);
+    }
+
+    if (win->send_base == win->next_seq) {
+        win->state = PROTOCOL_STATE_IDLE;
+    }
+
+    return PROTOCOL_ERROR_NONE;
+}
+
+uint8_t protocol_window_in_flight(const protocol_window_t *win) {
+    if (win == NULL) return 0;
+
+    return (uint8_t)(win->next_seq - win->send_base);
+}
+
+// Earliest retransmit deadline, UINT64_MAX when nothing is outstanding
+uint64_t protocol_window_next_deadline(const protocol_window_t *win) {
+    uint64_t deadline = UINT64_MAX;
+
+    if (win == NULL) return deadline;
+
+    for (uint8_t seq = win->send_base; seq != win->next_seq; seq++) {
+        const protocol_window_slot_t *slot = &win->tx_slots[seq % PROTOCOL_WINDOW_MAX];
+        if (!slot->acked && slot->sent_at + win->config.rto_ns < deadline) {
+            deadline = slot->sent_at + win->config.rto_ns;
+        }
+    }
+
+    return deadline;
+}
+
+// UART transport adapters
+protocol_error_t protocol_window_uart_tx(const uint8_t *data, uint16_t length, void *context) {
+    error_t err = uart_driver_transmit((uart_driver_t*)context, data, length);
+
+    if (err == ERROR_NONE) {
+        return PROTOCOL_ERROR_NONE;
+    }
+    return (err == ERROR_TIMEOUT) ? PROTOCOL_ERROR_TIMEOUT : PROTOCOL_ERROR_INVALID_HEADER;
+}
+
+// Drains every byte the UART already holds into the window's framer
+protocol_error_t protocol_window_poll_uart(protocol_window_t *win, uart_driver_t *driver) {
+    if (win == NULL || driver == NULL || driver->uart == NULL) {
+        return PROTOCOL_ERROR_INVALID_HEADER;
+    }
+
+    uint8_t chunk[64];
+    uint32_t count = 0;
+
+    while (driver->uart->SR & USART_SR_RXNE) {
+        if (uart_driver_receive(driver, &chunk[count], 1) != ERROR_NONE) {
+            break;
+        }
+        if (++count == sizeof(chunk)) {
+            protocol_framer_feed(&win->framer, chunk, count);
+            count = 0;
+        }
+    }
+
+    if (count > 0) {
+        protocol_framer_feed(&win->framer, chunk, count);
+    }
+
+    return protocol_window_service(win);
+}
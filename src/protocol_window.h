@@ -0,0 +1,95 @@
+#ifndef PROTOCOL_WINDOW_H
+#define PROTOCOL_WINDOW_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "communication_protocols.h"
+#include "protocol_framer.h"
+#include "device_drivers.h"
+
+// Windowed (pipelined) mode for the UART protocol.
+// Data frames are ordinary protocol messages whose payload starts with a
+// one-byte link header carrying the sequence number. ACK and NACK are
+// reserved commands whose payload is the cumulative ACK (next expected
+// sequence) followed by a 32-bit selective-ACK bitmap of frames received
+// beyond it.
+#define PROTOCOL_WINDOW_MAX             32
+#define PROTOCOL_WINDOW_LINK_HEADER     1
+#define PROTOCOL_WINDOW_MAX_DATA        (PROTOCOL_MAX_PAYLOAD - PROTOCOL_WINDOW_LINK_HEADER)
+#define PROTOCOL_WINDOW_CMD_NACK        0xFD
+#define PROTOCOL_WINDOW_CMD_ACK         0xFE
+
+// Byte transport (e.g. protocol_window_uart_tx)
+typedef protocol_error_t (*protocol_window_tx_t)(const uint8_t *data, uint16_t length, void *context);
+
+// Configuration
+typedef struct {
+    uint8_t window_size;        // Frames in flight (1 = stop-and-wait)
+    uint64_t rto_ns;            // Retransmit timeout
+    uint8_t max_retries;        // Retransmissions before the frame is dropped
+    protocol_clock_t clock;     // Monotonic clock
+    protocol_window_tx_t tx;
+    void *tx_context;
+    void (*deliver_cb)(const protocol_frame_t *frame, void *context);  // In-order delivery
+    void *deliver_context;
+} protocol_window_config_t;
+
+// One buffered frame (transmit or out-of-order receive)
+typedef struct {
+    bool in_use;
+    bool acked;
+    uint8_t seq;
+    uint8_t retries;
+    uint64_t sent_at;
+    uint16_t length;            // Encoded frame length
+    uint8_t frame[PROTOCOL_MAX_FRAME];
+} protocol_window_slot_t;
+
+// Link statistics
+typedef struct {
+    uint32_t data_sent;
+    uint32_t retransmits;
+    uint32_t timeouts;
+    uint32_t acks_sent;
+    uint32_t nacks_sent;
+    uint32_t acks_received;
+    uint32_t nacks_received;
+    uint32_t delivered;
+    uint32_t duplicates;
+    uint32_t out_of_order;
+    uint32_t dropped;           // Frames given up after max_retries (link enters ERROR)
+} protocol_window_stats_t;
+
+// Windowed link endpoint
+typedef struct {
+    protocol_window_config_t config;
+    protocol_state_t state;
+    protocol_framer_t framer;
+
+    // Sender
+    protocol_window_slot_t tx_slots[PROTOCOL_WINDOW_MAX];
+    uint8_t send_base;          // Oldest unacknowledged sequence
+    uint8_t next_seq;
+
+    // Receiver
+    protocol_window_slot_t rx_slots[PROTOCOL_WINDOW_MAX];
+    uint8_t recv_base;          // Next sequence to deliver
+    uint32_t recv_bitmap;       // Bit i: recv_base + 1 + i is buffered
+    uint8_t last_nack;
+    bool nack_pending;
+
+    protocol_window_stats_t stats;
+} protocol_window_t;
+
+// Function declarations
+protocol_error_t protocol_window_init(protocol_window_t *win, const protocol_window_config_t *config);
+protocol_error_t protocol_window_send(protocol_window_t *win, uint8_t command, const uint8_t *data, uint16_t length);
+protocol_error_t protocol_window_receive_bytes(protocol_window_t *win, const uint8_t *data, uint32_t length);
+protocol_error_t protocol_window_service(protocol_window_t *win);
+uint8_t protocol_window_in_flight(const protocol_window_t *win);
+uint64_t protocol_window_next_deadline(const protocol_window_t *win);
+
+protocol_error_t protocol_window_uart_tx(const uint8_t *data, uint16_t length, void *context);
+protocol_error_t protocol_window_poll_uart(protocol_window_t *win, uart_driver_t *driver);
+
+#endif // PROTOCOL_WINDOW_H
@@ -0,0 +1,130 @@
+#ifndef PROTOCOL_WIRE_H
+#define PROTOCOL_WIRE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include "communication_protocols.h"
+#include "protocol_framer.h"
+
+// Explicit byte-order loads and stores on wire buffers
+static inline uint8_t protocol_wire_load_u8(const uint8_t *p) { return p[0]; }
+static inline uint16_t protocol_wire_load_le16(const uint8_t *p) { return (uint16_t)(p[0] | (p[1] << 8)); }
+static inline uint16_t protocol_wire_load_be16(const uint8_t *p) { return (uint16_t)((p[0] << 8) | p[1]); }
+static inline uint32_t protocol_wire_load_le32(const uint8_t *p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+static inline uint32_t protocol_wire_load_be32(const uint8_t *p) {
+    return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | (uint32_t)p[3];
+}
+
+static inline void protocol_wire_store_u8(uint8_t *p, uint8_t v) { p[0] = v; }
+static inline void protocol_wire_store_le16(uint8_t *p, uint16_t v) { p[0] = (uint8_t)v; p[1] = (uint8_t)(v >> 8); }
+static inline void protocol_wire_store_be16(uint8_t *p, uint16_t v) { p[0] = (uint8_t)(v >> 8); p[1] = (uint8_t)v; }
+static inline void protocol_wire_store_le32(uint8_t *p, uint32_t v) {
+    p[0] = (uint8_t)v; p[1] = (uint8_t)(v >> 8); p[2] = (uint8_t)(v >> 16); p[3] = (uint8_t)(v >> 24);
+}
+static inline void protocol_wire_store_be32(uint8_t *p, uint32_t v) {
+    p[0] = (uint8_t)(v >> 24); p[1] = (uint8_t)(v >> 16); p[2] = (uint8_t)(v >> 8); p[3] = (uint8_t)v;
+}
+
+#define PROTOCOL_WIRE_CTYPE_u8      uint8_t
+#define PROTOCOL_WIRE_CTYPE_le16    uint16_t
+#define PROTOCOL_WIRE_CTYPE_be16    uint16_t
+#define PROTOCOL_WIRE_CTYPE_le32    uint32_t
+#define PROTOCOL_WIRE_CTYPE_be32    uint32_t
+#define PROTOCOL_WIRE_SIZE_u8       1
+#define PROTOCOL_WIRE_SIZE_le16     2
+#define PROTOCOL_WIRE_SIZE_be16     2
+#define PROTOCOL_WIRE_SIZE_le32     4
+#define PROTOCOL_WIRE_SIZE_be32     4
+
+// Schema expansion: each X(name, type, offset) entry yields
+//   <prefix>_get_<name>(const uint8_t *wire)
+//   <prefix>_set_<name>(uint8_t *wire, value)
+// and a compile-time check that the field fits inside <prefix>_SIZE.
+#define PROTOCOL_WIRE_ACCESSORS(prefix, name, type, offset)                                          \
+    typedef char prefix##_##name##_fits[((offset) + PROTOCOL_WIRE_SIZE_##type <= prefix##_SIZE) ? 1 : -1]; \
+    static inline PROTOCOL_WIRE_CTYPE_##type prefix##_get_##name(const uint8_t *wire) {             \
+        return protocol_wire_load_##type(wire + (offset));                                          \
+    }                                                                                                \
+    static inline void prefix##_set_##name(uint8_t *wire, PROTOCOL_WIRE_CTYPE_##type value) {       \
+        protocol_wire_store_##type(wire + (offset), value);                                          \
+    }
+
+// UART protocol message header: header command length(LE)
+#define PROTOCOL_MSG_SIZE   PROTOCOL_HEADER_SIZE
+#define PROTOCOL_MSG_SCHEMA(X)                  \
+    X(PROTOCOL_MSG, header,      u8,   0)       \
+    X(PROTOCOL_MSG, command,     u8,   1)       \
+    X(PROTOCOL_MSG, data_length, le16, 2)
+
+// Windowed-mode ACK/NACK payload: cumulative ACK, selective-ACK bitmap (LE)
+#define PROTOCOL_ACK_SIZE   5
+#define PROTOCOL_ACK_SCHEMA(X)                  \
+    X(PROTOCOL_ACK, cumulative,  u8,   0)       \
+    X(PROTOCOL_ACK, bitmap,      le32, 1)
+
+#define PROTOCOL_WIRE_EXPAND(prefix, name, type, offset) PROTOCOL_WIRE_ACCESSORS(prefix, name, type, offset)
+PROTOCOL_MSG_SCHEMA(PROTOCOL_WIRE_EXPAND)
+PROTOCOL_ACK_SCHEMA(PROTOCOL_WIRE_EXPAND)
+#undef PROTOCOL_WIRE_EXPAND
+
+// CRC trailer follows the payload (not the fixed offset of protocol_message_t)
+static inline uint16_t PROTOCOL_MSG_get_crc(const uint8_t *wire) {
+    return protocol_wire_load_le16(wire + PROTOCOL_HEADER_SIZE + PROTOCOL_MSG_get_data_length(wire));
+}
+
+// Encodes header, payload and CRC in a single pass over the output buffer
+static inline protocol_error_t protocol_wire_encode(uint8_t *wire, uint16_t capacity, uint8_t command,
+                                                    const uint8_t *payload, uint16_t length,
+                                                    uint16_t *wire_length) {
+    uint16_t total = PROTOCOL_HEADER_SIZE + length + PROTOCOL_CRC_SIZE;
+
+    if (wire == NULL || wire_length == NULL || (payload == NULL && length > 0)) {
+        return PROTOCOL_ERROR_INVALID_HEADER;
+    }
+    if (length > PROTOCOL_MAX_PAYLOAD || total > capacity) {
+        return PROTOCOL_ERROR_BUFFER_OVERFLOW;
+    }
+
+    PROTOCOL_MSG_set_header(wire, PROTOCOL_HEADER_BYTE);
+    PROTOCOL_MSG_set_command(wire, command);
+    PROTOCOL_MSG_set_data_length(wire, length);
+
+    uint16_t crc = protocol_crc_update(0xFFFF, wire, PROTOCOL_HEADER_SIZE);
+    crc = protocol_crc_copy(crc, wire + PROTOCOL_HEADER_SIZE, payload, length);
+    protocol_wire_store_le16(wire + PROTOCOL_HEADER_SIZE + length, crc);
+
+    *wire_length = total;
+    return PROTOCOL_ERROR_NONE;
+}
+
+// Validates a message in place and returns a view into the wire buffer
+static inline protocol_error_t protocol_wire_decode(const uint8_t *wire, uint16_t length,
+                                                    protocol_frame_t *frame) {
+    if (wire == NULL || frame == NULL || length < PROTOCOL_HEADER_SIZE + PROTOCOL_CRC_SIZE ||
+        PROTOCOL_MSG_get_header(wire) != PROTOCOL_HEADER_BYTE) {
+        return PROTOCOL_ERROR_INVALID_HEADER;
+    }
+
+    uint16_t data_length = PROTOCOL_MSG_get_data_length(wire);
+    if (data_length > PROTOCOL_MAX_PAYLOAD ||
+        length < PROTOCOL_HEADER_SIZE + data_length + PROTOCOL_CRC_SIZE) {
+        return PROTOCOL_ERROR_BUFFER_OVERFLOW;
+    }
+
+    if (protocol_calculate_crc(wire, PROTOCOL_HEADER_SIZE + data_length) != PROTOCOL_MSG_get_crc(wire)) {
+        return PROTOCOL_ERROR_CRC_MISMATCH;
+    }
+
+    frame->command = PROTOCOL_MSG_get_command(wire);
+    frame->data_length = data_length;
+    frame->payload = wire + PROTOCOL_HEADER_SIZE;
+    frame->raw = wire;
+    frame->raw_length = PROTOCOL_HEADER_SIZE + data_length + PROTOCOL_CRC_SIZE;
+
+    return PROTOCOL_ERROR_NONE;
+}
+
+#endif // PROTOCOL_WIRE_H
@@ -0,0 +1,404 @@
+#include "prp_hsr.h"
+#include "timebase.h"
+#include <string.h>
+
+#define PRP_NODE_VALID  (1ULL << 48)
+
+// Internal helpers
+static uint32_t prp_popcount64(uint64_t value) {
+#if defined(__GNUC__)
+    return (uint32_t)__builtin_popcountll(value);
+#else
+    uint32_t count = 0;
+    while (value) {
+        value &= value - 1;
+        count++;
+    }
+    return count;
+#endif
+}
+
+static uint64_t prp_mac_key(const uint8_t mac[6]) {
+    uint64_t key = 0;
+    for (int i = 0; i < 6; i++) {
+        key = (key << 8) | mac[i];
+    }
+    return key | PRP_NODE_VALID;
+}
+
+static uint32_t prp_hash(uint64_t key, uint32_t mask) {
+    // Fibonacci hashing spreads sequential vendor MACs across the table
+    return (uint32_t)((key * 0x9E3779B97F4A7C15ULL) >> 32) & mask;
+}
+
+static bool prp_node_stale(const prp_discard_t *dd, const prp_node_t *node, uint64_t now) {
+    return now > node->last_seen_ns && now - node->last_seen_ns > dd->forget_ns;
+}
+
+// A silent source found on the probe chain is forgotten: either the sender
+// itself returning (its window starts over) or a slot the new key takes over
+static prp_node_t* prp_lookup(prp_discard_t *dd, uint64_t key, uint64_t now, bool *created) {
+    uint32_t slot = prp_hash(key, dd->mask);
+    prp_node_t *stale = NULL;
+
+    *created = false;
+    while (dd->nodes[slot].key != 0) {
+        prp_node_t *node = &dd->nodes[slot];
+        if (node->key == key) {
+            if (prp_node_stale(dd, node, now)) {
+                dd->forgotten++;
+                *created = true;
+            }
+            return node;
+        }
+        if (stale == NULL && prp_node_stale(dd, node, now)) {
+            stale = node;
+        }
+        slot = (slot + 1) & dd->mask;
+    }
+
+    if (stale != NULL) {
+        dd->forgotten++;
+        stale->key = key;
+        *created = true;
+        return stale;
+    }
+
+    if (dd->node_count >= dd->max_nodes) {
+        return NULL;  // Table at its load limit
+    }
+
+    dd->nodes[slot].key = key;
+    dd->node_count++;
+    *created = true;
+    return &dd->nodes[slot];
+}
+
+// Backward-shift deletion: later nodes of the probe chain move up so that
+// no lookup stops early at the hole
+static void prp_remove(prp_discard_t *dd, uint32_t slot) {
+    uint32_t next = (slot + 1) & dd->mask;
+
+    while (dd->nodes[next].key != 0) {
+        uint32_t home = prp_hash(dd->nodes[next].key, dd->mask);
+        if (((next - home) & dd->mask) >= ((next - slot) & dd->mask)) {
+            dd->nodes[slot] = dd->nodes[next];
+            slot = next;
+        }
+        next = (next + 1) & dd->mask;
+    }
+
+    memset(&dd->nodes[slot], 0, sizeof(prp_node_t));
+    dd->node_count--;
+}
+
+// Drops every stale node and notes when the oldest survivor goes stale, so
+// a full table of live senders is not swept on every frame
+static uint32_t prp_sweep(prp_discard_t *dd, uint64_t now) {
+    uint64_t oldest = now;
+    uint32_t dropped = 0;
+
+    for (uint32_t slot = 0; slot < dd->capacity; slot++) {
+        prp_node_t *node = &dd->nodes[slot];
+        while (node->key != 0 && prp_node_stale(dd, node, now)) {
+            prp_remove(dd, slot);  // Refills the slot from further down the chain
+            dropped++;
+        }
+        if (node->key != 0 && node->last_seen_ns < oldest) {
+            oldest = node->last_seen_ns;
+        }
+    }
+
+    dd->next_sweep_ns = (oldest > UINT64_MAX - dd->forget_ns) ? UINT64_MAX : oldest + dd->forget_ns;
+    dd->forgotten += dropped;
+    return dropped;
+}
+
+static void prp_node_restart(prp_node_t *node, uint16_t sequence, uint8_t lan) {
+    node->seen[PRP_LAN_A] = 0;
+    node->seen[PRP_LAN_B] = 0;
+    node->seen[lan] = 1;
+    node->newest_seq = sequence;
+    node->depth = 1;
+}
+
+// Slide the window forward, charging every sequence number that leaves it
+// unseen on a LAN to that LAN's lost counter
+static void prp_node_advance(prp_discard_t *dd, prp_node_t *node, uint16_t delta) {
+    uint64_t valid = (node->depth >= PRP_WINDOW_SIZE) ? ~0ULL : ((1ULL << node->depth) - 1);
+    uint64_t out;
+    uint32_t gap = 0;
+
+    if (delta >= PRP_WINDOW_SIZE) {
+        out = valid;
+        gap = delta - PRP_WINDOW_SIZE;  // Never entered the window
+    } else {
+        out = valid & ~((1ULL << (PRP_WINDOW_SIZE - delta)) - 1);
+    }
+
+    for (uint8_t lan = 0; lan < PRP_LAN_COUNT; lan++) {
+        dd->lan[lan].lost += prp_popcount64(out & ~node->seen[lan]) + gap;
+        node->seen[lan] = (delta >= PRP_WINDOW_SIZE) ? 0 : (node->seen[lan] << delta);
+    }
+
+    uint32_t depth = (uint32_t)node->depth + delta;
+    node->depth = (depth > PRP_WINDOW_SIZE) ? PRP_WINDOW_SIZE : (uint8_t)depth;
+}
+
+// Duplicate-discard Functions
+// The node table is the caller's: capacity slots, a power of two of at
+// least 2. Up to capacity / 2 sources are tracked, keeping the load factor
+// at or below 50% so probe chains stay short.
+protocol_error_t prp_discard_init(prp_discard_t *dd, prp_node_t *nodes, uint32_t capacity) {
+    if (dd == NULL || nodes == NULL || capacity < 2 || (capacity & (capacity - 1)) != 0) {
+        return PROTOCOL_ERROR_INVALID_HEADER;
+    }
+
+    memset(nodes, 0, (size_t)capacity * sizeof(prp_node_t));
+    dd->nodes = nodes;
+    dd->capacity = capacity;
+    dd->mask = capacity - 1;
+    dd->max_nodes = capacity / 2;
+    dd->node_count = 0;
+    dd->clock = timebase_now_ns;
+    dd->forget_ns = PRP_NODE_FORGET_TIME_NS;
+    dd->next_sweep_ns = 0;
+    memset(dd->lan, 0, sizeof(dd->lan));
+    dd->untagged = 0;
+    dd->table_full = 0;
+    dd->forgotten = 0;
+
+    return PROTOCOL_ERROR_NONE;
+}
+
+// Detaches the node table; the storage stays with the caller
+void prp_discard_deinit(prp_discard_t *dd) {
+    if (dd == NULL) return;
+
+    dd->nodes = NULL;
+    dd->capacity = 0;
+    dd->node_count = 0;
+}
+
+void prp_discard_reset(prp_discard_t *dd) {
+    if (dd == NULL || dd->nodes == NULL) return;
+
+    memset(dd->nodes, 0, dd->capacity * sizeof(prp_node_t));
+    dd->node_count = 0;
+    dd->next_sweep_ns = 0;
+    memset(dd->lan, 0, sizeof(dd->lan));
+    dd->untagged = 0;
+    dd->table_full = 0;
+    dd->forgotten = 0;
+}
+
+// Clock for the node forget time (NULL: timebase_now_ns) and the forget
+// time itself (0: PRP_NODE_FORGET_TIME_NS). Set before the first frame.
+void prp_discard_set_clock(prp_discard_t *dd, protocol_clock_t clock, uint64_t forget_ns) {
+    if (dd == NULL) return;
+
+    dd->clock = clock ? clock : timebase_now_ns;
+    dd->forget_ns = forget_ns ? forget_ns : PRP_NODE_FORGET_TIME_NS;
+    dd->next_sweep_ns = 0;
+}
+
+// Drops the nodes not heard from within the forget time; returns how many.
+// prp_discard_process does this itself once the table is full.
+uint32_t prp_discard_forget(prp_discard_t *dd) {
+    if (dd == NULL || dd->nodes == NULL) return 0;
+
+    return prp_sweep(dd, dd->clock());
+}
+
+protocol_error_t prp_parse_tag(const uint8_t *data, uint16_t length, prp_frame_info_t *info) {
+    if (data == NULL || info == NULL || length < 14) {
+        return PROTOCOL_ERROR_INVALID_HEADER;
+    }
+
+    memcpy(info->source, data + 6, 6);
+    info->type = PRP_TAG_NONE;
+    info->sequence = 0;
+    info->lan_id = 0;
+    info->lsdu_size = 0;
+    info->frame_length = length;
+
+    uint16_t ethertype = (data[12] << 8) | data[13];
+
+    // HSR tag sits between the source MAC and the original EtherType
+    if (ethertype == HSR_ETHERTYPE) {
+        if (length < 14 + HSR_TAG_SIZE) {
+            return PROTOCOL_ERROR_INVALID_HEADER;
+        }
+        info->type = PRP_TAG_HSR;
+        info->lan_id = data[14] >> 4;
+        info->lsdu_size = ((data[14] & 0x0F) << 8) | data[15];
+        info->sequence = (data[16] << 8) | data[17];
+        info->frame_length = length - HSR_TAG_SIZE;
+        return PROTOCOL_ERROR_NONE;
+    }
+
+    // PRP trailer occupies the last six bytes before the FCS
+    if (length >= 14 + PRP_TRAILER_SIZE) {
+        const uint8_t *rct = data + length - PRP_TRAILER_SIZE;
+        uint16_t suffix = (rct[4] << 8) | rct[5];
+        uint16_t lsdu_size = ((rct[2] & 0x0F) << 8) | rct[3];
+
+        // The LSDU size check rejects payloads that merely end in 0x88FB
+        if (suffix == PRP_SUFFIX && lsdu_size == length - 14) {
+            info->type = PRP_TAG_PRP;
+            info->sequence = (rct[0] << 8) | rct[1];
+            info->lan_id = rct[2] >> 4;
+            info->lsdu_size = lsdu_size;
+            info->frame_length = length - PRP_TRAILER_SIZE;
+        }
+    }
+
+    return PROTOCOL_ERROR_NONE;
+}
+
+protocol_error_t prp_discard_process(prp_discard_t *dd, const uint8_t *data, uint16_t length,
+                                     uint8_t lan, prp_decision_t *decision, prp_frame_info_t *info) {
+    if (dd == NULL || dd->nodes == NULL || decision == NULL || info == NULL || lan >= PRP_LAN_COUNT) {
+        return PROTOCOL_ERROR_INVALID_HEADER;
+    }
+
+    protocol_error_t err = prp_parse_tag(data, length, info);
+    if (err != PROTOCOL_ERROR_NONE) {
+        return err;
+    }
+
+    if (info->type == PRP_TAG_NONE) {
+        dd->untagged++;
+        *decision = PRP_DECISION_PASS;
+        return PROTOCOL_ERROR_NONE;
+    }
+
+    prp_lan_counters_t *counters = &dd->lan[lan];
+    counters->received++;
+
+    if (info->type == PRP_TAG_PRP &&
+        info->lan_id != (lan == PRP_LAN_A ? PRP_LAN_ID_A : PRP_LAN_ID_B)) {
+        counters->wrong_lan++;
+    }
+
+    bool created;
+    uint64_t key = prp_mac_key(info->source);
+    uint64_t now = dd->clock();
+    prp_node_t *node = prp_lookup(dd, key, now, &created);
+    if (node == NULL && now >= dd->next_sweep_ns && prp_sweep(dd, now) > 0) {
+        node = prp_lookup(dd, key, now, &created);
+    }
+    if (node == NULL) {
+        // No room to track the sender: deliver rather than risk dropping
+        dd->table_full++;
+        counters->accepted++;
+        *decision = PRP_DECISION_ACCEPT;
+        return PROTOCOL_ERROR_BUFFER_OVERFLOW;
+    }
+    node->last_seen_ns = now;
+
+    uint16_t sequence = info->sequence;
+    uint8_t lan_bit = (uint8_t)(1U << lan);
+
+    if (created) {
+        prp_node_restart(node, sequence, lan);
+        node->last_seq[lan] = sequence;
+        node->lan_valid = lan_bit;
+        counters->accepted++;
+        *decision = PRP_DECISION_ACCEPT;
+        return PROTOCOL_ERROR_NONE;
+    }
+
+    // Ordering is judged per LAN: the other LAN may legitimately lag
+    if (node->lan_valid & lan_bit) {
+        int16_t lan_delta = (int16_t)(sequence - node->last_seq[lan]);
+        if (lan_delta < 0) {
+            counters->out_of_order++;
+        } else {
+            node->last_seq[lan] = sequence;
+        }
+    } else {
+        node->last_seq[lan] = sequence;
+        node->lan_valid |= lan_bit;
+    }
+
+    int16_t delta = (int16_t)(sequence - node->newest_seq);
+
+    if (delta > 0) {
+        prp_node_advance(dd, node, (uint16_t)delta);
+        node->seen[lan] |= 1;
+        node->newest_seq = sequence;
+        counters->accepted++;
+        *decision = PRP_DECISION_ACCEPT;
+        return PROTOCOL_ERROR_NONE;
+    }
+
+    uint16_t offset = (uint16_t)(-(int32_t)delta);
+    if (offset >= PRP_WINDOW_SIZE) {
+        // Too far behind to be a late copy: the sender restarted its counter
+        prp_node_restart(node, sequence, lan);
+        counters->accepted++;
+        *decision = PRP_DECISION_ACCEPT;
+        return PROTOCOL_ERROR_NONE;
+    }
+
+    if (offset >= node->depth) {
+        node->depth = (uint8_t)(offset + 1);  // Older than the first frame seen
+    }
+
+    uint64_t bit = 1ULL << offset;
+    bool seen = ((node->seen[PRP_LAN_A] | node->seen[PRP_LAN_B]) & bit) != 0;
+    node->seen[lan] |= bit;
+
+    if (seen) {
+        counters->duplicates++;
+        *decision = PRP_DECISION_DISCARD;
+    } else {
+        counters->accepted++;
+        *decision = PRP_DECISION_ACCEPT;
+    }
+
+    return PROTOCOL_ERROR_NONE;
+}
+
+protocol_error_t prp_discard_parse_frame(prp_discard_t *dd, const uint8_t *data, uint16_t length,
+                                         uint8_t lan, prp_decision_t *decision, ethernet_frame_t *frame) {
+    if (frame == NULL) {
+        return PROTOCOL_ERROR_INVALID_HEADER;
+    }
+
+    prp_frame_info_t info;
+    protocol_error_t err = prp_discard_process(dd, data, length, lan, decision, &info);
+    if (err != PROTOCOL_ERROR_NONE && err != PROTOCOL_ERROR_BUFFER_OVERFLOW) {
+        return err;
+    }
+
+    if (*decision == PRP_DECISION_DISCARD) {
+        return PROTOCOL_ERROR_NONE;
+    }
+
+    if (info.type != PRP_TAG_HSR) {
+        // Trailer (if any) is dropped by shortening the frame
+        return ethernet_parse_frame(data, info.frame_length, frame);
+    }
+
+    // HSR: skip the tag and restore the original EtherType
+    uint16_t payload_length = length - 14 - HSR_TAG_SIZE;
+    if (payload_length > sizeof(frame->payload)) {
+        return PROTOCOL_ERROR_BUFFER_OVERFLOW;
+    }
+
+    memcpy(frame->destination, data, 6);
+    memcpy(frame->source, data + 6, 6);
+    frame->ethertype = (data[18] << 8) | data[19];
+    memcpy(frame->payload, data + 14 + HSR_TAG_SIZE, payload_length);
+    frame->crc = 0;
+
+    return PROTOCOL_ERROR_NONE;
+}
+
+const prp_lan_counters_t* prp_discard_get_counters(const prp_discard_t *dd, uint8_t lan) {
+    if (dd == NULL || lan >= PRP_LAN_COUNT) return NULL;
+
+    return &dd->lan[lan];
+}
@@ -0,0 +1,101 @@
+#ifndef PRP_HSR_H
+#define PRP_HSR_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "communication_protocols.h"
+
+// IEC 62439-3 redundancy identifiers
+#define PRP_SUFFIX              0x88FBU     // Redundancy Control Trailer suffix
+#define HSR_ETHERTYPE           0x892FU     // HSR tag EtherType
+#define PRP_TRAILER_SIZE        6           // SeqNr + LanId/LSDUsize + suffix
+#define HSR_TAG_SIZE            6           // EtherType + path/LSDUsize + SeqNr
+
+#define PRP_LAN_A               0
+#define PRP_LAN_B               1
+#define PRP_LAN_COUNT           2
+#define PRP_LAN_ID_A            0xAU        // LanId field value for LAN A
+#define PRP_LAN_ID_B            0xBU        // LanId field value for LAN B
+
+// Sliding window per source (sequence numbers tracked behind the newest one)
+#define PRP_WINDOW_SIZE         64
+
+// Sources silent this long are forgotten (NodeForgetTime, IEC 62439-3 default)
+#define PRP_NODE_FORGET_TIME_NS 60000000000ULL
+
+// Redundancy tag type found in a frame
+typedef enum {
+    PRP_TAG_NONE,
+    PRP_TAG_PRP,
+    PRP_TAG_HSR
+} prp_tag_type_t;
+
+// Duplicate-discard decision for one received frame
+typedef enum {
+    PRP_DECISION_ACCEPT,        // First copy: deliver to the application
+    PRP_DECISION_DISCARD,       // Duplicate: drop
+    PRP_DECISION_PASS           // No redundancy tag: deliver unchanged
+} prp_decision_t;
+
+// Redundancy information extracted from a raw frame (FCS already stripped)
+typedef struct {
+    prp_tag_type_t type;
+    uint8_t source[6];
+    uint16_t sequence;
+    uint8_t lan_id;             // PRP LanId or HSR path identifier
+    uint16_t lsdu_size;         // LSDU size from the tag
+    uint16_t frame_length;      // Frame length with the tag/trailer removed
+} prp_frame_info_t;
+
+// Per-LAN statistics
+typedef struct {
+    uint32_t received;          // Tagged frames received on this LAN
+    uint32_t accepted;          // Frames this LAN delivered first
+    uint32_t duplicates;        // Frames discarded as duplicates
+    uint32_t out_of_order;      // Sequence went backwards on this LAN
+    uint32_t lost;              // Sequence numbers never seen on this LAN
+    uint32_t wrong_lan;         // Trailer LanId did not match the port
+} prp_lan_counters_t;
+
+// Per-source node entry (open addressing slot)
+typedef struct {
+    uint64_t key;               // Source MAC | PRP_NODE_VALID, 0 = empty
+    uint64_t seen[PRP_LAN_COUNT]; // Bit n = (newest - n) seen on that LAN
+    uint16_t newest_seq;        // Highest sequence number seen
+    uint16_t last_seq[PRP_LAN_COUNT]; // Last sequence number per LAN
+    uint8_t depth;              // Valid window positions (<= PRP_WINDOW_SIZE)
+    uint8_t lan_valid;          // Bit mask of LANs that delivered a frame
+    uint64_t last_seen_ns;      // Clock reading of the last frame from this source
+} prp_node_t;
+
+// Duplicate-discard engine
+typedef struct {
+    prp_node_t *nodes;          // Hash table (power of two slots), caller storage
+    uint32_t capacity;
+    uint32_t mask;
+    uint32_t node_count;
+    uint32_t max_nodes;         // Load limit (half the capacity)
+    protocol_clock_t clock;     // timebase_now_ns unless set
+    uint64_t forget_ns;         // Node forget time
+    uint64_t next_sweep_ns;     // No node can be stale before this
+    prp_lan_counters_t lan[PRP_LAN_COUNT];
+    uint32_t untagged;          // Frames without a redundancy tag
+    uint32_t table_full;        // Frames accepted because no slot was free
+    uint32_t forgotten;         // Nodes dropped after the forget time
+} prp_discard_t;
+
+// Function declarations
+protocol_error_t prp_discard_init(prp_discard_t *dd, prp_node_t *nodes, uint32_t capacity);
+void prp_discard_deinit(prp_discard_t *dd);
+void prp_discard_reset(prp_discard_t *dd);
+void prp_discard_set_clock(prp_discard_t *dd, protocol_clock_t clock, uint64_t forget_ns);
+uint32_t prp_discard_forget(prp_discard_t *dd);
+
+protocol_error_t prp_parse_tag(const uint8_t *data, uint16_t length, prp_frame_info_t *info);
+protocol_error_t prp_discard_process(prp_discard_t *dd, const uint8_t *data, uint16_t length,
+                                     uint8_t lan, prp_decision_t *decision, prp_frame_info_t *info);
+protocol_error_t prp_discard_parse_frame(prp_discard_t *dd, const uint8_t *data, uint16_t length,
+                                         uint8_t lan, prp_decision_t *decision, ethernet_frame_t *frame);
+const prp_lan_counters_t* prp_discard_get_counters(const prp_discard_t *dd, uint8_t lan);
+
+#endif // PRP_HSR_H
@@ -1,4 +1,5 @@
 #include "safety_critical.h"
+#include "timebase.h"
 #include <stdlib.h>
 #include <string.h>
 #include <math.h>
@@ -115,7 +116,7 @@ error_t tmr_sensor_vote(tmr_sensor_t *tmr, voting_method_t method) {
             break;
     }
 
-    tmr->last_vote_time = 0;  // Mock timestamp
+    tmr->last_vote_time = timebase_now_us();
     tmr->fault_detected = false;
 
     return ERROR_NONE;
@@ -145,8 +146,8 @@ error_t watchdog_init(watchdog_t *wd, uint32_t timeout_ms) {
     }
 
     wd->timeout_ms = timeout_ms;
-    wd->counter = 0;
-    wd->last_feed_time = 0;
+    wd->counter = timebase_now_ms();
+    wd->last_feed_time = wd->counter;
     wd->expired = false;
 
     return ERROR_NONE;
@@ -155,14 +156,16 @@ error_t watchdog_init(watchdog_t *wd, uint32_t timeout_ms) {
 void watchdog_feed(watchdog_t *wd) {
     if (wd == NULL) return;
 
-    wd->last_feed_time = wd->counter;  // Mock time
+    wd->counter = timebase_now_ms();
+    wd->last_feed_time = wd->counter;
     wd->expired = false;
 }
 
 bool watchdog_check_expired(watchdog_t *wd) {
     if (wd == NULL) return true;
 
-    // Mock expiration check
+    // Unsigned difference stays correct across the 32-bit ms wrap
+    wd->counter = timebase_now_ms();
     if (wd->counter - wd->last_feed_time > wd->timeout_ms) {
         wd->expired = true;
         if (wd->timeout_cb) {
@@ -12,7 +12,7 @@ typedef struct {
     uint8_t sensor_id;
     bool calibrated;
     error_t last_error;
-    uint32_t timestamp;
+    uint32_t timestamp;        // timebase_now_us of the reading
     uint8_t confidence_level;  // 0-100
 } sensor_data_t;
 
@@ -23,14 +23,14 @@ typedef struct {
     float voted_value;
     bool fault_detected;
     uint8_t faulty_sensor_mask;  // Bit mask of faulty sensors
-    uint32_t last_vote_time;
+    uint32_t last_vote_time;     // timebase_now_us
 } tmr_sensor_t;
 
 // Watchdog Timer Structure
 typedef struct {
-    volatile uint32_t counter;
+    volatile uint32_t counter;      // timebase_now_ms at the last feed or check
     uint32_t timeout_ms;
-    uint32_t last_feed_time;
+    uint32_t last_feed_time;        // timebase_now_ms
     bool expired;
     void (*timeout_cb)(void* context);
     void *callback_context;
@@ -0,0 +1,330 @@
+#include "sample_sched.h"
+#include <string.h>
+
+#define SAMPLE_SCHED_MASK           (SAMPLE_SCHED_SLOTS - 1)
+#define SAMPLE_SCHED_SPAN(level)    (1ULL << (SAMPLE_SCHED_WHEEL_BITS * (level)))
+
+// Internal helpers
+static uint64_t sched_now(const sample_sched_t *sched) {
+    return sched->clock();
+}
+
+// First tick starting at or after ns, so no read runs early
+static uint64_t sched_tick_of(const sample_sched_t *sched, uint64_t ns) {
+    if (ns <= sched->base_ns) return 0;
+    return (ns - sched->base_ns + sched->tick_ns - 1) / sched->tick_ns;
+}
+
+// Tick the entry's next read runs in: its target's tick, deferred to the
+// bus's coalescing grid unless the period is shorter than the grid
+static uint64_t sched_due_tick(const sample_sched_t *sched, const sample_sched_entry_t *entry) {
+    uint64_t tick = sched_tick_of(sched, entry->due_ns);
+    uint64_t grid = sched->coalesce_ticks[entry->bus];
+
+    if (grid > 1 && entry->period_ns >= grid * sched->tick_ns) {
+        tick = (tick + grid - 1) / grid * grid;
+    }
+    return tick;
+}
+
+// Files the entry on the lowest level whose span covers its due tick.
+// Overdue entries expire with the next tick; entries beyond the top level
+// park in its last slot and are filed again when it cascades.
+static void sched_insert(sample_sched_t *sched, sample_sched_entry_t *entry) {
+    uint64_t due = (entry->due_tick > sched->tick) ? entry->due_tick : sched->tick;
+    uint64_t delta = due - sched->tick;
+    uint8_t level = 0;
+
+    if (delta >= SAMPLE_SCHED_SPAN(SAMPLE_SCHED_LEVELS)) {
+        due = sched->tick + SAMPLE_SCHED_SPAN(SAMPLE_SCHED_LEVELS) - 1;
+        delta = due - sched->tick;
+    }
+    while (level < SAMPLE_SCHED_LEVELS - 1 && delta >= SAMPLE_SCHED_SPAN(level + 1)) {
+        level++;
+    }
+
+    sample_sched_entry_t **slot =
+        &sched->wheel[level][(due >> (SAMPLE_SCHED_WHEEL_BITS * level)) & SAMPLE_SCHED_MASK];
+    entry->next = *slot;
+    if (entry->next) {
+        entry->next->pprev = &entry->next;
+    }
+    *slot = entry;
+    entry->pprev = slot;
+}
+
+static void sched_unlink(sample_sched_entry_t *entry) {
+    if (entry->pprev == NULL) return;
+
+    *entry->pprev = entry->next;
+    if (entry->next) {
+        entry->next->pprev = entry->pprev;
+    }
+    entry->next = NULL;
+    entry->pprev = NULL;
+}
+
+// When the tick crosses a level's slot boundary, that slot's entries are
+// due within the level's span and move down. Top level first, so entries
+// moved onto a lower level at the same boundary move on from there.
+static void sched_cascade(sample_sched_t *sched) {
+    for (uint8_t level = SAMPLE_SCHED_LEVELS - 1; level > 0; level--) {
+        if (sched->tick & (SAMPLE_SCHED_SPAN(level) - 1)) continue;
+
+        sample_sched_entry_t **slot =
+            &sched->wheel[level][(sched->tick >> (SAMPLE_SCHED_WHEEL_BITS * level)) & SAMPLE_SCHED_MASK];
+        sample_sched_entry_t *entry = *slot;
+        *slot = NULL;
+        while (entry) {
+            sample_sched_entry_t *next = entry->next;
+            sched_insert(sched, entry);
+            sched->stats.cascades++;
+            entry = next;
+        }
+    }
+}
+
+// Queues an expired entry behind the others on its bus
+static void sched_collect(sample_sched_t *sched, sample_sched_entry_t *entry) {
+    entry->next = NULL;
+    entry->pprev = NULL;
+    if (sched->due_tail[entry->bus]) {
+        sched->due_tail[entry->bus]->next = entry;
+    } else {
+        sched->due_head[entry->bus] = entry;
+    }
+    sched->due_tail[entry->bus] = entry;
+    sched->due_buses |= 1u << entry->bus;
+}
+
+static void sched_sample(sample_sched_t *sched, sample_sched_entry_t *entry) {
+    float value;
+    uint64_t now = sched_now(sched);
+    uint64_t jitter = (now > entry->due_ns) ? now - entry->due_ns : 0;
+
+    error_t err = sensor_driver_read(entry->sensor, &value);
+
+    latency_hist_record(&sched->jitter, jitter);
+    if (jitter > entry->max_jitter_ns) {
+        entry->max_jitter_ns = jitter;
+    }
+    entry->reads++;
+    sched->stats.reads++;
+    if (err != ERROR_NONE) {
+        entry->errors++;
+        sched->stats.errors++;
+    }
+    if (!entry->scheduled) return;  // Removed by data_ready_cb
+
+    // Next target on the period grid; targets already past are skipped
+    // rather than read in a burst
+    entry->due_ns += entry->period_ns;
+    if (entry->due_ns < now) {
+        uint64_t skipped = (now - entry->due_ns) / entry->period_ns + 1;
+        entry->due_ns += skipped * entry->period_ns;
+        entry->missed += (uint32_t)skipped;
+        sched->stats.missed += (uint32_t)skipped;
+    }
+    entry->due_tick = sched_due_tick(sched, entry);
+    sched_insert(sched, entry);
+}
+
+// One window per bus with reads due, buses in index order
+static uint32_t sched_read_due(sample_sched_t *sched) {
+    uint32_t total = 0;
+
+    while (sched->due_buses) {
+        uint8_t bus = (uint8_t)__builtin_ctz(sched->due_buses);
+        sample_sched_entry_t *entry = sched->due_head[bus];
+        uint32_t batch = 0;
+
+        sched->due_buses &= sched->due_buses - 1;
+        sched->due_head[bus] = NULL;
+        sched->due_tail[bus] = NULL;
+
+        if (sched->window) {
+            sched->window(bus, true, sched->window_context);
+        }
+        while (entry) {
+            sample_sched_entry_t *next = entry->next;
+            if (entry->scheduled) {
+                sched_sample(sched, entry);
+                batch++;
+            }
+            entry = next;
+        }
+        if (sched->window) {
+            sched->window(bus, false, sched->window_context);
+        }
+
+        sched->stats.windows++;
+        if (batch > sched->stats.max_batch) {
+            sched->stats.max_batch = batch;
+        }
+        total += batch;
+    }
+
+    return total;
+}
+
+// Period of the sensor's sampling_rate; 0 when the rate is 0 or the
+// period is shorter than a tick
+static uint64_t sched_period(const sample_sched_t *sched, const sensor_driver_t *sensor) {
+    if (sensor->sampling_rate == 0) return 0;
+
+    uint64_t period = 1000000000ULL / sensor->sampling_rate;
+    return (period >= sched->tick_ns) ? period : 0;
+}
+
+// Scheduler Functions
+// tick_ns 0 selects SAMPLE_SCHED_DEFAULT_TICK; reads run up to one tick
+// after their target plus the time spent on reads before them
+error_t sample_sched_init(sample_sched_t *sched, protocol_clock_t clock, uint64_t tick_ns) {
+    if (sched == NULL || clock == NULL) {
+        return ERROR_INVALID_PARAM;
+    }
+
+    memset(sched, 0, sizeof(sample_sched_t));
+    sched->clock = clock;
+    sched->tick_ns = tick_ns ? tick_ns : SAMPLE_SCHED_DEFAULT_TICK;
+    sched->base_ns = clock();
+
+    return ERROR_NONE;
+}
+
+void sample_sched_set_window(sample_sched_t *sched, sample_sched_window_t window, void *context) {
+    if (sched == NULL) return;
+
+    sched->window = window;
+    sched->window_context = context;
+}
+
+// Defers the bus's reads to a grid of window_ns (rounded up to whole
+// ticks) starting at tick 0, so sensors with unrelated phases share
+// windows. Keep it below the shortest period on the bus; sensors with a
+// shorter period are not deferred. 0 turns it off. Entries already added
+// move onto the grid after their next read.
+error_t sample_sched_set_coalesce(sample_sched_t *sched, uint8_t bus, uint64_t window_ns) {
+    if (sched == NULL || bus >= SAMPLE_SCHED_MAX_BUSES) {
+        return ERROR_INVALID_PARAM;
+    }
+
+    sched->coalesce_ticks[bus] = (window_ns + sched->tick_ns - 1) / sched->tick_ns;
+
+    return ERROR_NONE;
+}
+
+// First read phase_ns from now, then every 1/sampling_rate. The entry must
+// not already be added; rates whose period is shorter than a tick are
+// rejected.
+error_t sample_sched_add(sample_sched_t *sched, sample_sched_entry_t *entry, sensor_driver_t *sensor,
+                         uint8_t bus, uint64_t phase_ns) {
+    if (sched == NULL || entry == NULL || sensor == NULL || bus >= SAMPLE_SCHED_MAX_BUSES) {
+        return ERROR_INVALID_PARAM;
+    }
+
+    uint64_t period = sched_period(sched, sensor);
+    if (period == 0) {
+        return ERROR_INVALID_PARAM;
+    }
+
+    memset(entry, 0, sizeof(sample_sched_entry_t));
+    entry->sensor = sensor;
+    entry->bus = bus;
+    entry->period_ns = period;
+    entry->due_ns = sched_now(sched) + phase_ns;
+    entry->due_tick = sched_due_tick(sched, entry);
+    entry->scheduled = true;
+
+    sched_insert(sched, entry);
+    sched->count++;
+
+    return ERROR_NONE;
+}
+
+// Safe from data_ready_cb and the window callback; an entry removed there
+// must not be added again before sample_sched_run returns
+void sample_sched_remove(sample_sched_t *sched, sample_sched_entry_t *entry) {
+    if (sched == NULL || entry == NULL || !entry->scheduled) return;
+
+    sched_unlink(entry);
+    entry->scheduled = false;
+    sched->count--;
+}
+
+// Picks up a changed sensor->sampling_rate: the next read lands one new
+// period after the last target. Not from the callbacks. A rate rejected
+// here leaves the entry on its old period.
+error_t sample_sched_update_rate(sample_sched_t *sched, sample_sched_entry_t *entry) {
+    if (sched == NULL || entry == NULL || !entry->scheduled) {
+        return ERROR_INVALID_PARAM;
+    }
+
+    uint64_t period = sched_period(sched, entry->sensor);
+    if (period == 0) {
+        return ERROR_INVALID_PARAM;
+    }
+
+    uint64_t last = (entry->due_ns > entry->period_ns) ? entry->due_ns - entry->period_ns : 0;
+
+    sched_unlink(entry);
+    entry->period_ns = period;
+    entry->due_ns = last + entry->period_ns;
+    entry->due_tick = sched_due_tick(sched, entry);
+    sched_insert(sched, entry);
+
+    return ERROR_NONE;
+}
+
+// Expires every tick up to now and runs the reads that came due; returns
+// the number of reads
+uint32_t sample_sched_run(sample_sched_t *sched) {
+    if (sched == NULL) return 0;
+
+    uint64_t now = sched_now(sched);
+    if (now < sched->base_ns) return 0;
+
+    uint64_t last = (now - sched->base_ns) / sched->tick_ns;
+    while (sched->tick <= last) {
+        sched_cascade(sched);
+
+        sample_sched_entry_t **slot = &sched->wheel[0][sched->tick & SAMPLE_SCHED_MASK];
+        sample_sched_entry_t *entry = *slot;
+        *slot = NULL;
+        while (entry) {
+            sample_sched_entry_t *next = entry->next;
+            sched_collect(sched, entry);
+            entry = next;
+        }
+
+        sched->tick++;
+        sched->stats.ticks++;
+    }
+
+    return sched_read_due(sched);
+}
+
+// Earliest time a read can come due, for callers that sleep between runs;
+// may be early (the next cascade), never late. UINT64_MAX when empty.
+uint64_t sample_sched_next_due(const sample_sched_t *sched) {
+    if (sched == NULL || sched->count == 0) return UINT64_MAX;
+
+    // Ticks up to the next level boundary; at the boundary the upper
+    // levels may move entries down
+    uint64_t next = (sched->tick + SAMPLE_SCHED_MASK) & ~(uint64_t)SAMPLE_SCHED_MASK;
+    for (uint64_t tick = sched->tick; tick < next; tick++) {
+        if (sched->wheel[0][tick & SAMPLE_SCHED_MASK]) {
+            next = tick;
+            break;
+        }
+    }
+
+    return sched->base_ns + next * sched->tick_ns;
+}
+
+void sample_sched_reset_stats(sample_sched_t *sched) {
+    if (sched == NULL) return;
+
+    memset(&sched->stats, 0, sizeof(sched->stats));
+    latency_hist_reset(&sched->jitter);
+}
@@ -0,0 +1,105 @@
+#ifndef SAMPLE_SCHED_H
+#define SAMPLE_SCHED_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "embedded_hardware.h"
+#include "communication_protocols.h"
+#include "device_drivers.h"
+#include "latency_hist.h"
+
+// Periodic sampling scheduler.
+// Every registered sensor is read with sensor_driver_read once per
+// 1/sampling_rate. Target times advance by whole periods from the first
+// one, so rates do not drift; a read never happens before its target.
+//
+// Pending reads sit in a hierarchical timing wheel: SAMPLE_SCHED_LEVELS
+// levels of 2^SAMPLE_SCHED_WHEEL_BITS slots, level n spanning 64^(n+1)
+// ticks. Adding, removing and rescheduling are O(1); an entry moves down
+// a level when its slot comes up (at most LEVELS-1 moves per period), so
+// the cost per read does not grow with the number of sensors.
+//
+// Sensors name the bus they share (0..SAMPLE_SCHED_MAX_BUSES-1). Reads
+// due in the same run are grouped per bus and run back to back inside
+// one bus window, bracketed by the window callback (e.g. take the bus
+// lock, select a mux channel). Each read's lateness against its target is
+// recorded in the jitter histogram.
+//
+// Reads only share a window when they expire in the same run. To batch
+// a bus whose sensors have unrelated phases, sample_sched_set_coalesce
+// puts its reads on a shared grid: each read is deferred to the next
+// multiple of the coalescing window, so everything due within one window
+// runs together. Reads still never run early and targets stay on their
+// period grid; the price is up to one window of extra jitter.
+//
+// The entries are owned by the caller; nothing is allocated.
+#define SAMPLE_SCHED_WHEEL_BITS     6
+#define SAMPLE_SCHED_SLOTS          (1u << SAMPLE_SCHED_WHEEL_BITS)
+#define SAMPLE_SCHED_LEVELS         4       // 64^4 ticks: 168 s at the default tick
+#define SAMPLE_SCHED_MAX_BUSES      16
+#define SAMPLE_SCHED_DEFAULT_TICK   10000   // ns
+
+typedef struct sample_sched_entry sample_sched_entry_t;
+
+// One sensor's schedule; owned by the caller while added
+struct sample_sched_entry {
+    sensor_driver_t *sensor;
+    uint8_t bus;
+    uint64_t period_ns;
+    uint64_t due_ns;            // Target time of the next read
+    uint64_t due_tick;
+    bool scheduled;
+
+    // Filled in by the scheduler
+    uint32_t reads;
+    uint32_t errors;
+    uint32_t missed;            // Periods skipped because the read was a whole period late
+    uint64_t max_jitter_ns;
+    sample_sched_entry_t *next;
+    sample_sched_entry_t **pprev;   // NULL while not in the wheel
+};
+
+// Bus window: open before the first read of a batch, closed after the last
+typedef void (*sample_sched_window_t)(uint8_t bus, bool open, void *context);
+
+// Scheduler statistics
+typedef struct {
+    uint64_t reads;
+    uint32_t errors;
+    uint32_t missed;
+    uint32_t windows;           // Bus windows opened
+    uint32_t max_batch;         // Most reads in one window
+    uint64_t cascades;          // Entries moved down a wheel level
+    uint64_t ticks;
+} sample_sched_stats_t;
+
+typedef struct {
+    protocol_clock_t clock;
+    uint64_t tick_ns;
+    uint64_t base_ns;           // Start of tick 0
+    uint64_t tick;              // Next tick to expire
+    uint32_t count;             // Entries added
+    sample_sched_entry_t *wheel[SAMPLE_SCHED_LEVELS][SAMPLE_SCHED_SLOTS];
+    sample_sched_entry_t *due_head[SAMPLE_SCHED_MAX_BUSES];
+    sample_sched_entry_t *due_tail[SAMPLE_SCHED_MAX_BUSES];
+    uint64_t coalesce_ticks[SAMPLE_SCHED_MAX_BUSES];   // Read grid per bus; 0 runs reads in their own tick
+    uint32_t due_buses;         // Bit per bus with reads collected
+    sample_sched_window_t window;
+    void *window_context;
+    sample_sched_stats_t stats;
+    latency_hist_t jitter;      // Read time minus target time
+} sample_sched_t;
+
+// Function declarations
+error_t sample_sched_init(sample_sched_t *sched, protocol_clock_t clock, uint64_t tick_ns);
+void sample_sched_set_window(sample_sched_t *sched, sample_sched_window_t window, void *context);
+error_t sample_sched_set_coalesce(sample_sched_t *sched, uint8_t bus, uint64_t window_ns);
+error_t sample_sched_add(sample_sched_t *sched, sample_sched_entry_t *entry, sensor_driver_t *sensor,
+                         uint8_t bus, uint64_t phase_ns);
+void sample_sched_remove(sample_sched_t *sched, sample_sched_entry_t *entry);
+error_t sample_sched_update_rate(sample_sched_t *sched, sample_sched_entry_t *entry);
+uint32_t sample_sched_run(sample_sched_t *sched);
+uint64_t sample_sched_next_due(const sample_sched_t *sched);
+void sample_sched_reset_stats(sample_sched_t *sched);
+
+#endif // SAMPLE_SCHED_H
@@ -0,0 +1,315 @@
+#include "spi_queue.h"
+#include "latency_hist.h"
+#include <string.h>
+
+// Internal helpers
+static uint64_t queue_now(const spi_queue_t *queue) {
+    return queue->clock ? queue->clock() : 0;
+}
+
+static void queue_deselect(spi_queue_t *queue) {
+    const spi_device_t *device = queue->selected;
+    if (device != NULL && device->cs_gpio != NULL) {
+        gpio_write_pin(device->cs_gpio, device->cs_pin, true);
+    }
+    queue->selected = NULL;
+}
+
+// Applies the device's mode and prescaler and asserts its chip select
+static void queue_select(spi_queue_t *queue, const spi_device_t *device) {
+    if (queue->selected == device) {
+        return;
+    }
+
+    const spi_device_t *configured = queue->configured;
+    bool reconfigure = configured == NULL || configured->mode != device->mode ||
+                       configured->prescaler != device->prescaler;
+
+    // Chip selects on one port switch over in a single BSRR write, unless
+    // SCK must change while nothing is selected
+    const spi_device_t *previous = queue->selected;
+    bool same_port = !reconfigure && previous != NULL && previous->cs_gpio != NULL &&
+                     previous->cs_gpio == device->cs_gpio;
+    if (!same_port) {
+        queue_deselect(queue);
+    }
+
+    if (reconfigure) {
+        SPI_TypeDef *spi = queue->driver->spi;
+        uint32_t cr1 = spi->CR1 & ~(SPI_CR1_BR | SPI_CR1_CPOL | SPI_CR1_CPHA | SPI_CR1_SPE);
+
+        cr1 |= ((uint32_t)device->prescaler << SPI_CR1_BR_Pos) & SPI_CR1_BR;
+        cr1 |= device->mode & (SPI_CR1_CPOL | SPI_CR1_CPHA);
+        spi->CR1 = cr1;  // Mode changes need SPE clear
+        spi->CR1 = cr1 | SPI_CR1_SPE;
+
+        queue->stats.reconfigurations++;
+    }
+    queue->configured = device;
+
+    if (same_port) {
+        gpio_write_port(device->cs_gpio, (uint16_t)(1U << previous->cs_pin), (uint16_t)(1U << device->cs_pin));
+    } else if (device->cs_gpio != NULL) {
+        gpio_write_pin(device->cs_gpio, device->cs_pin, false);
+    }
+    queue->selected = device;
+    queue->stats.cs_assertions++;
+}
+
+static bool queue_has_dma(const spi_queue_t *queue) {
+    return queue->driver->dma_tx != NULL && queue->driver->dma_rx != NULL;
+}
+
+// Segments continue a run when both buffers pick up where it ended
+static bool queue_continues(const spi_segment_t *first, uint16_t length, const spi_segment_t *next) {
+    bool tx_ok = (first->tx == NULL) ? next->tx == NULL : next->tx == first->tx + length;
+    bool rx_ok = (first->rx == NULL) ? next->rx == NULL : next->rx == first->rx + length;
+
+    return tx_ok && rx_ok && (uint32_t)length + next->length <= UINT16_MAX;
+}
+
+static error_t queue_start_run(spi_queue_t *queue) {
+    spi_transaction_t *txn = queue->active;
+    spi_driver_t *driver = queue->driver;
+    const spi_segment_t *first = &txn->segments[queue->segment];
+    uint16_t length = first->length;
+    uint8_t count = 1;
+
+    while (queue->segment + count < txn->segment_count &&
+           queue_continues(first, length, &txn->segments[queue->segment + count])) {
+        length += txn->segments[queue->segment + count].length;
+        count++;
+    }
+    queue->run_segments = count;
+    queue->run_length = length;
+
+    uint32_t rx_ccr = DMA_CCR_TCIE | (first->rx ? DMA_CCR_MINC : 0);
+    uint32_t tx_ccr = DMA_CCR_DIR | (first->tx ? DMA_CCR_MINC : 0);
+    void *rx = first->rx ? (void*)first->rx : (void*)&queue->rx_sink;
+    void *tx = first->tx ? (void*)first->tx : (void*)&queue->tx_fill;
+
+    // RX first so no received frame can be missed once TX starts clocking
+    driver->spi->CR2 |= SPI_CR2_RXDMAEN;
+    error_t err = dma_channel_start(driver->dma_rx, &driver->spi->DR, rx, length, rx_ccr);
+    if (err != ERROR_NONE) {
+        driver->spi->CR2 &= ~SPI_CR2_RXDMAEN;
+        return err;
+    }
+
+    driver->spi->CR2 |= SPI_CR2_TXDMAEN;
+    err = dma_channel_start(driver->dma_tx, &driver->spi->DR, tx, length, tx_ccr);
+    if (err != ERROR_NONE) {
+        dma_channel_stop(driver->dma_rx);
+        driver->spi->CR2 &= ~(SPI_CR2_TXDMAEN | SPI_CR2_RXDMAEN);
+        return err;
+    }
+
+    queue->stats.dma_runs++;
+    return ERROR_NONE;
+}
+
+// Polled fallback; NULL buffers go through a bounce buffer
+static error_t queue_run_polled(spi_queue_t *queue, const spi_segment_t *segment) {
+    uint8_t tx_chunk[SPI_QUEUE_CHUNK];
+    uint8_t rx_chunk[SPI_QUEUE_CHUNK];
+    uint16_t done = 0;
+
+    if (segment->tx == NULL) {
+        memset(tx_chunk, 0xFF, sizeof(tx_chunk));
+    }
+
+    while (done < segment->length) {
+        uint16_t length = segment->length - done;
+        if ((segment->tx == NULL || segment->rx == NULL) && length > SPI_QUEUE_CHUNK) {
+            length = SPI_QUEUE_CHUNK;
+        }
+
+        uint8_t *tx = segment->tx ? (uint8_t*)segment->tx + done : tx_chunk;
+        uint8_t *rx = segment->rx ? segment->rx + done : rx_chunk;
+        error_t err = spi_transmit_receive(queue->driver->spi, tx, rx, length);
+        if (err != ERROR_NONE) {
+            return err;
+        }
+        done += length;
+    }
+
+    return ERROR_NONE;
+}
+
+static void queue_finish(spi_queue_t *queue, error_t result) {
+    spi_transaction_t *txn = queue->active;
+    spi_queue_stats_t *stats = &queue->stats;
+
+    txn->result = result;
+    txn->completed_at = queue_now(queue);
+    queue->active = NULL;
+
+    stats->transactions++;
+    stats->busy_ns += txn->completed_at - txn->started_at;
+    uint64_t latency = txn->completed_at - txn->submitted_at;
+    stats->total_ns += latency;
+    latency_hist_record(&stats->latency, latency);
+
+    if (result != ERROR_NONE) {
+        stats->errors++;
+        error_log_record(&queue->driver->errors, result, txn->device->cs_pin);
+    }
+
+    bool hold = result == ERROR_NONE && txn->cs_hold &&
+                queue->head != NULL && queue->head->device == txn->device;
+    if (!hold) {
+        queue_deselect(queue);
+    }
+    if (queue->head == NULL) {
+        queue->driver->state = DEVICE_STATE_READY;
+    }
+
+    if (txn->completion_cb) {
+        txn->completion_cb(txn, result, txn->context);
+    } else if (queue->driver->completion_cb) {
+        queue->driver->completion_cb(result, queue->driver->callback_context);
+    }
+}
+
+// Starts queued transactions while the bus is free; polled transfers
+// complete here, DMA transfers continue from the interrupt
+static void queue_kick(spi_queue_t *queue) {
+    while (queue->active == NULL && queue->head != NULL) {
+        spi_transaction_t *txn = queue->head;
+        queue->head = txn->next;
+        if (queue->head == NULL) {
+            queue->tail = NULL;
+        }
+        txn->next = NULL;
+
+        queue->active = txn;
+        queue->segment = 0;
+        queue->driver->state = DEVICE_STATE_BUSY;
+        txn->started_at = queue_now(queue);
+        queue_select(queue, txn->device);
+
+        error_t err = ERROR_NONE;
+        if (queue_has_dma(queue)) {
+            err = queue_start_run(queue);
+            if (err == ERROR_NONE) {
+                return;
+            }
+        } else {
+            for (; queue->segment < txn->segment_count && err == ERROR_NONE; queue->segment++) {
+                err = queue_run_polled(queue, &txn->segments[queue->segment]);
+                if (err == ERROR_NONE) {
+                    queue->stats.segments++;
+                    queue->stats.bytes += txn->segments[queue->segment].length;
+                }
+            }
+        }
+        queue_finish(queue, err);
+    }
+}
+
+// SPI Queue Functions
+error_t spi_queue_init(spi_queue_t *queue, spi_driver_t *driver, protocol_clock_t clock) {
+    if (queue == NULL || driver == NULL || driver->spi == NULL) {
+        return ERROR_INVALID_PARAM;
+    }
+
+    memset(queue, 0, sizeof(spi_queue_t));
+    queue->driver = driver;
+    queue->clock = clock;
+    queue->tx_fill = 0xFF;
+    queue->stats_since = queue_now(queue);
+
+    return ERROR_NONE;
+}
+
+error_t spi_queue_submit(spi_queue_t *queue, spi_transaction_t *txn) {
+    if (queue == NULL || txn == NULL || txn->device == NULL || txn->segments == NULL ||
+        txn->segment_count == 0) {
+        return ERROR_INVALID_PARAM;
+    }
+    for (uint8_t i = 0; i < txn->segment_count; i++) {
+        if (txn->segments[i].length == 0) {
+            return ERROR_INVALID_PARAM;
+        }
+    }
+
+    // The blocking transfer path owns the bus while it runs
+    if (queue->active == NULL && queue->head == NULL && queue->driver->state == DEVICE_STATE_BUSY) {
+        return ERROR_BUSY;
+    }
+
+    txn->result = ERROR_BUSY;
+    txn->submitted_at = queue_now(queue);
+    txn->started_at = 0;
+    txn->completed_at = 0;
+    txn->next = NULL;
+
+    if (queue->tail) {
+        queue->tail->next = txn;
+    } else {
+        queue->head = txn;
+    }
+    queue->tail = txn;
+
+    queue_kick(queue);
+
+    return ERROR_NONE;
+}
+
+// Called from the RX DMA channel interrupt
+void spi_queue_process_interrupt(spi_queue_t *queue) {
+    if (queue == NULL || queue->active == NULL || queue->run_length == 0) return;
+
+    spi_driver_t *driver = queue->driver;
+    if (driver->dma_rx->CNDTR != 0) return;
+
+    dma_channel_stop(driver->dma_tx);
+    dma_channel_stop(driver->dma_rx);
+    driver->spi->CR2 &= ~(SPI_CR2_TXDMAEN | SPI_CR2_RXDMAEN);
+
+    spi_transaction_t *txn = queue->active;
+    queue->stats.segments += queue->run_segments;
+    queue->stats.bytes += queue->run_length;
+    queue->segment += queue->run_segments;
+    queue->run_length = 0;
+
+    if (queue->segment < txn->segment_count) {
+        error_t err = queue_start_run(queue);
+        if (err == ERROR_NONE) {
+            return;
+        }
+        queue_finish(queue, err);
+    } else {
+        queue_finish(queue, ERROR_NONE);
+    }
+
+    queue_kick(queue);
+}
+
+bool spi_queue_idle(const spi_queue_t *queue) {
+    return queue == NULL || (queue->active == NULL && queue->head == NULL);
+}
+
+// Statistics Functions
+const spi_queue_stats_t* spi_queue_get_stats(const spi_queue_t *queue) {
+    if (queue == NULL) return NULL;
+
+    return &queue->stats;
+}
+
+// Fraction of the time since the last reset a transaction held the bus
+float spi_queue_utilization(const spi_queue_t *queue) {
+    if (queue == NULL) return 0.0f;
+
+    uint64_t elapsed = queue_now(queue) - queue->stats_since;
+    if (elapsed == 0) return 0.0f;
+
+    return (float)queue->stats.busy_ns / (float)elapsed;
+}
+
+void spi_queue_reset_stats(spi_queue_t *queue) {
+    if (queue == NULL) return;
+
+    memset(&queue->stats, 0, sizeof(queue->stats));
+    queue->stats_since = queue_now(queue);
+}
@@ -0,0 +1,97 @@
+#ifndef SPI_QUEUE_H
+#define SPI_QUEUE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "embedded_hardware.h"
+#include "communication_protocols.h"
+#include "device_drivers.h"
+#include "latency_hist.h"
+
+// Queued SPI engine.
+// Callers submit transaction descriptors; the queue owns the bus of one
+// spi_driver_t, selects each device's chip select, mode and prescaler, and
+// moves every segment through the driver's dma_tx/dma_rx channels. Segments
+// that continue the previous segment's buffers run as one DMA transfer, and
+// transactions marked cs_hold keep the chip select asserted into the next
+// transaction for the same device. Without DMA channels segments are run
+// with spi_transmit_receive from spi_queue_submit.
+#define SPI_QUEUE_CHUNK             64      // Bytes per polled transfer when a buffer is NULL
+
+// Device on the bus
+typedef struct {
+    GPIO_TypeDef *cs_gpio;      // Active-low chip select (NULL: none)
+    uint16_t cs_pin;
+    uint8_t mode;               // CPOL/CPHA
+    uint8_t prescaler;          // CR1 BR field: SCK = pclk / 2^(prescaler + 1)
+} spi_device_t;
+
+// One run of clocks under the transaction's chip select
+typedef struct {
+    const uint8_t *tx;          // NULL: clock out 0xFF
+    uint8_t *rx;                // NULL: discard MISO
+    uint16_t length;
+} spi_segment_t;
+
+typedef struct spi_transaction spi_transaction_t;
+
+// Transaction descriptor; owned by the caller until completion_cb runs
+struct spi_transaction {
+    const spi_device_t *device;
+    const spi_segment_t *segments;
+    uint8_t segment_count;
+    bool cs_hold;               // Keep CS asserted if the next transaction is for the same device
+    void (*completion_cb)(spi_transaction_t *txn, error_t result, void *context);
+    void *context;
+
+    // Filled in by the queue
+    error_t result;
+    uint64_t submitted_at;
+    uint64_t started_at;
+    uint64_t completed_at;
+    spi_transaction_t *next;
+};
+
+// Bus statistics
+typedef struct {
+    uint32_t transactions;
+    uint32_t segments;
+    uint32_t dma_runs;          // DMA transfers after merging segments
+    uint32_t cs_assertions;
+    uint32_t reconfigurations;  // CR1 mode/prescaler changes between devices
+    uint32_t errors;
+    uint64_t bytes;
+    uint64_t busy_ns;           // Time a transaction was on the bus
+    uint64_t total_ns;          // Submit to completion
+    latency_hist_t latency;     // Submit to completion per transaction; exact max in latency.max_ns
+} spi_queue_stats_t;
+
+// Queue bound to one SPI driver
+typedef struct {
+    spi_driver_t *driver;
+    protocol_clock_t clock;
+    spi_transaction_t *head;    // Waiting transactions
+    spi_transaction_t *tail;
+    spi_transaction_t *active;
+    uint8_t segment;            // Next segment of the active transaction
+    uint8_t run_segments;       // Segments in the DMA transfer in flight
+    uint16_t run_length;
+    const spi_device_t *selected;    // Device whose chip select is asserted
+    const spi_device_t *configured;  // Device whose mode/prescaler is in CR1
+    uint8_t tx_fill;            // Source for segments without TX data
+    uint8_t rx_sink;            // Destination for segments without RX data
+    uint64_t stats_since;
+    spi_queue_stats_t stats;
+} spi_queue_t;
+
+// Function declarations
+error_t spi_queue_init(spi_queue_t *queue, spi_driver_t *driver, protocol_clock_t clock);
+error_t spi_queue_submit(spi_queue_t *queue, spi_transaction_t *txn);
+void spi_queue_process_interrupt(spi_queue_t *queue);
+bool spi_queue_idle(const spi_queue_t *queue);
+
+const spi_queue_stats_t* spi_queue_get_stats(const spi_queue_t *queue);
+float spi_queue_utilization(const spi_queue_t *queue);
+void spi_queue_reset_stats(spi_queue_t *queue);
+
+#endif // SPI_QUEUE_H
@@ -0,0 +1,190 @@
+#define _POSIX_C_SOURCE 199309L  // clock_gettime
+#include "timebase.h"
+#include <time.h>
+
+#if defined(__x86_64__)
+#include <cpuid.h>
+#include <x86intrin.h>
+#define TIMEBASE_HAVE_COUNTER 1
+#elif defined(__aarch64__)
+#define TIMEBASE_HAVE_COUNTER 1
+#else
+#define TIMEBASE_HAVE_COUNTER 0
+#endif
+
+typedef struct {
+    timebase_source_t source;
+    timebase_clock_t clock;     // CUSTOM
+    uint64_t sim_ns;            // SIMULATED
+    uint64_t base_cycles;       // CYCLE_COUNTER: counter and time at calibration
+    uint64_t base_ns;
+    uint64_t mult;              // ns per cycle << TIMEBASE_SHIFT
+    uint64_t counter_hz;
+} timebase_state_t;
+
+static timebase_state_t timebase = {TIMEBASE_SOURCE_MONOTONIC, NULL, 0, 0, 0, 0, 0};
+
+// Internal helpers
+static uint64_t timebase_monotonic_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+#if TIMEBASE_HAVE_COUNTER
+__extension__ typedef unsigned __int128 timebase_u128_t;
+
+static inline uint64_t timebase_read_counter(void) {
+#if defined(__x86_64__)
+    return __rdtsc();
+#else
+    uint64_t cycles;
+    __asm__ __volatile__("mrs %0, cntvct_el0" : "=r"(cycles));
+    return cycles;
+#endif
+}
+
+// The TSC only counts wall time if it is invariant across P- and C-states
+static bool timebase_counter_usable(void) {
+#if defined(__x86_64__)
+    unsigned int eax, ebx, ecx, edx;
+    if (!__get_cpuid(0x80000007, &eax, &ebx, &ecx, &edx)) {
+        return false;
+    }
+    return (edx & (1U << 8)) != 0;
+#else
+    return true;
+#endif
+}
+
+// Pairs a CLOCK_MONOTONIC read with the counter value at its midpoint
+static void timebase_sample(uint64_t *cycles, uint64_t *ns) {
+    uint64_t before = timebase_read_counter();
+    *ns = timebase_monotonic_ns();
+    uint64_t after = timebase_read_counter();
+    *cycles = before + (after - before) / 2;
+}
+
+static bool timebase_calibrate(void) {
+    if (!timebase_counter_usable()) {
+        return false;
+    }
+
+    uint64_t start_cycles, start_ns, end_cycles, end_ns;
+    timebase_sample(&start_cycles, &start_ns);
+    do {
+        timebase_sample(&end_cycles, &end_ns);
+    } while (end_ns - start_ns < TIMEBASE_CALIBRATION_NS);
+
+    uint64_t cycles = end_cycles - start_cycles;
+    uint64_t ns = end_ns - start_ns;
+    if (cycles == 0) {
+        return false;
+    }
+
+    timebase.counter_hz = (uint64_t)((timebase_u128_t)cycles * 1000000000ULL / ns);
+    timebase.mult = (uint64_t)(((timebase_u128_t)ns << TIMEBASE_SHIFT) / cycles);
+    timebase.base_cycles = end_cycles;
+    timebase.base_ns = end_ns;
+
+    return true;
+}
+#endif
+
+// Timebase Functions
+// Selects the source. A cycle counter that is missing or not invariant
+// leaves the monotonic source in place and returns false.
+bool timebase_init(timebase_source_t source) {
+    switch (source) {
+        case TIMEBASE_SOURCE_MONOTONIC:
+            timebase.source = TIMEBASE_SOURCE_MONOTONIC;
+            return true;
+
+        case TIMEBASE_SOURCE_CYCLE_COUNTER:
+#if TIMEBASE_HAVE_COUNTER
+            if (timebase_calibrate()) {
+                timebase.source = TIMEBASE_SOURCE_CYCLE_COUNTER;
+                return true;
+            }
+#endif
+            timebase.source = TIMEBASE_SOURCE_MONOTONIC;
+            return false;
+
+        case TIMEBASE_SOURCE_SIMULATED:
+            timebase.sim_ns = 0;
+            timebase.source = TIMEBASE_SOURCE_SIMULATED;
+            return true;
+
+        case TIMEBASE_SOURCE_CUSTOM:
+        default:
+            return false;   // Use timebase_use_clock
+    }
+}
+
+// Plugs in an external nanosecond clock; NULL returns to CLOCK_MONOTONIC
+void timebase_use_clock(timebase_clock_t clock) {
+    timebase.clock = clock;
+    timebase.source = clock ? TIMEBASE_SOURCE_CUSTOM : TIMEBASE_SOURCE_MONOTONIC;
+}
+
+timebase_source_t timebase_get_source(void) {
+    return timebase.source;
+}
+
+// Calibrated counter frequency; 0 until the cycle counter has been selected
+uint64_t timebase_counter_hz(void) {
+    return timebase.counter_hz;
+}
+
+uint64_t timebase_now_ns(void) {
+    switch (timebase.source) {
+#if TIMEBASE_HAVE_COUNTER
+        case TIMEBASE_SOURCE_CYCLE_COUNTER: {
+            uint64_t delta = timebase_read_counter() - timebase.base_cycles;
+            return timebase.base_ns + (uint64_t)(((timebase_u128_t)delta * timebase.mult) >> TIMEBASE_SHIFT);
+        }
+#endif
+        case TIMEBASE_SOURCE_SIMULATED:
+            return timebase.sim_ns;
+        case TIMEBASE_SOURCE_CUSTOM:
+            return timebase.clock();
+        default:
+            return timebase_monotonic_ns();
+    }
+}
+
+uint32_t timebase_now_us(void) {
+    return (uint32_t)(timebase_now_ns() / 1000U);
+}
+
+uint32_t timebase_now_ms(void) {
+    return (uint32_t)(timebase_now_ns() / 1000000U);
+}
+
+// Interval readings: no offset or scaling on the read side
+uint64_t timebase_ticks(void) {
+#if TIMEBASE_HAVE_COUNTER
+    if (timebase.source == TIMEBASE_SOURCE_CYCLE_COUNTER) {
+        return timebase_read_counter();
+    }
+#endif
+    return timebase_now_ns();
+}
+
+uint64_t timebase_ticks_to_ns(uint64_t ticks) {
+#if TIMEBASE_HAVE_COUNTER
+    if (timebase.source == TIMEBASE_SOURCE_CYCLE_COUNTER) {
+        return (uint64_t)(((timebase_u128_t)ticks * timebase.mult) >> TIMEBASE_SHIFT);
+    }
+#endif
+    return ticks;
+}
+
+// Simulated source: absolute time and relative advance
+void timebase_sim_set(uint64_t ns) {
+    timebase.sim_ns = ns;
+}
+
+void timebase_sim_advance(uint64_t ns) {
+    timebase.sim_ns += ns;
+}
@@ -0,0 +1,51 @@
+#ifndef TIMEBASE_H
+#define TIMEBASE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Monotonic timebase used to stamp driver, protocol and safety events.
+// All real sources report CLOCK_MONOTONIC nanoseconds:
+//   MONOTONIC      clock_gettime(CLOCK_MONOTONIC); the default before init
+//   CYCLE_COUNTER  invariant TSC (x86-64) or CNTVCT_EL0 (AArch64), scaled by
+//                  a mult/shift pair calibrated against CLOCK_MONOTONIC, so
+//                  a read is one counter read, one multiply and one shift
+//   SIMULATED      a value tests set and advance by hand
+//   CUSTOM         any uint64_t (*)(void) nanosecond clock, e.g.
+//                  peripheral_sim_clock for virtual time
+// timebase_now_ns has the protocol_clock_t signature and can be passed to
+// protocol_dispatch_init, spi_queue_init, gpio_capture_init, ...
+// The 32-bit timestamp fields of frames, error histories and votes hold
+// timebase_now_us and wrap after ~71 minutes; compare them by unsigned
+// subtraction.
+// timebase_ticks is the cheapest reading for measuring short intervals:
+// the raw counter with the cycle-counter source, nanoseconds otherwise.
+// Convert a difference of two readings with timebase_ticks_to_ns.
+#define TIMEBASE_CALIBRATION_NS  10000000ULL    // Cycle-counter calibration window
+#define TIMEBASE_SHIFT           32
+
+typedef enum {
+    TIMEBASE_SOURCE_MONOTONIC,
+    TIMEBASE_SOURCE_CYCLE_COUNTER,
+    TIMEBASE_SOURCE_SIMULATED,
+    TIMEBASE_SOURCE_CUSTOM
+} timebase_source_t;
+
+typedef uint64_t (*timebase_clock_t)(void);
+
+// Function declarations
+bool timebase_init(timebase_source_t source);
+void timebase_use_clock(timebase_clock_t clock);
+timebase_source_t timebase_get_source(void);
+uint64_t timebase_counter_hz(void);
+
+uint64_t timebase_now_ns(void);
+uint32_t timebase_now_us(void);
+uint32_t timebase_now_ms(void);
+uint64_t timebase_ticks(void);
+uint64_t timebase_ticks_to_ns(uint64_t ticks);
+
+void timebase_sim_set(uint64_t ns);
+void timebase_sim_advance(uint64_t ns);
+
+#endif // TIMEBASE_H
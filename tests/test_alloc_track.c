@@ -0,0 +1,147 @@
+/* test_alloc_track.c – Unity Tests for the allocation tracker and the allocation-free hot path */
+/* Build with -DALLOC_TRACK and the Makefile's ALLOC_TRACK_LDFLAGS */
+
+#include "unity.h"
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "alloc_track.h"
+#include "device_drivers.h"
+#include "safety_critical.h"
+#include "sensor.h"
+
+// ====================================================================
+// Test Fixtures
+// ====================================================================
+
+static alloc_track_stats_t stats;
+
+// Kept out of line so the allocation has a call site of its own
+__attribute__((noinline))
+static void *allocate_in_hot_path(size_t size) {
+    return malloc(size);
+}
+
+// ====================================================================
+// Setup and Teardown
+// ====================================================================
+
+void setUp(void) {
+    alloc_track_disarm();
+    alloc_track_reset();
+}
+
+void tearDown(void) {
+    alloc_track_disarm();
+    alloc_track_reset();
+}
+
+// ====================================================================
+// Tracker Tests
+// ====================================================================
+
+void test_alloc_track_counts_call_sites(void) {
+    alloc_track_site_t sites[4];
+
+    TEST_ASSERT_TRUE(alloc_track_enabled());
+
+    // Expected: create/free_sensor are one allocation and one free
+    Sensor *sensor = create_sensor(1, "probe");
+    TEST_ASSERT_NOT_NULL(sensor);
+    free_sensor(sensor);
+
+    for (uint8_t i = 0; i < 3; i++) {
+        free(allocate_in_hot_path(32));
+    }
+
+    alloc_track_get_stats(&stats);
+    TEST_ASSERT_EQUAL_UINT32(4, (uint32_t)stats.allocations);
+    TEST_ASSERT_EQUAL_UINT32(4, (uint32_t)stats.frees);
+    TEST_ASSERT_EQUAL_UINT32(0, stats.armed_allocations);
+
+    // Expected: the busiest site first
+    uint16_t count = alloc_track_get_sites(sites, 4);
+    TEST_ASSERT_EQUAL_UINT16(stats.sites, count);
+    TEST_ASSERT_EQUAL_UINT32(3, sites[0].calls);
+    TEST_ASSERT_EQUAL_UINT32(96, (uint32_t)sites[0].bytes);
+}
+
+void test_alloc_track_monitoring_loop_is_allocation_free(void) {
+    sensor_driver_t sensor;
+    can_driver_t can;
+    tmr_sensor_t tmr;
+    watchdog_t wd;
+    uint8_t ids[TMR_SENSOR_COUNT] = {1, 2, 3};
+    can_frame_t frame;
+    float value;
+
+    // Startup may allocate
+    memset(&sensor, 0, sizeof(sensor));
+    memset(&can, 0, sizeof(can));
+    memset(&frame, 0, sizeof(frame));
+    TEST_ASSERT_EQUAL(ERROR_NONE, sensor_driver_init(&sensor, 0, 0));
+    TEST_ASSERT_EQUAL(ERROR_NONE, can_driver_init(&can, 500000));
+    TEST_ASSERT_EQUAL(ERROR_NONE, tmr_sensor_init(&tmr, ids));
+    TEST_ASSERT_EQUAL(ERROR_NONE, watchdog_init(&wd, 1000));
+    frame.id = 0x123;
+    frame.dlc = 4;
+
+    alloc_track_arm();
+    for (uint16_t cycle = 0; cycle < 200; cycle++) {
+        sensor_driver_read(&sensor, &value);
+        for (uint8_t i = 0; i < TMR_SENSOR_COUNT; i++) {
+            tmr.sensors[i].temperature = value;
+            tmr.sensors[i].last_error = ERROR_NONE;
+        }
+        tmr_sensor_vote(&tmr, VOTE_MEDIAN);
+        memcpy(frame.data, &tmr.voted_value, sizeof(float));
+        can_driver_send_message(&can, &frame);
+        watchdog_feed(&wd);
+        watchdog_check_expired(&wd);
+    }
+    alloc_track_disarm();
+
+    // Expected: nothing on the heap once armed
+    alloc_track_get_stats(&stats);
+    TEST_ASSERT_EQUAL_UINT32(0, stats.armed_allocations);
+    TEST_ASSERT_EQUAL_UINT32(0, stats.armed_frees);
+
+    can_driver_deinit(&can);
+    sensor_driver_deinit(&sensor);
+}
+
+void test_alloc_track_armed_allocation_is_reported(void) {
+    alloc_track_site_t sites[4];
+
+    alloc_track_arm();
+    TEST_ASSERT_TRUE(alloc_track_armed());
+    void *block = allocate_in_hot_path(48);
+    alloc_track_disarm();
+    free(block);
+
+    // Expected: one violation, charged to its call site
+    alloc_track_get_stats(&stats);
+    TEST_ASSERT_EQUAL_UINT32(1, stats.armed_allocations);
+    TEST_ASSERT_EQUAL_UINT32(0, stats.armed_frees);
+    TEST_ASSERT_EQUAL_UINT16(1, alloc_track_get_sites(sites, 4));
+    TEST_ASSERT_EQUAL_UINT32(1, sites[0].armed_calls);
+    TEST_ASSERT_EQUAL_UINT32(48, (uint32_t)sites[0].bytes);
+
+    // Expected: reset clears the violation so the exit check passes
+    alloc_track_reset();
+    alloc_track_get_stats(&stats);
+    TEST_ASSERT_EQUAL_UINT32(0, stats.armed_allocations);
+    TEST_ASSERT_EQUAL_UINT16(0, alloc_track_get_sites(sites, 4));
+}
+
+int main(void) {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_alloc_track_counts_call_sites);
+    RUN_TEST(test_alloc_track_monitoring_loop_is_allocation_free);
+    RUN_TEST(test_alloc_track_armed_allocation_is_reported);
+
+    return UNITY_END();
+}
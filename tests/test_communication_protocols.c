@@ -43,6 +43,7 @@ typedef struct {
     uint16_t tx_tail;
     uint16_t buffer_size;
     protocol_state_t state;
+    const void *pool_owner;
 } can_handle_t;
 
 typedef struct {
@@ -73,6 +74,7 @@ typedef union {
 
 // CAN Functions
 extern protocol_error_t can_init(can_handle_t *can, uint16_t buffer_size);
+extern void can_deinit(can_handle_t *can);
 extern protocol_error_t can_transmit_message(can_handle_t *can, const can_frame_t *frame, uint32_t timeout);
 extern protocol_error_t can_receive_message(can_handle_t *can, can_frame_t *frame, uint32_t timeout);
 extern uint16_t can_calculate_crc(const can_frame_t *frame);
@@ -108,15 +110,8 @@ void setUp(void) {
 }
 
 void tearDown(void) {
-    // Free any dynamically allocated buffers by test_can_handle if they exist
-    if (test_can_handle.rx_buffer != NULL) {
-        free(test_can_handle.rx_buffer);
-        test_can_handle.rx_buffer = NULL;
-    }
-    if (test_can_handle.tx_buffer != NULL) {
-        free(test_can_handle.tx_buffer);
-        test_can_handle.tx_buffer = NULL;
-    }
+    // Return any queues test_can_handle took from the pool
+    can_deinit(&test_can_handle);
 }
 
 // ====================================================================
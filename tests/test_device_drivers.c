@@ -0,0 +1,448 @@
+/* test_device_drivers.c – Unity Tests for the device drivers on simulated peripherals */
+
+#include "unity.h"
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "device_drivers.h"
+#include "peripheral_sim.h"
+#include "protocol_wire.h"
+#include "i2c_mock.h"
+
+// ====================================================================
+// Test Fixtures
+// ====================================================================
+
+static peripheral_sim_t sim;
+static uart_driver_t uart_drv;
+static DMA_Channel_TypeDef dma_tx;
+static DMA_Channel_TypeDef dma_rx;
+
+static uint8_t wire[256];
+static uint16_t wire_count;
+
+typedef struct {
+    uint32_t tx_done;
+    uint32_t rx_done;
+    error_t tx_result;
+    uint16_t rx_length;
+    uint32_t spans;
+    uint16_t span_bytes;
+    uint64_t tx_done_at;
+} events_t;
+
+static events_t events;
+
+static void wire_rx(peripheral_sim_t *s, USART_TypeDef *u, uint8_t byte, void *context) {
+    (void)s;
+    (void)u;
+    (void)context;
+    if (wire_count < sizeof(wire)) {
+        wire[wire_count++] = byte;
+    }
+}
+
+static void uart_isr(void *context) {
+    uart_driver_process_interrupt((uart_driver_t*)context);
+}
+
+static void tx_complete(error_t result, void *context) {
+    events_t *ev = (events_t*)context;
+    ev->tx_done++;
+    ev->tx_result = result;
+    ev->tx_done_at = peripheral_sim_clock();
+}
+
+static void rx_complete(error_t result, uint16_t length, void *context) {
+    events_t *ev = (events_t*)context;
+    (void)result;
+    ev->rx_done++;
+    ev->rx_length = length;
+}
+
+static void rx_span(const uint8_t *data, uint16_t length, void *context) {
+    events_t *ev = (events_t*)context;
+    (void)data;
+    ev->spans++;
+    ev->span_bytes += length;
+}
+
+static void attach_dma(void) {
+    uart_drv.dma_tx = &dma_tx;
+    uart_drv.dma_rx = &dma_rx;
+    peripheral_sim_attach_dma(&sim, &dma_tx, uart_drv.uart, true);
+    peripheral_sim_attach_dma(&sim, &dma_rx, uart_drv.uart, false);
+    peripheral_sim_set_irq(&sim, &dma_tx, uart_isr, &uart_drv);
+    peripheral_sim_set_irq(&sim, &dma_rx, uart_isr, &uart_drv);
+}
+
+static void count_message(const protocol_frame_t *frame, void *context) {
+    uint32_t *count = (uint32_t*)context;
+    (void)frame;
+    (*count)++;
+}
+
+static uint64_t frame_ns(void) {
+    return peripheral_sim_uart_frame_ns(uart_drv.uart);
+}
+
+static i2c_mock_bus_t i2c_bus;
+static i2c_mock_target_t imu;
+static i2c_driver_t i2c_drv;
+static uint32_t i2c_order[4];
+static uint8_t i2c_done;
+
+static uint64_t i2c_clock(void) {
+    return i2c_mock_now(&i2c_bus);
+}
+
+static void i2c_complete(i2c_transaction_t *txn, error_t result, void *context) {
+    (void)txn;
+    (void)result;
+    if (i2c_done < 4) {
+        i2c_order[i2c_done++] = (uint32_t)(uintptr_t)context;
+    }
+}
+
+// IMU at 0x68 on a 400 kHz bus; accel/gyro sample block at 0x3B..0x46
+static void setup_i2c(void) {
+    i2c_mock_init(&i2c_bus);
+    memset(&imu, 0, sizeof(imu));
+    imu.address = 0x68;
+    for (uint8_t i = 0; i < 12; i++) {
+        imu.regs[0x3B + i] = (uint8_t)(0x10 + i);
+    }
+    i2c_mock_attach(&i2c_bus, &imu);
+
+    i2c_driver_init(&i2c_drv, 0x68, 400000);
+    i2c_drv.backend = &i2c_bus.backend;
+    i2c_drv.clock = i2c_clock;
+}
+
+// ====================================================================
+// Setup and Teardown
+// ====================================================================
+
+void setUp(void) {
+    peripheral_sim_config_t sim_config = {8000000, 0};
+    uart_config_t config = {115200, 8, 0, 0, false};
+    peripheral_sim_device_t device = {wire_rx, NULL, NULL, NULL};
+
+    memset(&uart_drv, 0, sizeof(uart_drv));
+    memset(&i2c_drv, 0, sizeof(i2c_drv));
+    memset(&events, 0, sizeof(events));
+    i2c_done = 0;
+    wire_count = 0;
+
+    peripheral_sim_init(&sim, &sim_config);
+    peripheral_sim_install(&sim);
+
+    uart_drv.tx_complete_cb = tx_complete;
+    uart_drv.rx_complete_cb = rx_complete;
+    uart_drv.rx_data_cb = rx_span;
+    uart_drv.callback_context = &events;
+    uart_drv.async_context = &events;
+    uart_driver_init(&uart_drv, &config);
+    peripheral_sim_attach_uart(&sim, uart_drv.uart, &device);
+    peripheral_sim_set_irq(&sim, uart_drv.uart, uart_isr, &uart_drv);
+}
+
+void tearDown(void) {
+    peripheral_sim_uninstall();
+    uart_driver_deinit(&uart_drv);
+    i2c_driver_deinit(&i2c_drv);
+}
+
+// ====================================================================
+// Asynchronous UART Tests
+// ====================================================================
+
+void test_uart_driver_transmit_async_dma_completes_on_tc(void) {
+    uint8_t data[32];
+    for (int i = 0; i < 32; i++) data[i] = (uint8_t)i;
+    attach_dma();
+
+    TEST_ASSERT_EQUAL(ERROR_NONE, uart_driver_transmit_async(&uart_drv, data, sizeof(data)));
+    // Expected: Call returns at once; the CPU is free while the wire runs
+    TEST_ASSERT_EQUAL_UINT64(0, peripheral_sim_now(&sim));
+    TEST_ASSERT_EQUAL_UINT32(0, events.tx_done);
+
+    peripheral_sim_advance(&sim, 40 * frame_ns());
+    TEST_ASSERT_EQUAL_UINT32(1, events.tx_done);
+    TEST_ASSERT_EQUAL(ERROR_NONE, events.tx_result);
+    TEST_ASSERT_EQUAL_UINT64(32 * frame_ns(), events.tx_done_at);
+    TEST_ASSERT_EQUAL_UINT16(32, wire_count);
+    TEST_ASSERT_EQUAL_MEMORY(data, wire, 32);
+    TEST_ASSERT_EQUAL_UINT32(1, peripheral_sim_get_stats(&sim, uart_drv.uart)->irqs);
+}
+
+void test_uart_driver_transmit_async_interrupt_mode(void) {
+    uint8_t data[] = "interrupt driven";
+
+    TEST_ASSERT_EQUAL(ERROR_NONE, uart_driver_transmit_async(&uart_drv, data, 16));
+    peripheral_sim_advance(&sim, 20 * frame_ns());
+
+    // Expected: TXE refills back to back, completion on the final TC
+    TEST_ASSERT_EQUAL_UINT32(1, events.tx_done);
+    TEST_ASSERT_EQUAL_UINT64(16 * frame_ns(), events.tx_done_at);
+    TEST_ASSERT_EQUAL_MEMORY(data, wire, 16);
+}
+
+void test_uart_driver_async_rejects_second_transfer(void) {
+    uint8_t data[4] = {1, 2, 3, 4};
+    attach_dma();
+
+    TEST_ASSERT_EQUAL(ERROR_NONE, uart_driver_transmit_async(&uart_drv, data, 4));
+    // Expected: Both the async and the blocking path see the direction busy
+    TEST_ASSERT_EQUAL(ERROR_BUSY, uart_driver_transmit_async(&uart_drv, data, 4));
+    TEST_ASSERT_EQUAL(ERROR_BUSY, uart_driver_transmit(&uart_drv, data, 4));
+
+    uart_driver_abort_async(&uart_drv);
+    TEST_ASSERT_FALSE(uart_drv.tx_async_active);
+    TEST_ASSERT_FALSE(dma_tx.CCR & DMA_CCR_EN);
+}
+
+void test_uart_driver_receive_async_dma_completes_on_idle(void) {
+    uint8_t frame[40];
+    uint8_t buffer[128];
+    memset(frame, 0x3C, sizeof(frame));
+    attach_dma();
+
+    TEST_ASSERT_EQUAL(ERROR_NONE, uart_driver_receive_async(&uart_drv, buffer, sizeof(buffer)));
+    peripheral_sim_uart_inject(&sim, uart_drv.uart, frame, sizeof(frame), 0);
+    peripheral_sim_advance(&sim, 50 * frame_ns());
+
+    // Expected: Shorter frame than the buffer ends on the idle line
+    TEST_ASSERT_EQUAL_UINT32(1, events.rx_done);
+    TEST_ASSERT_EQUAL_UINT16(40, events.rx_length);
+    TEST_ASSERT_EQUAL_UINT16(40, events.span_bytes);
+    TEST_ASSERT_EQUAL_MEMORY(frame, buffer, 40);
+    TEST_ASSERT_EQUAL_UINT32(0, peripheral_sim_get_stats(&sim, uart_drv.uart)->overruns);
+}
+
+void test_uart_driver_receive_async_dma_half_transfer_span(void) {
+    uint8_t frame[64];
+    uint8_t buffer[64];
+    memset(frame, 0xA5, sizeof(frame));
+    attach_dma();
+
+    uart_driver_receive_async(&uart_drv, buffer, sizeof(buffer));
+    peripheral_sim_uart_inject(&sim, uart_drv.uart, frame, sizeof(frame), 0);
+    peripheral_sim_advance(&sim, 40 * frame_ns());
+
+    // Expected: First half handed over before the transfer completes
+    TEST_ASSERT_EQUAL_UINT32(0, events.rx_done);
+    TEST_ASSERT_EQUAL_UINT32(1, events.spans);
+    TEST_ASSERT_EQUAL_UINT16(32, events.span_bytes);
+
+    peripheral_sim_advance(&sim, 30 * frame_ns());
+    TEST_ASSERT_EQUAL_UINT32(1, events.rx_done);
+    TEST_ASSERT_EQUAL_UINT16(64, events.rx_length);
+    TEST_ASSERT_EQUAL_UINT32(2, events.spans);
+}
+
+void test_uart_driver_receive_async_interrupt_mode(void) {
+    uint8_t frame[8] = {9, 8, 7, 6, 5, 4, 3, 2};
+    uint8_t buffer[8];
+
+    uart_driver_receive_async(&uart_drv, buffer, sizeof(buffer));
+    peripheral_sim_uart_inject(&sim, uart_drv.uart, frame, sizeof(frame), 0);
+    peripheral_sim_advance(&sim, 10 * frame_ns());
+
+    // Expected: RXNE per byte, complete when the buffer is full
+    TEST_ASSERT_EQUAL_UINT32(1, events.rx_done);
+    TEST_ASSERT_EQUAL_UINT16(8, events.rx_length);
+    TEST_ASSERT_EQUAL_MEMORY(frame, buffer, 8);
+}
+
+// ====================================================================
+// Circular DMA Receive Tests
+// ====================================================================
+
+void test_uart_driver_circular_rx_requires_dma_channel(void) {
+    // Expected: Circular mode has no interrupt-only fallback
+    TEST_ASSERT_EQUAL(ERROR_INVALID_PARAM, uart_driver_start_circular_rx(&uart_drv, NULL, 0, NULL));
+}
+
+void test_uart_driver_circular_rx_feeds_framer_at_3mbaud(void) {
+    protocol_framer_t framer;
+    uint32_t messages = 0;
+    uint8_t payload[PROTOCOL_MAX_PAYLOAD];
+    uint8_t encoded[PROTOCOL_MAX_FRAME];
+    uint32_t total = 0;
+
+    memset(payload, 0x42, sizeof(payload));
+    uart_drv.uart->BRR = 3000000;
+    attach_dma();
+    protocol_framer_init(&framer, count_message, &messages);
+
+    TEST_ASSERT_EQUAL(ERROR_NONE, uart_driver_start_circular_rx(&uart_drv, NULL, 0, &framer));
+
+    // Variable-length frames back to back, several laps of the 256-byte ring
+    for (uint16_t i = 0; i < 40; i++) {
+        uint16_t length = 0;
+        protocol_wire_encode(encoded, sizeof(encoded), (uint8_t)i, payload, (uint16_t)((i * 37) % 120), &length);
+        peripheral_sim_uart_inject(&sim, uart_drv.uart, encoded, length, 0);
+        peripheral_sim_advance(&sim, length * frame_ns());
+        total += length;
+    }
+    peripheral_sim_advance(&sim, 2 * frame_ns());
+
+    // Expected: Every frame reaches the framer with no overrun
+    TEST_ASSERT_EQUAL_UINT32(40, messages);
+    TEST_ASSERT_EQUAL_UINT64(total, uart_drv.rx_stats.bytes);
+    TEST_ASSERT_EQUAL_UINT32(0, uart_drv.rx_stats.overruns);
+    TEST_ASSERT_GREATER_THAN(0, uart_drv.rx_stats.wrap_events);
+    TEST_ASSERT_EQUAL_UINT32(1, uart_drv.rx_stats.idle_events);
+    TEST_ASSERT_LESS_OR_EQUAL(128, uart_drv.rx_stats.max_bytes_per_irq);
+    TEST_ASSERT_EQUAL_UINT32(0, framer.stats.crc_errors);
+}
+
+void test_uart_driver_circular_rx_spans_on_idle(void) {
+    uint8_t ring[64];
+    uint8_t burst[10] = {0};
+    attach_dma();
+
+    uart_driver_start_circular_rx(&uart_drv, ring, sizeof(ring), NULL);
+    peripheral_sim_uart_inject(&sim, uart_drv.uart, burst, sizeof(burst), 0);
+    peripheral_sim_advance(&sim, 12 * frame_ns());
+
+    // Expected: Short burst flushed by the idle line as one zero-copy span
+    TEST_ASSERT_EQUAL_UINT32(1, events.spans);
+    TEST_ASSERT_EQUAL_UINT16(10, events.span_bytes);
+    TEST_ASSERT_EQUAL_UINT32(0, events.rx_done);
+
+    uart_driver_stop_circular_rx(&uart_drv);
+    TEST_ASSERT_FALSE(uart_drv.rx_async_active);
+    TEST_ASSERT_FALSE(dma_rx.CCR & DMA_CCR_EN);
+}
+
+// ====================================================================
+// I2C Transaction Tests
+// ====================================================================
+
+void test_i2c_driver_imu_block_is_one_transaction(void) {
+    sensor_driver_t sensor;
+    uint8_t sample[12];
+    setup_i2c();
+    memset(&sensor, 0, sizeof(sensor));
+    sensor.i2c = &i2c_drv;
+    sensor.state = DEVICE_STATE_READY;
+
+    TEST_ASSERT_EQUAL(ERROR_NONE, sensor_driver_read_block(&sensor, 0x3B, sample, 12));
+
+    // Expected: Register write, repeated START, 12-byte burst, one STOP
+    for (uint8_t i = 0; i < 12; i++) {
+        TEST_ASSERT_EQUAL_HEX8(0x10 + i, sample[i]);
+    }
+    TEST_ASSERT_EQUAL_UINT32(1, i2c_bus.stats.transactions);
+    TEST_ASSERT_EQUAL_UINT32(2, i2c_bus.stats.starts);
+    TEST_ASSERT_EQUAL_UINT32(1, imu.transactions);
+    TEST_ASSERT_EQUAL_UINT32(1, i2c_drv.stats.transactions);
+
+    // Expected: (1 + 9 + 9) + (1 + 9 + 12 * 9) + 1 bits at 2.5 us
+    TEST_ASSERT_EQUAL_UINT64(138 * 2500, i2c_mock_now(&i2c_bus));
+    TEST_ASSERT_EQUAL_UINT64(138 * 2500, i2c_drv.stats.max_ns);
+}
+
+void test_i2c_driver_write_is_single_message(void) {
+    uint8_t data[3] = {0xA1, 0xA2, 0xA3};
+    uint8_t check[3];
+    setup_i2c();
+
+    TEST_ASSERT_EQUAL(ERROR_NONE, i2c_driver_write(&i2c_drv, 0x20, data, 3));
+    // Expected: Register address and data share one address phase
+    TEST_ASSERT_EQUAL_UINT32(1, i2c_bus.stats.starts);
+    TEST_ASSERT_EQUAL_MEMORY(data, &imu.regs[0x20], 3);
+
+    TEST_ASSERT_EQUAL(ERROR_NONE, i2c_driver_read(&i2c_drv, 0x20, check, 3));
+    TEST_ASSERT_EQUAL_MEMORY(data, check, 3);
+}
+
+void test_i2c_driver_clock_stretching_and_timeout(void) {
+    uint8_t value;
+    setup_i2c();
+    imu.read_stretch_ns = 40000;
+
+    TEST_ASSERT_EQUAL(ERROR_NONE, i2c_driver_read(&i2c_drv, 0x3B, &value, 1));
+    // Expected: The target's SCL hold is added to the wire time
+    TEST_ASSERT_EQUAL_UINT64((19 + 19 + 1) * 2500 + 40000, i2c_mock_now(&i2c_bus));
+    TEST_ASSERT_EQUAL_UINT64(40000, i2c_bus.stats.stretch_ns);
+
+    i2c_bus.stretch_timeout_ns = 25000;
+    TEST_ASSERT_EQUAL(ERROR_TIMEOUT, i2c_driver_read(&i2c_drv, 0x3B, &value, 1));
+    TEST_ASSERT_EQUAL_UINT32(1, i2c_bus.stats.timeouts);
+    TEST_ASSERT_EQUAL(ERROR_TIMEOUT, i2c_drv.errors.entries[0].error_code);
+    TEST_ASSERT_EQUAL(DEVICE_STATE_READY, i2c_drv.state);
+}
+
+void test_i2c_driver_absent_target_nacks(void) {
+    uint8_t value = 0;
+    setup_i2c();
+    i2c_drv.device_addr = 0x50;
+
+    // Expected: Address phase not acknowledged, no data moved
+    TEST_ASSERT_EQUAL(ERROR_NACK, i2c_driver_read(&i2c_drv, 0x00, &value, 1));
+    TEST_ASSERT_EQUAL_UINT32(1, i2c_bus.stats.nacks);
+    TEST_ASSERT_EQUAL_UINT32(1, i2c_drv.stats.errors);
+    TEST_ASSERT_EQUAL_UINT32(0, imu.transactions);
+}
+
+void test_i2c_driver_queue_runs_in_order_and_dma_saves_irqs(void) {
+    uint8_t reg = 0x3B;
+    uint8_t block[12];
+    i2c_msg_t msgs[2] = {{0x68, 0, &reg, 1}, {0x68, I2C_MSG_READ, block, 12}};
+    i2c_transaction_t txns[3];
+    setup_i2c();
+
+    for (uint8_t i = 0; i < 3; i++) {
+        memset(&txns[i], 0, sizeof(txns[i]));
+        txns[i].msgs = msgs;
+        txns[i].msg_count = 2;
+        txns[i].completion_cb = i2c_complete;
+        txns[i].context = (void*)(uintptr_t)(i + 1);
+    }
+
+    TEST_ASSERT_EQUAL(ERROR_NONE, i2c_driver_submit(&i2c_drv, &txns[0]));
+    uint32_t irqs_interrupt = i2c_bus.stats.irqs;
+
+    i2c_drv.use_dma = true;
+    i2c_drv.dma_tx = &dma_tx;
+    i2c_drv.dma_rx = &dma_rx;
+    TEST_ASSERT_EQUAL(ERROR_NONE, i2c_driver_submit(&i2c_drv, &txns[1]));
+    TEST_ASSERT_EQUAL(ERROR_NONE, i2c_driver_submit(&i2c_drv, &txns[2]));
+
+    // Expected: Completions in submit order
+    TEST_ASSERT_EQUAL_UINT8(3, i2c_done);
+    TEST_ASSERT_EQUAL_UINT32(1, i2c_order[0]);
+    TEST_ASSERT_EQUAL_UINT32(2, i2c_order[1]);
+    TEST_ASSERT_EQUAL_UINT32(3, i2c_order[2]);
+    TEST_ASSERT_TRUE(txns[2].completed_at > txns[1].completed_at);
+
+    // Expected: 4 + 13 interrupts per byte-driven read, 4 + 2 with DMA
+    TEST_ASSERT_EQUAL_UINT32(17, irqs_interrupt);
+    TEST_ASSERT_EQUAL_UINT32(17 + 2 * 6, i2c_bus.stats.irqs);
+}
+
+int main(void) {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_uart_driver_transmit_async_dma_completes_on_tc);
+    RUN_TEST(test_uart_driver_transmit_async_interrupt_mode);
+    RUN_TEST(test_uart_driver_async_rejects_second_transfer);
+    RUN_TEST(test_uart_driver_receive_async_dma_completes_on_idle);
+    RUN_TEST(test_uart_driver_receive_async_dma_half_transfer_span);
+    RUN_TEST(test_uart_driver_receive_async_interrupt_mode);
+    RUN_TEST(test_uart_driver_circular_rx_requires_dma_channel);
+    RUN_TEST(test_uart_driver_circular_rx_feeds_framer_at_3mbaud);
+    RUN_TEST(test_uart_driver_circular_rx_spans_on_idle);
+    RUN_TEST(test_i2c_driver_imu_block_is_one_transaction);
+    RUN_TEST(test_i2c_driver_write_is_single_message);
+    RUN_TEST(test_i2c_driver_clock_stretching_and_timeout);
+    RUN_TEST(test_i2c_driver_absent_target_nacks);
+    RUN_TEST(test_i2c_driver_queue_runs_in_order_and_dma_saves_irqs);
+
+    return UNITY_END();
+}
@@ -0,0 +1,254 @@
+/* test_dma_engine.c – Unity Tests for the memory-to-memory DMA engine */
+
+#include "unity.h"
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "dma_engine.h"
+#include "dma_host.h"
+#include "ethernet_dma.h"
+
+// ====================================================================
+// Test Fixtures
+// ====================================================================
+
+static dma_engine_t engine;
+static DMA_Channel_TypeDef channel_regs[2];
+static DMA_Channel_TypeDef *const channels[2] = {&channel_regs[0], &channel_regs[1]};
+
+static uint8_t source[80000];
+static uint8_t destination[80000];
+
+static dma_transfer_t *completed[8];
+static uint32_t completion_count;
+
+static void on_complete(dma_transfer_t *transfer, error_t result, void *context) {
+    (void)result;
+    (void)context;
+    if (completion_count < 8) {
+        completed[completion_count] = transfer;
+    }
+    completion_count++;
+}
+
+static void make_transfer(dma_transfer_t *transfer, const dma_descriptor_t *chain, uint8_t priority) {
+    memset(transfer, 0, sizeof(dma_transfer_t));
+    transfer->chain = chain;
+    transfer->priority = priority;
+    transfer->completion_cb = on_complete;
+}
+
+// ====================================================================
+// Setup and Teardown
+// ====================================================================
+
+void setUp(void) {
+    memset(channel_regs, 0, sizeof(channel_regs));
+    memset(destination, 0, sizeof(destination));
+    for (uint32_t i = 0; i < sizeof(source); i++) {
+        source[i] = (uint8_t)(i * 7 + 3);
+    }
+    memset(completed, 0, sizeof(completed));
+    completion_count = 0;
+}
+
+void tearDown(void) {
+}
+
+// ====================================================================
+// Register-Level Tests
+// ====================================================================
+
+void test_dma_engine_rejects_invalid_transfers(void) {
+    dma_descriptor_t desc = {source, destination, 16, NULL};
+    dma_transfer_t transfer;
+    DMA_Channel_TypeDef *missing[1] = {NULL};
+
+    TEST_ASSERT_EQUAL(ERROR_INVALID_PARAM, dma_engine_init(&engine, channels, 0, NULL));
+    TEST_ASSERT_EQUAL(ERROR_INVALID_PARAM, dma_engine_init(&engine, missing, 1, NULL));
+    TEST_ASSERT_EQUAL(ERROR_NONE, dma_engine_init(&engine, channels, 1, NULL));
+
+    // Expected: empty chains, zero-length descriptors and unknown
+    // priorities are refused before any register is touched
+    make_transfer(&transfer, NULL, 0);
+    TEST_ASSERT_EQUAL(ERROR_INVALID_PARAM, dma_engine_submit(&engine, &transfer));
+    desc.length = 0;
+    make_transfer(&transfer, &desc, 0);
+    TEST_ASSERT_EQUAL(ERROR_INVALID_PARAM, dma_engine_submit(&engine, &transfer));
+    desc.length = 16;
+    make_transfer(&transfer, &desc, DMA_ENGINE_PRIORITIES);
+    TEST_ASSERT_EQUAL(ERROR_INVALID_PARAM, dma_engine_submit(&engine, &transfer));
+    TEST_ASSERT_EQUAL_HEX32(0, channel_regs[0].CCR);
+    TEST_ASSERT_TRUE(dma_engine_idle(&engine));
+}
+
+void test_dma_engine_walks_descriptors_and_chunks(void) {
+    dma_descriptor_t second = {source + 70000, destination + 70000, 100, NULL};
+    dma_descriptor_t first = {source, destination, 70000, &second};
+    dma_transfer_t transfer;
+    dma_engine_init(&engine, channels, 1, NULL);
+
+    make_transfer(&transfer, &first, 2);
+    TEST_ASSERT_EQUAL(ERROR_NONE, dma_engine_submit(&engine, &transfer));
+    TEST_ASSERT_EQUAL_UINT32(70100, transfer.bytes);
+
+    // Expected: memory-to-memory, both addresses incrementing, priority in PL,
+    // the first descriptor split at the 16-bit CNDTR limit
+    uint32_t ccr = channel_regs[0].CCR;
+    TEST_ASSERT_TRUE(ccr & DMA_CCR_EN);
+    TEST_ASSERT_TRUE(ccr & DMA_CCR_MEM2MEM);
+    TEST_ASSERT_EQUAL_HEX32(DMA_CCR_MINC | DMA_CCR_PINC, ccr & (DMA_CCR_MINC | DMA_CCR_PINC));
+    TEST_ASSERT_EQUAL_UINT32(2, (ccr & DMA_CCR_PL) >> DMA_CCR_PL_Pos);
+    TEST_ASSERT_EQUAL_UINT32(DMA_ENGINE_MAX_CHUNK, channel_regs[0].CNDTR);
+
+    dma_engine_process_interrupt(&engine, 0);
+    TEST_ASSERT_EQUAL_UINT32(70000 - DMA_ENGINE_MAX_CHUNK, channel_regs[0].CNDTR);
+    dma_engine_process_interrupt(&engine, 0);
+    TEST_ASSERT_EQUAL_UINT32(100, channel_regs[0].CNDTR);
+    TEST_ASSERT_FALSE(dma_engine_transfer_done(&transfer));
+
+    // Expected: the last chunk completes the transfer and frees the channel
+    dma_engine_process_interrupt(&engine, 0);
+    TEST_ASSERT_TRUE(dma_engine_transfer_done(&transfer));
+    TEST_ASSERT_EQUAL(ERROR_NONE, transfer.result);
+    TEST_ASSERT_EQUAL_UINT32(1, completion_count);
+    TEST_ASSERT_FALSE(channel_regs[0].CCR & DMA_CCR_EN);
+    TEST_ASSERT_TRUE(dma_engine_idle(&engine));
+
+    dma_engine_stats_t stats;
+    dma_engine_get_stats(&engine, &stats);
+    TEST_ASSERT_EQUAL_UINT32(1, stats.transfers);
+    TEST_ASSERT_EQUAL_UINT32(2, stats.descriptors);
+    TEST_ASSERT_EQUAL_UINT32(3, stats.chunks);
+    TEST_ASSERT_EQUAL_UINT64(70100, stats.bytes);
+}
+
+void test_dma_engine_arbitrates_by_priority(void) {
+    dma_descriptor_t desc[4] = {
+        {source, destination, 8, NULL},
+        {source + 8, destination + 8, 8, NULL},
+        {source + 16, destination + 16, 8, NULL},
+        {source + 24, destination + 24, 8, NULL},
+    };
+    dma_transfer_t running, low_a, high, low_b;
+    dma_engine_init(&engine, channels, 1, NULL);
+
+    make_transfer(&running, &desc[0], 0);
+    make_transfer(&low_a, &desc[1], 0);
+    make_transfer(&high, &desc[2], 3);
+    make_transfer(&low_b, &desc[3], 0);
+    dma_engine_submit(&engine, &running);
+    dma_engine_submit(&engine, &low_a);
+    dma_engine_submit(&engine, &high);
+    dma_engine_submit(&engine, &low_b);
+
+    // Expected: the freed channel serves the high-priority transfer first,
+    // then the low ones in submission order
+    for (uint8_t i = 0; i < 4; i++) {
+        dma_engine_process_interrupt(&engine, 0);
+    }
+    TEST_ASSERT_EQUAL_UINT32(4, completion_count);
+    TEST_ASSERT_EQUAL_PTR(&running, completed[0]);
+    TEST_ASSERT_EQUAL_PTR(&high, completed[1]);
+    TEST_ASSERT_EQUAL_PTR(&low_a, completed[2]);
+    TEST_ASSERT_EQUAL_PTR(&low_b, completed[3]);
+
+    dma_engine_stats_t stats;
+    dma_engine_get_stats(&engine, &stats);
+    TEST_ASSERT_EQUAL_UINT32(3, stats.queued);
+    TEST_ASSERT_EQUAL_UINT32(3, stats.max_pending);
+}
+
+// ====================================================================
+// Host Backend Tests
+// ====================================================================
+
+void test_dma_engine_host_workers_copy_scatter_gather(void) {
+    dma_host_t host;
+    dma_descriptor_t desc[8][4];
+    dma_transfer_t transfers[8];
+
+    TEST_ASSERT_EQUAL(ERROR_NONE, dma_host_init(&host, 2));
+    dma_engine_init(&engine, channels, 2, &host.backend);
+
+    // Eight transfers of four 2500-byte pieces, gathered in reverse order
+    for (uint8_t t = 0; t < 8; t++) {
+        for (uint8_t d = 0; d < 4; d++) {
+            uint32_t offset = t * 10000 + d * 2500;
+            desc[t][d].source = source + offset;
+            desc[t][d].destination = destination + t * 10000 + (3 - d) * 2500;
+            desc[t][d].length = 2500;
+            desc[t][d].next = d < 3 ? &desc[t][d + 1] : NULL;
+        }
+        make_transfer(&transfers[t], desc[t], t % DMA_ENGINE_PRIORITIES);
+        TEST_ASSERT_EQUAL(ERROR_NONE, dma_engine_submit(&engine, &transfers[t]));
+    }
+    for (uint8_t t = 0; t < 8; t++) {
+        dma_engine_wait(&engine, &transfers[t]);
+        TEST_ASSERT_EQUAL(ERROR_NONE, transfers[t].result);
+    }
+
+    // Expected: every piece landed where its descriptor pointed
+    for (uint8_t t = 0; t < 8; t++) {
+        for (uint8_t d = 0; d < 4; d++) {
+            TEST_ASSERT_EQUAL_MEMORY(source + t * 10000 + d * 2500, destination + t * 10000 + (3 - d) * 2500, 2500);
+        }
+    }
+    TEST_ASSERT_EQUAL_UINT32(8, completion_count);
+    TEST_ASSERT_TRUE(dma_engine_idle(&engine));
+    TEST_ASSERT_EQUAL_UINT64(80000, host.workers[0].bytes + host.workers[1].bytes);
+
+    dma_host_shutdown(&host);
+}
+
+void test_dma_engine_flattens_ethernet_batch(void) {
+    static const uint8_t dst_mac[6] = {0x01, 0x02, 0x03, 0x04, 0x05, 0x06};
+    static const uint8_t src_mac[6] = {0x0A, 0x0B, 0x0C, 0x0D, 0x0E, 0x0F};
+    static uint8_t scratch[3][ETHERNET_SINK_SCRATCH];
+    static uint8_t expected[ETHERNET_SINK_SCRATCH];
+    ethernet_fragment_t fragments[3][2];
+    ethernet_tx_frame_t frames[3];
+    dma_host_t host;
+    ethernet_dma_t eth_dma;
+
+    dma_host_init(&host, 2);
+    dma_engine_init(&engine, channels, 2, &host.backend);
+    TEST_ASSERT_EQUAL(ERROR_NONE, ethernet_dma_init(&eth_dma, &engine, 1));
+
+    // A padded short frame, a two-fragment frame and a full-size frame
+    const uint16_t lengths[3][2] = {{20, 0}, {300, 700}, {1000, 500}};
+    for (uint8_t f = 0; f < 3; f++) {
+        fragments[f][0].data = source + f * 3000;
+        fragments[f][0].length = lengths[f][0];
+        fragments[f][1].data = source + f * 3000 + 1500;
+        fragments[f][1].length = lengths[f][1];
+        ethernet_build_frame(dst_mac, src_mac, 0x88B5, fragments[f], lengths[f][1] ? 2 : 1, &frames[f]);
+    }
+
+    TEST_ASSERT_EQUAL(PROTOCOL_ERROR_NONE, ethernet_dma_flatten(frames, 3, scratch, &eth_dma));
+
+    // Expected: byte for byte what the memcpy flattener produces
+    for (uint8_t f = 0; f < 3; f++) {
+        uint16_t length = 0;
+        ethernet_frame_flatten(&frames[f], expected, sizeof(expected), &length);
+        TEST_ASSERT_EQUAL_UINT16(frames[f].frame_length, length);
+        TEST_ASSERT_EQUAL_MEMORY(expected, scratch[f], length);
+    }
+    TEST_ASSERT_EQUAL_UINT32(1, eth_dma.batches);
+    TEST_ASSERT_EQUAL_UINT32(0, eth_dma.fallbacks);
+
+    dma_host_shutdown(&host);
+}
+
+int main(void) {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_dma_engine_rejects_invalid_transfers);
+    RUN_TEST(test_dma_engine_walks_descriptors_and_chunks);
+    RUN_TEST(test_dma_engine_arbitrates_by_priority);
+    RUN_TEST(test_dma_engine_host_workers_copy_scatter_gather);
+    RUN_TEST(test_dma_engine_flattens_ethernet_batch);
+
+    return UNITY_END();
+}
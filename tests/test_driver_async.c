@@ -0,0 +1,369 @@
+/* test_driver_async.c – Unity Tests for the asynchronous driver request channels */
+
+#include "unity.h"
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "driver_async.h"
+#include "peripheral_sim.h"
+#include "i2c_mock.h"
+
+// ====================================================================
+// Test Fixtures
+// ====================================================================
+
+static peripheral_sim_t sim;
+static uart_driver_t uart_drv;
+static spi_driver_t spi_drv;
+static spi_queue_t spi_q;
+static DMA_Channel_TypeDef uart_dma_tx;
+static DMA_Channel_TypeDef spi_dma_tx;
+static DMA_Channel_TypeDef spi_dma_rx;
+static GPIO_TypeDef cs_port;
+static peripheral_sim_regmap_t adc;
+static const spi_device_t adc_dev = {&cs_port, 0, 0, 1};
+
+static uint8_t wire[256];
+static uint16_t wire_count;
+
+static driver_request_t *started[8];
+static uint8_t start_count;
+static driver_request_t *finished[8];
+static uint8_t finish_count;
+static bool congestion[4];
+static uint8_t congestion_count;
+
+static void wire_rx(peripheral_sim_t *s, USART_TypeDef *u, uint8_t byte, void *context) {
+    (void)s;
+    (void)u;
+    (void)context;
+    if (wire_count < sizeof(wire)) {
+        wire[wire_count++] = byte;
+    }
+}
+
+static void uart_isr(void *context) {
+    uart_driver_process_interrupt((uart_driver_t*)context);
+}
+
+static void spi_dma_isr(void *context) {
+    spi_queue_process_interrupt((spi_queue_t*)context);
+}
+
+// Bus that accepts requests and completes them when the test says so
+static error_t manual_start(driver_async_t *channel, driver_request_t *req, void *context) {
+    (void)channel;
+    (void)context;
+    if (start_count < 8) {
+        started[start_count++] = req;
+    }
+    return ERROR_NONE;
+}
+
+// Bus that completes every request inside start
+static error_t sync_start(driver_async_t *channel, driver_request_t *req, void *context) {
+    (void)context;
+    driver_async_complete(channel, req, ERROR_NONE);
+    return ERROR_NONE;
+}
+
+static void on_complete(driver_request_t *req, error_t result, void *context) {
+    (void)result;
+    (void)context;
+    if (finish_count < 8) {
+        finished[finish_count] = req;
+    }
+    finish_count++;
+}
+
+static void on_backpressure(driver_async_t *channel, bool congested, void *context) {
+    (void)channel;
+    (void)context;
+    if (congestion_count < 4) {
+        congestion[congestion_count++] = congested;
+    }
+}
+
+static void make_request(driver_request_t *req) {
+    memset(req, 0, sizeof(driver_request_t));
+    req->completion_cb = on_complete;
+}
+
+// ====================================================================
+// Setup and Teardown
+// ====================================================================
+
+void setUp(void) {
+    peripheral_sim_config_t sim_config = {8000000, 0};
+    uart_config_t uart_config = {115200, 8, 0, 0, false};
+    spi_config_t spi_config = {1, 8, 0, 0, false, false};
+    peripheral_sim_device_t uart_device = {wire_rx, NULL, NULL, NULL};
+
+    memset(&uart_drv, 0, sizeof(uart_drv));
+    memset(&spi_drv, 0, sizeof(spi_drv));
+    memset(&uart_dma_tx, 0, sizeof(uart_dma_tx));
+    memset(&spi_dma_tx, 0, sizeof(spi_dma_tx));
+    memset(&spi_dma_rx, 0, sizeof(spi_dma_rx));
+    memset(&cs_port, 0, sizeof(cs_port));
+    memset(&adc, 0, sizeof(adc));
+    wire_count = 0;
+    start_count = 0;
+    finish_count = 0;
+    congestion_count = 0;
+
+    cs_port.MODER = 0x1U;
+    cs_port.ODR = 0x1U;
+    adc.regs[0x10] = 0xA5;
+    adc.regs[0x11] = 0x5A;
+
+    peripheral_sim_init(&sim, &sim_config);
+    peripheral_sim_install(&sim);
+
+    uart_driver_init(&uart_drv, &uart_config);
+    uart_drv.dma_tx = &uart_dma_tx;
+    peripheral_sim_attach_uart(&sim, uart_drv.uart, &uart_device);
+    peripheral_sim_attach_dma(&sim, &uart_dma_tx, uart_drv.uart, true);
+    peripheral_sim_set_irq(&sim, uart_drv.uart, uart_isr, &uart_drv);
+    peripheral_sim_set_irq(&sim, &uart_dma_tx, uart_isr, &uart_drv);
+
+    spi_driver_init(&spi_drv, &spi_config);
+    spi_drv.dma_tx = &spi_dma_tx;
+    spi_drv.dma_rx = &spi_dma_rx;
+    peripheral_sim_device_t adc_device = peripheral_sim_regmap_device(&adc);
+    peripheral_sim_attach_spi(&sim, spi_drv.spi, &cs_port, 0, &adc_device);
+    peripheral_sim_attach_dma(&sim, &spi_dma_tx, spi_drv.spi, true);
+    peripheral_sim_attach_dma(&sim, &spi_dma_rx, spi_drv.spi, false);
+    spi_queue_init(&spi_q, &spi_drv, peripheral_sim_clock);
+    peripheral_sim_set_irq(&sim, &spi_dma_rx, spi_dma_isr, &spi_q);
+}
+
+void tearDown(void) {
+    peripheral_sim_uninstall();
+    uart_driver_deinit(&uart_drv);
+    spi_driver_deinit(&spi_drv);
+}
+
+// ====================================================================
+// Channel Tests
+// ====================================================================
+
+void test_driver_async_backpressure_and_futures(void) {
+    driver_async_config_t config = {3, 1, NULL};
+    driver_async_t channel;
+    driver_request_t req[4];
+
+    TEST_ASSERT_EQUAL(ERROR_INVALID_PARAM, driver_async_init(&channel, &config, NULL, 1, NULL));
+    TEST_ASSERT_EQUAL(ERROR_NONE, driver_async_init(&channel, &config, manual_start, 1, NULL));
+    driver_async_set_backpressure(&channel, on_backpressure, NULL);
+
+    for (uint8_t i = 0; i < 4; i++) {
+        make_request(&req[i]);
+    }
+    TEST_ASSERT_EQUAL(ERROR_NONE, driver_async_submit(&channel, &req[0]));
+    TEST_ASSERT_EQUAL(ERROR_NONE, driver_async_submit(&channel, &req[1]));
+    TEST_ASSERT_EQUAL(0, congestion_count);
+    TEST_ASSERT_EQUAL(ERROR_NONE, driver_async_submit(&channel, &req[2]));
+
+    // Expected: the third request fills the channel; the fourth bounces
+    TEST_ASSERT_EQUAL(1, congestion_count);
+    TEST_ASSERT_TRUE(congestion[0]);
+    TEST_ASSERT_EQUAL(ERROR_BUSY, driver_async_submit(&channel, &req[3]));
+    TEST_ASSERT_EQUAL_UINT32(1, channel.stats.rejected);
+    TEST_ASSERT_EQUAL_UINT16(0, driver_async_space(&channel));
+
+    // Expected: one request on the bus at a time, the rest waiting
+    TEST_ASSERT_EQUAL(1, start_count);
+    TEST_ASSERT_EQUAL(DRIVER_REQUEST_ACTIVE, req[0].state);
+    TEST_ASSERT_EQUAL(DRIVER_REQUEST_QUEUED, req[1].state);
+    TEST_ASSERT_FALSE(driver_request_done(&req[0]));
+
+    driver_async_complete(&channel, &req[0], ERROR_NONE);
+    TEST_ASSERT_TRUE(driver_request_done(&req[0]));
+    TEST_ASSERT_EQUAL(ERROR_NONE, req[0].result);
+    TEST_ASSERT_EQUAL_PTR(&req[1], started[1]);
+    TEST_ASSERT_EQUAL(1, congestion_count);
+
+    // Expected: released once the depth drops to low water
+    driver_async_complete(&channel, &req[1], ERROR_TIMEOUT);
+    TEST_ASSERT_EQUAL(2, congestion_count);
+    TEST_ASSERT_FALSE(congestion[1]);
+    TEST_ASSERT_EQUAL(ERROR_TIMEOUT, req[1].result);
+
+    driver_async_complete(&channel, &req[2], ERROR_NONE);
+    TEST_ASSERT_TRUE(driver_async_idle(&channel));
+    TEST_ASSERT_EQUAL(3, finish_count);
+    TEST_ASSERT_EQUAL_PTR(&req[0], finished[0]);
+    TEST_ASSERT_EQUAL_PTR(&req[2], finished[2]);
+    TEST_ASSERT_EQUAL_UINT32(3, channel.stats.completed);
+    TEST_ASSERT_EQUAL_UINT32(1, channel.stats.errors);
+    TEST_ASSERT_EQUAL_UINT16(3, channel.stats.max_depth);
+}
+
+static void resubmit(driver_request_t *req, error_t result, void *context) {
+    driver_async_t *channel = (driver_async_t*)context;
+    (void)result;
+    if (++finish_count < 100) {
+        driver_async_submit(channel, req);
+    }
+}
+
+void test_driver_async_synchronous_bus_resubmits_from_callback(void) {
+    driver_async_config_t config = {2, 0, NULL};
+    driver_async_t channel;
+    driver_request_t req;
+
+    driver_async_init(&channel, &config, sync_start, 1, NULL);
+    memset(&req, 0, sizeof(req));
+    req.completion_cb = resubmit;
+    req.context = &channel;
+
+    // Expected: completions inside start chain without recursing per request
+    TEST_ASSERT_EQUAL(ERROR_NONE, driver_async_submit(&channel, &req));
+    TEST_ASSERT_EQUAL(100, finish_count);
+    TEST_ASSERT_TRUE(driver_request_done(&req));
+    TEST_ASSERT_TRUE(driver_async_idle(&channel));
+    TEST_ASSERT_EQUAL_UINT32(100, channel.stats.completed);
+}
+
+// ====================================================================
+// Driver Binding Tests
+// ====================================================================
+
+void test_driver_async_uart_and_spi_overlap(void) {
+    driver_async_config_t config = {8, 4, peripheral_sim_clock};
+    driver_async_uart_t uart;
+    driver_async_spi_t spi;
+    driver_request_t tx[2];
+    driver_request_t reads[4];
+    spi_segment_t segments[4][1];
+    uint8_t cmd[3] = {0x10 | PERIPHERAL_SIM_REGMAP_READ, 0, 0};
+    uint8_t rx[4][3];
+    uint8_t data[2][32];
+
+    uart_drv.callback_context = &sim;
+    TEST_ASSERT_EQUAL(ERROR_NONE, driver_async_bind_uart(&uart, &uart_drv, &config));
+    TEST_ASSERT_EQUAL(ERROR_NONE, driver_async_bind_spi(&spi, &spi_q, &config));
+    // Expected: the binding leaves the user's callback context alone
+    TEST_ASSERT_EQUAL_PTR(&sim, uart_drv.callback_context);
+
+    for (uint8_t i = 0; i < 2; i++) {
+        memset(data[i], 0x30 + i, sizeof(data[i]));
+        make_request(&tx[i]);
+        tx[i].op.uart_tx.data = data[i];
+        tx[i].op.uart_tx.size = sizeof(data[i]);
+        TEST_ASSERT_EQUAL(ERROR_NONE, driver_async_submit(&uart.tx, &tx[i]));
+    }
+    for (uint8_t i = 0; i < 4; i++) {
+        make_request(&reads[i]);
+        segments[i][0].tx = cmd;
+        segments[i][0].rx = rx[i];
+        segments[i][0].length = 3;
+        reads[i].op.spi.device = &adc_dev;
+        reads[i].op.spi.segments = segments[i];
+        reads[i].op.spi.segment_count = 1;
+        TEST_ASSERT_EQUAL(ERROR_NONE, driver_async_submit(&spi.channel, &reads[i]));
+    }
+
+    // Expected: every submit returned before any bus time passed
+    TEST_ASSERT_EQUAL_UINT64(0, peripheral_sim_now(&sim));
+
+    while (!(driver_async_idle(&uart.tx) && driver_async_idle(&spi.channel)) && peripheral_sim_step(&sim)) {
+    }
+
+    for (uint8_t i = 0; i < 4; i++) {
+        TEST_ASSERT_TRUE(driver_request_done(&reads[i]));
+        TEST_ASSERT_EQUAL(ERROR_NONE, reads[i].result);
+        TEST_ASSERT_EQUAL_HEX8(0xA5, rx[i][1]);
+        TEST_ASSERT_EQUAL_HEX8(0x5A, rx[i][2]);
+    }
+    TEST_ASSERT_TRUE(driver_request_done(&tx[1]));
+    TEST_ASSERT_EQUAL_UINT16(64, wire_count);
+    TEST_ASSERT_EQUAL_MEMORY(data[0], wire, 32);
+    TEST_ASSERT_EQUAL_MEMORY(data[1], wire + 32, 32);
+
+    // Expected: the SPI reads ran while the UART was still sending, so the
+    // whole batch takes no longer than the UART alone
+    uint64_t uart_ns = 64 * peripheral_sim_uart_frame_ns(uart_drv.uart);
+    TEST_ASSERT_EQUAL_UINT64(uart_ns, tx[1].completed_at);
+    TEST_ASSERT_LESS_THAN(uart_ns / 4, reads[3].completed_at);
+    TEST_ASSERT_EQUAL_UINT64(tx[0].completed_at, tx[1].started_at);
+}
+
+void test_driver_async_i2c_and_can(void) {
+    driver_async_config_t config = {40, 8, NULL};
+    i2c_mock_bus_t bus;
+    i2c_mock_target_t imu;
+    i2c_driver_t i2c;
+    can_driver_t can;
+    driver_async_i2c_t i2c_async;
+    driver_async_can_t can_async;
+    driver_request_t reads[2];
+    driver_request_t frames[35];
+    uint8_t reg = 0x3B;
+    uint8_t sample[2][6];
+    i2c_msg_t msgs[2][2];
+
+    i2c_mock_init(&bus);
+    memset(&imu, 0, sizeof(imu));
+    imu.address = 0x68;
+    for (uint8_t i = 0; i < 6; i++) {
+        imu.regs[0x3B + i] = (uint8_t)(0x10 + i);
+    }
+    i2c_mock_attach(&bus, &imu);
+    memset(&i2c, 0, sizeof(i2c));
+    i2c_driver_init(&i2c, 0x68, 400000);
+    i2c.backend = &bus.backend;
+    TEST_ASSERT_EQUAL(ERROR_NONE, driver_async_bind_i2c(&i2c_async, &i2c, &config));
+
+    // Expected: the I2C backend runs to STOP inside submit
+    for (uint8_t i = 0; i < 2; i++) {
+        msgs[i][0] = (i2c_msg_t){0x68, 0, &reg, 1};
+        msgs[i][1] = (i2c_msg_t){0x68, I2C_MSG_READ, sample[i], 6};
+        make_request(&reads[i]);
+        reads[i].op.i2c.msgs = msgs[i];
+        reads[i].op.i2c.msg_count = 2;
+        TEST_ASSERT_EQUAL(ERROR_NONE, driver_async_submit(&i2c_async.channel, &reads[i]));
+        TEST_ASSERT_TRUE(driver_request_done(&reads[i]));
+        TEST_ASSERT_EQUAL_HEX8(0x15, sample[i][5]);
+    }
+
+    memset(&can, 0, sizeof(can));
+    can_driver_init(&can, 500000);
+    can.callback_context = &bus;
+    TEST_ASSERT_EQUAL(ERROR_NONE, driver_async_bind_can(&can_async, &can, &config));
+    TEST_ASSERT_EQUAL_PTR(&bus, can.callback_context);
+    for (uint8_t i = 0; i < 35; i++) {
+        make_request(&frames[i]);
+        frames[i].op.can.id = 0x100 + i;
+        frames[i].op.can.dlc = 1;
+        TEST_ASSERT_EQUAL(ERROR_NONE, driver_async_submit(&can_async.channel, &frames[i]));
+    }
+
+    // Expected: the 31-slot TX queue fills, the rest wait in the channel
+    TEST_ASSERT_EQUAL(DRIVER_REQUEST_ACTIVE, frames[30].state);
+    TEST_ASSERT_EQUAL(DRIVER_REQUEST_QUEUED, frames[31].state);
+    TEST_ASSERT_EQUAL(DEVICE_STATE_READY, can.state);
+
+    finish_count = 0;
+    for (uint8_t i = 0; i < 35; i++) {
+        can_driver_process_tx_complete(&can);
+    }
+    TEST_ASSERT_EQUAL(35, finish_count);
+    TEST_ASSERT_TRUE(driver_request_done(&frames[34]));
+    TEST_ASSERT_TRUE(driver_async_idle(&can_async.channel));
+
+    i2c_driver_deinit(&i2c);
+    can_driver_deinit(&can);
+}
+
+int main(void) {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_driver_async_backpressure_and_futures);
+    RUN_TEST(test_driver_async_synchronous_bus_resubmits_from_callback);
+    RUN_TEST(test_driver_async_uart_and_spi_overlap);
+    RUN_TEST(test_driver_async_i2c_and_can);
+
+    return UNITY_END();
+}
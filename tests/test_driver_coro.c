@@ -0,0 +1,373 @@
+/* test_driver_coro.c – Unity Tests for the driver coroutines and their executor */
+
+#include "unity.h"
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "driver_coro.h"
+#include "peripheral_sim.h"
+#include "i2c_mock.h"
+
+// ====================================================================
+// Test Fixtures
+// ====================================================================
+
+#define FIXTURE_CORO_COUNT  8
+
+typedef struct {
+    uint32_t step;
+    uint8_t reg;
+    uint8_t data[6];
+    i2c_msg_t msgs[2];
+} fixture_frame_t;
+
+static uint64_t storage[DRIVER_CORO_POOL_BYTES(sizeof(fixture_frame_t), FIXTURE_CORO_COUNT) / sizeof(uint64_t)];
+static driver_coro_t *timers[FIXTURE_CORO_COUNT];
+static driver_coro_pool_t pool;
+static driver_coro_exec_t exec;
+
+static uint64_t now_ns;
+static uint32_t order[16];
+static uint8_t order_count;
+static driver_request_t *started[4];
+static uint8_t start_count;
+
+static uint64_t test_clock(void) {
+    return now_ns;
+}
+
+static void record(uint32_t value) {
+    if (order_count < 16) {
+        order[order_count++] = value;
+    }
+}
+
+static error_t manual_start(driver_async_t *channel, driver_request_t *req, void *context) {
+    (void)channel;
+    (void)context;
+    if (start_count < 4) {
+        started[start_count++] = req;
+    }
+    return ERROR_NONE;
+}
+
+// Sleeps for arg microseconds, twice
+static driver_coro_status_t sleeper(driver_coro_t *co) {
+    uint32_t us = (uint32_t)(uintptr_t)co->arg;
+
+    DRIVER_CORO_BEGIN(co);
+    DRIVER_CORO_SLEEP(co, us * 1000ULL);
+    record(us);
+    DRIVER_CORO_SLEEP(co, us * 1000ULL);
+    record(us + 1000);
+    DRIVER_CORO_END(co);
+}
+
+static driver_coro_status_t awaiter(driver_coro_t *co) {
+    DRIVER_CORO_BEGIN(co);
+    DRIVER_CORO_AWAIT(co, (driver_async_t*)co->arg);
+    record(co->result);
+    DRIVER_CORO_END(co);
+}
+
+// Accelerometer conversation: start a conversion, wait for it, burst-read
+// the sample and scale it
+typedef struct {
+    driver_async_i2c_t *bus;
+    uint8_t address;
+    int32_t x;
+} accel_t;
+
+static driver_coro_status_t accel_conversation(driver_coro_t *co) {
+    fixture_frame_t *f = (fixture_frame_t*)co->frame;
+    accel_t *accel = (accel_t*)co->arg;
+
+    DRIVER_CORO_BEGIN(co);
+    f->data[0] = 0x6B;
+    f->data[1] = 0x01;
+    f->msgs[0] = (i2c_msg_t){accel->address, 0, f->data, 2};
+    co->req.op.i2c.msgs = f->msgs;
+    co->req.op.i2c.msg_count = 1;
+    DRIVER_CORO_AWAIT(co, &accel->bus->channel);
+    if (co->result != ERROR_NONE) return DRIVER_CORO_FINISHED;
+
+    DRIVER_CORO_SLEEP(co, 1000000);
+
+    f->reg = 0x3B;
+    f->msgs[0] = (i2c_msg_t){accel->address, 0, &f->reg, 1};
+    f->msgs[1] = (i2c_msg_t){accel->address, I2C_MSG_READ, f->data, 6};
+    co->req.op.i2c.msgs = f->msgs;
+    co->req.op.i2c.msg_count = 2;
+    DRIVER_CORO_AWAIT(co, &accel->bus->channel);
+
+    accel->x = (int16_t)((f->data[0] << 8) | f->data[1]) * 4;
+    DRIVER_CORO_END(co);
+}
+
+// ====================================================================
+// Setup and Teardown
+// ====================================================================
+
+void setUp(void) {
+    now_ns = 0;
+    order_count = 0;
+    start_count = 0;
+    driver_coro_pool_init(&pool, storage, sizeof(storage), sizeof(fixture_frame_t));
+    driver_coro_exec_init(&exec, test_clock, timers, FIXTURE_CORO_COUNT);
+}
+
+void tearDown(void) {
+}
+
+// ====================================================================
+// Executor Tests
+// ====================================================================
+
+void test_driver_coro_pool_bounds_spawns(void) {
+    TEST_ASSERT_EQUAL(ERROR_INVALID_PARAM, driver_coro_pool_init(&pool, storage, 16, 64));
+    TEST_ASSERT_EQUAL(ERROR_NONE, driver_coro_pool_init(&pool, storage, sizeof(storage), sizeof(fixture_frame_t)));
+    TEST_ASSERT_EQUAL_UINT16(FIXTURE_CORO_COUNT, pool.count);
+
+    for (uint8_t i = 0; i < FIXTURE_CORO_COUNT; i++) {
+        TEST_ASSERT_EQUAL(ERROR_NONE, driver_coro_spawn(&exec, &pool, sleeper, (void*)(uintptr_t)10));
+    }
+
+    // Expected: no heap fallback once the pool is empty
+    TEST_ASSERT_EQUAL(ERROR_BUSY, driver_coro_spawn(&exec, &pool, sleeper, (void*)(uintptr_t)10));
+    TEST_ASSERT_EQUAL_UINT32(1, exec.stats.rejected);
+
+    driver_coro_exec_run(&exec);
+    now_ns = 10000;
+    driver_coro_exec_run(&exec);
+    now_ns = 20000;
+    driver_coro_exec_run(&exec);
+    TEST_ASSERT_EQUAL_UINT16(0, driver_coro_exec_live(&exec));
+    TEST_ASSERT_EQUAL_UINT16(0, pool.in_use);
+    TEST_ASSERT_EQUAL_UINT16(FIXTURE_CORO_COUNT, pool.max_in_use);
+
+    // Expected: frames come back zeroed
+    TEST_ASSERT_EQUAL(ERROR_NONE, driver_coro_spawn(&exec, &pool, sleeper, (void*)(uintptr_t)10));
+    fixture_frame_t *frame = (fixture_frame_t*)exec.ready_head->frame;
+    TEST_ASSERT_EQUAL_UINT32(0, frame->step);
+    TEST_ASSERT_EQUAL_UINT32(0, ((uintptr_t)frame) & 7u);
+}
+
+void test_driver_coro_sleeps_wake_in_deadline_order(void) {
+    const uint32_t delays[4] = {250, 100, 400, 170};
+
+    for (uint8_t i = 0; i < 4; i++) {
+        driver_coro_spawn(&exec, &pool, sleeper, (void*)(uintptr_t)delays[i]);
+    }
+    TEST_ASSERT_EQUAL_UINT32(4, driver_coro_exec_run(&exec));
+    TEST_ASSERT_EQUAL_UINT64(100000, driver_coro_exec_next_wake(&exec));
+
+    while (driver_coro_exec_live(&exec) > 0) {
+        now_ns = driver_coro_exec_next_wake(&exec);
+        driver_coro_exec_run(&exec);
+    }
+
+    // Expected: each sleeper wakes at d and 2d (second wake recorded as d + 1000)
+    const uint32_t expected[8] = {100, 170, 1100, 250, 1170, 400, 1250, 1400};
+    TEST_ASSERT_EQUAL(8, order_count);
+    TEST_ASSERT_EQUAL_UINT32_ARRAY(expected, order, 8);
+    TEST_ASSERT_EQUAL_UINT64(UINT64_MAX, driver_coro_exec_next_wake(&exec));
+}
+
+void test_driver_coro_await_parks_on_full_channel(void) {
+    driver_async_config_t config = {1, 0, NULL};
+    driver_async_t channel;
+
+    driver_async_init(&channel, &config, manual_start, 1, NULL);
+    driver_coro_spawn(&exec, &pool, awaiter, &channel);
+    driver_coro_spawn(&exec, &pool, awaiter, &channel);
+    driver_coro_exec_run(&exec);
+
+    // Expected: the second await found the channel full and waits its turn
+    TEST_ASSERT_EQUAL(1, start_count);
+    TEST_ASSERT_EQUAL_UINT32(1, exec.stats.blocked);
+    TEST_ASSERT_EQUAL(DRIVER_CORO_BLOCKED, exec.blocked_head->state);
+
+    driver_async_complete(&channel, started[0], ERROR_NONE);
+    driver_coro_exec_run(&exec);
+    TEST_ASSERT_EQUAL(2, start_count);
+    TEST_ASSERT_EQUAL(1, order_count);
+
+    driver_async_complete(&channel, started[1], ERROR_TIMEOUT);
+    driver_coro_exec_run(&exec);
+    TEST_ASSERT_EQUAL(2, order_count);
+    TEST_ASSERT_EQUAL_UINT32(ERROR_TIMEOUT, order[1]);
+    TEST_ASSERT_EQUAL_UINT16(0, driver_coro_exec_live(&exec));
+}
+
+// ====================================================================
+// Driver Conversation Tests
+// ====================================================================
+
+void test_driver_coro_i2c_conversations(void) {
+    driver_async_config_t config = {4, 1, test_clock};
+    i2c_mock_bus_t bus;
+    i2c_mock_target_t targets[3];
+    i2c_driver_t i2c;
+    driver_async_i2c_t async;
+    accel_t accels[4];
+
+    i2c_mock_init(&bus);
+    for (uint8_t i = 0; i < 3; i++) {
+        memset(&targets[i], 0, sizeof(targets[i]));
+        targets[i].address = (uint8_t)(0x68 + i);
+        targets[i].regs[0x3B] = 0x01;
+        targets[i].regs[0x3C] = (uint8_t)(0x10 * (i + 1));
+        i2c_mock_attach(&bus, &targets[i]);
+    }
+    memset(&i2c, 0, sizeof(i2c));
+    i2c_driver_init(&i2c, 0x68, 400000);
+    i2c.backend = &bus.backend;
+    driver_async_bind_i2c(&async, &i2c, &config);
+
+    for (uint8_t i = 0; i < 4; i++) {
+        accels[i].bus = &async;
+        accels[i].address = (uint8_t)(0x68 + i);
+        accels[i].x = -1;
+        TEST_ASSERT_EQUAL(ERROR_NONE, driver_coro_spawn(&exec, &pool, accel_conversation, &accels[i]));
+    }
+
+    driver_coro_exec_run(&exec);
+
+    // Expected: all four conversions are started before any one finishes
+    TEST_ASSERT_EQUAL_HEX8(0x01, targets[2].regs[0x6B]);
+    TEST_ASSERT_EQUAL_UINT16(3, driver_coro_exec_live(&exec));
+    TEST_ASSERT_EQUAL_INT32(-1, accels[0].x);
+
+    now_ns = driver_coro_exec_next_wake(&exec);
+    driver_coro_exec_run(&exec);
+
+    TEST_ASSERT_EQUAL_UINT16(0, driver_coro_exec_live(&exec));
+    TEST_ASSERT_EQUAL_INT32(0x0110 * 4, accels[0].x);
+    TEST_ASSERT_EQUAL_INT32(0x0130 * 4, accels[2].x);
+
+    // Expected: the missing target NACKs and ends its conversation early
+    TEST_ASSERT_EQUAL_INT32(-1, accels[3].x);
+    TEST_ASSERT_EQUAL_UINT32(1, async.channel.stats.errors);
+
+    i2c_driver_deinit(&i2c);
+}
+
+static driver_async_spi_t *spi_channel;
+static const spi_device_t *adc_dev;
+static uint16_t adc_samples[4];
+
+typedef struct {
+    uint32_t i;
+    uint8_t cmd[3];
+    uint8_t rx[3];
+    spi_segment_t segment;
+} adc_frame_t;
+
+static void spi_dma_isr(void *context) {
+    spi_queue_process_interrupt((spi_queue_t*)context);
+}
+
+// Samples the ADC four times at 100 us intervals over SPI DMA
+static driver_coro_status_t adc_sampler(driver_coro_t *co) {
+    adc_frame_t *f = (adc_frame_t*)co->frame;
+
+    DRIVER_CORO_BEGIN(co);
+    for (f->i = 0; f->i < 4; f->i++) {
+        f->cmd[0] = 0x10 | PERIPHERAL_SIM_REGMAP_READ;
+        f->segment.tx = f->cmd;
+        f->segment.rx = f->rx;
+        f->segment.length = 3;
+        co->req.op.spi.device = adc_dev;
+        co->req.op.spi.segments = &f->segment;
+        co->req.op.spi.segment_count = 1;
+        DRIVER_CORO_AWAIT(co, &spi_channel->channel);
+        adc_samples[f->i] = (uint16_t)((f->rx[1] << 8) | f->rx[2]);
+        DRIVER_CORO_SLEEP(co, 100000);
+    }
+    DRIVER_CORO_END(co);
+}
+
+void test_driver_coro_spi_under_simulator(void) {
+    peripheral_sim_t sim;
+    peripheral_sim_config_t sim_config = {8000000, 0};
+    spi_config_t spi_config = {1, 8, 0, 0, false, false};
+    spi_driver_t spi_drv;
+    spi_queue_t spi_q;
+    driver_async_spi_t async;
+    DMA_Channel_TypeDef dma_tx;
+    DMA_Channel_TypeDef dma_rx;
+    GPIO_TypeDef cs_port;
+    peripheral_sim_regmap_t adc;
+    const spi_device_t dev = {&cs_port, 0, 0, 1};
+    driver_async_config_t config = {4, 1, peripheral_sim_clock};
+
+    memset(&spi_drv, 0, sizeof(spi_drv));
+    memset(&dma_tx, 0, sizeof(dma_tx));
+    memset(&dma_rx, 0, sizeof(dma_rx));
+    memset(&cs_port, 0, sizeof(cs_port));
+    memset(&adc, 0, sizeof(adc));
+    cs_port.MODER = 0x1U;
+    cs_port.ODR = 0x1U;
+    adc.regs[0x10] = 0x12;
+    adc.regs[0x11] = 0x34;
+
+    peripheral_sim_init(&sim, &sim_config);
+    peripheral_sim_install(&sim);
+    spi_driver_init(&spi_drv, &spi_config);
+    spi_drv.dma_tx = &dma_tx;
+    spi_drv.dma_rx = &dma_rx;
+    peripheral_sim_device_t adc_device = peripheral_sim_regmap_device(&adc);
+    peripheral_sim_attach_spi(&sim, spi_drv.spi, &cs_port, 0, &adc_device);
+    peripheral_sim_attach_dma(&sim, &dma_tx, spi_drv.spi, true);
+    peripheral_sim_attach_dma(&sim, &dma_rx, spi_drv.spi, false);
+    spi_queue_init(&spi_q, &spi_drv, peripheral_sim_clock);
+    peripheral_sim_set_irq(&sim, &dma_rx, spi_dma_isr, &spi_q);
+    driver_async_bind_spi(&async, &spi_q, &config);
+    driver_coro_pool_init(&pool, storage, sizeof(storage), sizeof(adc_frame_t));
+    driver_coro_exec_init(&exec, peripheral_sim_clock, timers, FIXTURE_CORO_COUNT);
+
+    spi_channel = &async;
+    adc_dev = &dev;
+    memset(adc_samples, 0, sizeof(adc_samples));
+    driver_coro_spawn(&exec, &pool, adc_sampler, NULL);
+
+    // Run the executor between simulator events and sleep deadlines
+    while (driver_coro_exec_live(&exec) > 0) {
+        driver_coro_exec_run(&exec);
+        uint64_t wake = driver_coro_exec_next_wake(&exec);
+        uint64_t event = peripheral_sim_next_event(&sim);
+        if (event <= wake && event != UINT64_MAX) {
+            peripheral_sim_step(&sim);
+        } else if (wake != UINT64_MAX) {
+            peripheral_sim_advance(&sim, wake - peripheral_sim_now(&sim));
+        } else {
+            break;
+        }
+    }
+
+    TEST_ASSERT_EQUAL_UINT16(0, driver_coro_exec_live(&exec));
+    for (uint8_t i = 0; i < 4; i++) {
+        TEST_ASSERT_EQUAL_HEX16(0x1234, adc_samples[i]);
+    }
+
+    // Expected: four 100 us sleeps plus four 3-byte transfers
+    uint64_t transfer_ns = 3 * peripheral_sim_spi_frame_ns(&sim, spi_drv.spi);
+    TEST_ASSERT_GREATER_OR_EQUAL(400000 + 4 * transfer_ns, peripheral_sim_now(&sim));
+    TEST_ASSERT_LESS_THAN(420000 + 4 * transfer_ns, peripheral_sim_now(&sim));
+
+    peripheral_sim_uninstall();
+    spi_driver_deinit(&spi_drv);
+}
+
+int main(void) {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_driver_coro_pool_bounds_spawns);
+    RUN_TEST(test_driver_coro_sleeps_wake_in_deadline_order);
+    RUN_TEST(test_driver_coro_await_parks_on_full_channel);
+    RUN_TEST(test_driver_coro_i2c_conversations);
+    RUN_TEST(test_driver_coro_spi_under_simulator);
+
+    return UNITY_END();
+}
@@ -0,0 +1,185 @@
+/* test_error_telemetry.c – Unity Tests for the driver error logs, seqlock snapshots and fleet counters */
+
+#define _POSIX_C_SOURCE 200112L
+#include "unity.h"
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <pthread.h>
+
+#include "error_telemetry.h"
+#include "device_drivers.h"
+#include "timebase.h"
+
+// ====================================================================
+// Test Fixtures
+// ====================================================================
+
+#define WRITER_RECORDS  200000
+
+static error_log_t log_under_test;
+static error_log_snapshot_t snapshot;
+static error_fleet_t before;
+static error_fleet_t after;
+
+static error_t nack_transfer(i2c_driver_t *driver, const i2c_msg_t *msgs, uint8_t count, void *context) {
+    (void)driver;
+    (void)msgs;
+    (void)count;
+    (void)context;
+    return ERROR_NACK;
+}
+
+static const i2c_backend_t nack_backend = {nack_transfer, NULL};
+
+// Context carries a sequence number so readers can check ordering
+static void *writer_thread(void *arg) {
+    error_log_t *log = (error_log_t*)arg;
+    for (uint32_t i = 0; i < WRITER_RECORDS; i++) {
+        error_log_record(log, (error_t)(1 + i % 5), i);
+    }
+    return NULL;
+}
+
+static bool snapshot_consistent(const error_log_snapshot_t *snap) {
+    uint32_t sum = 0;
+    for (uint8_t i = 0; i < ERROR_TELEMETRY_CODES; i++) {
+        sum += snap->counts[i];
+    }
+    if (sum != snap->total) return false;
+
+    for (uint8_t i = 0; i < snap->count; i++) {
+        if (snap->entries[i].context != snap->total - snap->count + i) return false;
+    }
+    return true;
+}
+
+// ====================================================================
+// Setup and Teardown
+// ====================================================================
+
+void setUp(void) {
+    timebase_init(TIMEBASE_SOURCE_SIMULATED);
+    timebase_sim_set(0);
+    memset(&log_under_test, 0, sizeof(log_under_test));
+}
+
+void tearDown(void) {
+}
+
+// ====================================================================
+// Error Log Tests
+// ====================================================================
+
+void test_error_log_ring_and_counters(void) {
+    error_log_init(&log_under_test, ERROR_SOURCE_SPI);
+
+    for (uint32_t i = 0; i < ERROR_HISTORY_SIZE + 3; i++) {
+        timebase_sim_set((uint64_t)(i + 1) * 1000000);
+        error_log_record(&log_under_test, (i & 1) ? ERROR_TIMEOUT : ERROR_NACK, i);
+    }
+    error_log_record(&log_under_test, (error_t)42, 99);
+
+    TEST_ASSERT_EQUAL(ERROR_NONE, error_log_snapshot(&log_under_test, &snapshot));
+    TEST_ASSERT_EQUAL(ERROR_SOURCE_SPI, snapshot.source);
+    TEST_ASSERT_EQUAL_UINT32(ERROR_HISTORY_SIZE + 4, snapshot.total);
+    TEST_ASSERT_EQUAL_UINT8(ERROR_HISTORY_SIZE, snapshot.count);
+
+    // Expected: oldest surviving entry first, newest last, stamped in us
+    TEST_ASSERT_EQUAL_UINT32(4, snapshot.entries[0].context);
+    TEST_ASSERT_EQUAL_UINT32(5000, snapshot.entries[0].timestamp);
+    TEST_ASSERT_EQUAL_UINT32(99, snapshot.entries[ERROR_HISTORY_SIZE - 1].context);
+
+    // Expected: counters cover every error, not just the ring
+    TEST_ASSERT_EQUAL_UINT32(7, error_log_count(&log_under_test, ERROR_NACK));
+    TEST_ASSERT_EQUAL_UINT32(6, error_log_count(&log_under_test, ERROR_TIMEOUT));
+    TEST_ASSERT_EQUAL_UINT32(1, snapshot.counts[ERROR_TELEMETRY_CODES - 1]);
+
+    error_log_init(&log_under_test, ERROR_SOURCE_SPI);
+    TEST_ASSERT_EQUAL(ERROR_NONE, error_log_snapshot(&log_under_test, &snapshot));
+    TEST_ASSERT_EQUAL_UINT8(0, snapshot.count);
+    TEST_ASSERT_EQUAL_UINT32(0, error_log_count(&log_under_test, ERROR_NACK));
+}
+
+void test_error_log_driver_errors_reach_fleet(void) {
+    i2c_driver_t i2c;
+    uint8_t value;
+
+    memset(&i2c, 0, sizeof(i2c));
+    TEST_ASSERT_EQUAL(ERROR_NONE, i2c_driver_init(&i2c, 0x50, 400000));
+    i2c.backend = &nack_backend;
+
+    error_telemetry_get_fleet(&before);
+    TEST_ASSERT_EQUAL(ERROR_NACK, i2c_driver_read(&i2c, 0x10, &value, 1));
+    TEST_ASSERT_EQUAL(ERROR_NACK, i2c_driver_read(&i2c, 0x11, &value, 1));
+    error_telemetry_get_fleet(&after);
+
+    // Expected: the driver's own log names the target address
+    TEST_ASSERT_EQUAL(ERROR_NONE, error_log_snapshot(&i2c.errors, &snapshot));
+    TEST_ASSERT_EQUAL_UINT8(2, snapshot.count);
+    TEST_ASSERT_EQUAL(ERROR_NACK, snapshot.entries[1].error_code);
+    TEST_ASSERT_EQUAL_UINT32(0x50, snapshot.entries[1].context);
+
+    // Expected: fleet counters grow by source and code
+    TEST_ASSERT_EQUAL_UINT32(2, (uint32_t)(after.total - before.total));
+    TEST_ASSERT_EQUAL_UINT32(2, (uint32_t)(after.by_source[ERROR_SOURCE_I2C] - before.by_source[ERROR_SOURCE_I2C]));
+    TEST_ASSERT_EQUAL_UINT32(2, (uint32_t)(after.counts[ERROR_SOURCE_I2C][ERROR_NACK] -
+                                           before.counts[ERROR_SOURCE_I2C][ERROR_NACK]));
+
+    i2c_driver_deinit(&i2c);
+}
+
+void test_error_log_snapshots_while_writing(void) {
+    pthread_t writer;
+    uint32_t taken = 0;
+    uint32_t last_total = 0;
+
+    error_log_init(&log_under_test, ERROR_SOURCE_CAN);
+    TEST_ASSERT_EQUAL(0, pthread_create(&writer, NULL, writer_thread, &log_under_test));
+
+    while (last_total < WRITER_RECORDS) {
+        if (error_log_snapshot(&log_under_test, &snapshot) != ERROR_NONE) continue;
+        // Expected: never a torn copy, and totals never go backwards
+        TEST_ASSERT_TRUE(snapshot_consistent(&snapshot));
+        TEST_ASSERT_TRUE(snapshot.total >= last_total);
+        last_total = snapshot.total;
+        taken++;
+    }
+    pthread_join(writer, NULL);
+
+    TEST_ASSERT_GREATER_THAN(0, taken);
+    TEST_ASSERT_EQUAL(ERROR_NONE, error_log_snapshot(&log_under_test, &snapshot));
+    TEST_ASSERT_EQUAL_UINT32(WRITER_RECORDS, snapshot.total);
+    TEST_ASSERT_EQUAL_UINT32(WRITER_RECORDS - 1, snapshot.entries[ERROR_HISTORY_SIZE - 1].context);
+}
+
+void test_error_rate_over_fleet(void) {
+    error_rate_t meter;
+
+    error_log_init(&log_under_test, ERROR_SOURCE_UART);
+    error_rate_init(&meter);
+    TEST_ASSERT_EQUAL_UINT32(0, error_rate_update(&meter, 1000000000ULL));
+
+    for (uint8_t i = 0; i < 50; i++) {
+        error_log_record(&log_under_test, ERROR_OVERFLOW, i);
+    }
+
+    // Expected: 50 errors over half a second
+    TEST_ASSERT_EQUAL_UINT32(100, error_rate_update(&meter, 1500000000ULL));
+    TEST_ASSERT_EQUAL_UINT32(25, meter.smoothed);
+
+    // Expected: a quiet second brings the rate back to zero
+    TEST_ASSERT_EQUAL_UINT32(0, error_rate_update(&meter, 2500000000ULL));
+    TEST_ASSERT_EQUAL_UINT32(19, meter.smoothed);
+}
+
+int main(void) {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_error_log_ring_and_counters);
+    RUN_TEST(test_error_log_driver_errors_reach_fleet);
+    RUN_TEST(test_error_log_snapshots_while_writing);
+    RUN_TEST(test_error_rate_over_fleet);
+
+    return UNITY_END();
+}
@@ -0,0 +1,310 @@
+/* test_ethernet_sink.c – Unity Tests for scatter-gather Ethernet frames and the batched transmit sink */
+
+#include "unity.h"
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "communication_protocols.h"
+#include "ethernet_sink.h"
+
+// ====================================================================
+// Test Fixtures
+// ====================================================================
+
+#define FULL_FRAME      (ETHERNET_HEADER_SIZE + ETHERNET_MAX_PAYLOAD + ETHERNET_FCS_SIZE)
+#define BATCH           ETHERNET_SINK_MAX_BATCH
+
+static const uint8_t DST_MAC[6] = {0x01, 0x80, 0xC2, 0x00, 0x00, 0x0E};
+static const uint8_t SRC_MAC[6] = {0x02, 0x00, 0x00, 0x00, 0x00, 0x01};
+
+static uint8_t payload[ETHERNET_MAX_PAYLOAD];
+static ethernet_fragment_t fragments[BATCH][3];
+static ethernet_tx_frame_t frames[BATCH];
+static uint8_t reference[BATCH][FULL_FRAME];
+static uint8_t received[BATCH * FULL_FRAME];
+static ethernet_sink_t sink;
+static int fds[2];
+
+// Frame i carries the full payload in three fragments, tagged with its index
+static void build_batch(void) {
+    for (uint16_t i = 0; i < BATCH; i++) {
+        fragments[i][0].data = payload;
+        fragments[i][0].length = 100;
+        fragments[i][1].data = payload + 100;
+        fragments[i][1].length = 1000;
+        fragments[i][2].data = payload + 1100;
+        fragments[i][2].length = ETHERNET_MAX_PAYLOAD - 1100;
+        TEST_ASSERT_EQUAL(PROTOCOL_ERROR_NONE,
+                          ethernet_build_frame(DST_MAC, SRC_MAC, (uint16_t)(0x8800 + i), fragments[i], 3, &frames[i]));
+        uint16_t length;
+        TEST_ASSERT_EQUAL(PROTOCOL_ERROR_NONE,
+                          ethernet_frame_flatten(&frames[i], reference[i], FULL_FRAME, &length));
+    }
+}
+
+static void open_pair(int type) {
+    TEST_ASSERT_EQUAL_INT(0, socketpair(AF_UNIX, type, 0, fds));
+    fcntl(fds[0], F_SETFL, fcntl(fds[0], F_GETFL) | O_NONBLOCK);
+    fcntl(fds[1], F_SETFL, fcntl(fds[1], F_GETFL) | O_NONBLOCK);
+}
+
+// Reads everything queued on the receiving end into received[offset..];
+// returns the new end
+static size_t drain_from(size_t offset) {
+    size_t total = offset;
+    ssize_t result;
+    while (total < sizeof(received) &&
+           (result = read(fds[1], received + total, sizeof(received) - total)) > 0) {
+        total += (size_t)result;
+    }
+    return total;
+}
+
+static size_t drain(void) {
+    return drain_from(0);
+}
+
+// ====================================================================
+// Setup and Teardown
+// ====================================================================
+
+void setUp(void) {
+    for (uint16_t i = 0; i < sizeof(payload); i++) {
+        payload[i] = (uint8_t)(i * 7 + 3);
+    }
+    fds[0] = -1;
+    fds[1] = -1;
+}
+
+void tearDown(void) {
+    if (fds[0] >= 0) close(fds[0]);
+    if (fds[1] >= 0) close(fds[1]);
+}
+
+// ====================================================================
+// CRC and Frame Building Tests
+// ====================================================================
+
+void test_ethernet_crc32_known_vectors(void) {
+    const uint8_t check[] = "123456789";
+
+    // Expected: the CRC-32/IEEE check value and the empty message
+    TEST_ASSERT_EQUAL_HEX32(0xCBF43926, ~ethernet_crc32_update(0xFFFFFFFF, check, 9));
+    TEST_ASSERT_EQUAL_HEX32(0x00000000, ~ethernet_crc32_update(0xFFFFFFFF, check, 0));
+
+    // Expected: feeding the message in pieces gives the same CRC
+    uint32_t crc = ethernet_crc32_update(0xFFFFFFFF, check, 4);
+    crc = ethernet_crc32_update(crc, check + 4, 5);
+    TEST_ASSERT_EQUAL_HEX32(0xCBF43926, ~crc);
+}
+
+void test_ethernet_build_frame_fcs_leaves_residue(void) {
+    uint8_t wire[FULL_FRAME];
+    uint16_t length;
+    ethernet_fragment_t fragment = {payload, 200};
+    ethernet_tx_frame_t frame;
+
+    TEST_ASSERT_EQUAL(PROTOCOL_ERROR_NONE, ethernet_build_frame(DST_MAC, SRC_MAC, 0x0800, &fragment, 1, &frame));
+    TEST_ASSERT_EQUAL(PROTOCOL_ERROR_NONE, ethernet_frame_flatten(&frame, wire, sizeof(wire), &length));
+
+    // Expected: the CRC over a frame and its FCS is the IEEE 802.3 residue
+    TEST_ASSERT_EQUAL_UINT16(ETHERNET_HEADER_SIZE + 200 + ETHERNET_FCS_SIZE, length);
+    TEST_ASSERT_EQUAL_HEX32(0xDEBB20E3, ethernet_crc32_update(0xFFFFFFFF, wire, length));
+    TEST_ASSERT_EQUAL_HEX32(0x2144DF1C, ~ethernet_crc32_update(0xFFFFFFFF, wire, length));
+}
+
+void test_ethernet_build_frame_pads_to_minimum(void) {
+    uint8_t wire[FULL_FRAME];
+    uint8_t zeros[ETHERNET_MIN_PAYLOAD] = {0};
+    uint16_t length;
+    ethernet_fragment_t fragment = {payload, 10};
+    ethernet_tx_frame_t frame;
+
+    memset(wire, 0xAA, sizeof(wire));
+    TEST_ASSERT_EQUAL(PROTOCOL_ERROR_NONE, ethernet_build_frame(DST_MAC, SRC_MAC, 0x0800, &fragment, 1, &frame));
+    TEST_ASSERT_EQUAL(PROTOCOL_ERROR_NONE, ethernet_frame_flatten(&frame, wire, sizeof(wire), &length));
+
+    // Expected: 10 payload bytes padded with 36 zeros to a 64-byte frame
+    TEST_ASSERT_EQUAL_UINT16(10, frame.payload_length);
+    TEST_ASSERT_EQUAL_UINT16(36, frame.pad_length);
+    TEST_ASSERT_EQUAL_UINT16(64, frame.frame_length);
+    TEST_ASSERT_EQUAL_UINT16(64, length);
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(payload, wire + ETHERNET_HEADER_SIZE, 10);
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(zeros, wire + ETHERNET_HEADER_SIZE + 10, 36);
+    TEST_ASSERT_EQUAL_HEX32(0xDEBB20E3, ethernet_crc32_update(0xFFFFFFFF, wire, length));
+
+    // Expected: no fragments at all still makes a minimum-size frame
+    TEST_ASSERT_EQUAL(PROTOCOL_ERROR_NONE, ethernet_build_frame(DST_MAC, SRC_MAC, 0x0800, NULL, 0, &frame));
+    TEST_ASSERT_EQUAL_UINT16(ETHERNET_MIN_PAYLOAD, frame.pad_length);
+    TEST_ASSERT_EQUAL_UINT16(64, frame.frame_length);
+
+    // Expected: a payload at the minimum needs no padding
+    fragment.length = ETHERNET_MIN_PAYLOAD;
+    TEST_ASSERT_EQUAL(PROTOCOL_ERROR_NONE, ethernet_build_frame(DST_MAC, SRC_MAC, 0x0800, &fragment, 1, &frame));
+    TEST_ASSERT_EQUAL_UINT16(0, frame.pad_length);
+}
+
+void test_ethernet_frame_flatten_matches_contiguous_reference(void) {
+    uint8_t gathered[FULL_FRAME];
+    uint8_t contiguous[FULL_FRAME];
+    uint16_t gathered_length;
+    uint16_t contiguous_length;
+    ethernet_fragment_t pieces[4] = {{payload, 1}, {payload + 1, 0}, {payload + 1, 700}, {payload + 701, 99}};
+    ethernet_fragment_t whole = {payload, 800};
+    ethernet_tx_frame_t frame;
+
+    TEST_ASSERT_EQUAL(PROTOCOL_ERROR_NONE, ethernet_build_frame(DST_MAC, SRC_MAC, 0x88B5, pieces, 4, &frame));
+    TEST_ASSERT_EQUAL(PROTOCOL_ERROR_NONE, ethernet_frame_flatten(&frame, gathered, sizeof(gathered), &gathered_length));
+    TEST_ASSERT_EQUAL(PROTOCOL_ERROR_NONE, ethernet_build_frame(DST_MAC, SRC_MAC, 0x88B5, &whole, 1, &frame));
+    TEST_ASSERT_EQUAL(PROTOCOL_ERROR_NONE,
+                      ethernet_frame_flatten(&frame, contiguous, sizeof(contiguous), &contiguous_length));
+
+    // Expected: fragment boundaries (including an empty one) do not change the wire bytes
+    TEST_ASSERT_EQUAL_UINT16(contiguous_length, gathered_length);
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(contiguous, gathered, contiguous_length);
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(DST_MAC, gathered, 6);
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(SRC_MAC, gathered + 6, 6);
+    TEST_ASSERT_EQUAL_HEX8(0x88, gathered[12]);
+    TEST_ASSERT_EQUAL_HEX8(0xB5, gathered[13]);
+
+    // Expected: too small a buffer is refused
+    TEST_ASSERT_EQUAL(PROTOCOL_ERROR_BUFFER_OVERFLOW,
+                      ethernet_frame_flatten(&frame, gathered, (uint16_t)(contiguous_length - 1), &gathered_length));
+}
+
+void test_ethernet_build_frame_rejects_oversize(void) {
+    ethernet_fragment_t pieces[2] = {{payload, 1000}, {payload, 501}};
+    ethernet_fragment_t missing = {NULL, 4};
+    ethernet_tx_frame_t frame;
+
+    // Expected: more than 1500 payload bytes, a NULL fragment or too many fragments fail
+    TEST_ASSERT_EQUAL(PROTOCOL_ERROR_BUFFER_OVERFLOW, ethernet_build_frame(DST_MAC, SRC_MAC, 0x0800, pieces, 2, &frame));
+    TEST_ASSERT_EQUAL(PROTOCOL_ERROR_INVALID_HEADER, ethernet_build_frame(DST_MAC, SRC_MAC, 0x0800, &missing, 1, &frame));
+    TEST_ASSERT_EQUAL(PROTOCOL_ERROR_BUFFER_OVERFLOW,
+                      ethernet_build_frame(DST_MAC, SRC_MAC, 0x0800, pieces, ETHERNET_MAX_FRAGMENTS + 1, &frame));
+}
+
+// ====================================================================
+// Sink Tests
+// ====================================================================
+
+void test_ethernet_sink_stream_sends_batch(void) {
+    uint16_t sent;
+
+    build_batch();
+    open_pair(SOCK_STREAM);
+    TEST_ASSERT_EQUAL(PROTOCOL_ERROR_NONE, ethernet_sink_init(&sink, fds[0], ETHERNET_SINK_STREAM, false));
+
+    // Expected: four frames leave back to back in one writev
+    TEST_ASSERT_EQUAL(PROTOCOL_ERROR_NONE, ethernet_sink_send_batch(&sink, frames, 4, &sent));
+    TEST_ASSERT_EQUAL_UINT16(4, sent);
+    TEST_ASSERT_EQUAL_UINT32(1, sink.syscalls);
+    TEST_ASSERT_EQUAL_UINT32(4 * FULL_FRAME, sink.bytes_sent);
+    TEST_ASSERT_EQUAL_UINT32(4 * FULL_FRAME, (uint32_t)drain());
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(reference, received, 4 * FULL_FRAME);
+}
+
+void test_ethernet_sink_stream_short_write_counts_whole_frames(void) {
+    int sndbuf = 4096;
+    uint16_t sent;
+
+    build_batch();
+    open_pair(SOCK_STREAM);
+    setsockopt(fds[0], SOL_SOCKET, SO_SNDBUF, &sndbuf, sizeof(sndbuf));
+    TEST_ASSERT_EQUAL(PROTOCOL_ERROR_NONE, ethernet_sink_init(&sink, fds[0], ETHERNET_SINK_STREAM, true));
+
+    // Expected: the socket takes part of the batch, the rest times out
+    TEST_ASSERT_EQUAL(PROTOCOL_ERROR_TIMEOUT, ethernet_sink_send_batch(&sink, frames, BATCH, &sent));
+    TEST_ASSERT_TRUE(sent < BATCH);
+    TEST_ASSERT_EQUAL_UINT32(BATCH, sink.flattened);
+
+    // Expected: only frames that went out whole are reported sent, and the
+    // bytes that did go out are the frames in order
+    size_t queued = drain();
+    TEST_ASSERT_TRUE(queued > 0);
+    TEST_ASSERT_EQUAL_UINT32((uint32_t)queued, sink.bytes_sent);
+    TEST_ASSERT_EQUAL_UINT16((uint16_t)(queued / FULL_FRAME), sent);
+    TEST_ASSERT_EQUAL_UINT32(sent, sink.frames_sent);
+    TEST_ASSERT_EQUAL_UINT32(queued % FULL_FRAME, sink.partial);
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(reference, received, queued);
+
+    // Expected: retrying from sent finishes the cut frame instead of
+    // repeating its prefix, and the stream ends up as the whole batch
+    uint16_t total = sent;
+    while (total < BATCH) {
+        uint16_t more;
+        protocol_error_t err = ethernet_sink_send_batch(&sink, &frames[total], (uint16_t)(BATCH - total), &more);
+        TEST_ASSERT_TRUE(err == PROTOCOL_ERROR_NONE || err == PROTOCOL_ERROR_TIMEOUT);
+        total = (uint16_t)(total + more);
+        queued = drain_from(queued);
+    }
+    TEST_ASSERT_EQUAL_UINT32(0, sink.partial);
+    TEST_ASSERT_EQUAL_UINT32(BATCH * FULL_FRAME, (uint32_t)queued);
+    TEST_ASSERT_EQUAL_UINT32(BATCH * FULL_FRAME, sink.bytes_sent);
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(reference, received, BATCH * FULL_FRAME);
+}
+
+void test_ethernet_sink_datagram_partial_send(void) {
+    uint8_t datagram[FULL_FRAME + 1];
+    int sndbuf = 8192;
+    uint16_t sent;
+    uint16_t count = 0;
+    ssize_t result;
+
+    build_batch();
+    open_pair(SOCK_DGRAM);
+    setsockopt(fds[0], SOL_SOCKET, SO_SNDBUF, &sndbuf, sizeof(sndbuf));
+    TEST_ASSERT_EQUAL(PROTOCOL_ERROR_NONE, ethernet_sink_init(&sink, fds[0], ETHERNET_SINK_DATAGRAM, false));
+
+    // Expected: the send buffer fills part way through the batch
+    TEST_ASSERT_EQUAL(PROTOCOL_ERROR_TIMEOUT, ethernet_sink_send_batch(&sink, frames, BATCH, &sent));
+    TEST_ASSERT_TRUE(sent > 0);
+    TEST_ASSERT_TRUE(sent < BATCH);
+    TEST_ASSERT_EQUAL_UINT32(sent, sink.frames_sent);
+    TEST_ASSERT_EQUAL_UINT32((uint32_t)sent * FULL_FRAME, sink.bytes_sent);
+
+    // Expected: one whole frame per datagram, in order
+    while ((result = recv(fds[1], datagram, sizeof(datagram), 0)) > 0) {
+        TEST_ASSERT_EQUAL_INT(FULL_FRAME, (int)result);
+        TEST_ASSERT_EQUAL_UINT8_ARRAY(reference[count], datagram, FULL_FRAME);
+        count++;
+    }
+    TEST_ASSERT_EQUAL_UINT16(sent, count);
+
+    // Expected: the rest goes out once the queue has drained
+    uint16_t rest;
+    TEST_ASSERT_EQUAL(PROTOCOL_ERROR_NONE, ethernet_sink_send_batch(&sink, &frames[sent], 1, &rest));
+    TEST_ASSERT_EQUAL_UINT16(1, rest);
+    TEST_ASSERT_EQUAL_INT(FULL_FRAME, (int)recv(fds[1], datagram, sizeof(datagram), 0));
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(reference[sent], datagram, FULL_FRAME);
+}
+
+void test_ethernet_sink_invalid_params(void) {
+    uint16_t sent;
+
+    // Expected: NULL arguments and a negative descriptor are rejected
+    TEST_ASSERT_EQUAL(PROTOCOL_ERROR_INVALID_HEADER, ethernet_sink_init(&sink, -1, ETHERNET_SINK_STREAM, false));
+    TEST_ASSERT_EQUAL(PROTOCOL_ERROR_INVALID_HEADER, ethernet_sink_init(NULL, 0, ETHERNET_SINK_STREAM, false));
+    TEST_ASSERT_EQUAL(PROTOCOL_ERROR_INVALID_HEADER, ethernet_sink_send_batch(NULL, frames, 1, &sent));
+    TEST_ASSERT_EQUAL(PROTOCOL_ERROR_INVALID_HEADER, ethernet_sink_send_batch(&sink, NULL, 1, &sent));
+}
+
+int main(void) {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_ethernet_crc32_known_vectors);
+    RUN_TEST(test_ethernet_build_frame_fcs_leaves_residue);
+    RUN_TEST(test_ethernet_build_frame_pads_to_minimum);
+    RUN_TEST(test_ethernet_frame_flatten_matches_contiguous_reference);
+    RUN_TEST(test_ethernet_build_frame_rejects_oversize);
+    RUN_TEST(test_ethernet_sink_stream_sends_batch);
+    RUN_TEST(test_ethernet_sink_stream_short_write_counts_whole_frames);
+    RUN_TEST(test_ethernet_sink_datagram_partial_send);
+    RUN_TEST(test_ethernet_sink_invalid_params);
+
+    return UNITY_END();
+}
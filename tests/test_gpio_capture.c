@@ -0,0 +1,183 @@
+/* test_gpio_capture.c – Unity Tests for GPIO edge capture */
+
+#include "unity.h"
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "gpio_capture.h"
+#include "peripheral_sim.h"
+
+// ====================================================================
+// Test Fixtures
+// ====================================================================
+
+static peripheral_sim_t sim;
+static GPIO_TypeDef port;
+static gpio_capture_t capture;
+static gpio_edge_t events[GPIO_CAPTURE_RING];
+static uint32_t edge_irqs;
+
+static void edge_isr(void *context) {
+    edge_irqs++;
+    gpio_capture_sample((gpio_capture_t*)context);
+}
+
+// ====================================================================
+// Setup and Teardown
+// ====================================================================
+
+void setUp(void) {
+    peripheral_sim_config_t sim_config = {8000000, 0};
+
+    memset(&port, 0, sizeof(port));
+    memset(events, 0, sizeof(events));
+    edge_irqs = 0;
+
+    peripheral_sim_init(&sim, &sim_config);
+    peripheral_sim_install(&sim);
+    peripheral_sim_attach_gpio(&sim, &port);
+}
+
+void tearDown(void) {
+    peripheral_sim_uninstall();
+}
+
+// ====================================================================
+// Ring Tests
+// ====================================================================
+
+void test_gpio_capture_rejects_invalid_params(void) {
+    // Expected: no port or no watched pins is refused, estimates of an
+    // unknown pin read as zero
+    TEST_ASSERT_EQUAL(ERROR_INVALID_PARAM, gpio_capture_init(NULL, &port, 0x1, peripheral_sim_clock));
+    TEST_ASSERT_EQUAL(ERROR_INVALID_PARAM, gpio_capture_init(&capture, NULL, 0x1, peripheral_sim_clock));
+    TEST_ASSERT_EQUAL(ERROR_INVALID_PARAM, gpio_capture_init(&capture, &port, 0, peripheral_sim_clock));
+
+    TEST_ASSERT_EQUAL(ERROR_NONE, gpio_capture_init(&capture, &port, 0x1, peripheral_sim_clock));
+    TEST_ASSERT_FALSE(gpio_capture_push(&capture, GPIO_CAPTURE_PINS, true, 0));
+    TEST_ASSERT_NULL(gpio_capture_get_pin(&capture, GPIO_CAPTURE_PINS));
+    TEST_ASSERT_FLOAT_WITHIN(0.0f, 0.0f, gpio_capture_frequency_hz(&capture, 0));
+    TEST_ASSERT_FLOAT_WITHIN(0.0f, 0.0f, gpio_capture_duty_cycle(&capture, 0));
+}
+
+void test_gpio_capture_ring_keeps_order_and_counts_drops(void) {
+    gpio_capture_init(&capture, &port, 0x1, peripheral_sim_clock);
+
+    // Expected: a full ring refuses the next edge and counts it
+    for (uint32_t i = 0; i < GPIO_CAPTURE_RING; i++) {
+        TEST_ASSERT_TRUE(gpio_capture_push(&capture, 0, (i & 1) == 0, i * 100));
+    }
+    TEST_ASSERT_FALSE(gpio_capture_push(&capture, 0, true, 999999));
+    TEST_ASSERT_EQUAL_UINT32(1, capture.dropped);
+    TEST_ASSERT_EQUAL_UINT32(GPIO_CAPTURE_RING, gpio_capture_pending(&capture));
+
+    // Expected: a partial drain returns the oldest edges in order
+    TEST_ASSERT_EQUAL_UINT32(10, gpio_capture_process(&capture, events, 10));
+    for (uint32_t i = 0; i < 10; i++) {
+        TEST_ASSERT_EQUAL_UINT64(i * 100, events[i].timestamp_ns);
+        TEST_ASSERT_EQUAL((i & 1) == 0, events[i].level);
+    }
+    TEST_ASSERT_EQUAL_UINT32(GPIO_CAPTURE_RING - 10, gpio_capture_pending(&capture));
+
+    // Expected: freed slots take new edges across the wrap
+    TEST_ASSERT_TRUE(gpio_capture_push(&capture, 0, true, 200000));
+    TEST_ASSERT_EQUAL_UINT32(GPIO_CAPTURE_RING - 9, gpio_capture_process(&capture, events, 0));
+    TEST_ASSERT_EQUAL_UINT64(200000, events[GPIO_CAPTURE_RING - 10].timestamp_ns);
+    TEST_ASSERT_EQUAL_UINT32(0, gpio_capture_pending(&capture));
+}
+
+// ====================================================================
+// Estimate Tests
+// ====================================================================
+
+void test_gpio_capture_estimates_period_and_duty(void) {
+    gpio_capture_init(&capture, &port, 0x4, peripheral_sim_clock);
+
+    // 200 kHz, 2 us high
+    for (uint64_t t = 0; t < 50000; t += 5000) {
+        gpio_capture_push(&capture, 2, true, t);
+        gpio_capture_push(&capture, 2, false, t + 2000);
+    }
+    gpio_capture_process(&capture, NULL, 0);
+
+    // Expected: 10 periods seen, 9 rising-to-rising intervals measured
+    const gpio_capture_pin_t *pin = gpio_capture_get_pin(&capture, 2);
+    TEST_ASSERT_EQUAL_UINT32(10, pin->rising_edges);
+    TEST_ASSERT_EQUAL_UINT32(10, pin->falling_edges);
+    TEST_ASSERT_EQUAL_UINT64(5000, gpio_capture_period_ns(&capture, 2));
+    TEST_ASSERT_EQUAL_UINT64(5000, pin->min_period_ns);
+    TEST_ASSERT_EQUAL_UINT64(5000, pin->max_period_ns);
+    TEST_ASSERT_FLOAT_WITHIN(1.0f, 200000.0f, gpio_capture_frequency_hz(&capture, 2));
+    TEST_ASSERT_FLOAT_WITHIN(0.001f, 0.4f, gpio_capture_duty_cycle(&capture, 2));
+
+    // Expected: one long period moves the smoothed estimate by 1/8 of the
+    // difference and is kept as the maximum
+    gpio_capture_push(&capture, 2, true, 50000 + 8000);
+    gpio_capture_process(&capture, NULL, 0);
+    TEST_ASSERT_EQUAL_UINT64(13000, pin->last_period_ns);
+    TEST_ASSERT_EQUAL_UINT64(6000, gpio_capture_period_ns(&capture, 2));
+    TEST_ASSERT_EQUAL_UINT64(13000, pin->max_period_ns);
+}
+
+// ====================================================================
+// Simulated Input Tests
+// ====================================================================
+
+void test_gpio_capture_samples_simulated_wave(void) {
+    gpio_capture_init(&capture, &port, 0x8, peripheral_sim_clock);
+    peripheral_sim_set_irq(&sim, &port, edge_isr, &capture);
+
+    // 200 kHz tach, 25% duty, 100 periods
+    TEST_ASSERT_EQUAL(ERROR_NONE, peripheral_sim_gpio_wave(&sim, &port, 3, 5000, 1250, 100));
+    peripheral_sim_advance(&sim, 600000);
+
+    // Expected: every edge reached the ring with its simulated time
+    TEST_ASSERT_EQUAL_UINT32(200, edge_irqs);
+    TEST_ASSERT_EQUAL_UINT32(200, gpio_capture_process(&capture, events, 0));
+    TEST_ASSERT_EQUAL_UINT32(0, capture.dropped);
+    TEST_ASSERT_EQUAL_UINT64(0, events[0].timestamp_ns);
+    TEST_ASSERT_TRUE(events[0].level);
+    TEST_ASSERT_EQUAL_UINT64(1250, events[1].timestamp_ns);
+    TEST_ASSERT_FALSE(events[1].level);
+    TEST_ASSERT_EQUAL_UINT64(99 * 5000 + 1250, events[199].timestamp_ns);
+
+    TEST_ASSERT_EQUAL_UINT64(5000, gpio_capture_period_ns(&capture, 3));
+    TEST_ASSERT_FLOAT_WITHIN(0.001f, 0.25f, gpio_capture_duty_cycle(&capture, 3));
+}
+
+void test_gpio_capture_tracks_two_pins(void) {
+    gpio_capture_init(&capture, &port, 0x88, peripheral_sim_clock);
+    peripheral_sim_set_irq(&sim, &port, edge_isr, &capture);
+
+    // 200 kHz on PA3, 50 kHz square wave on PA7; unwatched PA0 toggling too
+    peripheral_sim_gpio_wave(&sim, &port, 3, 5000, 2500, 40);
+    peripheral_sim_gpio_wave(&sim, &port, 7, 20000, 10000, 10);
+    peripheral_sim_gpio_wave(&sim, &port, 0, 1000, 500, 200);
+    peripheral_sim_advance(&sim, 250000);
+
+    // Expected: coincident edges share one interrupt, each pin is tracked
+    // on its own and the unwatched pin never enters the ring
+    gpio_capture_process(&capture, events, 0);
+    TEST_ASSERT_EQUAL_UINT32(40, gpio_capture_get_pin(&capture, 3)->rising_edges);
+    TEST_ASSERT_EQUAL_UINT32(10, gpio_capture_get_pin(&capture, 7)->rising_edges);
+    TEST_ASSERT_EQUAL_UINT32(0, gpio_capture_get_pin(&capture, 0)->rising_edges);
+    TEST_ASSERT_EQUAL(7, events[0].pin == 3 ? events[1].pin : events[0].pin);
+    TEST_ASSERT_EQUAL_UINT64(events[0].timestamp_ns, events[1].timestamp_ns);
+
+    TEST_ASSERT_FLOAT_WITHIN(1.0f, 200000.0f, gpio_capture_frequency_hz(&capture, 3));
+    TEST_ASSERT_FLOAT_WITHIN(1.0f, 50000.0f, gpio_capture_frequency_hz(&capture, 7));
+    TEST_ASSERT_FLOAT_WITHIN(0.001f, 0.5f, gpio_capture_duty_cycle(&capture, 7));
+}
+
+int main(void) {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_gpio_capture_rejects_invalid_params);
+    RUN_TEST(test_gpio_capture_ring_keeps_order_and_counts_drops);
+    RUN_TEST(test_gpio_capture_estimates_period_and_duty);
+    RUN_TEST(test_gpio_capture_samples_simulated_wave);
+    RUN_TEST(test_gpio_capture_tracks_two_pins);
+
+    return UNITY_END();
+}
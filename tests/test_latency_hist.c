@@ -0,0 +1,186 @@
+/* test_latency_hist.c – Unity Tests for the per-operation latency histograms */
+
+#define _POSIX_C_SOURCE 200112L
+#include "unity.h"
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <pthread.h>
+
+#include "latency_hist.h"
+#include "device_drivers.h"
+#include "timebase.h"
+
+// ====================================================================
+// Test Fixtures
+// ====================================================================
+
+#define THREAD_RECORDS  100000
+
+static uint64_t fake_ns;
+static latency_hist_t hist_a;
+static latency_hist_t hist_b;
+static latency_hist_t snapshot;
+
+static uint64_t fake_clock(void) {
+    return fake_ns;
+}
+
+// Every transfer takes 1.5 us of clock time
+static error_t slow_transfer(i2c_driver_t *driver, const i2c_msg_t *msgs, uint8_t count, void *context) {
+    (void)driver;
+    (void)context;
+    for (uint8_t i = 0; i < count; i++) {
+        if (msgs[i].flags & I2C_MSG_READ) {
+            memset(msgs[i].data, 0, msgs[i].length);
+        }
+    }
+    fake_ns += 1500;
+    return ERROR_NONE;
+}
+
+static const i2c_backend_t slow_backend = {slow_transfer, NULL};
+
+static void *record_thread(void *arg) {
+    latency_hist_t *hist = (latency_hist_t*)arg;
+    for (uint32_t i = 0; i < THREAD_RECORDS; i++) {
+        latency_hist_record(hist, 100 + i % 5000);
+    }
+    return NULL;
+}
+
+static void assert_within_precision(uint64_t expected, uint64_t actual) {
+    // Expected: never below the value, at most 1/32 above it
+    TEST_ASSERT_TRUE(actual >= expected);
+    TEST_ASSERT_TRUE(actual - expected <= expected / 32 + 1);
+}
+
+// ====================================================================
+// Setup and Teardown
+// ====================================================================
+
+void setUp(void) {
+    fake_ns = 1000000;
+    timebase_use_clock(fake_clock);
+    latency_hist_reset_all();
+    memset(&hist_a, 0, sizeof(hist_a));
+    memset(&hist_b, 0, sizeof(hist_b));
+}
+
+void tearDown(void) {
+    latency_hist_enable(false);
+    latency_hist_set_sampling(LATENCY_HIST_DEFAULT_SAMPLING);
+    timebase_use_clock(NULL);
+}
+
+// ====================================================================
+// Histogram Tests
+// ====================================================================
+
+void test_latency_hist_percentiles_within_precision(void) {
+    for (uint64_t ns = 1; ns <= 10000; ns++) {
+        latency_hist_record(&hist_a, ns);
+    }
+    latency_hist_record(&hist_a, 1ULL << 40);  // Beyond the range
+
+    TEST_ASSERT_EQUAL_UINT32(10001, (uint32_t)latency_hist_count(&hist_a));
+    assert_within_precision(5000, latency_hist_percentile(&hist_a, 50.0));
+    assert_within_precision(9900, latency_hist_percentile(&hist_a, 99.0));
+    assert_within_precision(9990, latency_hist_percentile(&hist_a, 99.9));
+    TEST_ASSERT_EQUAL_UINT64(1, latency_hist_percentile(&hist_a, 0.0));
+
+    // Expected: small values are exact, the maximum is exact even out of range
+    latency_hist_record(&hist_b, 37);
+    TEST_ASSERT_EQUAL_UINT64(37, latency_hist_percentile(&hist_b, 50.0));
+    TEST_ASSERT_EQUAL_UINT64(1ULL << 40, latency_hist_percentile(&hist_a, 100.0));
+    TEST_ASSERT_EQUAL_UINT64(1ULL << 40, hist_a.max_ns);
+
+    uint64_t mean = latency_hist_mean(&hist_b);
+    TEST_ASSERT_EQUAL_UINT64(37, mean);
+}
+
+void test_latency_hist_snapshot_merge_reset(void) {
+    for (uint32_t i = 0; i < 90; i++) {
+        latency_hist_record(&hist_a, 1000);
+    }
+    for (uint32_t i = 0; i < 10; i++) {
+        latency_hist_record(&hist_b, 80000);
+    }
+
+    latency_hist_snapshot(&hist_a, &snapshot);
+    latency_hist_merge(&snapshot, &hist_b);
+
+    // Expected: merged tail comes from hist_b, sources untouched
+    TEST_ASSERT_EQUAL_UINT32(100, (uint32_t)latency_hist_count(&snapshot));
+    assert_within_precision(1000, latency_hist_percentile(&snapshot, 90.0));
+    TEST_ASSERT_EQUAL_UINT64(80000, latency_hist_percentile(&snapshot, 99.0));
+    TEST_ASSERT_EQUAL_UINT64(80000, snapshot.max_ns);
+    TEST_ASSERT_EQUAL_UINT32(90, (uint32_t)latency_hist_count(&hist_a));
+
+    latency_hist_reset(&snapshot);
+    TEST_ASSERT_EQUAL_UINT32(0, (uint32_t)latency_hist_count(&snapshot));
+    TEST_ASSERT_EQUAL_UINT64(0, latency_hist_percentile(&snapshot, 50.0));
+}
+
+void test_latency_hist_concurrent_recording(void) {
+    pthread_t threads[4];
+
+    for (uint8_t i = 0; i < 4; i++) {
+        TEST_ASSERT_EQUAL(0, pthread_create(&threads[i], NULL, record_thread, &hist_a));
+    }
+    for (uint8_t i = 0; i < 4; i++) {
+        pthread_join(threads[i], NULL);
+    }
+
+    // Expected: no record lost without a lock
+    TEST_ASSERT_EQUAL_UINT32(4 * THREAD_RECORDS, (uint32_t)latency_hist_count(&hist_a));
+    TEST_ASSERT_EQUAL_UINT64(5099, hist_a.max_ns);
+}
+
+// ====================================================================
+// Driver Instrumentation Tests
+// ====================================================================
+
+void test_latency_hist_driver_operations(void) {
+    i2c_driver_t i2c;
+    uint8_t value;
+    latency_hist_t *hist = latency_hist_get(LATENCY_OP_I2C_TRANSFER);
+
+    memset(&i2c, 0, sizeof(i2c));
+    TEST_ASSERT_EQUAL(ERROR_NONE, i2c_driver_init(&i2c, 0x40, 400000));
+    i2c.backend = &slow_backend;
+
+    // Expected: nothing recorded until enabled
+    TEST_ASSERT_EQUAL(ERROR_NONE, i2c_driver_read(&i2c, 0x00, &value, 1));
+    TEST_ASSERT_EQUAL_UINT32(0, (uint32_t)latency_hist_count(hist));
+
+    latency_hist_enable(true);
+    latency_hist_set_sampling(0);
+    for (uint8_t i = 0; i < 10; i++) {
+        TEST_ASSERT_EQUAL(ERROR_NONE, i2c_driver_read(&i2c, 0x00, &value, 1));
+    }
+    TEST_ASSERT_EQUAL_UINT32(10, (uint32_t)latency_hist_count(hist));
+    TEST_ASSERT_EQUAL_UINT64(1500, hist->max_ns);
+    assert_within_precision(1500, latency_hist_percentile(hist, 50.0));
+
+    // Expected: one in eight operations timed
+    latency_hist_reset_all();
+    latency_hist_set_sampling(3);
+    for (uint8_t i = 0; i < 32; i++) {
+        TEST_ASSERT_EQUAL(ERROR_NONE, i2c_driver_read(&i2c, 0x00, &value, 1));
+    }
+    TEST_ASSERT_EQUAL_UINT32(4, (uint32_t)latency_hist_count(hist));
+
+    i2c_driver_deinit(&i2c);
+}
+
+int main(void) {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_latency_hist_percentiles_within_precision);
+    RUN_TEST(test_latency_hist_snapshot_merge_reset);
+    RUN_TEST(test_latency_hist_concurrent_recording);
+    RUN_TEST(test_latency_hist_driver_operations);
+
+    return UNITY_END();
+}
@@ -0,0 +1,239 @@
+/* test_mem_pool.c – Unity Tests for the static object pools behind the driver inits */
+
+#include "unity.h"
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "mem_pool.h"
+#include "communication_protocols.h"
+#include "device_drivers.h"
+
+// ====================================================================
+// Test Fixtures
+// ====================================================================
+
+static mem_pool_budget_t budget;
+
+static uint16_t pool_used(mem_pool_id_t id) {
+    mem_pool_get_budget(id, &budget);
+    return budget.used;
+}
+
+// ====================================================================
+// Setup and Teardown
+// ====================================================================
+
+void setUp(void) {
+    mem_pool_seal(false);
+    mem_pool_use_arena(NULL);
+}
+
+void tearDown(void) {
+    mem_pool_seal(false);
+    mem_pool_use_arena(NULL);
+}
+
+// ====================================================================
+// Pool Tests
+// ====================================================================
+
+void test_mem_pool_driver_inits_draw_from_pools(void) {
+    uart_config_t config = {115200, 8, 0, 0, false};
+    uart_driver_t uarts[MEM_POOL_UART_COUNT + 1];
+
+    memset(uarts, 0, sizeof(uarts));
+    for (uint8_t i = 0; i < MEM_POOL_UART_COUNT; i++) {
+        TEST_ASSERT_EQUAL(ERROR_NONE, uart_driver_init(&uarts[i], &config));
+        TEST_ASSERT_TRUE(mem_pool_owns(MEM_POOL_UART_REGS, uarts[i].uart));
+    }
+    TEST_ASSERT_EQUAL_UINT16(MEM_POOL_UART_COUNT, pool_used(MEM_POOL_UART_REGS));
+
+    // Expected: an exhausted pool fails the init instead of touching the heap
+    TEST_ASSERT_EQUAL(ERROR_BUSY, uart_driver_init(&uarts[MEM_POOL_UART_COUNT], &config));
+    TEST_ASSERT_NULL(uarts[MEM_POOL_UART_COUNT].uart);
+    mem_pool_get_budget(MEM_POOL_UART_REGS, &budget);
+    TEST_ASSERT_EQUAL_UINT32(1, budget.failures);
+
+    // Expected: re-running init reuses the driver's own slot
+    TEST_ASSERT_EQUAL(ERROR_NONE, uart_driver_init(&uarts[0], &config));
+    TEST_ASSERT_EQUAL_UINT16(MEM_POOL_UART_COUNT, pool_used(MEM_POOL_UART_REGS));
+
+    for (uint8_t i = 0; i < MEM_POOL_UART_COUNT; i++) {
+        uart_driver_deinit(&uarts[i]);
+    }
+    TEST_ASSERT_EQUAL_UINT16(0, pool_used(MEM_POOL_UART_REGS));
+    TEST_ASSERT_EQUAL_UINT16(MEM_POOL_UART_COUNT, budget.high_water);
+}
+
+void test_mem_pool_sensor_reinit_does_not_leak(void) {
+    sensor_driver_t sensor;
+    float value;
+
+    memset(&sensor, 0, sizeof(sensor));
+    for (uint8_t i = 0; i < 3 * MEM_POOL_SENSOR_I2C_COUNT; i++) {
+        TEST_ASSERT_EQUAL(ERROR_NONE, sensor_driver_init(&sensor, 0, 0));
+    }
+    TEST_ASSERT_EQUAL_UINT16(1, pool_used(MEM_POOL_SENSOR_I2C));
+    TEST_ASSERT_EQUAL_UINT16(1, pool_used(MEM_POOL_I2C_REGS));
+    TEST_ASSERT_EQUAL(ERROR_NONE, sensor_driver_read(&sensor, &value));
+
+    // Expected: switching interface returns the I2C objects
+    TEST_ASSERT_EQUAL(ERROR_NONE, sensor_driver_init(&sensor, 1, 0));
+    TEST_ASSERT_NULL(sensor.i2c);
+    TEST_ASSERT_EQUAL_UINT16(0, pool_used(MEM_POOL_SENSOR_I2C));
+    TEST_ASSERT_EQUAL_UINT16(1, pool_used(MEM_POOL_SENSOR_SPI));
+
+    sensor_driver_deinit(&sensor);
+    TEST_ASSERT_EQUAL_UINT16(0, pool_used(MEM_POOL_SENSOR_SPI));
+    TEST_ASSERT_EQUAL_UINT16(0, pool_used(MEM_POOL_I2C_REGS));
+}
+
+void test_mem_pool_init_releases_only_owned_blocks(void) {
+    uart_config_t config = {115200, 8, 0, 0, false};
+    uart_driver_t live;
+    uart_driver_t copy;
+    sensor_driver_t sensor;
+    sensor_driver_t sensor_copy;
+
+    memset(&live, 0, sizeof(live));
+    TEST_ASSERT_EQUAL(ERROR_NONE, uart_driver_init(&live, &config));
+    TEST_ASSERT_EQUAL_UINT16(1, pool_used(MEM_POOL_UART_REGS));
+
+    // Expected: init on a copy takes its own block and leaves the live driver's alone
+    memcpy(&copy, &live, sizeof(copy));
+    TEST_ASSERT_EQUAL(ERROR_NONE, uart_driver_init(&copy, &config));
+    TEST_ASSERT_EQUAL_UINT16(2, pool_used(MEM_POOL_UART_REGS));
+    TEST_ASSERT_TRUE(copy.uart != live.uart);
+    uart_driver_deinit(&copy);
+    TEST_ASSERT_EQUAL_UINT16(1, pool_used(MEM_POOL_UART_REGS));
+
+    // Expected: a struct holding garbage releases nothing
+    memset(&copy, 0xA5, sizeof(copy));
+    copy.uart = live.uart;
+    copy.state_change_cb = NULL;
+    TEST_ASSERT_EQUAL(ERROR_NONE, uart_driver_init(&copy, &config));
+    TEST_ASSERT_EQUAL_UINT16(2, pool_used(MEM_POOL_UART_REGS));
+    uart_driver_deinit(&copy);
+    TEST_ASSERT_EQUAL_UINT16(1, pool_used(MEM_POOL_UART_REGS));
+
+    memset(&sensor, 0, sizeof(sensor));
+    TEST_ASSERT_EQUAL(ERROR_NONE, sensor_driver_init(&sensor, 0, 0));
+    memcpy(&sensor_copy, &sensor, sizeof(sensor_copy));
+    TEST_ASSERT_EQUAL(ERROR_NONE, sensor_driver_init(&sensor_copy, 0, 0));
+    TEST_ASSERT_EQUAL_UINT16(2, pool_used(MEM_POOL_SENSOR_I2C));
+    sensor_driver_deinit(&sensor_copy);
+    TEST_ASSERT_EQUAL_UINT16(1, pool_used(MEM_POOL_SENSOR_I2C));
+
+    // Expected: deinit of a copy that never ran init leaves the original's interface
+    memcpy(&sensor_copy, &sensor, sizeof(sensor_copy));
+    sensor_driver_deinit(&sensor_copy);
+    TEST_ASSERT_EQUAL_UINT16(1, pool_used(MEM_POOL_SENSOR_I2C));
+    TEST_ASSERT_TRUE(mem_pool_owns(MEM_POOL_SENSOR_I2C, sensor.i2c));
+
+    sensor_driver_deinit(&sensor);
+    TEST_ASSERT_EQUAL_UINT16(0, pool_used(MEM_POOL_SENSOR_I2C));
+    uart_driver_deinit(&live);
+    TEST_ASSERT_EQUAL_UINT16(0, pool_used(MEM_POOL_UART_REGS));
+}
+
+void test_mem_pool_can_handle_releases_only_owned_queues(void) {
+    can_handle_t live;
+    can_handle_t copy;
+
+    memset(&live, 0, sizeof(live));
+    TEST_ASSERT_EQUAL(PROTOCOL_ERROR_NONE, can_init(&live, 8));
+    TEST_ASSERT_EQUAL_UINT16(2, pool_used(MEM_POOL_CAN_QUEUES));
+
+    // Expected: a rejected re-init leaves the live queues in place
+    TEST_ASSERT_EQUAL(PROTOCOL_ERROR_BUFFER_OVERFLOW, can_init(&live, MEM_POOL_CAN_QUEUE_FRAMES + 1));
+    TEST_ASSERT_EQUAL_UINT16(2, pool_used(MEM_POOL_CAN_QUEUES));
+    TEST_ASSERT_TRUE(mem_pool_owns(MEM_POOL_CAN_QUEUES, live.rx_buffer));
+
+    // Expected: init on a copy takes new queues instead of reissuing the original's
+    memcpy(&copy, &live, sizeof(copy));
+    TEST_ASSERT_EQUAL(PROTOCOL_ERROR_NONE, can_init(&copy, 8));
+    TEST_ASSERT_EQUAL_UINT16(4, pool_used(MEM_POOL_CAN_QUEUES));
+    TEST_ASSERT_TRUE(copy.rx_buffer != live.rx_buffer);
+    TEST_ASSERT_TRUE(copy.tx_buffer != live.tx_buffer);
+    can_deinit(&copy);
+    TEST_ASSERT_EQUAL_UINT16(2, pool_used(MEM_POOL_CAN_QUEUES));
+
+    // Expected: deinit of a copy that never ran init releases nothing
+    memcpy(&copy, &live, sizeof(copy));
+    can_deinit(&copy);
+    TEST_ASSERT_EQUAL_UINT16(2, pool_used(MEM_POOL_CAN_QUEUES));
+
+    can_deinit(&live);
+    TEST_ASSERT_EQUAL_UINT16(0, pool_used(MEM_POOL_CAN_QUEUES));
+}
+
+void test_mem_pool_can_queues_and_seal(void) {
+    can_driver_t can;
+    can_handle_t handle;
+
+    memset(&can, 0, sizeof(can));
+    memset(&handle, 0, sizeof(handle));
+    TEST_ASSERT_EQUAL(PROTOCOL_ERROR_BUFFER_OVERFLOW, can_init(&handle, MEM_POOL_CAN_QUEUE_FRAMES + 1));
+    TEST_ASSERT_NULL(handle.rx_buffer);
+    TEST_ASSERT_EQUAL(ERROR_NONE, can_driver_init(&can, 500000));
+    TEST_ASSERT_EQUAL_UINT16(2, pool_used(MEM_POOL_CAN_QUEUES));
+    TEST_ASSERT_EQUAL_UINT16(1, pool_used(MEM_POOL_CAN_HANDLES));
+
+    // Expected: after startup no init can take memory
+    mem_pool_seal(true);
+    TEST_ASSERT_EQUAL(PROTOCOL_ERROR_BUFFER_OVERFLOW, can_init(&handle, 8));
+    mem_pool_get_budget(MEM_POOL_CAN_QUEUES, &budget);
+    TEST_ASSERT_GREATER_THAN(0, budget.failures);
+
+    // Expected: releasing still works while sealed
+    can_driver_deinit(&can);
+    TEST_ASSERT_EQUAL_UINT16(0, pool_used(MEM_POOL_CAN_QUEUES));
+    TEST_ASSERT_EQUAL_UINT16(0, pool_used(MEM_POOL_CAN_HANDLES));
+}
+
+void test_mem_pool_caller_arena(void) {
+    static uint64_t buffer[64];
+    mem_arena_t arena;
+    i2c_driver_t i2c[4];
+
+    TEST_ASSERT_EQUAL(ERROR_INVALID_PARAM, mem_arena_init(&arena, (uint8_t*)buffer + 1, 64));
+    TEST_ASSERT_EQUAL(ERROR_NONE, mem_arena_init(&arena, buffer, sizeof(buffer)));
+    mem_pool_use_arena(&arena);
+
+    // Expected: 104-byte blocks, four fit in 512 bytes
+    memset(i2c, 0, sizeof(i2c));
+    for (uint8_t i = 0; i < 4; i++) {
+        TEST_ASSERT_EQUAL(ERROR_NONE, i2c_driver_init(&i2c[i], 0x40, 400000));
+        TEST_ASSERT_FALSE(mem_pool_owns(MEM_POOL_I2C_REGS, i2c[i].i2c_regs));
+    }
+    TEST_ASSERT_EQUAL_PTR(buffer, i2c[0].i2c_regs);
+    TEST_ASSERT_EQUAL_UINT32(4 * 104, arena.used);
+
+    i2c_driver_t extra;
+    memset(&extra, 0, sizeof(extra));
+    TEST_ASSERT_EQUAL(ERROR_BUSY, i2c_driver_init(&extra, 0x40, 400000));
+    TEST_ASSERT_EQUAL_UINT32(1, arena.failures);
+    mem_pool_get_budget(MEM_POOL_I2C_REGS, &budget);
+    TEST_ASSERT_EQUAL_UINT16(4, budget.from_arena);
+
+    // Expected: arena objects are not returned one by one
+    for (uint8_t i = 0; i < 4; i++) {
+        i2c_driver_deinit(&i2c[i]);
+    }
+    TEST_ASSERT_EQUAL_UINT32(4 * 104, arena.used);
+    TEST_ASSERT_GREATER_THAN(0, mem_pool_static_bytes());
+}
+
+int main(void) {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_mem_pool_driver_inits_draw_from_pools);
+    RUN_TEST(test_mem_pool_sensor_reinit_does_not_leak);
+    RUN_TEST(test_mem_pool_init_releases_only_owned_blocks);
+    RUN_TEST(test_mem_pool_can_handle_releases_only_owned_queues);
+    RUN_TEST(test_mem_pool_can_queues_and_seal);
+    RUN_TEST(test_mem_pool_caller_arena);
+
+    return UNITY_END();
+}
@@ -0,0 +1,420 @@
+/* test_peripheral_sim.c – Unity Tests for the simulated peripheral backend */
+
+#include "unity.h"
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "peripheral_sim.h"
+
+// ====================================================================
+// Test Fixtures
+// ====================================================================
+
+static peripheral_sim_t sim;
+static USART_TypeDef uart;
+static SPI_TypeDef spi;
+static GPIO_TypeDef gpio;
+static DMA_Channel_TypeDef dma;
+
+static uint8_t captured[64];
+static uint16_t captured_count;
+static uint32_t irq_count;
+
+static void capture_rx(peripheral_sim_t *s, USART_TypeDef *u, uint8_t byte, void *context) {
+    (void)s;
+    (void)u;
+    (void)context;
+    if (captured_count < sizeof(captured)) {
+        captured[captured_count++] = byte;
+    }
+}
+
+// 16-bit ADC stand-in: answers each frame with its complement
+static uint16_t invert_exchange(peripheral_sim_t *s, SPI_TypeDef *bus, uint16_t mosi, void *context) {
+    (void)s;
+    (void)bus;
+    (void)context;
+    return (uint16_t)~mosi;
+}
+
+static void count_irq(void *context) {
+    (void)context;
+    irq_count++;
+}
+
+static void setup_uart(const peripheral_sim_device_t *device) {
+    uart_config_t config = {115200, 8, 0, 0, false};
+    uart_init(&uart, &config);
+    peripheral_sim_attach_uart(&sim, &uart, device);
+}
+
+static void setup_spi(const peripheral_sim_device_t *device) {
+    spi_config_t config = {1, 8, 0, 0, false, false};  // pclk / 4
+    spi_init(&spi, &config);
+    gpio.MODER = 0x1U << (4 * 2);  // PA4 output
+    gpio.ODR = 1U << 4;            // CS idle high
+    peripheral_sim_attach_spi(&sim, &spi, &gpio, 4, device);
+}
+
+// ====================================================================
+// Setup and Teardown
+// ====================================================================
+
+void setUp(void) {
+    peripheral_sim_config_t config = {8000000, 0};
+    memset(&uart, 0, sizeof(uart));
+    memset(&spi, 0, sizeof(spi));
+    memset(&gpio, 0, sizeof(gpio));
+    memset(&dma, 0, sizeof(dma));
+    captured_count = 0;
+    irq_count = 0;
+    peripheral_sim_init(&sim, &config);
+    peripheral_sim_install(&sim);
+}
+
+void tearDown(void) {
+    peripheral_sim_uninstall();
+}
+
+// ====================================================================
+// Timing Model Tests
+// ====================================================================
+
+void test_peripheral_sim_init_rejects_zero_clock(void) {
+    peripheral_sim_config_t config = {0, 0};
+    // Expected: The SPI prescaler needs a peripheral clock
+    TEST_ASSERT_EQUAL(ERROR_INVALID_PARAM, peripheral_sim_init(&sim, &config));
+    TEST_ASSERT_EQUAL(ERROR_INVALID_PARAM, peripheral_sim_init(NULL, &config));
+}
+
+void test_peripheral_sim_uart_frame_time_follows_brr(void) {
+    setup_uart(NULL);
+    // Expected: 8N1 at 115200 baud is 10 bits = 86.8 us
+    TEST_ASSERT_EQUAL_UINT64(86806, peripheral_sim_uart_frame_ns(&uart));
+
+    uart.CR2 |= 2U << 12;  // Two stop bits
+    TEST_ASSERT_EQUAL_UINT64(95486, peripheral_sim_uart_frame_ns(&uart));
+}
+
+void test_peripheral_sim_uart_transmit_takes_wire_time(void) {
+    peripheral_sim_device_t device = {capture_rx, NULL, NULL, NULL};
+    uint8_t data[] = "hello";
+    setup_uart(&device);
+
+    TEST_ASSERT_EQUAL(ERROR_NONE, uart_transmit(&uart, data, 5, 100));
+    // Expected: Device saw every byte; virtual time is five frames
+    TEST_ASSERT_EQUAL_UINT16(5, captured_count);
+    TEST_ASSERT_EQUAL_MEMORY(data, captured, 5);
+    TEST_ASSERT_EQUAL_UINT64(5 * peripheral_sim_uart_frame_ns(&uart), peripheral_sim_now(&sim));
+    TEST_ASSERT_TRUE(uart.SR & USART_SR_TC);
+}
+
+void test_peripheral_sim_uart_script_replies_after_latency(void) {
+    static const uint8_t ping[] = {'P', 'I', 'N', 'G'};
+    static const uint8_t pong[] = {'P', 'O', 'N', 'G'};
+    peripheral_sim_script_step_t steps[] = {{ping, 4, pong, 4, 1000000}};
+    peripheral_sim_script_t script = {steps, 1, 0, 0, false, 0};
+    peripheral_sim_device_t device = peripheral_sim_script_device(&script);
+    uint8_t reply[4];
+    setup_uart(&device);
+
+    TEST_ASSERT_EQUAL(ERROR_NONE, uart_transmit(&uart, (uint8_t*)ping, 4, 100));
+    TEST_ASSERT_EQUAL(ERROR_NONE, uart_receive(&uart, reply, 4, 100));
+
+    // Expected: Reply arrives 1 ms after the request, at wire speed
+    TEST_ASSERT_EQUAL_MEMORY(pong, reply, 4);
+    TEST_ASSERT_EQUAL_UINT64(8 * peripheral_sim_uart_frame_ns(&uart) + 1000000, peripheral_sim_now(&sim));
+    TEST_ASSERT_EQUAL_UINT32(0, script.mismatches);
+}
+
+void test_peripheral_sim_uart_receive_times_out_without_traffic(void) {
+    uint8_t byte;
+    setup_uart(NULL);
+    // Expected: No event ever sets RXNE, so the tick timeout fires
+    TEST_ASSERT_EQUAL(ERROR_TIMEOUT, uart_receive(&uart, &byte, 1, 50));
+}
+
+void test_peripheral_sim_uart_overrun_and_idle(void) {
+    uint8_t burst[3] = {1, 2, 3};
+    setup_uart(NULL);
+
+    peripheral_sim_uart_inject(&sim, &uart, burst, 3, 0);
+    peripheral_sim_advance(&sim, 3 * peripheral_sim_uart_frame_ns(&uart));
+    // Expected: Unread bytes overrun; IDLE not yet (line idle one frame later)
+    TEST_ASSERT_TRUE(uart.SR & USART_SR_ORE);
+    TEST_ASSERT_FALSE(uart.SR & USART_SR_IDLE);
+    TEST_ASSERT_EQUAL_UINT32(2, peripheral_sim_get_stats(&sim, &uart)->overruns);
+
+    peripheral_sim_advance(&sim, peripheral_sim_uart_frame_ns(&uart));
+    TEST_ASSERT_TRUE(uart.SR & USART_SR_IDLE);
+    TEST_ASSERT_EQUAL_UINT16(1, uart_read_data(&uart));
+    TEST_ASSERT_FALSE(uart.SR & (USART_SR_RXNE | USART_SR_ORE | USART_SR_IDLE));
+}
+
+void test_peripheral_sim_uart_rx_interrupt(void) {
+    uint8_t burst[4] = {1, 2, 3, 4};
+    setup_uart(NULL);
+    peripheral_sim_set_irq(&sim, &uart, count_irq, NULL);
+    uart.CR1 |= USART_CR1_RXNEIE;
+
+    peripheral_sim_uart_inject(&sim, &uart, burst, 4, 0);
+    peripheral_sim_advance(&sim, 4 * peripheral_sim_uart_frame_ns(&uart));
+    // Expected: Handler that ignores RXNE is re-entered, bounded per event
+    TEST_ASSERT_EQUAL_UINT32(4 * PERIPHERAL_SIM_IRQ_LOOPS, irq_count);
+}
+
+// ====================================================================
+// SPI, GPIO and DMA Tests
+// ====================================================================
+
+void test_peripheral_sim_spi_regmap_read(void) {
+    peripheral_sim_regmap_t regmap;
+    memset(&regmap, 0, sizeof(regmap));
+    regmap.regs[0x10] = 0xC0;
+    regmap.regs[0x11] = 0xDE;
+    peripheral_sim_device_t device = peripheral_sim_regmap_device(&regmap);
+    uint8_t tx[3] = {0x10 | PERIPHERAL_SIM_REGMAP_READ, 0, 0};
+    uint8_t rx[3] = {0};
+    setup_spi(&device);
+
+    gpio_write_pin(&gpio, 4, false);
+    TEST_ASSERT_EQUAL(ERROR_NONE, spi_transmit_receive(&spi, tx, rx, 3));
+    gpio_write_pin(&gpio, 4, true);
+
+    // Expected: Auto-increment read; 3 bytes at 2 MHz SCK take 12 us
+    TEST_ASSERT_EQUAL_HEX8(0xC0, rx[1]);
+    TEST_ASSERT_EQUAL_HEX8(0xDE, rx[2]);
+    TEST_ASSERT_EQUAL_UINT32(1, regmap.transactions);
+    TEST_ASSERT_EQUAL_UINT64(12000, peripheral_sim_now(&sim));
+    TEST_ASSERT_TRUE(gpio.IDR & (1U << 4));
+}
+
+void test_peripheral_sim_spi_unselected_reads_pullup(void) {
+    peripheral_sim_regmap_t regmap;
+    memset(&regmap, 0, sizeof(regmap));
+    peripheral_sim_device_t device = peripheral_sim_regmap_device(&regmap);
+    uint8_t tx[2] = {0x80, 0};
+    uint8_t rx[2] = {0};
+    setup_spi(&device);
+
+    TEST_ASSERT_EQUAL(ERROR_NONE, spi_transmit_receive(&spi, tx, rx, 2));
+    // Expected: Without chip select nobody drives MISO
+    TEST_ASSERT_EQUAL_HEX8(0xFF, rx[0]);
+    TEST_ASSERT_EQUAL_HEX8(0xFF, rx[1]);
+}
+
+void test_peripheral_sim_spi_16bit_frames(void) {
+    peripheral_sim_device_t device = {NULL, invert_exchange, NULL, NULL};
+    uint16_t tx[4] = {0x1234, 0xABCD, 0x0000, 0xFF00};
+    uint16_t rx[4] = {0};
+    setup_spi(&device);
+    spi.CR1 |= SPI_CR1_DFF;
+    gpio_write_pin(&gpio, 4, false);
+
+    TEST_ASSERT_EQUAL(ERROR_NONE, spi_transmit_receive(&spi, (uint8_t*)tx, (uint8_t*)rx, 4));
+    // Expected: Whole words per frame; 4 x 16 bits at 2 MHz SCK is 32 us
+    TEST_ASSERT_EQUAL_HEX16(0xEDCB, rx[0]);
+    TEST_ASSERT_EQUAL_HEX16(0x5432, rx[1]);
+    TEST_ASSERT_EQUAL_HEX16(0xFFFF, rx[2]);
+    TEST_ASSERT_EQUAL_HEX16(0x00FF, rx[3]);
+    TEST_ASSERT_EQUAL_UINT64(32000, peripheral_sim_now(&sim));
+}
+
+void test_peripheral_sim_spi_primed_tx_hides_access_time(void) {
+    peripheral_sim_config_t config = {8000000, 1000};  // 1 us per register access
+    peripheral_sim_device_t device = {NULL, invert_exchange, NULL, NULL};
+    uint16_t tx[8] = {0};
+    uint16_t rx[8];
+    peripheral_sim_init(&sim, &config);
+    peripheral_sim_install(&sim);
+    setup_spi(&device);
+    spi.CR1 |= SPI_CR1_DFF;
+    gpio_write_pin(&gpio, 4, false);
+
+    TEST_ASSERT_EQUAL(ERROR_NONE, spi_transmit_receive(&spi, (uint8_t*)tx, (uint8_t*)rx, 8));
+    // Expected: Frames run back to back (8 x 8 us); only the chip-select
+    // write and the last read are exposed, not two accesses per frame
+    TEST_ASSERT_EQUAL_UINT64(8 * 8000 + 2 * 1000, peripheral_sim_now(&sim));
+    TEST_ASSERT_EQUAL_HEX16(0xFFFF, rx[7]);
+    TEST_ASSERT_EQUAL_UINT32(0, peripheral_sim_get_stats(&sim, &spi)->overruns);
+}
+
+void test_peripheral_sim_spi_timeout_when_disabled(void) {
+    uint8_t tx[2] = {0};
+    uint8_t rx[2];
+    setup_spi(NULL);
+    spi.CR1 &= ~SPI_CR1_SPE;
+
+    // Expected: Nothing ever shifts, the bounded variant gives up
+    TEST_ASSERT_EQUAL(ERROR_TIMEOUT, spi_transmit_receive_timeout(&spi, tx, rx, 2, 50));
+}
+
+void test_peripheral_sim_init_fields_and_range_checks(void) {
+    uart_config_t uart_config = {115200, 9, 2, 2, false};  // 9 bits, 2 stop bits, odd parity
+    spi_config_t spi_config = {3, 16, 3, 1, true, true};
+    uart.CR1 = USART_CR1_RXNEIE;  // Unrelated bits must survive
+
+    TEST_ASSERT_EQUAL(ERROR_NONE, uart_init(&uart, &uart_config));
+    // Expected: Format fields and UE land in one CR1 update
+    TEST_ASSERT_EQUAL_HEX32(USART_CR1_RXNEIE | USART_CR1_UE | USART_CR1_M | USART_CR1_PCE | USART_CR1_PS, uart.CR1);
+    TEST_ASSERT_EQUAL_HEX32(USART_CR2_STOP_1, uart.CR2);
+
+    TEST_ASSERT_EQUAL(ERROR_NONE, spi_init(&spi, &spi_config));
+    TEST_ASSERT_EQUAL_HEX32((1U << 14) | (0xFU << 8) | SPI_CR1_SPE | (3U << SPI_CR1_BR_Pos) | 0x3U, spi.CR1);
+    TEST_ASSERT_TRUE(spi.CR1 & SPI_CR1_DFF);
+    TEST_ASSERT_EQUAL_HEX32(SPI_CR2_SSOE | SPI_CR2_TXDMAEN | SPI_CR2_RXDMAEN, spi.CR2);
+
+    // Expected: Values wider than their field are refused instead of
+    // spilling into neighbouring bits
+    uart_config.stop_bits = 4;
+    TEST_ASSERT_EQUAL(ERROR_INVALID_PARAM, uart_init(&uart, &uart_config));
+    spi_config.baud_rate = 8;
+    TEST_ASSERT_EQUAL(ERROR_INVALID_PARAM, spi_init(&spi, &spi_config));
+    spi_config.baud_rate = 3;
+    spi_config.data_size = 17;
+    TEST_ASSERT_EQUAL(ERROR_INVALID_PARAM, spi_init(&spi, &spi_config));
+    spi_config.data_size = 0;
+    TEST_ASSERT_EQUAL(ERROR_INVALID_PARAM, spi_init(&spi, &spi_config));
+}
+
+void test_peripheral_sim_gpio_init_uses_pin_number(void) {
+    gpio_config_t config = {5, 1, 1, 2, 0};  // PA5 output, pull-up, fast
+    peripheral_sim_attach_gpio(&sim, &gpio);
+    gpio.MODER = 0x3U;  // PA0 analog, must survive
+
+    TEST_ASSERT_EQUAL(ERROR_NONE, gpio_init(&gpio, &config));
+    // Expected: Only pin 5's two-bit fields change
+    TEST_ASSERT_EQUAL_HEX32(0x3U | (0x1U << 10), gpio.MODER);
+    TEST_ASSERT_EQUAL_HEX32(0x1U << 10, gpio.PUPDR);
+    TEST_ASSERT_EQUAL_HEX32(0x2U << 10, gpio.OSPEEDR);
+
+    config.pin = 16;
+    TEST_ASSERT_EQUAL(ERROR_INVALID_PARAM, gpio_init(&gpio, &config));
+
+    // Expected: Field values that do not fit are refused, not truncated
+    // (mode 4 would become input, AF16 would become AF0)
+    const gpio_config_t invalid[] = {
+        {5, 4, 1, 2, 0},
+        {5, 1, 4, 2, 0},
+        {5, 1, 1, 4, 0},
+        {5, 2, 1, 2, 16},
+        {12, 2, 1, 2, 16},
+    };
+    gpio_port_config_t table;
+    for (uint8_t i = 0; i < sizeof(invalid) / sizeof(invalid[0]); i++) {
+        TEST_ASSERT_EQUAL(ERROR_INVALID_PARAM, gpio_init(&gpio, (gpio_config_t*)&invalid[i]));
+        TEST_ASSERT_EQUAL(ERROR_INVALID_PARAM, gpio_config_compile(&table, &invalid[i], 1));
+    }
+    TEST_ASSERT_EQUAL_HEX32(0x3U | (0x1U << 10), gpio.MODER);
+    TEST_ASSERT_EQUAL_HEX32(0, gpio.AFR[0]);
+    TEST_ASSERT_EQUAL_HEX32(0, gpio.AFR[1]);
+
+    // Expected: The largest speed and alternate function values are accepted
+    config.pin = 12;
+    config.mode = 2;
+    config.pull = 2;
+    config.speed = 3;
+    config.alternate = 15;
+    TEST_ASSERT_EQUAL(ERROR_NONE, gpio_init(&gpio, &config));
+    TEST_ASSERT_EQUAL_HEX32(0xFU << 16, gpio.AFR[1]);
+}
+
+void test_peripheral_sim_gpio_config_table_matches_per_pin_init(void) {
+    static const gpio_config_t pins[] = {
+        {0, 1, 0, 3, 0},   // Chip selects
+        {1, 1, 0, 3, 0},
+        {9, 2, 1, 3, 7},   // USART1 TX, AF7
+        {10, 2, 1, 0, 7},  // USART1 RX, AF7
+    };
+    GPIO_TypeDef expected;
+    gpio_port_config_t table;
+    memset(&expected, 0, sizeof(expected));
+
+    for (uint8_t i = 0; i < 4; i++) {
+        gpio_init(&expected, (gpio_config_t*)&pins[i]);
+    }
+    TEST_ASSERT_EQUAL(ERROR_NONE, gpio_config_compile(&table, pins, 4));
+    TEST_ASSERT_EQUAL(ERROR_NONE, gpio_config_apply(&gpio, &table));
+
+    // Expected: One RMW per register gives the same port state
+    TEST_ASSERT_EQUAL_HEX32(expected.MODER, gpio.MODER);
+    TEST_ASSERT_EQUAL_HEX32(expected.PUPDR, gpio.PUPDR);
+    TEST_ASSERT_EQUAL_HEX32(expected.OSPEEDR, gpio.OSPEEDR);
+    TEST_ASSERT_EQUAL_HEX32(0x77U << 4, gpio.AFR[1]);
+    TEST_ASSERT_EQUAL_HEX32(0, gpio.AFR[0]);
+}
+
+void test_peripheral_sim_gpio_port_write_is_atomic(void) {
+    peripheral_sim_attach_gpio(&sim, &gpio);
+    gpio.MODER = 0x5555U;  // PA0..PA7 outputs
+    gpio.ODR = 0x0FU;
+
+    TEST_ASSERT_EQUAL(ERROR_NONE, gpio_write_port(&gpio, 0xF0, 0x0F));
+    // Expected: Four pins rise and four fall in the same BSRR write
+    TEST_ASSERT_EQUAL_HEX32(0xF0U, gpio.ODR);
+    TEST_ASSERT_EQUAL_HEX16(0xF0, gpio_read_port(&gpio));
+
+    gpio_write_port(&gpio, 0x01, 0x01);
+    // Expected: Set wins when a pin is in both masks
+    TEST_ASSERT_EQUAL_HEX16(0xF1, gpio_read_port(&gpio));
+}
+
+void test_peripheral_sim_dma_uart_transmit(void) {
+    peripheral_sim_device_t device = {capture_rx, NULL, NULL, NULL};
+    uint8_t data[10] = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9};
+    setup_uart(&device);
+    peripheral_sim_attach_dma(&sim, &dma, &uart, true);
+    peripheral_sim_set_irq(&sim, &dma, count_irq, NULL);
+    uart.CR3 |= USART_CR3_DMAT;
+
+    TEST_ASSERT_EQUAL(ERROR_NONE, dma_channel_start(&dma, &uart.DR, data, 10,
+                                                   DMA_CCR_DIR | DMA_CCR_MINC | DMA_CCR_HTIE | DMA_CCR_TCIE));
+    peripheral_sim_advance(&sim, 20 * peripheral_sim_uart_frame_ns(&uart));
+
+    // Expected: Channel drained, half and full transfer interrupts raised
+    TEST_ASSERT_EQUAL_UINT32(0, dma.CNDTR);
+    TEST_ASSERT_EQUAL_UINT16(10, captured_count);
+    TEST_ASSERT_EQUAL_MEMORY(data, captured, 10);
+    TEST_ASSERT_EQUAL_UINT32(2, irq_count);
+    TEST_ASSERT_TRUE(uart.SR & USART_SR_TC);
+}
+
+void test_peripheral_sim_runs_faster_than_real_time(void) {
+    uint8_t data[64];
+    memset(data, 0x55, sizeof(data));
+    setup_uart(NULL);
+    uart.BRR = 9600;
+
+    for (int i = 0; i < 16; i++) {
+        uart_transmit(&uart, data, sizeof(data), 100);
+    }
+    // Expected: ~1 s of 9600-baud traffic is simulated, not waited for
+    TEST_ASSERT_GREATER_THAN(1000000000ULL, peripheral_sim_now(&sim));
+    TEST_ASSERT_EQUAL_UINT64(peripheral_sim_now(&sim), peripheral_sim_clock());
+}
+
+int main(void) {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_peripheral_sim_init_rejects_zero_clock);
+    RUN_TEST(test_peripheral_sim_uart_frame_time_follows_brr);
+    RUN_TEST(test_peripheral_sim_uart_transmit_takes_wire_time);
+    RUN_TEST(test_peripheral_sim_uart_script_replies_after_latency);
+    RUN_TEST(test_peripheral_sim_uart_receive_times_out_without_traffic);
+    RUN_TEST(test_peripheral_sim_uart_overrun_and_idle);
+    RUN_TEST(test_peripheral_sim_uart_rx_interrupt);
+    RUN_TEST(test_peripheral_sim_spi_regmap_read);
+    RUN_TEST(test_peripheral_sim_spi_unselected_reads_pullup);
+    RUN_TEST(test_peripheral_sim_spi_16bit_frames);
+    RUN_TEST(test_peripheral_sim_spi_primed_tx_hides_access_time);
+    RUN_TEST(test_peripheral_sim_spi_timeout_when_disabled);
+    RUN_TEST(test_peripheral_sim_init_fields_and_range_checks);
+    RUN_TEST(test_peripheral_sim_gpio_init_uses_pin_number);
+    RUN_TEST(test_peripheral_sim_gpio_config_table_matches_per_pin_init);
+    RUN_TEST(test_peripheral_sim_gpio_port_write_is_atomic);
+    RUN_TEST(test_peripheral_sim_dma_uart_transmit);
+    RUN_TEST(test_peripheral_sim_runs_faster_than_real_time);
+
+    return UNITY_END();
+}
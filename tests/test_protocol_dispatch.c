@@ -0,0 +1,285 @@
+/* test_protocol_dispatch.c – Unity Tests for the flat command table dispatcher */
+
+#include "unity.h"
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "protocol_dispatch.h"
+#include "protocol_framer.h"
+
+// ====================================================================
+// Test Fixtures
+// ====================================================================
+
+#define MAX_CALLS 8
+
+typedef struct {
+    uint32_t calls;
+    uint16_t counts[MAX_CALLS];         // Messages per call
+    uint8_t first_byte[MAX_CALLS][4];   // First payload byte of each message in the call
+    uint64_t delay_ns;                  // Fake time spent in the handler
+    protocol_error_t result;
+} handler_log_t;
+
+static protocol_dispatcher_t dispatcher;
+static handler_log_t single_log;
+static handler_log_t batch_log;
+static uint64_t fake_ns;
+static uint8_t raw[PROTOCOL_DISPATCH_BURST_MAX + 1][PROTOCOL_MAX_FRAME];
+static protocol_frame_t frames[PROTOCOL_DISPATCH_BURST_MAX + 1];
+
+static uint64_t fake_clock(void) {
+    return fake_ns;
+}
+
+static protocol_error_t single_handler(const protocol_frame_t *frame, void *context) {
+    handler_log_t *log = (handler_log_t*)context;
+    if (log->calls < MAX_CALLS) {
+        log->counts[log->calls] = 1;
+        log->first_byte[log->calls][0] = frame->payload[0];
+    }
+    log->calls++;
+    fake_ns += log->delay_ns;
+    return log->result;
+}
+
+static protocol_error_t batch_handler(const protocol_frame_t *batch, uint16_t count, void *context) {
+    handler_log_t *log = (handler_log_t*)context;
+    if (log->calls < MAX_CALLS) {
+        log->counts[log->calls] = count;
+        for (uint16_t i = 0; i < count && i < 4; i++) {
+            log->first_byte[log->calls][i] = batch[i].payload[0];
+        }
+    }
+    log->calls++;
+    fake_ns += log->delay_ns;
+    return log->result;
+}
+
+// Frame view over raw[index] with a 4-byte payload starting with tag
+static const protocol_frame_t* make_frame(uint16_t index, uint8_t command, uint8_t tag) {
+    uint8_t *buf = raw[index];
+    buf[0] = PROTOCOL_HEADER_BYTE;
+    buf[1] = command;
+    buf[2] = 4;
+    buf[3] = 0;
+    memset(buf + PROTOCOL_HEADER_SIZE, tag, 4);
+
+    frames[index].command = command;
+    frames[index].data_length = 4;
+    frames[index].payload = buf + PROTOCOL_HEADER_SIZE;
+    frames[index].raw = buf;
+    frames[index].raw_length = PROTOCOL_HEADER_SIZE + 4 + PROTOCOL_CRC_SIZE;
+    return &frames[index];
+}
+
+// ====================================================================
+// Setup and Teardown
+// ====================================================================
+
+void setUp(void) {
+    fake_ns = 0;
+    memset(&single_log, 0, sizeof(single_log));
+    memset(&batch_log, 0, sizeof(batch_log));
+    protocol_dispatch_init(&dispatcher, fake_clock);
+}
+
+void tearDown(void) {
+}
+
+// ====================================================================
+// Dispatch Tests
+// ====================================================================
+
+void test_protocol_dispatch_invalid_params(void) {
+    // Expected: NULL dispatcher, handler or frame are rejected
+    TEST_ASSERT_EQUAL(PROTOCOL_ERROR_INVALID_HEADER, protocol_dispatch_init(NULL, fake_clock));
+    TEST_ASSERT_EQUAL(PROTOCOL_ERROR_INVALID_HEADER, protocol_dispatch_register(&dispatcher, 0x10, NULL, NULL));
+    TEST_ASSERT_EQUAL(PROTOCOL_ERROR_INVALID_HEADER, protocol_dispatch_register_batch(&dispatcher, 0x10, NULL, NULL));
+    TEST_ASSERT_EQUAL(PROTOCOL_ERROR_INVALID_HEADER, protocol_dispatch_message(&dispatcher, NULL));
+    TEST_ASSERT_EQUAL(PROTOCOL_ERROR_INVALID_HEADER, protocol_dispatch_flush(NULL));
+}
+
+void test_protocol_dispatch_unknown_command(void) {
+    protocol_dispatch_register(&dispatcher, 0x10, single_handler, &single_log);
+
+    // Expected: a command with no handler is counted, not delivered
+    TEST_ASSERT_EQUAL(PROTOCOL_ERROR_INVALID_HEADER, protocol_dispatch_message(&dispatcher, make_frame(0, 0x11, 1)));
+    TEST_ASSERT_EQUAL_UINT32(1, dispatcher.unhandled);
+    TEST_ASSERT_EQUAL_UINT32(0, single_log.calls);
+    TEST_ASSERT_EQUAL_UINT32(0, protocol_dispatch_get_stats(&dispatcher, 0x11)->messages);
+
+    // Expected: an unregistered command goes back to unhandled
+    protocol_dispatch_unregister(&dispatcher, 0x10);
+    TEST_ASSERT_EQUAL(PROTOCOL_ERROR_INVALID_HEADER, protocol_dispatch_message(&dispatcher, make_frame(0, 0x10, 1)));
+    TEST_ASSERT_EQUAL_UINT32(2, dispatcher.unhandled);
+}
+
+void test_protocol_dispatch_propagates_handler_result(void) {
+    protocol_dispatch_register(&dispatcher, 0x10, single_handler, &single_log);
+
+    TEST_ASSERT_EQUAL(PROTOCOL_ERROR_NONE, protocol_dispatch_message(&dispatcher, make_frame(0, 0x10, 7)));
+    single_log.result = PROTOCOL_ERROR_CRC_MISMATCH;
+
+    // Expected: the handler's error is returned and counted against its command
+    TEST_ASSERT_EQUAL(PROTOCOL_ERROR_CRC_MISMATCH, protocol_dispatch_message(&dispatcher, make_frame(0, 0x10, 8)));
+    TEST_ASSERT_EQUAL_UINT32(2, single_log.calls);
+    TEST_ASSERT_EQUAL_UINT8(7, single_log.first_byte[0][0]);
+    TEST_ASSERT_EQUAL_UINT8(8, single_log.first_byte[1][0]);
+
+    const protocol_command_stats_t *stats = protocol_dispatch_get_stats(&dispatcher, 0x10);
+    TEST_ASSERT_EQUAL_UINT32(2, stats->messages);
+    TEST_ASSERT_EQUAL_UINT32(1, stats->errors);
+    TEST_ASSERT_EQUAL_UINT32(0, stats->batches);
+}
+
+void test_protocol_dispatch_single_and_batch_keep_their_context(void) {
+    // Expected: a command takes one kind of handler at a time
+    TEST_ASSERT_EQUAL(PROTOCOL_ERROR_NONE, protocol_dispatch_register(&dispatcher, 0x10, single_handler, &single_log));
+    TEST_ASSERT_EQUAL(PROTOCOL_ERROR_INVALID_HEADER,
+                      protocol_dispatch_register_batch(&dispatcher, 0x10, batch_handler, &batch_log));
+    TEST_ASSERT_EQUAL(PROTOCOL_ERROR_NONE, protocol_dispatch_register_batch(&dispatcher, 0x20, batch_handler, &batch_log));
+    TEST_ASSERT_EQUAL(PROTOCOL_ERROR_INVALID_HEADER,
+                      protocol_dispatch_register(&dispatcher, 0x20, single_handler, &single_log));
+
+    // Expected: after unregistering, the other kind is accepted with its own context
+    protocol_dispatch_unregister(&dispatcher, 0x10);
+    TEST_ASSERT_EQUAL(PROTOCOL_ERROR_NONE, protocol_dispatch_register_batch(&dispatcher, 0x10, batch_handler, &batch_log));
+    TEST_ASSERT_EQUAL_PTR(&batch_log, dispatcher.commands[0x10].batch_context);
+    TEST_ASSERT_NULL(dispatcher.commands[0x10].context);
+
+    protocol_dispatch_message(&dispatcher, make_frame(0, 0x10, 1));
+    protocol_dispatch_message(&dispatcher, make_frame(1, 0x20, 2));
+    TEST_ASSERT_EQUAL(PROTOCOL_ERROR_NONE, protocol_dispatch_flush(&dispatcher));
+    TEST_ASSERT_EQUAL_UINT32(2, batch_log.calls);
+    TEST_ASSERT_EQUAL_UINT32(0, single_log.calls);
+}
+
+void test_protocol_dispatch_batch_staging_and_flush(void) {
+    protocol_dispatch_register(&dispatcher, 0x10, single_handler, &single_log);
+    protocol_dispatch_register_batch(&dispatcher, 0x20, batch_handler, &batch_log);
+    protocol_dispatch_register_batch(&dispatcher, 0x21, batch_handler, &batch_log);
+
+    protocol_dispatch_message(&dispatcher, make_frame(0, 0x20, 1));
+    protocol_dispatch_message(&dispatcher, make_frame(1, 0x21, 2));
+    protocol_dispatch_message(&dispatcher, make_frame(2, 0x10, 3));
+    protocol_dispatch_message(&dispatcher, make_frame(3, 0x20, 4));
+
+    // Expected: single handlers run at once, batched messages wait for the flush
+    TEST_ASSERT_EQUAL_UINT32(1, single_log.calls);
+    TEST_ASSERT_EQUAL_UINT32(0, batch_log.calls);
+    TEST_ASSERT_EQUAL_UINT16(3, dispatcher.burst_count);
+
+    // Expected: staged messages are copies, not views of the caller's buffer
+    memset(raw, 0xEE, sizeof(raw));
+    TEST_ASSERT_EQUAL(PROTOCOL_ERROR_NONE, protocol_dispatch_flush(&dispatcher));
+
+    // Expected: one call per command in first-arrival order, arrival order within it
+    TEST_ASSERT_EQUAL_UINT32(2, batch_log.calls);
+    TEST_ASSERT_EQUAL_UINT16(2, batch_log.counts[0]);
+    TEST_ASSERT_EQUAL_UINT8(1, batch_log.first_byte[0][0]);
+    TEST_ASSERT_EQUAL_UINT8(4, batch_log.first_byte[0][1]);
+    TEST_ASSERT_EQUAL_UINT16(1, batch_log.counts[1]);
+    TEST_ASSERT_EQUAL_UINT8(2, batch_log.first_byte[1][0]);
+    TEST_ASSERT_EQUAL_UINT16(0, dispatcher.burst_count);
+    TEST_ASSERT_EQUAL_UINT32(2, protocol_dispatch_get_stats(&dispatcher, 0x20)->messages);
+    TEST_ASSERT_EQUAL_UINT32(1, protocol_dispatch_get_stats(&dispatcher, 0x20)->batches);
+
+    // Expected: a flush with nothing staged calls nobody
+    TEST_ASSERT_EQUAL(PROTOCOL_ERROR_NONE, protocol_dispatch_flush(&dispatcher));
+    TEST_ASSERT_EQUAL_UINT32(2, batch_log.calls);
+}
+
+void test_protocol_dispatch_full_burst_flushes_early(void) {
+    protocol_dispatch_register_batch(&dispatcher, 0x20, batch_handler, &batch_log);
+
+    for (uint16_t i = 0; i <= PROTOCOL_DISPATCH_BURST_MAX; i++) {
+        TEST_ASSERT_EQUAL(PROTOCOL_ERROR_NONE, protocol_dispatch_message(&dispatcher, make_frame(i, 0x20, (uint8_t)i)));
+    }
+
+    // Expected: the 65th message flushes the first 64 and is staged itself
+    TEST_ASSERT_EQUAL_UINT32(1, dispatcher.burst_overflow);
+    TEST_ASSERT_EQUAL_UINT32(1, batch_log.calls);
+    TEST_ASSERT_EQUAL_UINT16(PROTOCOL_DISPATCH_BURST_MAX, batch_log.counts[0]);
+    TEST_ASSERT_EQUAL_UINT16(1, dispatcher.burst_count);
+
+    // Expected: a batch handler's error comes back from the flush
+    batch_log.result = PROTOCOL_ERROR_BUFFER_OVERFLOW;
+    TEST_ASSERT_EQUAL(PROTOCOL_ERROR_BUFFER_OVERFLOW, protocol_dispatch_flush(&dispatcher));
+    TEST_ASSERT_EQUAL_UINT32(1, protocol_dispatch_get_stats(&dispatcher, 0x20)->errors);
+}
+
+void test_protocol_dispatch_latency_stats_and_percentiles(void) {
+    protocol_dispatch_register(&dispatcher, 0x10, single_handler, &single_log);
+
+    // 8 x 500 ns, 1 x 3000 ns, 1 x 20 ms
+    single_log.delay_ns = 500;
+    for (uint8_t i = 0; i < 8; i++) {
+        protocol_dispatch_message(&dispatcher, make_frame(0, 0x10, i));
+    }
+    single_log.delay_ns = 3000;
+    protocol_dispatch_message(&dispatcher, make_frame(0, 0x10, 8));
+    single_log.delay_ns = 20000000;
+    protocol_dispatch_message(&dispatcher, make_frame(0, 0x10, 9));
+
+    const protocol_command_stats_t *stats = protocol_dispatch_get_stats(&dispatcher, 0x10);
+
+    // Expected: every call's elapsed time lands in the command's histogram
+    TEST_ASSERT_EQUAL_UINT32(10, stats->messages);
+    TEST_ASSERT_EQUAL_UINT32(10, (uint32_t)latency_hist_count(&stats->latency));
+    TEST_ASSERT_EQUAL_UINT64(8 * 500 + 3000 + 20000000, stats->total_ns);
+    TEST_ASSERT_EQUAL_UINT64(20000000, stats->latency.max_ns);
+
+    // Expected: percentiles within the histogram's 1/32, the maximum exact
+    uint64_t p90 = latency_hist_percentile(&stats->latency, 90.0);
+    TEST_ASSERT_TRUE(latency_hist_percentile(&stats->latency, 50.0) >= 500);
+    TEST_ASSERT_TRUE(latency_hist_percentile(&stats->latency, 50.0) <= 500 + 500 / 32);
+    TEST_ASSERT_TRUE(p90 >= 3000 && p90 <= 3000 + 3000 / 32);
+    TEST_ASSERT_EQUAL_UINT64(20000000, latency_hist_percentile(&stats->latency, 100.0));
+
+    // Expected: commands keep separate statistics, and a reset clears them
+    TEST_ASSERT_EQUAL_UINT64(0, latency_hist_percentile(&protocol_dispatch_get_stats(&dispatcher, 0x11)->latency, 50.0));
+    protocol_dispatch_reset_stats(&dispatcher);
+    TEST_ASSERT_EQUAL_UINT32(0, stats->messages);
+    TEST_ASSERT_EQUAL_UINT64(0, latency_hist_percentile(&stats->latency, 50.0));
+}
+
+void test_protocol_dispatch_fed_by_framer(void) {
+    protocol_framer_t framer;
+    uint8_t stream[2 * PROTOCOL_MAX_FRAME];
+    uint16_t length = 0;
+
+    protocol_dispatch_register(&dispatcher, 0x10, single_handler, &single_log);
+    protocol_framer_init(&framer, protocol_dispatch_framer_cb, &dispatcher);
+
+    for (uint8_t tag = 5; tag < 7; tag++) {
+        make_frame(0, 0x10, tag);
+        uint16_t crc = protocol_calculate_crc(raw[0], PROTOCOL_HEADER_SIZE + 4);
+        raw[0][PROTOCOL_HEADER_SIZE + 4] = (uint8_t)(crc & 0xFF);
+        raw[0][PROTOCOL_HEADER_SIZE + 5] = (uint8_t)(crc >> 8);
+        memcpy(stream + length, raw[0], frames[0].raw_length);
+        length += frames[0].raw_length;
+    }
+
+    // Expected: every verified message reaches its handler
+    TEST_ASSERT_EQUAL(PROTOCOL_ERROR_NONE, protocol_framer_feed(&framer, stream, length));
+    TEST_ASSERT_EQUAL_UINT32(2, single_log.calls);
+    TEST_ASSERT_EQUAL_UINT8(5, single_log.first_byte[0][0]);
+    TEST_ASSERT_EQUAL_UINT8(6, single_log.first_byte[1][0]);
+}
+
+int main(void) {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_protocol_dispatch_invalid_params);
+    RUN_TEST(test_protocol_dispatch_unknown_command);
+    RUN_TEST(test_protocol_dispatch_propagates_handler_result);
+    RUN_TEST(test_protocol_dispatch_single_and_batch_keep_their_context);
+    RUN_TEST(test_protocol_dispatch_batch_staging_and_flush);
+    RUN_TEST(test_protocol_dispatch_full_burst_flushes_early);
+    RUN_TEST(test_protocol_dispatch_latency_stats_and_percentiles);
+    RUN_TEST(test_protocol_dispatch_fed_by_framer);
+
+    return UNITY_END();
+}
@@ -0,0 +1,246 @@
+/* test_protocol_framer.c – Unity Tests for the streaming protocol framer */
+
+#include "unity.h"
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "protocol_framer.h"
+#include "protocol_wire.h"
+
+// ====================================================================
+// Test Fixtures
+// ====================================================================
+
+#define MAX_CAPTURED 16
+
+typedef struct {
+    uint32_t count;
+    uint8_t commands[MAX_CAPTURED];
+    uint16_t lengths[MAX_CAPTURED];
+    uint8_t first_payload_byte[MAX_CAPTURED];
+} capture_t;
+
+static protocol_framer_t test_framer;
+static capture_t capture;
+static uint8_t stream[2048];
+
+static void capture_cb(const protocol_frame_t *frame, void *context) {
+    capture_t *cap = (capture_t*)context;
+    if (cap->count < MAX_CAPTURED) {
+        cap->commands[cap->count] = frame->command;
+        cap->lengths[cap->count] = frame->data_length;
+        cap->first_payload_byte[cap->count] = frame->data_length ? frame->payload[0] : 0;
+    }
+    cap->count++;
+}
+
+// Encodes one message at buf, returns its length on the wire
+static uint16_t encode_message(uint8_t *buf, uint8_t command, uint16_t length, uint8_t fill) {
+    buf[0] = PROTOCOL_HEADER_BYTE;
+    buf[1] = command;
+    buf[2] = (uint8_t)(length & 0xFF);
+    buf[3] = (uint8_t)(length >> 8);
+    memset(buf + PROTOCOL_HEADER_SIZE, fill, length);
+    uint16_t crc = protocol_calculate_crc(buf, PROTOCOL_HEADER_SIZE + length);
+    buf[PROTOCOL_HEADER_SIZE + length] = (uint8_t)(crc & 0xFF);
+    buf[PROTOCOL_HEADER_SIZE + length + 1] = (uint8_t)(crc >> 8);
+    return PROTOCOL_HEADER_SIZE + length + PROTOCOL_CRC_SIZE;
+}
+
+// ====================================================================
+// Setup and Teardown
+// ====================================================================
+
+void setUp(void) {
+    memset(&capture, 0, sizeof(capture));
+    protocol_framer_init(&test_framer, capture_cb, &capture);
+}
+
+void tearDown(void) {
+}
+
+// ====================================================================
+// Framer Tests
+// ====================================================================
+
+void test_protocol_framer_init_null_returns_invalid_header(void) {
+    // Expected: NULL framer is rejected
+    TEST_ASSERT_EQUAL(PROTOCOL_ERROR_INVALID_HEADER, protocol_framer_init(NULL, capture_cb, NULL));
+    // Expected: Fresh framer is idle
+    TEST_ASSERT_EQUAL(PROTOCOL_STATE_IDLE, test_framer.state);
+}
+
+void test_protocol_framer_feed_null_data_returns_invalid_header(void) {
+    TEST_ASSERT_EQUAL(PROTOCOL_ERROR_INVALID_HEADER, protocol_framer_feed(&test_framer, NULL, 4));
+    TEST_ASSERT_EQUAL(PROTOCOL_ERROR_INVALID_HEADER, protocol_framer_feed(NULL, stream, 4));
+}
+
+void test_protocol_framer_whole_messages_are_zero_copy(void) {
+    uint16_t len = encode_message(stream, 0x10, 8, 0x11);
+    len += encode_message(stream + len, 0x20, 0, 0);
+
+    TEST_ASSERT_EQUAL(PROTOCOL_ERROR_NONE, protocol_framer_feed(&test_framer, stream, len));
+    // Expected: Both messages delivered straight from the chunk
+    TEST_ASSERT_EQUAL_UINT32(2, capture.count);
+    TEST_ASSERT_EQUAL_HEX8(0x10, capture.commands[0]);
+    TEST_ASSERT_EQUAL_UINT16(8, capture.lengths[0]);
+    TEST_ASSERT_EQUAL_HEX8(0x11, capture.first_payload_byte[0]);
+    TEST_ASSERT_EQUAL_HEX8(0x20, capture.commands[1]);
+    TEST_ASSERT_EQUAL_UINT32(2, test_framer.stats.zero_copy);
+    TEST_ASSERT_EQUAL(PROTOCOL_STATE_IDLE, test_framer.state);
+}
+
+void test_protocol_framer_byte_by_byte_stream(void) {
+    uint16_t len = encode_message(stream, 0x33, 200, 0x5C);
+
+    for (uint16_t i = 0; i < len; i++) {
+        protocol_framer_feed(&test_framer, &stream[i], 1);
+        if (i + 1 < len) {
+            // Expected: Partial frame keeps the framer in RECEIVING
+            TEST_ASSERT_EQUAL(PROTOCOL_STATE_RECEIVING, test_framer.state);
+        }
+    }
+
+    // Expected: Message assembled from single-byte chunks
+    TEST_ASSERT_EQUAL_UINT32(1, capture.count);
+    TEST_ASSERT_EQUAL_UINT16(200, capture.lengths[0]);
+    TEST_ASSERT_EQUAL_HEX8(0x5C, capture.first_payload_byte[0]);
+    TEST_ASSERT_EQUAL_UINT32(0, test_framer.stats.zero_copy);
+    TEST_ASSERT_EQUAL(PROTOCOL_STATE_IDLE, test_framer.state);
+}
+
+void test_protocol_framer_skips_leading_noise(void) {
+    memset(stream, 0x55, 37);
+    uint16_t len = 37 + encode_message(stream + 37, 0x01, 4, 0x02);
+
+    protocol_framer_feed(&test_framer, stream, len);
+    // Expected: Noise is discarded, message found
+    TEST_ASSERT_EQUAL_UINT32(1, capture.count);
+    TEST_ASSERT_EQUAL_UINT32(37, test_framer.stats.discarded_bytes);
+    TEST_ASSERT_EQUAL_UINT32(0, test_framer.stats.resync_events);
+}
+
+void test_protocol_framer_resyncs_after_crc_error(void) {
+    uint16_t first = encode_message(stream, 0x01, 16, 0x00);
+    stream[first - 1] ^= 0xFF;  // Corrupt CRC of the first message
+    uint16_t len = first + encode_message(stream + first, 0x02, 16, 0x00);
+
+    protocol_framer_feed(&test_framer, stream, len);
+    // Expected: Corrupt frame dropped, the next one recovered
+    TEST_ASSERT_EQUAL_UINT32(1, capture.count);
+    TEST_ASSERT_EQUAL_HEX8(0x02, capture.commands[0]);
+    TEST_ASSERT_EQUAL_UINT32(1, test_framer.stats.crc_errors);
+    TEST_ASSERT_GREATER_OR_EQUAL(1, test_framer.stats.resync_events);
+}
+
+void test_protocol_framer_false_header_inside_split_frame(void) {
+    // A stray 0xAA with a plausible length swallows the start of a real
+    // message; the framer must find the real one inside its own buffer
+    stream[0] = PROTOCOL_HEADER_BYTE;
+    stream[1] = 0x00;
+    stream[2] = 20;
+    stream[3] = 0x00;
+    uint16_t len = 4 + encode_message(stream + 4, 0x44, 2, 0x99);
+
+    for (uint16_t i = 0; i < len; i += 3) {
+        uint16_t chunk = (len - i) < 3 ? (len - i) : 3;
+        protocol_framer_feed(&test_framer, stream + i, chunk);
+    }
+    // Pad with noise so the false candidate completes and is rejected
+    uint8_t noise[32];
+    memset(noise, 0x00, sizeof(noise));
+    protocol_framer_feed(&test_framer, noise, sizeof(noise));
+
+    // Expected: Real message recovered from the assembly buffer
+    TEST_ASSERT_EQUAL_UINT32(1, capture.count);
+    TEST_ASSERT_EQUAL_HEX8(0x44, capture.commands[0]);
+    TEST_ASSERT_EQUAL_HEX8(0x99, capture.first_payload_byte[0]);
+    TEST_ASSERT_EQUAL_UINT32(1, test_framer.stats.resync_events);
+}
+
+void test_protocol_framer_rejects_oversized_length(void) {
+    stream[0] = PROTOCOL_HEADER_BYTE;
+    stream[1] = 0x01;
+    stream[2] = 0xFF;
+    stream[3] = 0xFF;  // 65535 > PROTOCOL_MAX_PAYLOAD
+    uint16_t len = 4 + encode_message(stream + 4, 0x07, 1, 0x01);
+
+    protocol_framer_feed(&test_framer, stream, len);
+    // Expected: Bad length triggers resync, following message is delivered
+    TEST_ASSERT_EQUAL_UINT32(1, test_framer.stats.length_errors);
+    TEST_ASSERT_EQUAL_UINT32(1, capture.count);
+    TEST_ASSERT_EQUAL_HEX8(0x07, capture.commands[0]);
+}
+
+void test_protocol_framer_reset_drops_partial_frame(void) {
+    uint16_t len = encode_message(stream, 0x01, 10, 0x00);
+    protocol_framer_feed(&test_framer, stream, len / 2);
+    TEST_ASSERT_EQUAL(PROTOCOL_STATE_RECEIVING, test_framer.state);
+
+    protocol_framer_reset(&test_framer);
+    // Expected: Reset returns to IDLE and forgets buffered bytes
+    TEST_ASSERT_EQUAL(PROTOCOL_STATE_IDLE, test_framer.state);
+    TEST_ASSERT_EQUAL_UINT16(0, test_framer.buffered);
+}
+
+void test_protocol_wire_encode_is_accepted_by_framer(void) {
+    uint8_t payload[3] = {0x10, 0x20, 0x30};
+    uint16_t len = 0;
+
+    TEST_ASSERT_EQUAL(PROTOCOL_ERROR_NONE,
+                      protocol_wire_encode(stream, sizeof(stream), 0x42, payload, sizeof(payload), &len));
+    protocol_framer_feed(&test_framer, stream, len);
+
+    // Expected: Little-endian length, trailing CRC, one message delivered
+    TEST_ASSERT_EQUAL_UINT16(PROTOCOL_HEADER_SIZE + 3 + PROTOCOL_CRC_SIZE, len);
+    TEST_ASSERT_EQUAL_UINT8(0x03, stream[2]);
+    TEST_ASSERT_EQUAL_UINT8(0x00, stream[3]);
+    TEST_ASSERT_EQUAL_UINT32(1, capture.count);
+    TEST_ASSERT_EQUAL_UINT8(0x42, capture.commands[0]);
+    TEST_ASSERT_EQUAL_UINT8(0x10, capture.first_payload_byte[0]);
+}
+
+void test_protocol_wire_decode_detects_corruption(void) {
+    uint8_t payload[8] = {0};
+    uint16_t len = 0;
+    protocol_frame_t frame;
+
+    protocol_wire_encode(stream, sizeof(stream), 0x07, payload, sizeof(payload), &len);
+    TEST_ASSERT_EQUAL(PROTOCOL_ERROR_NONE, protocol_wire_decode(stream, len, &frame));
+    TEST_ASSERT_EQUAL_PTR(stream + PROTOCOL_HEADER_SIZE, frame.payload);
+
+    // Expected: Truncation and bit errors are reported, not decoded
+    TEST_ASSERT_EQUAL(PROTOCOL_ERROR_BUFFER_OVERFLOW, protocol_wire_decode(stream, len - 1, &frame));
+    stream[PROTOCOL_HEADER_SIZE] ^= 0x01;
+    TEST_ASSERT_EQUAL(PROTOCOL_ERROR_CRC_MISMATCH, protocol_wire_decode(stream, len, &frame));
+}
+
+void test_protocol_wire_encode_rejects_small_buffer(void) {
+    uint8_t payload[16] = {0};
+    uint16_t len = 0;
+
+    // Expected: Capacity is checked before anything is written
+    TEST_ASSERT_EQUAL(PROTOCOL_ERROR_BUFFER_OVERFLOW,
+                      protocol_wire_encode(stream, 8, 0x01, payload, sizeof(payload), &len));
+    TEST_ASSERT_EQUAL_UINT16(0, len);
+}
+
+int main(void) {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_protocol_framer_init_null_returns_invalid_header);
+    RUN_TEST(test_protocol_framer_feed_null_data_returns_invalid_header);
+    RUN_TEST(test_protocol_framer_whole_messages_are_zero_copy);
+    RUN_TEST(test_protocol_framer_byte_by_byte_stream);
+    RUN_TEST(test_protocol_framer_skips_leading_noise);
+    RUN_TEST(test_protocol_framer_resyncs_after_crc_error);
+    RUN_TEST(test_protocol_framer_false_header_inside_split_frame);
+    RUN_TEST(test_protocol_framer_rejects_oversized_length);
+    RUN_TEST(test_protocol_framer_reset_drops_partial_frame);
+    RUN_TEST(test_protocol_wire_encode_is_accepted_by_framer);
+    RUN_TEST(test_protocol_wire_decode_detects_corruption);
+    RUN_TEST(test_protocol_wire_encode_rejects_small_buffer);
+
+    return UNITY_END();
+}
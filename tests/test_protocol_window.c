@@ -0,0 +1,313 @@
+/* test_protocol_window.c – Unity Tests for the windowed (pipelined) UART protocol link */
+
+#include "unity.h"
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "protocol_window.h"
+#include "protocol_wire.h"
+#include "timebase.h"
+
+// ====================================================================
+// Test Fixtures
+// ====================================================================
+
+#define MAX_WIRE        64
+#define MAX_DELIVERED   64
+#define RTO_NS          1000000ULL
+#define CMD_DATA        0x30
+
+// Frames one endpoint put on the wire, held until the test hands them over
+typedef struct {
+    uint32_t count;
+    uint16_t length[MAX_WIRE];
+    uint8_t frame[MAX_WIRE][PROTOCOL_MAX_FRAME];
+} wire_t;
+
+typedef struct {
+    uint32_t count;
+    uint8_t first_byte[MAX_DELIVERED];
+} delivered_t;
+
+static protocol_window_t sender;
+static protocol_window_t receiver;
+static wire_t sender_wire;
+static wire_t receiver_wire;
+static delivered_t delivered;
+
+static protocol_error_t capture_tx(const uint8_t *data, uint16_t length, void *context) {
+    wire_t *wire = (wire_t*)context;
+    uint32_t index = wire->count++ % MAX_WIRE;
+    memcpy(wire->frame[index], data, length);
+    wire->length[index] = length;
+    return PROTOCOL_ERROR_NONE;
+}
+
+static void capture_deliver(const protocol_frame_t *frame, void *context) {
+    delivered_t *log = (delivered_t*)context;
+    if (log->count < MAX_DELIVERED) {
+        log->first_byte[log->count] = frame->payload[0];
+    }
+    log->count++;
+}
+
+static void init_link(uint8_t window_size, uint8_t max_retries) {
+    protocol_window_config_t config = {
+        .window_size = window_size,
+        .rto_ns = RTO_NS,
+        .max_retries = max_retries,
+        .clock = timebase_now_ns,
+        .tx = capture_tx,
+        .tx_context = &sender_wire,
+        .deliver_cb = NULL,
+        .deliver_context = NULL
+    };
+    TEST_ASSERT_EQUAL(PROTOCOL_ERROR_NONE, protocol_window_init(&sender, &config));
+
+    config.tx_context = &receiver_wire;
+    config.deliver_cb = capture_deliver;
+    config.deliver_context = &delivered;
+    TEST_ASSERT_EQUAL(PROTOCOL_ERROR_NONE, protocol_window_init(&receiver, &config));
+}
+
+static void send_tag(uint8_t tag) {
+    TEST_ASSERT_EQUAL(PROTOCOL_ERROR_NONE, protocol_window_send(&sender, CMD_DATA, &tag, 1));
+}
+
+// Hands one captured frame to the other endpoint
+static void pass(const wire_t *wire, uint32_t index, protocol_window_t *to) {
+    TEST_ASSERT_TRUE(index < wire->count);
+    TEST_ASSERT_EQUAL(PROTOCOL_ERROR_NONE,
+                      protocol_window_receive_bytes(to, wire->frame[index % MAX_WIRE], wire->length[index % MAX_WIRE]));
+}
+
+static const uint8_t* last_frame(const wire_t *wire) {
+    return wire->frame[(wire->count - 1) % MAX_WIRE];
+}
+
+// ====================================================================
+// Setup and Teardown
+// ====================================================================
+
+void setUp(void) {
+    timebase_init(TIMEBASE_SOURCE_SIMULATED);
+    timebase_sim_set(1000000000ULL);
+    memset(&sender_wire, 0, sizeof(sender_wire));
+    memset(&receiver_wire, 0, sizeof(receiver_wire));
+    memset(&delivered, 0, sizeof(delivered));
+}
+
+void tearDown(void) {
+    timebase_init(TIMEBASE_SOURCE_MONOTONIC);
+}
+
+// ====================================================================
+// Receiver Tests
+// ====================================================================
+
+void test_protocol_window_delivers_reordered_frames_in_order(void) {
+    init_link(8, 3);
+    send_tag(10);
+    send_tag(11);
+    send_tag(12);
+
+    // Expected: frames arriving 2, 0, 1 are handed up as 0, 1, 2
+    pass(&sender_wire, 2, &receiver);
+    TEST_ASSERT_EQUAL_UINT32(0, delivered.count);
+    pass(&sender_wire, 0, &receiver);
+    TEST_ASSERT_EQUAL_UINT32(1, delivered.count);
+    pass(&sender_wire, 1, &receiver);
+
+    const uint8_t expected[] = {10, 11, 12};
+    TEST_ASSERT_EQUAL_UINT32(3, delivered.count);
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(expected, delivered.first_byte, 3);
+    TEST_ASSERT_EQUAL_UINT8(3, receiver.recv_base);
+    TEST_ASSERT_EQUAL_UINT32(0, receiver.recv_bitmap);
+    TEST_ASSERT_EQUAL_UINT32(1, receiver.stats.out_of_order);
+
+    // Expected: a repeat of a delivered frame is dropped and re-ACKed
+    pass(&sender_wire, 1, &receiver);
+    TEST_ASSERT_EQUAL_UINT32(3, delivered.count);
+    TEST_ASSERT_EQUAL_UINT32(1, receiver.stats.duplicates);
+    TEST_ASSERT_EQUAL_HEX8(PROTOCOL_WINDOW_CMD_ACK, PROTOCOL_MSG_get_command(last_frame(&receiver_wire)));
+}
+
+void test_protocol_window_sack_bitmap_acknowledges_gaps(void) {
+    init_link(8, 3);
+    for (uint8_t i = 0; i < 5; i++) {
+        send_tag(i);
+    }
+
+    // Frame 1 lost, 0, 2 and 3 arrive
+    pass(&sender_wire, 0, &receiver);
+    pass(&sender_wire, 2, &receiver);
+    pass(&sender_wire, 3, &receiver);
+
+    // Expected: cumulative ACK 1, bits 0 and 1 for frames 2 and 3
+    const uint8_t *ack = last_frame(&receiver_wire) + PROTOCOL_HEADER_SIZE;
+    TEST_ASSERT_EQUAL_UINT8(1, PROTOCOL_ACK_get_cumulative(ack));
+    TEST_ASSERT_EQUAL_HEX32(0x3, PROTOCOL_ACK_get_bitmap(ack));
+    TEST_ASSERT_EQUAL_UINT32(1, receiver.stats.nacks_sent);
+
+    // Expected: the sender keeps only frames 1 and 4 unacknowledged
+    pass(&receiver_wire, receiver_wire.count - 1, &sender);
+    TEST_ASSERT_EQUAL_UINT8(1, sender.send_base);
+    TEST_ASSERT_EQUAL_UINT8(4, protocol_window_in_flight(&sender));
+    TEST_ASSERT_FALSE(sender.tx_slots[1].acked);
+    TEST_ASSERT_TRUE(sender.tx_slots[2].acked);
+    TEST_ASSERT_TRUE(sender.tx_slots[3].acked);
+    TEST_ASSERT_FALSE(sender.tx_slots[4].acked);
+
+    // Expected: on timeout only the unacknowledged frames go out again
+    uint32_t before = sender_wire.count;
+    timebase_sim_advance(RTO_NS);
+    TEST_ASSERT_EQUAL(PROTOCOL_ERROR_NONE, protocol_window_service(&sender));
+    TEST_ASSERT_EQUAL_UINT32(before + 2, sender_wire.count);
+    TEST_ASSERT_EQUAL_UINT8(1, sender_wire.frame[before][PROTOCOL_HEADER_SIZE]);
+    TEST_ASSERT_EQUAL_UINT8(4, sender_wire.frame[before + 1][PROTOCOL_HEADER_SIZE]);
+
+    // Expected: the retransmitted frame releases the buffered ones and the window slides
+    pass(&sender_wire, before, &receiver);
+    pass(&sender_wire, before + 1, &receiver);
+    pass(&receiver_wire, receiver_wire.count - 1, &sender);
+    TEST_ASSERT_EQUAL_UINT32(5, delivered.count);
+    TEST_ASSERT_EQUAL_UINT8(0, protocol_window_in_flight(&sender));
+    TEST_ASSERT_EQUAL_UINT64(UINT64_MAX, protocol_window_next_deadline(&sender));
+}
+
+// ====================================================================
+// Sender Tests
+// ====================================================================
+
+void test_protocol_window_nack_triggers_retransmit(void) {
+    init_link(8, 3);
+    send_tag(20);
+    send_tag(21);
+
+    // Frame 0 lost: frame 1 makes the receiver NACK sequence 0
+    pass(&sender_wire, 1, &receiver);
+    TEST_ASSERT_EQUAL_HEX8(PROTOCOL_WINDOW_CMD_NACK, PROTOCOL_MSG_get_command(last_frame(&receiver_wire)));
+    TEST_ASSERT_EQUAL_UINT8(0, PROTOCOL_ACK_get_cumulative(last_frame(&receiver_wire) + PROTOCOL_HEADER_SIZE));
+
+    // Expected: the sender resends frame 0 at once, before its timer runs out
+    pass(&receiver_wire, receiver_wire.count - 1, &sender);
+    TEST_ASSERT_EQUAL_UINT32(1, sender.stats.nacks_received);
+    TEST_ASSERT_EQUAL_UINT32(1, sender.stats.retransmits);
+    TEST_ASSERT_EQUAL_UINT32(0, sender.stats.timeouts);
+    TEST_ASSERT_EQUAL_UINT32(3, sender_wire.count);
+    TEST_ASSERT_EQUAL_UINT8(0, last_frame(&sender_wire)[PROTOCOL_HEADER_SIZE]);
+    TEST_ASSERT_EQUAL_UINT8(1, sender.tx_slots[0].retries);
+
+    // Expected: further arrivals in the same gap only refresh the ACK
+    pass(&sender_wire, 1, &receiver);
+    TEST_ASSERT_EQUAL_UINT32(1, receiver.stats.nacks_sent);
+
+    pass(&sender_wire, 2, &receiver);
+    const uint8_t expected[] = {20, 21};
+    TEST_ASSERT_EQUAL_UINT32(2, delivered.count);
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(expected, delivered.first_byte, 2);
+}
+
+void test_protocol_window_rto_expiry_and_max_retries(void) {
+    init_link(4, 2);
+    send_tag(30);
+    TEST_ASSERT_EQUAL(PROTOCOL_STATE_PROCESSING, sender.state);
+    TEST_ASSERT_EQUAL_UINT64(timebase_now_ns() + RTO_NS, protocol_window_next_deadline(&sender));
+
+    // Expected: nothing is resent before the timeout
+    timebase_sim_advance(RTO_NS - 1);
+    TEST_ASSERT_EQUAL(PROTOCOL_ERROR_NONE, protocol_window_service(&sender));
+    TEST_ASSERT_EQUAL_UINT32(1, sender_wire.count);
+
+    // Expected: each expiry resends and restarts the timer, up to max_retries
+    for (uint8_t retry = 1; retry <= 2; retry++) {
+        timebase_sim_advance(retry == 1 ? 1 : RTO_NS);
+        TEST_ASSERT_EQUAL(PROTOCOL_ERROR_NONE, protocol_window_service(&sender));
+        TEST_ASSERT_EQUAL_UINT32(1 + retry, sender_wire.count);
+        TEST_ASSERT_EQUAL_UINT32(retry, sender.stats.timeouts);
+        TEST_ASSERT_EQUAL_UINT64(timebase_now_ns() + RTO_NS, protocol_window_next_deadline(&sender));
+    }
+
+    // Expected: the next expiry gives up and the link enters the error state
+    timebase_sim_advance(RTO_NS);
+    TEST_ASSERT_EQUAL(PROTOCOL_ERROR_TIMEOUT, protocol_window_service(&sender));
+    TEST_ASSERT_EQUAL(PROTOCOL_STATE_ERROR, sender.state);
+    TEST_ASSERT_EQUAL_UINT32(1, sender.stats.dropped);
+    TEST_ASSERT_EQUAL_UINT32(3, sender_wire.count);
+
+    // Expected: a failed link refuses new data until re-initialised
+    uint8_t tag = 31;
+    TEST_ASSERT_EQUAL(PROTOCOL_ERROR_TIMEOUT, protocol_window_send(&sender, CMD_DATA, &tag, 1));
+    TEST_ASSERT_EQUAL(PROTOCOL_ERROR_TIMEOUT, protocol_window_service(&sender));
+}
+
+void test_protocol_window_full_window_refuses_send(void) {
+    init_link(2, 3);
+    send_tag(1);
+    send_tag(2);
+
+    // Expected: a third frame waits until an ACK opens the window
+    uint8_t tag = 3;
+    TEST_ASSERT_EQUAL(PROTOCOL_ERROR_BUFFER_OVERFLOW, protocol_window_send(&sender, CMD_DATA, &tag, 1));
+    pass(&sender_wire, 0, &receiver);
+    pass(&receiver_wire, receiver_wire.count - 1, &sender);
+    TEST_ASSERT_EQUAL(PROTOCOL_ERROR_NONE, protocol_window_send(&sender, CMD_DATA, &tag, 1));
+}
+
+// ====================================================================
+// Sequence Wraparound Tests
+// ====================================================================
+
+void test_protocol_window_sequence_wraps_at_256(void) {
+    init_link(4, 3);
+
+    // Lossless exchange up to sequence 254
+    for (uint16_t i = 0; i < 254; i++) {
+        send_tag((uint8_t)i);
+        pass(&sender_wire, sender_wire.count - 1, &receiver);
+        pass(&receiver_wire, receiver_wire.count - 1, &sender);
+    }
+    TEST_ASSERT_EQUAL_UINT8(254, sender.send_base);
+    TEST_ASSERT_EQUAL_UINT8(254, receiver.recv_base);
+    TEST_ASSERT_EQUAL_UINT32(254, delivered.count);
+    memset(&delivered, 0, sizeof(delivered));
+
+    // Sequences 254, 255, 0, 1 arrive in reverse across the wrap
+    uint32_t first = sender_wire.count;
+    for (uint8_t i = 0; i < 4; i++) {
+        send_tag((uint8_t)(100 + i));
+    }
+    TEST_ASSERT_EQUAL_UINT8(2, sender.next_seq);
+    TEST_ASSERT_EQUAL_UINT8(4, protocol_window_in_flight(&sender));
+    for (uint8_t i = 4; i > 0; i--) {
+        pass(&sender_wire, first + i - 1, &receiver);
+    }
+
+    // Expected: delivered in sequence order and fully acknowledged across the wrap
+    const uint8_t expected[] = {100, 101, 102, 103};
+    TEST_ASSERT_EQUAL_UINT32(4, delivered.count);
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(expected, delivered.first_byte, 4);
+    TEST_ASSERT_EQUAL_UINT8(2, receiver.recv_base);
+    pass(&receiver_wire, receiver_wire.count - 1, &sender);
+    TEST_ASSERT_EQUAL_UINT8(2, sender.send_base);
+    TEST_ASSERT_EQUAL_UINT8(0, protocol_window_in_flight(&sender));
+    TEST_ASSERT_EQUAL_UINT32(0, sender.stats.retransmits);
+
+    // Expected: the 256-behind copy of an old frame is a duplicate, not new data
+    pass(&sender_wire, first + 2, &receiver);
+    TEST_ASSERT_EQUAL_UINT32(4, delivered.count);
+}
+
+int main(void) {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_protocol_window_delivers_reordered_frames_in_order);
+    RUN_TEST(test_protocol_window_sack_bitmap_acknowledges_gaps);
+    RUN_TEST(test_protocol_window_nack_triggers_retransmit);
+    RUN_TEST(test_protocol_window_rto_expiry_and_max_retries);
+    RUN_TEST(test_protocol_window_full_window_refuses_send);
+    RUN_TEST(test_protocol_window_sequence_wraps_at_256);
+
+    return UNITY_END();
+}
@@ -0,0 +1,347 @@
+/* test_prp_hsr.c – Unity Tests for the PRP/HSR duplicate-discard engine */
+
+#include "unity.h"
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "prp_hsr.h"
+
+// ====================================================================
+// Test Fixtures
+// ====================================================================
+
+static prp_discard_t test_dd;
+static prp_node_t test_nodes[32];
+static uint8_t frame_buf[128];
+static uint64_t fake_ns;
+
+static const uint8_t SRC_MAC[6] = {0x02, 0x00, 0x00, 0x00, 0x00, 0x01};
+static const uint8_t DST_MAC[6] = {0x01, 0x15, 0x4E, 0x00, 0x01, 0x00};
+
+// Builds a 60-byte PRP frame (46-byte LSDU including the trailer)
+static uint16_t build_prp_frame(uint8_t *buf, const uint8_t *src, uint16_t seq, uint8_t lan_id) {
+    const uint16_t length = 60;
+    memset(buf, 0, length);
+    memcpy(buf, DST_MAC, 6);
+    memcpy(buf + 6, src, 6);
+    buf[12] = 0x08;
+    buf[13] = 0x00;
+    buf[14] = 0x45;  // Arbitrary payload byte
+
+    uint16_t lsdu = length - 14;
+    uint8_t *rct = buf + length - PRP_TRAILER_SIZE;
+    rct[0] = (uint8_t)(seq >> 8);
+    rct[1] = (uint8_t)seq;
+    rct[2] = (uint8_t)((lan_id << 4) | (lsdu >> 8));
+    rct[3] = (uint8_t)lsdu;
+    rct[4] = 0x88;
+    rct[5] = 0xFB;
+    return length;
+}
+
+static uint16_t build_hsr_frame(uint8_t *buf, uint16_t seq, uint8_t path) {
+    const uint16_t length = 66;
+    memset(buf, 0, length);
+    memcpy(buf, DST_MAC, 6);
+    memcpy(buf + 6, SRC_MAC, 6);
+    buf[12] = 0x89;
+    buf[13] = 0x2F;
+    uint16_t lsdu = length - 14;
+    buf[14] = (uint8_t)((path << 4) | (lsdu >> 8));
+    buf[15] = (uint8_t)lsdu;
+    buf[16] = (uint8_t)(seq >> 8);
+    buf[17] = (uint8_t)seq;
+    buf[18] = 0x88;  // Inner EtherType 0x88B8 (GOOSE)
+    buf[19] = 0xB8;
+    buf[20] = 0x5A;
+    return length;
+}
+
+static uint64_t fake_clock(void) {
+    return fake_ns;
+}
+
+static prp_decision_t feed_from(const uint8_t *src, uint16_t seq, uint8_t lan) {
+    prp_frame_info_t info;
+    prp_decision_t decision = PRP_DECISION_PASS;
+    uint16_t len = build_prp_frame(frame_buf, src, seq, lan == PRP_LAN_A ? PRP_LAN_ID_A : PRP_LAN_ID_B);
+    if (prp_discard_process(&test_dd, frame_buf, len, lan, &decision, &info) != PROTOCOL_ERROR_NONE) {
+        return PRP_DECISION_PASS;
+    }
+    return decision;
+}
+
+static prp_decision_t feed(uint16_t seq, uint8_t lan) {
+    prp_frame_info_t info;
+    prp_decision_t decision = PRP_DECISION_PASS;
+    uint16_t len = build_prp_frame(frame_buf, SRC_MAC, seq, lan == PRP_LAN_A ? PRP_LAN_ID_A : PRP_LAN_ID_B);
+    if (prp_discard_process(&test_dd, frame_buf, len, lan, &decision, &info) != PROTOCOL_ERROR_NONE) {
+        return PRP_DECISION_PASS;
+    }
+    return decision;
+}
+
+// ====================================================================
+// Setup and Teardown
+// ====================================================================
+
+void setUp(void) {
+    fake_ns = 0;
+    memset(&test_dd, 0, sizeof(test_dd));
+    prp_discard_init(&test_dd, test_nodes, 32);
+}
+
+void tearDown(void) {
+    prp_discard_deinit(&test_dd);
+}
+
+// ====================================================================
+// Tag Parsing Tests
+// ====================================================================
+
+void test_prp_discard_init_invalid_params(void) {
+    // Expected: NULL engine or table and a capacity that is not a power of two are rejected
+    TEST_ASSERT_EQUAL(PROTOCOL_ERROR_INVALID_HEADER, prp_discard_init(NULL, test_nodes, 32));
+    prp_discard_t dd;
+    TEST_ASSERT_EQUAL(PROTOCOL_ERROR_INVALID_HEADER, prp_discard_init(&dd, NULL, 32));
+    TEST_ASSERT_EQUAL(PROTOCOL_ERROR_INVALID_HEADER, prp_discard_init(&dd, test_nodes, 0));
+    TEST_ASSERT_EQUAL(PROTOCOL_ERROR_INVALID_HEADER, prp_discard_init(&dd, test_nodes, 1));
+    TEST_ASSERT_EQUAL(PROTOCOL_ERROR_INVALID_HEADER, prp_discard_init(&dd, test_nodes, 24));
+}
+
+void test_prp_discard_init_sizes_table_to_power_of_two(void) {
+    // Expected: 32 caller slots track 16 nodes at 50% load
+    TEST_ASSERT_EQUAL_PTR(test_nodes, test_dd.nodes);
+    TEST_ASSERT_EQUAL_UINT32(32, test_dd.capacity);
+    TEST_ASSERT_EQUAL_UINT32(16, test_dd.max_nodes);
+}
+
+void test_prp_parse_tag_reads_trailer(void) {
+    prp_frame_info_t info;
+    uint16_t len = build_prp_frame(frame_buf, SRC_MAC, 0x1234, PRP_LAN_ID_B);
+
+    TEST_ASSERT_EQUAL(PROTOCOL_ERROR_NONE, prp_parse_tag(frame_buf, len, &info));
+    // Expected: Trailer fields are decoded and stripped from the frame length
+    TEST_ASSERT_EQUAL(PRP_TAG_PRP, info.type);
+    TEST_ASSERT_EQUAL_HEX16(0x1234, info.sequence);
+    TEST_ASSERT_EQUAL_UINT8(PRP_LAN_ID_B, info.lan_id);
+    TEST_ASSERT_EQUAL_UINT16(len - PRP_TRAILER_SIZE, info.frame_length);
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(SRC_MAC, info.source, 6);
+}
+
+void test_prp_parse_tag_rejects_suffix_with_wrong_lsdu_size(void) {
+    prp_frame_info_t info;
+    uint16_t len = build_prp_frame(frame_buf, SRC_MAC, 1, PRP_LAN_ID_A);
+    frame_buf[len - 3] ^= 0x01;  // Corrupt LSDU size
+
+    TEST_ASSERT_EQUAL(PROTOCOL_ERROR_NONE, prp_parse_tag(frame_buf, len, &info));
+    // Expected: A payload that merely ends in 0x88FB is not treated as tagged
+    TEST_ASSERT_EQUAL(PRP_TAG_NONE, info.type);
+    TEST_ASSERT_EQUAL_UINT16(len, info.frame_length);
+}
+
+void test_prp_parse_tag_reads_hsr_tag(void) {
+    prp_frame_info_t info;
+    uint16_t len = build_hsr_frame(frame_buf, 0x0042, 1);
+
+    TEST_ASSERT_EQUAL(PROTOCOL_ERROR_NONE, prp_parse_tag(frame_buf, len, &info));
+    // Expected: HSR tag fields are decoded
+    TEST_ASSERT_EQUAL(PRP_TAG_HSR, info.type);
+    TEST_ASSERT_EQUAL_HEX16(0x0042, info.sequence);
+    TEST_ASSERT_EQUAL_UINT8(1, info.lan_id);
+    TEST_ASSERT_EQUAL_UINT16(len - HSR_TAG_SIZE, info.frame_length);
+}
+
+// ====================================================================
+// Duplicate-discard Tests
+// ====================================================================
+
+void test_prp_discard_second_copy_is_discarded(void) {
+    // Expected: First copy from either LAN is accepted, the second discarded
+    TEST_ASSERT_EQUAL(PRP_DECISION_ACCEPT, feed(10, PRP_LAN_A));
+    TEST_ASSERT_EQUAL(PRP_DECISION_DISCARD, feed(10, PRP_LAN_B));
+    TEST_ASSERT_EQUAL(PRP_DECISION_ACCEPT, feed(11, PRP_LAN_B));
+    TEST_ASSERT_EQUAL(PRP_DECISION_DISCARD, feed(11, PRP_LAN_A));
+
+    // Expected: Counters split per LAN
+    TEST_ASSERT_EQUAL_UINT32(1, prp_discard_get_counters(&test_dd, PRP_LAN_A)->duplicates);
+    TEST_ASSERT_EQUAL_UINT32(1, prp_discard_get_counters(&test_dd, PRP_LAN_B)->duplicates);
+    TEST_ASSERT_EQUAL_UINT32(2, prp_discard_get_counters(&test_dd, PRP_LAN_A)->received);
+}
+
+void test_prp_discard_untagged_frame_passes(void) {
+    prp_frame_info_t info;
+    prp_decision_t decision;
+    memset(frame_buf, 0, 60);
+    frame_buf[12] = 0x08;
+
+    TEST_ASSERT_EQUAL(PROTOCOL_ERROR_NONE,
+                      prp_discard_process(&test_dd, frame_buf, 60, PRP_LAN_A, &decision, &info));
+    // Expected: Non-redundant traffic is delivered untouched
+    TEST_ASSERT_EQUAL(PRP_DECISION_PASS, decision);
+    TEST_ASSERT_EQUAL_UINT32(1, test_dd.untagged);
+}
+
+void test_prp_discard_late_copy_within_window(void) {
+    for (uint16_t seq = 100; seq < 110; seq++) {
+        TEST_ASSERT_EQUAL(PRP_DECISION_ACCEPT, feed(seq, PRP_LAN_A));
+    }
+    // Expected: LAN B copies arriving behind LAN A are still recognised
+    TEST_ASSERT_EQUAL(PRP_DECISION_DISCARD, feed(100, PRP_LAN_B));
+    TEST_ASSERT_EQUAL(PRP_DECISION_DISCARD, feed(105, PRP_LAN_B));
+    // Expected: LAN B moved forward normally, so nothing is out of order
+    TEST_ASSERT_EQUAL_UINT32(0, prp_discard_get_counters(&test_dd, PRP_LAN_B)->out_of_order);
+}
+
+void test_prp_discard_counts_out_of_order_per_lan(void) {
+    feed(5, PRP_LAN_A);
+    feed(7, PRP_LAN_A);
+    // Expected: Sequence 6 arrives late on LAN A but is the first copy
+    TEST_ASSERT_EQUAL(PRP_DECISION_ACCEPT, feed(6, PRP_LAN_A));
+    TEST_ASSERT_EQUAL_UINT32(1, prp_discard_get_counters(&test_dd, PRP_LAN_A)->out_of_order);
+    TEST_ASSERT_EQUAL_UINT32(0, prp_discard_get_counters(&test_dd, PRP_LAN_B)->out_of_order);
+}
+
+void test_prp_discard_counts_lost_frames_leaving_window(void) {
+    // LAN A sees every frame, LAN B misses sequence 3
+    for (uint16_t seq = 0; seq < 8; seq++) {
+        feed(seq, PRP_LAN_A);
+        if (seq != 3) {
+            feed(seq, PRP_LAN_B);
+        }
+    }
+
+    // Push the whole window out
+    feed(8 + PRP_WINDOW_SIZE, PRP_LAN_A);
+
+    // Expected: LAN B lost one frame inside the window; both LANs lost
+    // sequence 8, which left the window without ever being seen. The other
+    // skipped numbers are still inside the window and not yet charged.
+    uint32_t skipped = 1;
+    TEST_ASSERT_EQUAL_UINT32(skipped, prp_discard_get_counters(&test_dd, PRP_LAN_A)->lost);
+    TEST_ASSERT_EQUAL_UINT32(skipped + 1, prp_discard_get_counters(&test_dd, PRP_LAN_B)->lost);
+}
+
+void test_prp_discard_sequence_wraparound(void) {
+    TEST_ASSERT_EQUAL(PRP_DECISION_ACCEPT, feed(0xFFFE, PRP_LAN_A));
+    TEST_ASSERT_EQUAL(PRP_DECISION_ACCEPT, feed(0xFFFF, PRP_LAN_A));
+    TEST_ASSERT_EQUAL(PRP_DECISION_ACCEPT, feed(0x0000, PRP_LAN_A));
+    // Expected: Duplicates across the 16-bit wrap are still detected
+    TEST_ASSERT_EQUAL(PRP_DECISION_DISCARD, feed(0xFFFF, PRP_LAN_B));
+    TEST_ASSERT_EQUAL(PRP_DECISION_DISCARD, feed(0x0000, PRP_LAN_B));
+}
+
+void test_prp_discard_flags_wrong_lan_id(void) {
+    prp_frame_info_t info;
+    prp_decision_t decision;
+    uint16_t len = build_prp_frame(frame_buf, SRC_MAC, 1, PRP_LAN_ID_B);
+
+    prp_discard_process(&test_dd, frame_buf, len, PRP_LAN_A, &decision, &info);
+    // Expected: A LAN B trailer received on port A is counted
+    TEST_ASSERT_EQUAL_UINT32(1, prp_discard_get_counters(&test_dd, PRP_LAN_A)->wrong_lan);
+}
+
+void test_prp_discard_table_full_passes_frame(void) {
+    prp_frame_info_t info;
+    prp_decision_t decision;
+    uint8_t mac[6] = {0x02, 0, 0, 0, 0, 0};
+
+    for (uint8_t i = 0; i < 16; i++) {
+        mac[5] = i;
+        uint16_t len = build_prp_frame(frame_buf, mac, 1, PRP_LAN_ID_A);
+        TEST_ASSERT_EQUAL(PROTOCOL_ERROR_NONE,
+                          prp_discard_process(&test_dd, frame_buf, len, PRP_LAN_A, &decision, &info));
+    }
+
+    mac[5] = 0xFF;
+    uint16_t len = build_prp_frame(frame_buf, mac, 1, PRP_LAN_ID_A);
+    // Expected: Untracked sender is delivered and the overflow reported
+    TEST_ASSERT_EQUAL(PROTOCOL_ERROR_BUFFER_OVERFLOW,
+                      prp_discard_process(&test_dd, frame_buf, len, PRP_LAN_A, &decision, &info));
+    TEST_ASSERT_EQUAL(PRP_DECISION_ACCEPT, decision);
+    TEST_ASSERT_EQUAL_UINT32(1, test_dd.table_full);
+    TEST_ASSERT_EQUAL_UINT32(17, prp_discard_get_counters(&test_dd, PRP_LAN_A)->accepted);
+}
+
+void test_prp_discard_forgets_silent_nodes(void) {
+    uint8_t mac[6] = {0x02, 0, 0, 0, 0, 0};
+
+    prp_discard_set_clock(&test_dd, fake_clock, 1000);
+    for (uint8_t i = 0; i < 16; i++) {
+        mac[5] = i;
+        TEST_ASSERT_EQUAL(PRP_DECISION_ACCEPT, feed_from(mac, 1, PRP_LAN_A));
+    }
+
+    // Expected: within the forget time a full table keeps refusing new sources
+    fake_ns = 500;
+    mac[5] = 3;
+    TEST_ASSERT_EQUAL(PRP_DECISION_ACCEPT, feed_from(mac, 2, PRP_LAN_A));
+    mac[5] = 0xFF;
+    TEST_ASSERT_EQUAL(PRP_DECISION_PASS, feed_from(mac, 1, PRP_LAN_A));
+    TEST_ASSERT_EQUAL_UINT32(1, test_dd.table_full);
+
+    // Expected: once the others are silent past it, the new source is tracked
+    fake_ns = 1200;
+    TEST_ASSERT_EQUAL(PRP_DECISION_ACCEPT, feed_from(mac, 1, PRP_LAN_A));
+    TEST_ASSERT_EQUAL(PRP_DECISION_DISCARD, feed_from(mac, 1, PRP_LAN_B));
+    TEST_ASSERT_EQUAL_UINT32(1, test_dd.table_full);
+
+    // Expected: the node heard at 500 survives the sweep and still discards
+    prp_discard_forget(&test_dd);
+    TEST_ASSERT_EQUAL_UINT32(2, test_dd.node_count);
+    TEST_ASSERT_EQUAL_UINT32(15, test_dd.forgotten);
+    mac[5] = 3;
+    TEST_ASSERT_EQUAL(PRP_DECISION_DISCARD, feed_from(mac, 2, PRP_LAN_B));
+    mac[5] = 0xFF;
+    TEST_ASSERT_EQUAL(PRP_DECISION_DISCARD, feed_from(mac, 1, PRP_LAN_A));
+}
+
+void test_prp_discard_returning_node_starts_over(void) {
+    prp_discard_set_clock(&test_dd, fake_clock, 1000);
+    TEST_ASSERT_EQUAL(PRP_DECISION_ACCEPT, feed(10, PRP_LAN_A));
+
+    // Expected: a sender back after the forget time is not judged on its old window
+    fake_ns = 2000;
+    TEST_ASSERT_EQUAL(PRP_DECISION_ACCEPT, feed(10, PRP_LAN_B));
+    TEST_ASSERT_EQUAL(PRP_DECISION_DISCARD, feed(10, PRP_LAN_A));
+    TEST_ASSERT_EQUAL_UINT32(1, test_dd.forgotten);
+    TEST_ASSERT_EQUAL_UINT32(1, test_dd.node_count);
+}
+
+void test_prp_discard_parse_frame_strips_hsr_tag(void) {
+    ethernet_frame_t frame;
+    prp_decision_t decision;
+    uint16_t len = build_hsr_frame(frame_buf, 7, 0);
+
+    TEST_ASSERT_EQUAL(PROTOCOL_ERROR_NONE,
+                      prp_discard_parse_frame(&test_dd, frame_buf, len, PRP_LAN_A, &decision, &frame));
+    // Expected: The original EtherType and payload follow the source MAC
+    TEST_ASSERT_EQUAL(PRP_DECISION_ACCEPT, decision);
+    TEST_ASSERT_EQUAL_HEX16(0x88B8, frame.ethertype);
+    TEST_ASSERT_EQUAL_HEX8(0x5A, frame.payload[0]);
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(SRC_MAC, frame.source, 6);
+}
+
+int main(void) {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_prp_discard_init_invalid_params);
+    RUN_TEST(test_prp_discard_init_sizes_table_to_power_of_two);
+    RUN_TEST(test_prp_parse_tag_reads_trailer);
+    RUN_TEST(test_prp_parse_tag_rejects_suffix_with_wrong_lsdu_size);
+    RUN_TEST(test_prp_parse_tag_reads_hsr_tag);
+    RUN_TEST(test_prp_discard_second_copy_is_discarded);
+    RUN_TEST(test_prp_discard_untagged_frame_passes);
+    RUN_TEST(test_prp_discard_late_copy_within_window);
+    RUN_TEST(test_prp_discard_counts_out_of_order_per_lan);
+    RUN_TEST(test_prp_discard_counts_lost_frames_leaving_window);
+    RUN_TEST(test_prp_discard_sequence_wraparound);
+    RUN_TEST(test_prp_discard_flags_wrong_lan_id);
+    RUN_TEST(test_prp_discard_table_full_passes_frame);
+    RUN_TEST(test_prp_discard_forgets_silent_nodes);
+    RUN_TEST(test_prp_discard_returning_node_starts_over);
+    RUN_TEST(test_prp_discard_parse_frame_strips_hsr_tag);
+
+    return UNITY_END();
+}
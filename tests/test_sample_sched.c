@@ -0,0 +1,328 @@
+/* test_sample_sched.c – Unity Tests for the timing-wheel sensor sampling scheduler */
+
+#include "unity.h"
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "sample_sched.h"
+#include "device_drivers.h"
+
+// ====================================================================
+// Test Fixtures
+// ====================================================================
+
+#define TICK_NS         10000
+#define FLEET_SIZE      10000
+#define FLEET_BUSES     16
+
+static uint64_t fake_ns;
+static sample_sched_t sched;
+static i2c_driver_t buses[FLEET_BUSES];
+static sensor_driver_t sensors[FLEET_SIZE];
+static sample_sched_entry_t entries[FLEET_SIZE];
+
+static uint8_t events[32];      // Window open: 100 + bus, close: 200 + bus, read: sensor index
+static uint8_t event_count;
+
+static uint64_t fake_clock(void) {
+    return fake_ns;
+}
+
+static error_t sample_transfer(i2c_driver_t *driver, const i2c_msg_t *msgs, uint8_t count, void *context) {
+    (void)driver;
+    (void)context;
+    for (uint8_t i = 0; i < count; i++) {
+        if (msgs[i].flags & I2C_MSG_READ) {
+            memset(msgs[i].data, 0x10, msgs[i].length);
+        }
+    }
+    return ERROR_NONE;
+}
+
+static const i2c_backend_t sample_backend = {sample_transfer, NULL};
+
+static void log_window(uint8_t bus, bool open, void *context) {
+    (void)context;
+    events[event_count++] = (uint8_t)((open ? 100 : 200) + bus);
+}
+
+static void log_read(float data, void *context) {
+    (void)data;
+    events[event_count++] = (uint8_t)(intptr_t)context;
+}
+
+static void remove_self(float data, void *context) {
+    (void)data;
+    sample_sched_remove(&sched, (sample_sched_entry_t*)context);
+}
+
+// Sensor on a shared I2C bus driver
+static void make_sensor(uint16_t index, uint8_t bus, uint32_t rate) {
+    sensor_driver_t *sensor = &sensors[index];
+
+    memset(sensor, 0, sizeof(*sensor));
+    sensor->i2c = &buses[bus];
+    sensor->bus = SENSOR_BUS_I2C;
+    sensor->state = DEVICE_STATE_READY;
+    sensor->calibration_scale = 1.0f;
+    sensor->sampling_rate = rate;
+    error_log_init(&sensor->errors, ERROR_SOURCE_SENSOR);
+}
+
+// Runs the scheduler at every tick up to end_ns
+static uint64_t run_until(uint64_t end_ns) {
+    uint64_t reads = 0;
+    while (fake_ns + TICK_NS <= end_ns) {
+        fake_ns += TICK_NS;
+        reads += sample_sched_run(&sched);
+    }
+    return reads;
+}
+
+// ====================================================================
+// Setup and Teardown
+// ====================================================================
+
+void setUp(void) {
+    fake_ns = 0;
+    event_count = 0;
+    for (uint8_t i = 0; i < FLEET_BUSES; i++) {
+        memset(&buses[i], 0, sizeof(buses[i]));
+        i2c_driver_init(&buses[i], (uint8_t)(0x40 + i), 400000);
+        buses[i].backend = &sample_backend;
+    }
+    TEST_ASSERT_EQUAL(ERROR_NONE, sample_sched_init(&sched, fake_clock, TICK_NS));
+}
+
+void tearDown(void) {
+    for (uint8_t i = 0; i < FLEET_BUSES; i++) {
+        i2c_driver_deinit(&buses[i]);
+    }
+}
+
+// ====================================================================
+// Scheduling Tests
+// ====================================================================
+
+void test_sample_sched_honours_rates(void) {
+    const uint32_t rates[] = {1, 3, 10, 100, 1000};
+
+    for (uint8_t i = 0; i < 5; i++) {
+        make_sensor(i, 0, rates[i]);
+        TEST_ASSERT_EQUAL(ERROR_NONE, sample_sched_add(&sched, &entries[i], &sensors[i], 0, 0));
+    }
+    TEST_ASSERT_EQUAL_UINT32(5, sample_sched_run(&sched));
+    run_until(1000000000ULL - 1);
+
+    // Expected: one second holds exactly rate reads, never early
+    for (uint8_t i = 0; i < 5; i++) {
+        TEST_ASSERT_EQUAL_UINT32(rates[i], entries[i].reads);
+        TEST_ASSERT_EQUAL_UINT32(0, entries[i].missed);
+    }
+    TEST_ASSERT_EQUAL_UINT64(0, entries[4].max_jitter_ns);
+    TEST_ASSERT_TRUE(entries[1].max_jitter_ns < TICK_NS);
+
+    // Expected: the 1 Hz sensor came down through the upper wheel levels
+    TEST_ASSERT_GREATER_THAN(0, (uint32_t)sched.stats.cascades);
+    TEST_ASSERT_EQUAL_UINT32(1114, (uint32_t)latency_hist_count(&sched.jitter));
+}
+
+void test_sample_sched_batches_per_bus(void) {
+    const uint8_t bus_of[] = {1, 0, 2, 1, 0, 1};
+
+    sample_sched_set_window(&sched, log_window, NULL);
+    for (uint8_t i = 0; i < 6; i++) {
+        make_sensor(i, bus_of[i], 100);
+        sensors[i].data_ready_cb = log_read;
+        sensors[i].callback_context = (void*)(intptr_t)i;
+        TEST_ASSERT_EQUAL(ERROR_NONE, sample_sched_add(&sched, &entries[i], &sensors[i], bus_of[i], 5000000));
+    }
+
+    TEST_ASSERT_EQUAL_UINT32(0, sample_sched_run(&sched));
+    fake_ns = 5000000;
+    TEST_ASSERT_EQUAL_UINT32(6, sample_sched_run(&sched));
+
+    // Expected: one window per bus, each bus's reads back to back inside it
+    const uint8_t expected[] = {100, 1, 4, 200, 101, 0, 3, 5, 201, 102, 2, 202};
+    TEST_ASSERT_EQUAL_UINT8(12, event_count);
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(expected, events, 12);
+    TEST_ASSERT_EQUAL_UINT32(3, sched.stats.windows);
+    TEST_ASSERT_EQUAL_UINT32(3, sched.stats.max_batch);
+}
+
+void test_sample_sched_coalesces_bus_reads(void) {
+    const uint8_t bus_of[] = {0, 0, 0, 0, 1, 2};
+    const uint64_t phase_of[] = {10000, 30000, 70000, 100000, 30000, 30000};
+
+    // 100 us grid on bus 0; bus 2's grid is longer than the 10 ms period
+    TEST_ASSERT_EQUAL(ERROR_NONE, sample_sched_set_coalesce(&sched, 0, 95000));
+    TEST_ASSERT_EQUAL(ERROR_NONE, sample_sched_set_coalesce(&sched, 2, 20000000));
+    TEST_ASSERT_EQUAL(ERROR_INVALID_PARAM, sample_sched_set_coalesce(&sched, SAMPLE_SCHED_MAX_BUSES, 0));
+    sample_sched_set_window(&sched, log_window, NULL);
+    for (uint8_t i = 0; i < 6; i++) {
+        make_sensor(i, bus_of[i], 100);
+        sensors[i].data_ready_cb = log_read;
+        sensors[i].callback_context = (void*)(intptr_t)i;
+        TEST_ASSERT_EQUAL(ERROR_NONE, sample_sched_add(&sched, &entries[i], &sensors[i], bus_of[i], phase_of[i]));
+    }
+
+    // Expected: buses 1 and 2 read on target, bus 0 waits for its grid line
+    TEST_ASSERT_EQUAL_UINT64(2, run_until(90000));
+    TEST_ASSERT_EQUAL_UINT64(4, run_until(100000));
+    const uint8_t expected[] = {101, 4, 201, 102, 5, 202, 100, 3, 2, 1, 0, 200};
+    TEST_ASSERT_EQUAL_UINT8(12, event_count);
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(expected, events, 12);
+    TEST_ASSERT_EQUAL_UINT32(4, sched.stats.max_batch);
+    TEST_ASSERT_EQUAL_UINT64(90000, entries[0].max_jitter_ns);
+    TEST_ASSERT_EQUAL_UINT64(0, entries[3].max_jitter_ns);
+
+    // Expected: targets stay on the 10 ms grid and the next batch is whole again
+    TEST_ASSERT_EQUAL_UINT64(10010000, entries[0].due_ns);
+    TEST_ASSERT_EQUAL_UINT64(2, run_until(10090000));
+    TEST_ASSERT_EQUAL_UINT64(4, run_until(10100000));
+    TEST_ASSERT_EQUAL_UINT32(6, sched.stats.windows);
+    TEST_ASSERT_EQUAL_UINT32(4, sched.stats.max_batch);
+    TEST_ASSERT_EQUAL_UINT32(0, sched.stats.missed);
+}
+
+void test_sample_sched_late_run_skips_periods(void) {
+    make_sensor(0, 0, 100);
+    TEST_ASSERT_EQUAL(ERROR_NONE, sample_sched_add(&sched, &entries[0], &sensors[0], 0, 0));
+    TEST_ASSERT_EQUAL_UINT32(1, sample_sched_run(&sched));
+
+    // Expected: one late read for the 10 ms target, 20 and 30 ms skipped
+    fake_ns = 35000000;
+    TEST_ASSERT_EQUAL_UINT32(1, sample_sched_run(&sched));
+    TEST_ASSERT_EQUAL_UINT32(2, entries[0].missed);
+    TEST_ASSERT_EQUAL_UINT64(25000000, entries[0].max_jitter_ns);
+    TEST_ASSERT_EQUAL_UINT64(40000000, entries[0].due_ns);
+    // Expected: a wake-up hint that is never past the next target
+    TEST_ASSERT_TRUE(sample_sched_next_due(&sched) > 35000000);
+    TEST_ASSERT_TRUE(sample_sched_next_due(&sched) <= 40000000);
+
+    // Expected: back on the 10 ms grid
+    fake_ns = 40000000;
+    TEST_ASSERT_EQUAL_UINT32(1, sample_sched_run(&sched));
+    TEST_ASSERT_EQUAL_UINT64(25000000, latency_hist_percentile(&sched.jitter, 100.0));
+    TEST_ASSERT_EQUAL_UINT64(0, latency_hist_percentile(&sched.jitter, 50.0));
+
+    // Expected: a read one period late leaves the next target, due now, in place
+    fake_ns = 60000000;
+    TEST_ASSERT_EQUAL_UINT32(1, sample_sched_run(&sched));
+    TEST_ASSERT_EQUAL_UINT32(2, entries[0].missed);
+    TEST_ASSERT_EQUAL_UINT64(60000000, entries[0].due_ns);
+    fake_ns += TICK_NS;
+    TEST_ASSERT_EQUAL_UINT32(1, sample_sched_run(&sched));
+    TEST_ASSERT_EQUAL_UINT64(70000000, entries[0].due_ns);
+}
+
+void test_sample_sched_remove_and_rate_change(void) {
+    make_sensor(0, 0, 100);
+    make_sensor(1, 0, 100);
+    make_sensor(2, 0, 100);
+    sensors[2].data_ready_cb = remove_self;
+    sensors[2].callback_context = &entries[2];
+    for (uint8_t i = 0; i < 3; i++) {
+        TEST_ASSERT_EQUAL(ERROR_NONE, sample_sched_add(&sched, &entries[i], &sensors[i], 0, 0));
+    }
+    TEST_ASSERT_EQUAL_UINT32(3, sample_sched_run(&sched));
+
+    // Expected: removed entries stop, a new rate applies from the last target
+    sample_sched_remove(&sched, &entries[0]);
+    sensors[1].sampling_rate = 1000;
+    TEST_ASSERT_EQUAL(ERROR_NONE, sample_sched_update_rate(&sched, &entries[1]));
+    run_until(100000000);
+
+    TEST_ASSERT_EQUAL_UINT32(1, entries[0].reads);
+    TEST_ASSERT_EQUAL_UINT32(101, entries[1].reads);
+    TEST_ASSERT_EQUAL_UINT32(1, entries[2].reads);
+    TEST_ASSERT_EQUAL_UINT32(1, sched.count);
+
+    sensors[1].sampling_rate = 0;
+    TEST_ASSERT_EQUAL(ERROR_INVALID_PARAM, sample_sched_update_rate(&sched, &entries[1]));
+    TEST_ASSERT_EQUAL(ERROR_INVALID_PARAM, sample_sched_add(&sched, &entries[0], &sensors[1], 0, 0));
+    TEST_ASSERT_EQUAL(ERROR_INVALID_PARAM, sample_sched_add(&sched, &entries[0], &sensors[0], SAMPLE_SCHED_MAX_BUSES, 0));
+}
+
+void test_sample_sched_rejects_periods_below_tick(void) {
+    make_sensor(0, 0, 100000);
+    make_sensor(1, 0, 2000000000u);
+    make_sensor(2, 0, 100);
+
+    // Expected: 10 us is one tick and fits; 5 us and a zero period do not
+    TEST_ASSERT_EQUAL(ERROR_NONE, sample_sched_add(&sched, &entries[0], &sensors[0], 0, 0));
+    TEST_ASSERT_EQUAL_UINT64(TICK_NS, entries[0].period_ns);
+    TEST_ASSERT_EQUAL(ERROR_INVALID_PARAM, sample_sched_add(&sched, &entries[1], &sensors[1], 0, 0));
+    sensors[1].sampling_rate = 200000;
+    TEST_ASSERT_EQUAL(ERROR_INVALID_PARAM, sample_sched_add(&sched, &entries[1], &sensors[1], 0, 0));
+
+    // Expected: a rejected rate change keeps the old period
+    TEST_ASSERT_EQUAL(ERROR_NONE, sample_sched_add(&sched, &entries[2], &sensors[2], 0, 0));
+    sensors[2].sampling_rate = 2000000000u;
+    TEST_ASSERT_EQUAL(ERROR_INVALID_PARAM, sample_sched_update_rate(&sched, &entries[2]));
+    sensors[2].sampling_rate = 200000;
+    TEST_ASSERT_EQUAL(ERROR_INVALID_PARAM, sample_sched_update_rate(&sched, &entries[2]));
+    TEST_ASSERT_EQUAL_UINT64(10000000, entries[2].period_ns);
+    TEST_ASSERT_EQUAL_UINT32(2, sched.count);
+
+    TEST_ASSERT_EQUAL_UINT32(2, sample_sched_run(&sched));
+    TEST_ASSERT_EQUAL_UINT64(1001, run_until(10000000));
+    TEST_ASSERT_EQUAL_UINT32(1001, entries[0].reads);
+    TEST_ASSERT_EQUAL_UINT32(2, entries[2].reads);
+    TEST_ASSERT_EQUAL_UINT32(0, sched.stats.missed);
+}
+
+void test_sample_sched_phase_beyond_wheel(void) {
+    // 64^4 ticks of 1 ms: the first read is past the top level
+    TEST_ASSERT_EQUAL(ERROR_NONE, sample_sched_init(&sched, fake_clock, 1000000));
+    make_sensor(0, 0, 1);
+    TEST_ASSERT_EQUAL(ERROR_NONE, sample_sched_add(&sched, &entries[0], &sensors[0], 0, 20000000000000ULL));
+
+    fake_ns = 19999999000000ULL;
+    TEST_ASSERT_EQUAL_UINT32(0, sample_sched_run(&sched));
+    fake_ns = 20000000000000ULL;
+    TEST_ASSERT_EQUAL_UINT32(1, sample_sched_run(&sched));
+    TEST_ASSERT_EQUAL_UINT64(0, entries[0].max_jitter_ns);
+}
+
+void test_sample_sched_fleet_of_ten_thousand(void) {
+    const uint32_t rates[] = {1, 10, 50, 100, 200, 500};
+    uint64_t expected = 0;
+
+    for (uint16_t i = 0; i < FLEET_SIZE; i++) {
+        uint8_t bus = (uint8_t)(i % FLEET_BUSES);
+        uint32_t rate = rates[i % 6];
+        make_sensor(i, bus, rate);
+        // Spread the phases over one period
+        uint64_t phase = (uint64_t)(i / 6) * TICK_NS % (1000000000ULL / rate);
+        TEST_ASSERT_EQUAL(ERROR_NONE, sample_sched_add(&sched, &entries[i], &sensors[i], bus, phase));
+        expected += rate;
+    }
+
+    uint64_t reads = sample_sched_run(&sched) + run_until(1000000000ULL - 1);
+
+    // Expected: every sensor at its own rate, none late on a perfect clock
+    TEST_ASSERT_EQUAL_UINT32((uint32_t)expected, (uint32_t)reads);
+    for (uint16_t i = 0; i < FLEET_SIZE; i++) {
+        TEST_ASSERT_EQUAL_UINT32(rates[i % 6], entries[i].reads);
+    }
+    TEST_ASSERT_EQUAL_UINT32(0, sched.stats.missed);
+    TEST_ASSERT_EQUAL_UINT32(0, sched.stats.errors);
+    TEST_ASSERT_EQUAL_UINT64(0, latency_hist_percentile(&sched.jitter, 100.0));
+}
+
+int main(void) {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_sample_sched_honours_rates);
+    RUN_TEST(test_sample_sched_batches_per_bus);
+    RUN_TEST(test_sample_sched_coalesces_bus_reads);
+    RUN_TEST(test_sample_sched_late_run_skips_periods);
+    RUN_TEST(test_sample_sched_remove_and_rate_change);
+    RUN_TEST(test_sample_sched_rejects_periods_below_tick);
+    RUN_TEST(test_sample_sched_phase_beyond_wheel);
+    RUN_TEST(test_sample_sched_fleet_of_ten_thousand);
+
+    return UNITY_END();
+}
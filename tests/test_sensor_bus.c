@@ -0,0 +1,209 @@
+/* test_sensor_bus.c – Unity Tests for the sensor read paths on I2C, SPI and UART */
+
+#include "unity.h"
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "device_drivers.h"
+#include "peripheral_sim.h"
+
+// ====================================================================
+// Test Fixtures
+// ====================================================================
+
+SENSOR_BUS_DEFINE(thermo, i2c)
+SENSOR_BUS_DEFINE(pressure, spi)
+SENSOR_BUS_DEFINE(humidity, uart)
+
+static peripheral_sim_t sim;
+static sensor_driver_t sensor;
+static GPIO_TypeDef cs_port;
+static peripheral_sim_regmap_t regmap;
+static float reported;
+
+static const uint8_t read_command[] = {SENSOR_UART_CMD_READ, SENSOR_REG_VALUE};
+static const uint8_t read_reply[] = {0x0B, 0xB8};  // 30.00
+static const peripheral_sim_script_step_t read_steps[] = {
+    {read_command, sizeof(read_command), read_reply, sizeof(read_reply), 20000},
+};
+static peripheral_sim_script_t script;
+
+// Sample 0x09C4 (25.00) at SENSOR_REG_VALUE
+static error_t sample_transfer(i2c_driver_t *driver, const i2c_msg_t *msgs, uint8_t count, void *context) {
+    (void)driver;
+    (void)context;
+    for (uint8_t i = 0; i < count; i++) {
+        if (msgs[i].flags & I2C_MSG_READ) {
+            msgs[i].data[0] = 0x09;
+            msgs[i].data[1] = 0xC4;
+        }
+    }
+    return ERROR_NONE;
+}
+
+static const i2c_backend_t sample_backend = {sample_transfer, NULL};
+
+static void data_ready(float data, void *context) {
+    (void)context;
+    reported = data;
+}
+
+// ====================================================================
+// Setup and Teardown
+// ====================================================================
+
+void setUp(void) {
+    peripheral_sim_config_t sim_config = {8000000, 0};
+
+    memset(&sensor, 0, sizeof(sensor));
+    memset(&cs_port, 0, sizeof(cs_port));
+    memset(&regmap, 0, sizeof(regmap));
+    memset(&script, 0, sizeof(script));
+    reported = 0.0f;
+
+    cs_port.MODER = 0x1U;
+    cs_port.ODR = 0x1U;
+    regmap.regs[SENSOR_REG_VALUE] = 0x0A;  // 26.00
+    regmap.regs[SENSOR_REG_VALUE + 1] = 0x28;
+    script.steps = read_steps;
+    script.step_count = 1;
+    script.loop = true;
+
+    peripheral_sim_init(&sim, &sim_config);
+    peripheral_sim_install(&sim);
+}
+
+void tearDown(void) {
+    sensor_driver_deinit(&sensor);
+    peripheral_sim_uninstall();
+}
+
+// ====================================================================
+// Bus Read Tests
+// ====================================================================
+
+void test_sensor_bus_i2c_bound_read(void) {
+    float value = 0.0f;
+
+    TEST_ASSERT_EQUAL(ERROR_NONE, thermo_init(&sensor, 0));
+    TEST_ASSERT_EQUAL(SENSOR_BUS_I2C, sensor.bus);
+    sensor.i2c->backend = &sample_backend;
+    sensor.calibration_scale = 2.0f;
+    sensor.calibration_offset = -1.0f;
+    sensor.data_ready_cb = data_ready;
+
+    TEST_ASSERT_EQUAL(ERROR_NONE, thermo_read(&sensor, &value));
+
+    // Expected: 25.00 scaled and offset, reported to the callback
+    TEST_ASSERT_FLOAT_WITHIN(0.001f, 49.0f, value);
+    TEST_ASSERT_FLOAT_WITHIN(0.001f, 49.0f, reported);
+    TEST_ASSERT_FLOAT_WITHIN(0.001f, 49.0f, sensor.last_value);
+
+    // Expected: a path bound to another bus refuses the sensor
+    TEST_ASSERT_EQUAL(ERROR_INVALID_PARAM, pressure_read(&sensor, &value));
+    TEST_ASSERT_EQUAL(DEVICE_STATE_READY, sensor.state);
+}
+
+void test_sensor_bus_spi_register_read(void) {
+    float value = 0.0f;
+
+    TEST_ASSERT_EQUAL(ERROR_NONE, pressure_init(&sensor, 0));
+    TEST_ASSERT_NOT_NULL(sensor.spi);
+    sensor.spi->cs_gpio = &cs_port;
+    sensor.spi->cs_pin = 0;
+    peripheral_sim_device_t device = peripheral_sim_regmap_device(&regmap);
+    TEST_ASSERT_EQUAL(ERROR_NONE, peripheral_sim_attach_spi(&sim, sensor.spi->spi, &cs_port, 0, &device));
+
+    TEST_ASSERT_EQUAL(ERROR_NONE, pressure_read(&sensor, &value));
+    TEST_ASSERT_FLOAT_WITHIN(0.001f, 26.0f, value);
+
+    // Expected: the run-time path reads the same register, one chip select each
+    value = 0.0f;
+    TEST_ASSERT_EQUAL(ERROR_NONE, sensor_driver_read(&sensor, &value));
+    TEST_ASSERT_FLOAT_WITHIN(0.001f, 26.0f, value);
+    TEST_ASSERT_EQUAL_UINT32(2, regmap.transactions);
+    TEST_ASSERT_GREATER_THAN(0, peripheral_sim_now(&sim));
+}
+
+void test_sensor_bus_uart_command_read(void) {
+    float value = 0.0f;
+
+    TEST_ASSERT_EQUAL(ERROR_NONE, humidity_init(&sensor, 0));
+    TEST_ASSERT_NOT_NULL(sensor.uart);
+    peripheral_sim_device_t device = peripheral_sim_script_device(&script);
+    TEST_ASSERT_EQUAL(ERROR_NONE, peripheral_sim_attach_uart(&sim, sensor.uart->uart, &device));
+
+    for (uint8_t i = 0; i < 3; i++) {
+        TEST_ASSERT_EQUAL(ERROR_NONE, humidity_read(&sensor, &value));
+        TEST_ASSERT_FLOAT_WITHIN(0.001f, 30.0f, value);
+    }
+
+    // Expected: every command matched the script
+    TEST_ASSERT_EQUAL_UINT32(0, script.mismatches);
+}
+
+void test_sensor_bus_uart_timeout_recovers(void) {
+    float value = 0.0f;
+    peripheral_sim_device_t silent = {NULL, NULL, NULL, NULL};
+
+    TEST_ASSERT_EQUAL(ERROR_NONE, sensor_driver_init(&sensor, SENSOR_BUS_UART, 0));
+    TEST_ASSERT_EQUAL(ERROR_NONE, peripheral_sim_attach_uart(&sim, sensor.uart->uart, &silent));
+
+    // Expected: no reply times out and lands in the sensor's error log
+    TEST_ASSERT_EQUAL(ERROR_TIMEOUT, sensor_driver_read(&sensor, &value));
+    TEST_ASSERT_EQUAL_UINT32(1, error_log_count(&sensor.errors, ERROR_TIMEOUT));
+    TEST_ASSERT_EQUAL(DEVICE_STATE_ERROR, sensor.state);
+    TEST_ASSERT_EQUAL(DEVICE_STATE_ERROR, sensor.uart->state);
+
+    // Expected: the error state holds until the sensor is recovered
+    TEST_ASSERT_EQUAL(ERROR_INVALID_PARAM, sensor_driver_read(&sensor, &value));
+    TEST_ASSERT_EQUAL(ERROR_NONE, sensor_driver_recover(&sensor));
+    TEST_ASSERT_EQUAL(DEVICE_STATE_READY, sensor.uart->state);
+    TEST_ASSERT_EQUAL(ERROR_INVALID_PARAM, sensor_driver_recover(&sensor));
+
+    // Expected: the next sample goes out again once the device answers
+    peripheral_sim_uart_inject(&sim, sensor.uart->uart, read_reply, sizeof(read_reply), 100000);
+    TEST_ASSERT_EQUAL(ERROR_NONE, sensor_driver_read(&sensor, &value));
+    TEST_ASSERT_FLOAT_WITHIN(0.001f, 30.0f, value);
+}
+
+void test_sensor_bus_spi_timeout_recovers(void) {
+    float value = 0.0f;
+
+    TEST_ASSERT_EQUAL(ERROR_NONE, sensor_driver_init(&sensor, SENSOR_BUS_SPI, 0));
+
+    // Expected: no chip select wired, the read is refused before touching the bus
+    TEST_ASSERT_EQUAL(ERROR_INVALID_PARAM, sensor_driver_read(&sensor, &value));
+    TEST_ASSERT_EQUAL(DEVICE_STATE_READY, sensor.state);
+    TEST_ASSERT_EQUAL(DEVICE_STATE_READY, sensor.spi->state);
+
+    // Expected: nothing attached to the SPI port, the transfer times out
+    // instead of spinning and the error is kept
+    sensor.spi->cs_gpio = &cs_port;
+    sensor.spi->cs_pin = 0;
+    TEST_ASSERT_EQUAL(ERROR_TIMEOUT, sensor_driver_read(&sensor, &value));
+    TEST_ASSERT_EQUAL_UINT32(1, error_log_count(&sensor.errors, ERROR_TIMEOUT));
+    TEST_ASSERT_EQUAL(DEVICE_STATE_ERROR, sensor.state);
+    TEST_ASSERT_EQUAL(DEVICE_STATE_ERROR, sensor.spi->state);
+    TEST_ASSERT_EQUAL(ERROR_INVALID_PARAM, sensor_driver_read(&sensor, &value));
+
+    // Expected: recovered with the device attached, the read goes through
+    peripheral_sim_device_t device = peripheral_sim_regmap_device(&regmap);
+    TEST_ASSERT_EQUAL(ERROR_NONE, peripheral_sim_attach_spi(&sim, sensor.spi->spi, &cs_port, 0, &device));
+    TEST_ASSERT_EQUAL(ERROR_NONE, sensor_driver_recover(&sensor));
+    TEST_ASSERT_EQUAL(ERROR_NONE, sensor_driver_read(&sensor, &value));
+    TEST_ASSERT_FLOAT_WITHIN(0.001f, 26.0f, value);
+}
+
+int main(void) {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_sensor_bus_i2c_bound_read);
+    RUN_TEST(test_sensor_bus_spi_register_read);
+    RUN_TEST(test_sensor_bus_uart_command_read);
+    RUN_TEST(test_sensor_bus_uart_timeout_recovers);
+    RUN_TEST(test_sensor_bus_spi_timeout_recovers);
+
+    return UNITY_END();
+}
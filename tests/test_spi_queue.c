@@ -0,0 +1,285 @@
+/* test_spi_queue.c – Unity Tests for the queued SPI engine */
+
+#include "unity.h"
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "spi_queue.h"
+#include "peripheral_sim.h"
+
+// ====================================================================
+// Test Fixtures
+// ====================================================================
+
+static peripheral_sim_t sim;
+static spi_driver_t spi_drv;
+static spi_queue_t queue;
+static DMA_Channel_TypeDef dma_tx;
+static DMA_Channel_TypeDef dma_rx;
+static GPIO_TypeDef cs_port;
+static peripheral_sim_regmap_t adc[2];
+
+// Two ADCs on PA0 and PA1, the second clocked four times slower
+static const spi_device_t adc0 = {&cs_port, 0, 0, 1};
+static const spi_device_t adc1 = {&cs_port, 1, 3, 3};
+
+static uint32_t completions;
+static error_t last_result;
+static spi_transaction_t *last_txn;
+
+static void on_complete(spi_transaction_t *txn, error_t result, void *context) {
+    (void)context;
+    completions++;
+    last_result = result;
+    last_txn = txn;
+}
+
+static void spi_dma_isr(void *context) {
+    spi_queue_process_interrupt((spi_queue_t*)context);
+}
+
+static void attach_dma(void) {
+    spi_drv.dma_tx = &dma_tx;
+    spi_drv.dma_rx = &dma_rx;
+    peripheral_sim_attach_dma(&sim, &dma_tx, spi_drv.spi, true);
+    peripheral_sim_attach_dma(&sim, &dma_rx, spi_drv.spi, false);
+    peripheral_sim_set_irq(&sim, &dma_rx, spi_dma_isr, &queue);
+}
+
+static void run_until_idle(void) {
+    while (!spi_queue_idle(&queue) && peripheral_sim_step(&sim)) {
+    }
+}
+
+static void read_txn(spi_transaction_t *txn, spi_segment_t *segments, const spi_device_t *device,
+                     uint8_t *tx, uint8_t *rx, uint16_t length) {
+    memset(txn, 0, sizeof(spi_transaction_t));
+    segments[0].tx = tx;
+    segments[0].rx = rx;
+    segments[0].length = length;
+    txn->device = device;
+    txn->segments = segments;
+    txn->segment_count = 1;
+    txn->completion_cb = on_complete;
+}
+
+// ====================================================================
+// Setup and Teardown
+// ====================================================================
+
+void setUp(void) {
+    peripheral_sim_config_t sim_config = {8000000, 0};
+    spi_config_t config = {1, 8, 0, 0, false, false};
+
+    memset(&spi_drv, 0, sizeof(spi_drv));
+    memset(&dma_tx, 0, sizeof(dma_tx));
+    memset(&dma_rx, 0, sizeof(dma_rx));
+    memset(&cs_port, 0, sizeof(cs_port));
+    memset(adc, 0, sizeof(adc));
+    completions = 0;
+    last_result = ERROR_BUSY;
+    last_txn = NULL;
+
+    cs_port.MODER = 0x5U;  // PA0, PA1 outputs
+    cs_port.ODR = 0x3U;    // Both chip selects idle high
+    for (uint8_t i = 0; i < 2; i++) {
+        adc[i].regs[0x10] = (uint8_t)(0xA0 + i);
+        adc[i].regs[0x11] = (uint8_t)(0xB0 + i);
+    }
+
+    peripheral_sim_init(&sim, &sim_config);
+    peripheral_sim_install(&sim);
+    spi_driver_init(&spi_drv, &config);
+
+    peripheral_sim_device_t dev0 = peripheral_sim_regmap_device(&adc[0]);
+    peripheral_sim_device_t dev1 = peripheral_sim_regmap_device(&adc[1]);
+    peripheral_sim_attach_spi(&sim, spi_drv.spi, &cs_port, 0, &dev0);
+    peripheral_sim_attach_spi(&sim, spi_drv.spi, &cs_port, 1, &dev1);
+    spi_queue_init(&queue, &spi_drv, peripheral_sim_clock);
+}
+
+void tearDown(void) {
+    peripheral_sim_uninstall();
+    spi_driver_deinit(&spi_drv);
+}
+
+// ====================================================================
+// Descriptor Validation Tests
+// ====================================================================
+
+void test_spi_queue_rejects_invalid_descriptors(void) {
+    spi_transaction_t txn;
+    spi_segment_t segment = {NULL, NULL, 0};
+
+    read_txn(&txn, &segment, &adc0, NULL, NULL, 0);
+    // Expected: Empty segments and missing devices are refused up front
+    TEST_ASSERT_EQUAL(ERROR_INVALID_PARAM, spi_queue_init(NULL, &spi_drv, NULL));
+    TEST_ASSERT_EQUAL(ERROR_INVALID_PARAM, spi_queue_submit(&queue, &txn));
+    segment.length = 1;
+    txn.device = NULL;
+    TEST_ASSERT_EQUAL(ERROR_INVALID_PARAM, spi_queue_submit(&queue, &txn));
+    TEST_ASSERT_TRUE(spi_queue_idle(&queue));
+}
+
+// ====================================================================
+// DMA Execution Tests
+// ====================================================================
+
+void test_spi_queue_dma_reads_two_devices(void) {
+    uint8_t tx[3] = {0x10 | PERIPHERAL_SIM_REGMAP_READ, 0, 0};
+    uint8_t rx0[3] = {0};
+    uint8_t rx1[3] = {0};
+    spi_segment_t seg0[1];
+    spi_segment_t seg1[1];
+    spi_transaction_t t0;
+    spi_transaction_t t1;
+    attach_dma();
+
+    read_txn(&t0, seg0, &adc0, tx, rx0, 3);
+    read_txn(&t1, seg1, &adc1, tx, rx1, 3);
+    TEST_ASSERT_EQUAL(ERROR_NONE, spi_queue_submit(&queue, &t0));
+    TEST_ASSERT_EQUAL(ERROR_NONE, spi_queue_submit(&queue, &t1));
+    // Expected: Bus owned by the queue; blocking transfers are refused
+    TEST_ASSERT_EQUAL(DEVICE_STATE_BUSY, spi_drv.state);
+    TEST_ASSERT_EQUAL(ERROR_INVALID_PARAM, spi_driver_transfer(&spi_drv, tx, rx0, 3));
+    run_until_idle();
+
+    // Expected: Each device answered under its own chip select and prescaler
+    TEST_ASSERT_EQUAL_UINT32(2, completions);
+    TEST_ASSERT_EQUAL_HEX8(0xA0, rx0[1]);
+    TEST_ASSERT_EQUAL_HEX8(0xB0, rx0[2]);
+    TEST_ASSERT_EQUAL_HEX8(0xA1, rx1[1]);
+    TEST_ASSERT_EQUAL_HEX8(0xB1, rx1[2]);
+    TEST_ASSERT_EQUAL_UINT32(1, adc[0].transactions);
+    TEST_ASSERT_EQUAL_UINT32(1, adc[1].transactions);
+    TEST_ASSERT_EQUAL_HEX32(0x3U, cs_port.ODR);
+    TEST_ASSERT_EQUAL(DEVICE_STATE_READY, spi_drv.state);
+
+    // Expected: 3 bytes at 2 MHz (12 us), then 3 bytes at 500 kHz (48 us)
+    TEST_ASSERT_EQUAL_UINT64(12000, t0.completed_at - t0.started_at);
+    TEST_ASSERT_EQUAL_UINT64(48000, t1.completed_at - t1.started_at);
+    TEST_ASSERT_EQUAL_UINT64(60000, t1.completed_at - t1.submitted_at);
+    TEST_ASSERT_EQUAL_UINT32(2, queue.stats.reconfigurations);
+}
+
+void test_spi_queue_merges_contiguous_segments(void) {
+    uint8_t tx[4] = {0x10 | PERIPHERAL_SIM_REGMAP_READ, 0, 0, 0};
+    uint8_t rx[4] = {0};
+    uint8_t tail[2] = {0};
+    spi_segment_t segments[3] = {{tx, rx, 1}, {tx + 1, rx + 1, 2}, {NULL, tail, 2}};
+    spi_transaction_t txn;
+    attach_dma();
+
+    read_txn(&txn, segments, &adc0, tx, rx, 1);
+    txn.segment_count = 3;
+    TEST_ASSERT_EQUAL(ERROR_NONE, spi_queue_submit(&queue, &txn));
+    run_until_idle();
+
+    // Expected: Command and data share one DMA run; the NULL-TX tail is a
+    // second run under the same chip select, clocking out 0xFF
+    TEST_ASSERT_EQUAL(ERROR_NONE, last_result);
+    TEST_ASSERT_EQUAL_UINT32(3, queue.stats.segments);
+    TEST_ASSERT_EQUAL_UINT32(2, queue.stats.dma_runs);
+    TEST_ASSERT_EQUAL_UINT32(1, queue.stats.cs_assertions);
+    TEST_ASSERT_EQUAL_UINT32(1, adc[0].transactions);
+    TEST_ASSERT_EQUAL_HEX8(0xA0, rx[1]);
+    TEST_ASSERT_EQUAL_HEX8(0xB0, rx[2]);
+    TEST_ASSERT_EQUAL_HEX8(0x00, tail[0]);  // Registers 0x12, 0x13 are clear
+    TEST_ASSERT_EQUAL_UINT64(5, queue.stats.bytes);
+}
+
+void test_spi_queue_cs_hold_spans_transactions(void) {
+    uint8_t address[1] = {0x10 | PERIPHERAL_SIM_REGMAP_READ};
+    uint8_t scratch[1];
+    uint8_t data[2] = {0};
+    spi_segment_t seg0[1];
+    spi_segment_t seg1[1] = {{NULL, data, 2}};
+    spi_transaction_t t0;
+    spi_transaction_t t1;
+    attach_dma();
+
+    read_txn(&t0, seg0, &adc0, address, scratch, 1);
+    t0.cs_hold = true;
+    read_txn(&t1, seg1, &adc0, NULL, data, 2);
+    t1.segments = seg1;
+    spi_queue_submit(&queue, &t0);
+    spi_queue_submit(&queue, &t1);
+    run_until_idle();
+
+    // Expected: Address phase and data phase form one device transaction
+    TEST_ASSERT_EQUAL_UINT32(2, completions);
+    TEST_ASSERT_EQUAL_UINT32(1, queue.stats.cs_assertions);
+    TEST_ASSERT_EQUAL_UINT32(1, adc[0].transactions);
+    TEST_ASSERT_EQUAL_HEX8(0xA0, data[0]);
+    TEST_ASSERT_EQUAL_HEX8(0xB0, data[1]);
+    TEST_ASSERT_TRUE(cs_port.ODR & 0x1U);
+}
+
+void test_spi_queue_reports_latency_and_utilization(void) {
+    uint8_t tx[3] = {0x10 | PERIPHERAL_SIM_REGMAP_READ, 0, 0};
+    uint8_t rx[4][3];
+    spi_segment_t segments[4][1];
+    spi_transaction_t txns[4];
+    attach_dma();
+
+    for (uint8_t i = 0; i < 4; i++) {
+        read_txn(&txns[i], segments[i], &adc0, tx, rx[i], 3);
+        spi_queue_submit(&queue, &txns[i]);
+    }
+    run_until_idle();
+
+    const spi_queue_stats_t *stats = spi_queue_get_stats(&queue);
+    // Expected: Queued back to back, the n-th read waits for n-1 before it
+    TEST_ASSERT_EQUAL_UINT32(4, stats->transactions);
+    TEST_ASSERT_EQUAL_UINT64(48000, stats->latency.max_ns);
+    TEST_ASSERT_EQUAL_UINT32(4, (uint32_t)latency_hist_count(&stats->latency));
+    TEST_ASSERT_EQUAL_UINT64(12000 + 24000 + 36000 + 48000, stats->total_ns);
+    TEST_ASSERT_EQUAL_UINT64(48000, stats->busy_ns);
+    TEST_ASSERT_FLOAT_WITHIN(0.001f, 1.0f, spi_queue_utilization(&queue));
+    TEST_ASSERT_EQUAL_UINT64(48000, latency_hist_percentile(&stats->latency, 100.0));
+    // Expected: the median is the second read, within the histogram's 1/32
+    uint64_t median = latency_hist_percentile(&stats->latency, 50.0);
+    TEST_ASSERT_TRUE(median >= 24000 && median <= 24000 + 24000 / 32);
+
+    peripheral_sim_advance(&sim, 48000);
+    // Expected: Idle time halves utilization
+    TEST_ASSERT_FLOAT_WITHIN(0.001f, 0.5f, spi_queue_utilization(&queue));
+}
+
+// ====================================================================
+// Polled Fallback Tests
+// ====================================================================
+
+void test_spi_queue_polled_without_dma(void) {
+    uint8_t tx[3] = {0x11 | PERIPHERAL_SIM_REGMAP_READ, 0, 0};
+    uint8_t rx[3] = {0};
+    spi_segment_t segments[2] = {{tx, NULL, 1}, {NULL, rx, 2}};
+    spi_transaction_t txn;
+
+    read_txn(&txn, segments, &adc1, tx, NULL, 1);
+    txn.segment_count = 2;
+    TEST_ASSERT_EQUAL(ERROR_NONE, spi_queue_submit(&queue, &txn));
+
+    // Expected: Completed inside submit with spi_transmit_receive
+    TEST_ASSERT_EQUAL_UINT32(1, completions);
+    TEST_ASSERT_EQUAL_PTR(&txn, last_txn);
+    TEST_ASSERT_EQUAL_HEX8(0xB1, rx[0]);
+    TEST_ASSERT_EQUAL_UINT32(0, queue.stats.dma_runs);
+    TEST_ASSERT_EQUAL_UINT32(1, adc[1].transactions);
+    TEST_ASSERT_TRUE(spi_queue_idle(&queue));
+}
+
+int main(void) {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_spi_queue_rejects_invalid_descriptors);
+    RUN_TEST(test_spi_queue_dma_reads_two_devices);
+    RUN_TEST(test_spi_queue_merges_contiguous_segments);
+    RUN_TEST(test_spi_queue_cs_hold_spans_transactions);
+    RUN_TEST(test_spi_queue_reports_latency_and_utilization);
+    RUN_TEST(test_spi_queue_polled_without_dma);
+
+    return UNITY_END();
+}
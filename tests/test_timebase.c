@@ -0,0 +1,188 @@
+/* test_timebase.c – Unity Tests for the monotonic timebase and event stamping */
+
+#define _POSIX_C_SOURCE 199309L
+#include "unity.h"
+#include <stdint.h>
+#include <stdbool.h>
+#include <time.h>
+
+#include "timebase.h"
+#include "communication_protocols.h"
+#include "device_drivers.h"
+#include "safety_critical.h"
+
+// ====================================================================
+// Test Fixtures
+// ====================================================================
+
+static uint64_t custom_now;
+
+static uint64_t custom_clock(void) {
+    return custom_now;
+}
+
+static uint64_t monotonic_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static uint32_t watchdog_fired;
+
+static void on_watchdog(void *context) {
+    (void)context;
+    watchdog_fired++;
+}
+
+// ====================================================================
+// Setup and Teardown
+// ====================================================================
+
+void setUp(void) {
+    timebase_init(TIMEBASE_SOURCE_SIMULATED);
+    watchdog_fired = 0;
+}
+
+void tearDown(void) {
+    timebase_init(TIMEBASE_SOURCE_MONOTONIC);
+}
+
+// ====================================================================
+// Source Tests
+// ====================================================================
+
+void test_timebase_simulated_clock(void) {
+    TEST_ASSERT_EQUAL(TIMEBASE_SOURCE_SIMULATED, timebase_get_source());
+    TEST_ASSERT_EQUAL_UINT64(0, timebase_now_ns());
+
+    timebase_sim_advance(1500);
+    TEST_ASSERT_EQUAL_UINT64(1500, timebase_now_ns());
+    TEST_ASSERT_EQUAL_UINT32(1, timebase_now_us());
+
+    // Expected: microsecond and millisecond views truncate, not round
+    timebase_sim_set(2999999999ULL);
+    TEST_ASSERT_EQUAL_UINT32(2999999, timebase_now_us());
+    TEST_ASSERT_EQUAL_UINT32(2999, timebase_now_ms());
+
+    // Expected: re-selecting the source restarts it at zero
+    timebase_init(TIMEBASE_SOURCE_SIMULATED);
+    TEST_ASSERT_EQUAL_UINT64(0, timebase_now_ns());
+}
+
+void test_timebase_custom_clock(void) {
+    custom_now = 123456789;
+    timebase_use_clock(custom_clock);
+    TEST_ASSERT_EQUAL(TIMEBASE_SOURCE_CUSTOM, timebase_get_source());
+    TEST_ASSERT_EQUAL_UINT64(123456789, timebase_now_ns());
+    TEST_ASSERT_EQUAL_UINT32(123456, timebase_now_us());
+
+    // Expected: NULL falls back to CLOCK_MONOTONIC
+    timebase_use_clock(NULL);
+    TEST_ASSERT_EQUAL(TIMEBASE_SOURCE_MONOTONIC, timebase_get_source());
+    TEST_ASSERT_FALSE(timebase_init(TIMEBASE_SOURCE_CUSTOM));
+}
+
+void test_timebase_cycle_counter_tracks_monotonic(void) {
+    if (!timebase_init(TIMEBASE_SOURCE_CYCLE_COUNTER)) {
+        // Expected: no usable counter leaves the monotonic source selected
+        TEST_ASSERT_EQUAL(TIMEBASE_SOURCE_MONOTONIC, timebase_get_source());
+        return;
+    }
+    TEST_ASSERT_EQUAL(TIMEBASE_SOURCE_CYCLE_COUNTER, timebase_get_source());
+    TEST_ASSERT_GREATER_THAN(1000000, timebase_counter_hz());
+
+    // Expected: never steps backwards
+    uint64_t previous = timebase_now_ns();
+    for (uint32_t i = 0; i < 100000; i++) {
+        uint64_t now = timebase_now_ns();
+        TEST_ASSERT_GREATER_OR_EQUAL(previous, now);
+        previous = now;
+    }
+
+    // Expected: same epoch and rate as CLOCK_MONOTONIC, within 1 ms after
+    // a 20 ms interval
+    uint64_t counter_start = timebase_now_ns();
+    uint64_t monotonic_start = monotonic_ns();
+    while (monotonic_ns() - monotonic_start < 20000000ULL) {
+    }
+    uint64_t counter_end = timebase_now_ns();
+    uint64_t monotonic_end = monotonic_ns();
+
+    int64_t offset = (int64_t)(counter_end - monotonic_end);
+    int64_t drift = (int64_t)((counter_end - counter_start) - (monotonic_end - monotonic_start));
+    TEST_ASSERT_LESS_THAN(1000000, offset < 0 ? -offset : offset);
+    TEST_ASSERT_LESS_THAN(1000000, drift < 0 ? -drift : drift);
+}
+
+// ====================================================================
+// Event Stamping Tests
+// ====================================================================
+
+void test_timebase_stamps_can_and_sensor_events(void) {
+    can_handle_t can;
+    can_frame_t frame = {0};
+    can_frame_t received;
+    sensor_driver_t sensor = {0};
+    float value;
+
+    TEST_ASSERT_EQUAL(PROTOCOL_ERROR_NONE, can_init(&can, 4));
+    frame.id = 0x123;
+    frame.dlc = 2;
+
+    // Expected: reception is stamped when the frame enters the RX queue
+    timebase_sim_set(5000000);
+    TEST_ASSERT_EQUAL(PROTOCOL_ERROR_NONE, can_process_rx(&can, &frame));
+    timebase_sim_advance(250000);
+    TEST_ASSERT_EQUAL(PROTOCOL_ERROR_NONE, can_receive_message(&can, &received, 0));
+    TEST_ASSERT_EQUAL_UINT32(5000, received.timestamp);
+    TEST_ASSERT_EQUAL_UINT32(0x123, received.id);
+
+    TEST_ASSERT_EQUAL(ERROR_NONE, sensor_driver_init(&sensor, 0, 0));
+    timebase_sim_set(7000000);
+    TEST_ASSERT_EQUAL(ERROR_NONE, sensor_driver_read(&sensor, &value));
+    TEST_ASSERT_EQUAL_UINT32(7000, sensor.last_reading_time);
+
+    sensor_driver_deinit(&sensor);
+    can_deinit(&can);
+}
+
+void test_timebase_drives_watchdog_and_vote(void) {
+    watchdog_t wd = {0};
+    tmr_sensor_t tmr;
+    uint8_t ids[TMR_SENSOR_COUNT] = {1, 2, 3};
+
+    timebase_sim_set(1000000000ULL);
+    TEST_ASSERT_EQUAL(ERROR_NONE, watchdog_init(&wd, 100));
+    wd.timeout_cb = on_watchdog;
+
+    // Expected: expiry follows the timebase, not the number of checks
+    timebase_sim_advance(100000000ULL);
+    TEST_ASSERT_FALSE(watchdog_check_expired(&wd));
+    timebase_sim_advance(1000000ULL);
+    TEST_ASSERT_TRUE(watchdog_check_expired(&wd));
+    TEST_ASSERT_EQUAL_UINT32(1, watchdog_fired);
+
+    watchdog_feed(&wd);
+    TEST_ASSERT_FALSE(watchdog_check_expired(&wd));
+    TEST_ASSERT_EQUAL_UINT32(1101, wd.last_feed_time);
+
+    tmr_sensor_init(&tmr, ids);
+    for (uint8_t i = 0; i < TMR_SENSOR_COUNT; i++) {
+        tmr.sensors[i].temperature = 20.0f + i;
+    }
+    timebase_sim_set(3000000000ULL);
+    TEST_ASSERT_EQUAL(ERROR_NONE, tmr_sensor_vote(&tmr, VOTE_MEDIAN));
+    TEST_ASSERT_EQUAL_UINT32(3000000, tmr.last_vote_time);
+}
+
+int main(void) {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_timebase_simulated_clock);
+    RUN_TEST(test_timebase_custom_clock);
+    RUN_TEST(test_timebase_cycle_counter_tracks_monotonic);
+    RUN_TEST(test_timebase_stamps_can_and_sensor_events);
+    RUN_TEST(test_timebase_drives_watchdog_and_vote);
+
+    return UNITY_END();
+}